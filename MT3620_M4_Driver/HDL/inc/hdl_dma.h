@@ -246,6 +246,8 @@ u32 mtk_hdl_dma_get_pgmaddr(void __iomem *chn_base);
 int mtk_hdl_dma_set_altlen(void __iomem *chn_base, u8 altscm, u32 altlen);
 int mtk_hdl_dma_set_ffsize(void __iomem *chn_base, u32 ffsize, u8 transize);
 void mtk_hdl_dma_set_timeout_thr(void __iomem *chn_base, u32 ff_timeout);
+u32 mtk_hdl_dma_get_timeout_thr(void __iomem *chn_base);
+void mtk_hdl_dma_set_timeout_int(void __iomem *chn_base, u8 enable);
 u32 mtk_hdl_dma_get_hwptr(void __iomem *chn_base);
 void mtk_hdl_dma_set_swptr(void __iomem *chn_base, u32 swptr);
 u32 mtk_hdl_dma_get_swptr(void __iomem *chn_base);
@@ -273,12 +273,17 @@ int mtk_hdl_i2c_master_trigger_transfer(void __iomem *i2c_base, u8 op,
 void mtk_hdl_i2c_master_start(void __iomem *i2c_base, bool dma_en);
 int mtk_hdl_i2c_master_get_data(void __iomem *i2c_base, u8 *buf, u16 data_len);
 int mtk_hdl_i2c_master_check_fifo_sta(void __iomem *i2c_base);
+bool mtk_hdl_i2c_master_bus_busy(void __iomem *i2c_base);
 
 void mtk_hdl_i2c_init_slave_addr(void __iomem *i2c_base, u8 slv_addr);
 void mtk_hdl_i2c_slave_irq_handle(void __iomem *i2c_base, u32 *irq_stat);
 void mtk_hdl_i2c_slave_trigger_transfer(void __iomem *i2c_base, bool dma_en);
 int mtk_hdl_i2c_slave_get_data(void __iomem *i2c_base, u8 *buf, u16 len);
 int mtk_hdl_i2c_slave_check_fifo_sta(void __iomem *i2c_base);
+int mtk_hdl_i2c_slave_read_fifo(void __iomem *i2c_base, u8 *buf, u16 max_len);
+u8 mtk_hdl_i2c_slave_tx_fifo_size(void __iomem *i2c_base);
+void mtk_hdl_i2c_slave_clear_tx_fifo(void __iomem *i2c_base);
+bool mtk_hdl_i2c_slave_received_read(void __iomem *i2c_base);
 
 #ifdef __cplusplus
 }
@@ -164,6 +164,7 @@ extern "C" {
 void mtk_hdl_spim_dump_reg(void __iomem *base);
 void mtk_hdl_spim_print_packet(char *name, u8 *ptr, int len);
 void mtk_hdl_spim_clear_irq_status(void __iomem *base);
+u32 mtk_hdl_spim_get_irq_status(void __iomem *base);
 void mtk_hdl_spim_fifo_handle_rx(void __iomem *base,
 	const void *tx_buf, void *rx_buf, u32 len);
 void mtk_hdl_spim_prepare_hw(void __iomem *base,
@@ -174,6 +174,22 @@ void mtk_hdl_dma_set_timeout_thr(void __iomem *chn_base, u32 ff_timeout)
 	osai_writel(ff_timeout, DMA_TO(chn_base));
 }
 
+u32 mtk_hdl_dma_get_timeout_thr(void __iomem *chn_base)
+{
+	return osai_readl(DMA_TO(chn_base));
+}
+
+void mtk_hdl_dma_set_timeout_int(void __iomem *chn_base, u8 enable)
+{
+	u32 value = osai_readl(DMA_CON(chn_base));
+
+	if (enable)
+		value |= DMA_CON_TOEN;
+	else
+		value &= ~DMA_CON_TOEN;
+	osai_writel(value, DMA_CON(chn_base));
+}
+
 u32 mtk_hdl_dma_get_hwptr(void __iomem *chn_base)
 {
 	return osai_readl(DMA_HWPTR(chn_base)) &
@@ -361,6 +361,12 @@ int mtk_hdl_i2c_master_check_fifo_sta(void __iomem *i2c_base)
 	return ret;
 }
 
+bool mtk_hdl_i2c_master_bus_busy(void __iomem *i2c_base)
+{
+	return !!(_mtk_hdl_i2c_readl(i2c_base, OFFSET_MM_STATUS) &
+		  I2C_BUS_BUSY);
+}
+
 void mtk_hdl_i2c_init_slave_addr(void __iomem *i2c_base, u8 slv_addr)
 {
 	_mtk_hdl_i2c_writel(i2c_base, slv_addr, OFFSET_S_ID_CON0);
@@ -456,3 +462,46 @@ int mtk_hdl_i2c_slave_check_fifo_sta(void __iomem *i2c_base)
 	return ret;
 }
 
+int mtk_hdl_i2c_slave_read_fifo(void __iomem *i2c_base, u8 *buf, u16 max_len)
+{
+	u16 data_len;
+	u16 i;
+
+	data_len = _mtk_hdl_i2c_slave_rx_fifo_size(i2c_base) & 0xf;
+	if (data_len > max_len)
+		data_len = max_len;
+
+	for (i = 0; i < data_len; i++)
+		buf[i] = _mtk_hdl_i2c_readl(i2c_base, OFFSET_S_FIFO_DATA);
+
+	return data_len;
+}
+
+u8 mtk_hdl_i2c_slave_tx_fifo_size(void __iomem *i2c_base)
+{
+	u8 tx_wptr = 0;
+	u8 tx_rptr = 0;
+	u32 reg_val;
+
+	reg_val = _mtk_hdl_i2c_readl(i2c_base, OFFSET_S_FIFO_PTR);
+	tx_wptr = (reg_val & I2C_S_TX_FIFO_WPTR_MASK) >>
+		  I2C_S_TX_FIFO_WPTR_OFFSET;
+	tx_rptr = (reg_val & I2C_S_TX_FIFO_RPTR_MASK) >>
+		  I2C_S_TX_FIFO_RPTR_OFFSET;
+
+	if (tx_wptr >= tx_rptr)
+		return tx_wptr - tx_rptr;
+
+	return I2C_FIFO_MAX_LEN - (tx_rptr - tx_wptr);
+}
+
+void mtk_hdl_i2c_slave_clear_tx_fifo(void __iomem *i2c_base)
+{
+	_mtk_hdl_i2c_writel(i2c_base, I2C_S_TX_FIFO_CLR, OFFSET_S_FIFO_CON0);
+}
+
+bool mtk_hdl_i2c_slave_received_read(void __iomem *i2c_base)
+{
+	return !!(_mtk_hdl_i2c_readl(i2c_base, OFFSET_S_ID_RECEIVED0) &
+		  I2C_S_RECEIVED_READ);
+}
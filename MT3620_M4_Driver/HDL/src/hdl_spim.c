@@ -169,6 +169,12 @@ void mtk_hdl_spim_clear_irq_status(void __iomem *base)
 	osai_readl(SPI_REG_STATUS(base));
 }
 
+u32 mtk_hdl_spim_get_irq_status(void __iomem *base)
+{
+	/* read clears the status, like mtk_hdl_spim_clear_irq_status */
+	return osai_readl(SPI_REG_STATUS(base));
+}
+
 /* fifo mode and rx only, afer transfer sw should copy rx data to rx_buf */
 void mtk_hdl_spim_fifo_handle_rx(void __iomem *base,
 	const void *tx_buf, void *rx_buf, u32 len)
@@ -332,6 +332,20 @@ struct mtk_adc_controller {
 	dma_addr_t	rx_addr;
 	/** ADC DMA channel number */
 	u8 dma_channel;
+	/** VFF DMA timeout in DMA bus clock cycles, 0 disables it.\n
+	 * When no sample lands for that long, the samples of the unfinished\n
+	 * period are handed to rx_callback_func.
+	 */
+	u32 rx_timeout;
+	/** Byte offset in the Virtual FIFO of the data handed to the last\n
+	 * rx_callback_func call.
+	 */
+	u32 rx_pos;
+	/** Bytes handed to the last rx_callback_func call, rx_period_len\n
+	 * or less after a timeout. They may wrap to the start of the\n
+	 * Virtual FIFO.
+	 */
+	u32 rx_len;
 };
 
 /**
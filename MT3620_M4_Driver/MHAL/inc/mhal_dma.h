@@ -223,6 +223,10 @@ enum dma_param {
 	DMA_PARAM_VFF_HWPTR = 5,
 	/** Software pointer, only for VFF DMA */
 	DMA_PARAM_VFF_SWPTR = 6,
+	/** FIFO timeout threshold in bus clock cycles, only for VFF DMA.
+	 * Setting it also enables the timeout interrupt, 0 disables it.
+	 */
+	DMA_PARAM_VFF_TIMEOUT = 7,
 };
 
 /** @brief DMA dma_status definition. DMA device has registers to check the
@@ -465,6 +469,27 @@ extern "C" {
  */
 int mtk_mhal_dma_config(struct dma_controller *controller);
 
+/**
+ * @brief This function is used to re-arm one configured DMA channel.
+ * @brief Usage: OS-HAL driver can call it instead of #mtk_mhal_dma_config()
+ * when the\n channel has already been configured once and only the addresses
+ * and\n the byte count change between transfers. Only the address and count
+ * registers\n are written (SRC/DST/COUNT for FULL-SIZE DMA, PGMADDR/COUNT
+ * for HALF-SIZE DMA),\n the control, wrap and limiter registers keep the
+ * values of the last\n #mtk_mhal_dma_config() call. VFF DMA is not supported,
+ * its FIFO pointers\n are maintained by #mtk_mhal_dma_update_swptr().
+ * @param [in] controller : The pointer of struct dma_controller, the new
+ * addresses\n and count are taken from controller->cfg.
+ *
+ * @return
+ * Return 0 if users re-arm DMA channel successfully.\n
+ * Return -#DMA_EPARAM if users input error parameters or the channel is
+ * VFF DMA.\n
+ * Return -#DMA_EBUSY if DMA channel is running.\n
+ * Return -#DMA_EPTR if controller is NULL.
+ */
+int mtk_mhal_dma_rearm(struct dma_controller *controller);
+
 /**
  * @brief This function is used to start one DMA channel.
  * @brief Usage: OS-HAL driver should call it after configuring DMA
@@ -296,6 +296,12 @@ struct mtk_i2c_controller {
 	/** I2C supports FIFO mode and DMA mode, 0: FIFO mode, 1: DMA mode*/
 	bool dma_en;
 
+	/** Messages longer than this many bytes are moved by DMA,
+	 * shorter ones through the FIFO. 0 means the FIFO depth (8),
+	 * larger values are limited to the FIFO depth.
+	 */
+	u16 dma_threshold;
+
 	/** Interrupt flag, this parameter will be set
 	 * in #mtk_mhal_i2c_irq_handle(). The OS-HAL driver
 	 * can judge the transmission status based on this flag.
@@ -523,6 +529,95 @@ int mtk_mhal_i2c_request_dma(struct mtk_i2c_controller *i2c);
  */
 int mtk_mhal_i2c_release_dma(struct mtk_i2c_controller *i2c);
 
+/**
+ *@brief This function is used to check whether the bus is held busy,
+ * e.g. by a slave that keeps SDA low after an interrupted transfer.
+ *@brief Usage: OS-HAL driver calls it before a master transfer and
+ * after a reset to decide whether the bus needs to be recovered.
+ *@param [in] i2c : mtk_i2c_controller pointer, it contains register
+ * base address, data transmission information and i2c hardware information.
+ *@return
+ * Return 1 if the controller sees the bus busy, 0 if it is idle.\n
+ * Return -#I2C_EPTR if i2c is NULL.\n
+ * Return -#I2C_EINVAL if *i2c contains illegal parameter.
+ */
+int mtk_mhal_i2c_bus_busy(struct mtk_i2c_controller *i2c);
+
+/**
+ *@brief This function is used to start the persistent slave mode.
+ *@brief Usage: OS-HAL driver calls it after mtk_mhal_i2c_init_slv_addr().
+ * The controller then answers its slave address until it is reset, and
+ * raises the slave interrupt at the end of every transaction. Data is
+ * moved through the FIFO only, up to 8 bytes per transaction.
+ *@param [in] i2c : mtk_i2c_controller pointer, it contains register
+ * base address, data transmission information and i2c hardware information.
+ *@return
+ * Return "0" if the slave mode is started successfully.\n
+ * Return -#I2C_EPTR if i2c is NULL.\n
+ * Return -#I2C_EINVAL if i2c is not in slave mode.
+ */
+int mtk_mhal_i2c_slave_stream_start(struct mtk_i2c_controller *i2c);
+
+/**
+ *@brief This function is used to handle the interrupt of the persistent
+ * slave mode.
+ *@brief Usage: OS-HAL driver calls it in the I2C irq handler, then
+ * drains the RX FIFO after a write of the master, or refills the TX
+ * FIFO after a read.
+ *@param [in] i2c : mtk_i2c_controller pointer, it contains register
+ * base address, data transmission information and i2c hardware information.
+ *@param [out] is_read : 1 if the master read from the slave, 0 if it
+ * wrote.
+ *@return
+ * Return "0" if the transaction is done.\n
+ * Return -#I2C_EFIFO if a FIFO overflowed or underflowed.
+ */
+int mtk_mhal_i2c_slave_stream_irq(struct mtk_i2c_controller *i2c,
+				  u8 *is_read);
+
+/**
+ *@brief This function is used to read what the master wrote.
+ *@param [in] i2c : mtk_i2c_controller pointer, it contains register
+ * base address, data transmission information and i2c hardware information.
+ *@param [out] buf : the received bytes.
+ *@param [in] max_len : size of buf.
+ *@return
+ * Return the number of bytes read from the RX FIFO.
+ */
+int mtk_mhal_i2c_slave_fifo_read(struct mtk_i2c_controller *i2c,
+				 u8 *buf, u16 max_len);
+
+/**
+ *@brief This function is used to queue bytes for the next read of
+ * the master.
+ *@param [in] i2c : mtk_i2c_controller pointer, it contains register
+ * base address, data transmission information and i2c hardware information.
+ *@param [in] buf : the bytes to send.
+ *@param [in] len : number of bytes, the part that does not fit into the
+ * TX FIFO is not written.
+ *@return
+ * Return the number of bytes written to the TX FIFO.
+ */
+int mtk_mhal_i2c_slave_fifo_write(struct mtk_i2c_controller *i2c,
+				  u8 *buf, u16 len);
+
+/**
+ *@brief This function is used to get the number of bytes in the TX FIFO
+ * that the master has not read yet.
+ *@param [in] i2c : mtk_i2c_controller pointer, it contains register
+ * base address, data transmission information and i2c hardware information.
+ *@return
+ * Return the number of bytes pending in the TX FIFO.
+ */
+int mtk_mhal_i2c_slave_tx_pending(struct mtk_i2c_controller *i2c);
+
+/**
+ *@brief This function is used to drop the bytes pending in the TX FIFO.
+ *@param [in] i2c : mtk_i2c_controller pointer, it contains register
+ * base address, data transmission information and i2c hardware information.
+ */
+void mtk_mhal_i2c_slave_tx_flush(struct mtk_i2c_controller *i2c);
+
 #ifdef __cplusplus
 }
 #endif
@@ -109,6 +109,9 @@ void osai_delay_ms(u32 ms);
 
 /**
  * @brief  This function is used to read I/O memory.\n
+ * HDL drivers access registers only through #osai_readl() and
+ * #osai_writel(),\n so a build with OSAI_REG_MODEL can link a register
+ * model in their\n place and run HDL/M-HAL code off target.
  * @param [in] addr : The I/O memory address.
  *
  * @return The value of the address.
@@ -179,6 +182,10 @@ enum osai_dma_param_type {
 	OSAI_DMA_PARAM_VFF_HWPTR = 5,
 	/** Software pointer, only for Virtual FIFO DMA */
 	OSAI_DMA_PARAM_VFF_SWPTR = 6,
+	/** FIFO timeout threshold, 0 disables the timeout interrupt;
+	 * only for Virtual FIFO DMA.
+	 */
+	OSAI_DMA_PARAM_VFF_TIMEOUT = 7,
 };
 
 /** @brief DMA interrupt type definition.
@@ -279,6 +286,18 @@ struct osai_dma_config {
  */
 int osai_dma_allocate_chan(u8 chn);
 
+/**
+ * @brief This function is used to lease one DMA channel.
+ * @brief Usage: same as #osai_dma_allocate_chan(), but the channel
+ * stays owned by the caller\n across #osai_dma_stop() and
+ * #osai_dma_reset() until #osai_dma_release_chan().
+ * @param [in] chn : The dma channel number.
+ * @return
+ * Return 0 if users lease DMA channel successfully.\n
+ * Return negative value if errors occur.
+ */
+int osai_dma_lease_chan(u8 chn);
+
 /**
  * @brief This function is used to configure one DMA channel.
  * @brief Usage: user should call it before starting DMA. According to
@@ -292,6 +311,21 @@ int osai_dma_allocate_chan(u8 chn);
  */
 int osai_dma_config(u8 chn, struct osai_dma_config *cfg_params);
 
+/**
+ * @brief This function is used to re-arm one configured DMA channel.
+ * @brief Usage: user can call it instead of #osai_dma_config() when
+ * only the buffer\n address and the length change. Only the address and
+ * count registers are\n rewritten. Not supported by VFF DMA channels.
+ * @param [in] chn : The dma channel number.
+ * @param [in] src_addr : The new source address.
+ * @param [in] dst_addr : The new destination address.
+ * @param [in] count : The new transfer length in bytes.
+ * @return
+ * Return 0 if users re-arm DMA channel successfully.\n
+ * Return negative value if errors occur.
+ */
+int osai_dma_rearm(u8 chn, u32 src_addr, u32 dst_addr, u32 count);
+
 /**
  * @brief This function is used to start one DMA channel.
  * @brief Usage: user should call it after configure DMA
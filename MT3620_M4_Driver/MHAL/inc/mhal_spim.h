@@ -260,6 +260,29 @@ struct mtk_spi_config {
 	enum spi_slave_sel slave_sel;
 };
 
+/** @brief Layout of a SPIM DMA tmp buffer of MTK_SPIM_DMA_BUFFER_BYTES.
+ * In DMA mode the TX DMA channel writes the whole frame to the SPIM
+ * data port: the opcode and data registers first, then the master,
+ * more-buffer and control registers, the last one starts the transaction.\n
+ * A caller that builds its tx data directly in a DMA-safe frame can pass
+ * it as mtk_spi_transfer->tx_frame, the driver then only fills in the
+ * opcode and control words and nothing is staged.
+ */
+struct mtk_spi_dma_frame {
+	/** opcode, the low opcode_len bytes are sent */
+	u32 opcode;
+	/** tx data, up to 32 bytes */
+	u8 data[32];
+	/** SPI_REG_MASTER value, filled in by the driver */
+	u32 master;
+	/** SPI_REG_MOREBUF value (bit counts), filled in by the driver */
+	u32 mbctl;
+	/** SPI_REG_CTL value, filled in by the driver */
+	u32 ctl;
+	/** reserved */
+	u32 reserved;
+};
+
 /** @brief I/O INTERFACE between SPI OS-HAL and M-HAL.
  * struct mtk_spi_transfer - a read/write buffer pair.\n
  * SPI transfers always write the same number of bytes as they read.\n
@@ -295,6 +318,34 @@ struct mtk_spi_transfer {
 	 * If speed_khz=0, SPIM HW use default 1Mhz.
 	 */
 	u32 speed_khz;
+
+	/** DMA mode only, optional: a DMA-safe frame that already holds the
+	 * tx data, tx_buf must then be NULL (rx only) or tx_frame->data.
+	 * The frame is handed to DMA as is, without copying to the tmp buffer.
+	 */
+	struct mtk_spi_dma_frame *tx_frame;
+};
+
+/** @brief Continuous full-duplex DMA stream, e.g. for SPI ADCs.
+ * The same transaction (opcode + len bytes of tx_buf) is repeated until
+ * the stream is stopped, and the bytes read are gathered into frames of
+ * frame_len bytes, alternately in rx_buf[0] and rx_buf[1].
+ */
+struct mtk_spi_duplex {
+	/** opcode of every transaction */
+	u32 opcode;
+	/** size of opcode length, it should be 1~4 */
+	u32 opcode_len;
+	/** len bytes sent with every transaction, NULL sends zeros */
+	const void *tx_buf;
+	/** data bytes of one transaction, it should be 1~16 */
+	u32 len;
+	/** bytes of one frame, a multiple of len */
+	u32 frame_len;
+	/** ping-pong frame buffers of frame_len bytes (DMA-safe memory) */
+	u8 *rx_buf[2];
+	/** SCK speed, see mtk_spi_transfer.speed_khz */
+	u32 speed_khz;
 };
 
 /** @brief M-HAL privite structure.
@@ -317,6 +368,36 @@ struct mtk_spi_private {
 	/** temp transfer len to DMA */
 	u32 xfer_len;
 
+	/** tx DMA channel holds a full config, re-arm it for next xfer */
+	u8 tx_dma_armed;
+	/** rx DMA channel holds a full config, re-arm it for next xfer */
+	u8 rx_dma_armed;
+
+	/** SPI_REG_MASTER value after the last prepare_transfer */
+	u32 master_reg;
+
+	/** the caller's stream transfer being segmented, NULL if idle */
+	struct mtk_spi_transfer *stream_xfer;
+	/** per-segment transfers, paired with the two DMA tmp buffers */
+	struct mtk_spi_transfer stream_seg[2];
+	/** bytes of stream_xfer already assigned to a segment */
+	u32 stream_pos;
+	/** index of the segment currently on the wire */
+	u8 stream_cur;
+	/** the other segment is built and can be started at once */
+	u8 stream_ready;
+
+	/** the caller's full-duplex stream, NULL if idle */
+	struct mtk_spi_duplex *duplex;
+	/** the transaction repeated by the full-duplex stream */
+	struct mtk_spi_transfer duplex_seg;
+	/** bytes of the current frame already read */
+	u32 duplex_pos;
+	/** index of the frame buffer being filled */
+	u8 duplex_cur;
+	/** stop request, the transaction on the wire is the last one */
+	volatile u8 duplex_stop;
+
 	/** user_data is a OS-HAL defined parameter provided
 	* by #mtk_mhal_spim_dma_done_callback_register().
 	*/
@@ -340,6 +421,11 @@ struct mtk_spi_controller {
 	* should be MTK_SPIM_DMA_BUFFER_BYTES
 	*/
 	u8 *dma_tmp_tx_buf;
+	/** second DMA tx temp buf of MTK_SPIM_DMA_BUFFER_BYTES, used to
+	* build the next segment of a stream while the current one is on
+	* the wire. NULL disables #mtk_mhal_spim_dma_stream_start().
+	*/
+	u8 *dma_stream_buf;
 
 	/** TX DMA channel */
 	int dma_tx_chan;
@@ -389,6 +475,21 @@ int mtk_mhal_spim_dump_reg(struct mtk_spi_controller *ctlr);
  */
 int mtk_mhal_spim_clear_irq_status(struct mtk_spi_controller *ctlr);
 
+/**
+ *@brief This function is used to poll for the end of a transaction.
+ *@brief Usage: OS-HAL may call it in a bounded loop instead of waiting
+ * for the SPIM irq, with the SPIM irq masked in the NVIC.
+ * The status is cleared when it reports completion, exactly as
+ * #mtk_mhal_spim_clear_irq_status() would in the irq handler.
+ *@param [in] ctlr : SPI controller used with the device.
+ *
+ *@return
+ * Return "1" if the transaction has completed.\n
+ * Return "0" if it is still in progress.\n
+ * Return -#SPIM_EPTR if ctlr is NULL.
+ */
+int mtk_mhal_spim_poll_done(struct mtk_spi_controller *ctlr);
+
 /**
  *@brief This function is used to read FIFO data from SPIM HW.
  *@brief Usage: it must be called in irq function with FIFO mode.
@@ -530,6 +631,125 @@ int mtk_mhal_spim_dma_done_callback_register(struct mtk_spi_controller *ctlr,
 int mtk_mhal_spim_dma_transfer_one(struct mtk_spi_controller *ctlr,
 				   struct mtk_spi_transfer *xfer);
 
+/**
+ *@brief This function is used to start a half-duplex DMA stream of any length.
+ *@brief Usage: The stream is cut into segments that fit one SPIM
+ * transaction, each one is a separate chip select cycle.\n
+ * TX only: the first segment carries xfer->opcode (if opcode_len != 0)
+ * and up to 32 data bytes, every later segment sends the next data byte
+ * as a 1-byte opcode followed by up to 32 bytes, so the data on the wire
+ * is contiguous. tx_buf is copied and may be in any memory.\n
+ * RX only: the first segment carries xfer->opcode, later segments have
+ * no opcode and read up to 32 bytes each into rx_buf (DMA-safe memory).\n
+ * Two segments are built ahead of the start. OS-HAL must call
+ * #mtk_mhal_spim_dma_stream_next() where a single DMA transfer would
+ * have completed, until it returns "0".
+ *@param [in] ctlr : SPI controller used with the device.
+ *@param [in] xfer : The stream, xfer->len may exceed 32 bytes.
+ *
+ *@return
+ * Return "0" if the first segment is in progress.\n
+ * Return -#SPIM_EPTR if ctlr or xfer is NULL or speed is invalid.\n
+ * Return -#SPIM_ELENGTH if xfer is full-duplex, empty or opcode_len > 4.\n
+ * Return -#SPIM_ENOMEM if ctlr->dma_stream_buf is NULL.
+ */
+int mtk_mhal_spim_dma_stream_start(struct mtk_spi_controller *ctlr,
+				   struct mtk_spi_transfer *xfer);
+
+/**
+ *@brief This function is used to chain the next segment of a DMA stream.
+ *@brief Usage: Call it from the SPIM irq (TX only) or the DMA done
+ * callback (RX) when a segment completes. It starts the segment built
+ * in advance and then builds the following one into the buffer just
+ * released, so the CPU work overlaps the transfer on the wire.
+ *@param [in] ctlr : SPI controller used with the device.
+ *
+ *@return
+ * Return "1" if another segment was started.\n
+ * Return "0" if no stream is active or the stream has completed.\n
+ * Return a negative DMA error code if the next segment failed to start,
+ * the stream is then terminated.
+ */
+int mtk_mhal_spim_dma_stream_next(struct mtk_spi_controller *ctlr);
+
+/**
+ *@brief This function is used to terminate a DMA stream.
+ *@brief Usage: The segment on the wire completes normally but no further
+ * segment is chained, e.g. after OS-HAL timed out waiting for the stream.
+ *@param [in] ctlr : SPI controller used with the device.
+ *
+ *@return
+ * Return "0" if the stream is terminated.\n
+ * Return -#SPIM_EPTR if ctlr is NULL.
+ */
+int mtk_mhal_spim_dma_stream_stop(struct mtk_spi_controller *ctlr);
+
+/**
+ *@brief This function is used to start a continuous full-duplex DMA stream.
+ *@brief Usage: The TX frame is built once into ctlr->dma_tmp_tx_buf and
+ * handed to the TX DMA again for every transaction, only the RX DMA
+ * destination moves through the frame buffers. OS-HAL must call
+ * #mtk_mhal_spim_dma_duplex_next() from the DMA done callback until it
+ * returns "0".
+ *@param [in] ctlr : SPI controller used with the device.
+ *@param [in] dx : The stream, it must stay valid until the stream ends.
+ *
+ *@return
+ * Return "0" if the first transaction is in progress.\n
+ * Return -#SPIM_EPTR if ctlr, dx or a frame buffer is NULL or speed is
+ * invalid.\n
+ * Return -#SPIM_ELENGTH if opcode_len, len or frame_len is not supported.\n
+ * Return -#SPIM_ENOMEM if ctlr->dma_tmp_tx_buf is NULL.
+ */
+int mtk_mhal_spim_dma_duplex_start(struct mtk_spi_controller *ctlr,
+				   struct mtk_spi_duplex *dx);
+
+/**
+ *@brief This function is used to chain the next full-duplex transaction.
+ *@brief Usage: Call it from the DMA done callback. The next transaction
+ * is started before a completed frame is reported, so the caller owns
+ * that frame until the other buffer is full.
+ *@param [in] ctlr : SPI controller used with the device.
+ *@param [out] frame : The frame buffer completed by this transaction,
+ * NULL if the frame is not full yet.
+ *
+ *@return
+ * Return "1" if another transaction was started.\n
+ * Return "0" if no stream is active or it has been stopped.\n
+ * Return a negative DMA error code if the next transaction failed to
+ * start, the stream is then terminated.
+ */
+int mtk_mhal_spim_dma_duplex_next(struct mtk_spi_controller *ctlr,
+				  u8 **frame);
+
+/**
+ *@brief This function is used to stop a full-duplex DMA stream.
+ *@brief Usage: The transaction on the wire completes and is the last one,
+ * #mtk_mhal_spim_dma_duplex_next() then returns "0". A partly filled
+ * frame is dropped.
+ *@param [in] ctlr : SPI controller used with the device.
+ *
+ *@return
+ * Return "0" if the stop is requested.\n
+ * Return -#SPIM_EPTR if ctlr is NULL.
+ */
+int mtk_mhal_spim_dma_duplex_stop(struct mtk_spi_controller *ctlr);
+
+/**
+ *@brief This function is used to abort the transaction on the wire.
+ *@brief Usage: OS-HAL calls it with interrupts disabled when it gives up
+ * on a transfer. The TX/RX DMA channels are reset and the controller is
+ * reset, so neither raises a completion for the aborted transfer later.
+ * DMA and duplex streams end at once. The controller must be set up with
+ * #mtk_mhal_spim_prepare_hw() again before the next transfer.
+ *@param [in] ctlr : SPI controller used with the device.
+ *
+ *@return
+ * Return "0" if the transaction is aborted.\n
+ * Return -#SPIM_EPTR if ctlr is NULL.
+ */
+int mtk_mhal_spim_abort(struct mtk_spi_controller *ctlr);
+
 /**
  *@brief This function is used to allocate SPIM DMA channel.
  *@brief Usage: User should call it to allocate DMA channel after
@@ -206,6 +206,11 @@ struct mtk_uart_private {
 	u32 tx_size;
 	/** tx transfer len */
 	u32 rx_size;
+	/** VFF RX DMA timeout in DMA bus clock cycles, 0 disables it.
+	* When the line stays idle that long, the bytes received so far
+	* complete the RX transfer.
+	*/
+	u32 rx_timeout;
 
 	/** user_data is a OS-HAL defined parameter provided
 	* by #mtk_mhal_uart_dma_done_callback_register().
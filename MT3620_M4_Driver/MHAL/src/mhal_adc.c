@@ -99,19 +99,44 @@ static int _mtk_mhal_adc_dma_release_chan(struct mtk_adc_controller *ctlr)
 	return osai_dma_release_chan(ctlr->dma_channel);
 }
 
-static void _mtk_mhal_adc_vdma_callback(void *data)
+static void _mtk_mhal_adc_vdma_deliver(struct mtk_adc_controller *ctlr,
+				       u32 len)
 {
-	struct mtk_adc_controller *ctlr = data;
 	struct adc_fsm_param *adc_fsm_params;
 
 	adc_fsm_params = ctlr->adc_fsm_parameter;
 
-	_mtk_mhal_adc_move_tx_point(ctlr,
-		adc_fsm_params->rx_period_len);
+	ctlr->rx_pos = osai_dma_get_param(ctlr->dma_channel,
+					  OSAI_DMA_PARAM_VFF_SWPTR) & 0xffff;
+	ctlr->rx_len = len;
+	_mtk_mhal_adc_move_tx_point(ctlr, len);
 
 	if (adc_fsm_params->rx_callback_func != NULL)
 		adc_fsm_params->rx_callback_func(
 			adc_fsm_params->rx_callback_data);
+}
+
+static void _mtk_mhal_adc_vdma_timeout_callback(void *data)
+{
+	struct mtk_adc_controller *ctlr = data;
+	u32 len;
+
+	/* the samples of a period the ADC did not finish in time */
+	len = osai_dma_get_param(ctlr->dma_channel,
+				 OSAI_DMA_PARAM_VFF_FIFO_CNT);
+	len &= ~3;
+	if (len)
+		_mtk_mhal_adc_vdma_deliver(ctlr, len);
+}
+
+static void _mtk_mhal_adc_vdma_callback(void *data)
+{
+	struct mtk_adc_controller *ctlr = data;
+	struct adc_fsm_param *adc_fsm_params;
+
+	adc_fsm_params = ctlr->adc_fsm_parameter;
+
+	_mtk_mhal_adc_vdma_deliver(ctlr, adc_fsm_params->rx_period_len);
 
 	ctlr->adc_processing = false;
 }
@@ -132,9 +157,14 @@ static int _mtk_mhal_adc_dma_config(struct mtk_adc_controller *ctlr)
 	config.vfifo_size = adc_fsm_params->vfifo_len;
 	config.done_callback_data = ctlr;
 	config.count = 0;
-	config.vfifo_timeout_cnt = 0;
+	config.vfifo_timeout_cnt = ctlr->rx_timeout;
 	config.excep_callback = NULL;
 	config.excep_callback_data = NULL;
+	if (ctlr->rx_timeout) {
+		config.interrupt_flag |= OSAI_DMA_INT_VFIFO_TIMEOUT;
+		config.excep_callback = _mtk_mhal_adc_vdma_timeout_callback;
+		config.excep_callback_data = ctlr;
+	}
 	adc_debug("\tconfig.vfifo_thrsh %d.\n", config.vfifo_thrsh);
 	adc_debug("\tconfig.vfifo_size %d.\n", config.vfifo_size);
 
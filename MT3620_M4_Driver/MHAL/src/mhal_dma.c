@@ -428,6 +428,59 @@ int mtk_mhal_dma_config(struct dma_controller *controller)
 	}
 }
 
+int mtk_mhal_dma_rearm(struct dma_controller *controller)
+{
+	void __iomem *chn_base;
+	struct dma_ctrl *ctrls;
+	struct dma_config *cfg;
+
+	if (controller == NULL) {
+		dma_err("dma controller is NULL!\n");
+		return -DMA_EPTR;
+	}
+
+	ctrls = controller->ctrls;
+	cfg = controller->cfg;
+	if (ctrls == NULL || cfg == NULL)
+		return -DMA_EPARAM;
+
+	if (mtk_hdl_dma_chk_run_status(controller->base,
+				       controller->chn)) {
+		return -DMA_EBUSY;
+	}
+
+	if (ctrls->wrap_en == true && cfg->wrap_point > cfg->count) {
+		dma_err("invalid wrap point: 0x%x\n", cfg->wrap_point);
+		return -DMA_EPARAM;
+	}
+
+	chn_base = DMA_GET_CHN_BASE(controller->base, controller->chn);
+
+	/* Only the address and count registers change between transfers,
+	 * CON/WPPT/WPTO/LIMITER keep the values of the last full config.
+	 */
+	switch (controller->chn_type) {
+	case DMA_TYPE_FULLSIZE:
+		mtk_hdl_dma_set_src(chn_base, cfg->addr_1);
+		mtk_hdl_dma_set_dst(chn_base, cfg->addr_2);
+		break;
+	case DMA_TYPE_HALFSIZE:
+		mtk_hdl_dma_set_pgmaddr(chn_base, cfg->addr_1);
+		break;
+	default:
+		dma_err("re-arm is not supported by chn %d!\n",
+			controller->chn);
+		return -DMA_EPARAM;
+	}
+
+	if (mtk_hdl_dma_set_count(chn_base, cfg->count, ctrls->transize) < 0) {
+		dma_err("invalid transfer byte count %d!\n", cfg->count);
+		return -DMA_EPARAM;
+	}
+
+	return 0;
+}
+
 int mtk_mhal_dma_start(struct dma_controller *controller)
 {
 	void __iomem *chn_base;
@@ -539,6 +592,16 @@ int mtk_mhal_dma_set_param(struct dma_controller *controller,
 	case DMA_PARAM_VFF_SWPTR:
 		mtk_hdl_dma_set_swptr(chn_base, value);
 		break;
+	case DMA_PARAM_VFF_TIMEOUT:
+		if (controller->chn_type != DMA_TYPE_VFF)
+			return -DMA_EPARAM;
+		mtk_hdl_dma_set_timeout_thr(chn_base, value);
+		mtk_hdl_dma_set_timeout_int(chn_base, value != 0);
+		if (controller->cfg != NULL)
+			controller->cfg->timeout_cnt = value;
+		if (controller->ctrls != NULL)
+			controller->ctrls->timeout_int_en = (value != 0);
+		break;
 	default:
 		dma_err("cannot set param %d\n", (u32)param);
 		return -DMA_EPARAM;
@@ -576,6 +639,8 @@ int mtk_mhal_dma_get_param(struct dma_controller *controller,
 		return mtk_hdl_dma_get_hwptr(chn_base);
 	case DMA_PARAM_VFF_SWPTR:
 		return mtk_hdl_dma_get_swptr(chn_base);
+	case DMA_PARAM_VFF_TIMEOUT:
+		return mtk_hdl_dma_get_timeout_thr(chn_base);
 	default:
 		dma_err("cannot get param %d\n", (u32)param);
 		return -DMA_EPARAM;
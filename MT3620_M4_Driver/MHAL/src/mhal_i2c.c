@@ -646,8 +646,18 @@ int _mtk_mhal_i2c_dma(struct mtk_i2c_controller *i2c)
 	return I2C_OK;
 }
 
+static u16 _mtk_mhal_i2c_dma_threshold(struct mtk_i2c_controller *i2c)
+{
+	/* the FIFO can not hold more than I2C_FIFO_MAX_LEN bytes */
+	if (!i2c->dma_threshold || i2c->dma_threshold > I2C_FIFO_MAX_LEN)
+		return I2C_FIFO_MAX_LEN;
+
+	return i2c->dma_threshold;
+}
+
 int mtk_mhal_i2c_trigger_transfer(struct mtk_i2c_controller *i2c)
 {
+	u16 dma_threshold;
 	int ret = I2C_OK;
 	int num_cnt;
 	struct i2c_msg *msgs;
@@ -667,6 +677,7 @@ int mtk_mhal_i2c_trigger_transfer(struct mtk_i2c_controller *i2c)
 		return -I2C_EINVAL;
 
 	mtk_mhal_i2c_init_hw(i2c);
+	dma_threshold = _mtk_mhal_i2c_dma_threshold(i2c);
 
 	/*I2C Master mode*/
 	if (i2c->i2c_mode == I2C_MASTER_MODE) {
@@ -708,8 +719,8 @@ int mtk_mhal_i2c_trigger_transfer(struct mtk_i2c_controller *i2c)
 			(msgs + 1)->len == 0))
 			return -I2C_EINVAL;
 
-		if ((msgs->len > I2C_FIFO_MAX_LEN) || ((i2c->op == I2C_WRRD) &&
-			((msgs + 1)->len > I2C_FIFO_MAX_LEN)))
+		if ((msgs->len > dma_threshold) || ((i2c->op == I2C_WRRD) &&
+			((msgs + 1)->len > dma_threshold)))
 			i2c->dma_en = true;
 
 		ret = mtk_hdl_i2c_master_trigger_transfer(i2c->base, i2c->op,
@@ -738,7 +749,7 @@ int mtk_mhal_i2c_trigger_transfer(struct mtk_i2c_controller *i2c)
 		if (msgs->buf == NULL)
 			return -I2C_EPTR;
 
-		if (msgs->len > I2C_FIFO_MAX_LEN)
+		if (msgs->len > dma_threshold)
 			i2c->dma_en = true;
 
 		mtk_hdl_i2c_slave_trigger_transfer(i2c->base, i2c->dma_en);
@@ -781,3 +792,82 @@ int mtk_mhal_i2c_init_slv_addr(struct mtk_i2c_controller *i2c, u8 slv_addr)
 
 	return ret;
 }
+
+int mtk_mhal_i2c_bus_busy(struct mtk_i2c_controller *i2c)
+{
+	if (!i2c) {
+		i2c_err("mtk_i2c_controller pointer is NULL\n");
+		return -I2C_EPTR;
+	}
+
+	if (i2c->cg_base == 0x00 || i2c->base == 0x00)
+		return -I2C_EINVAL;
+
+	return mtk_hdl_i2c_master_bus_busy(i2c->base) ? 1 : 0;
+}
+
+int mtk_mhal_i2c_slave_stream_start(struct mtk_i2c_controller *i2c)
+{
+	if (!i2c) {
+		i2c_err("mtk_i2c_controller pointer is NULL\n");
+		return -I2C_EPTR;
+	}
+
+	if (i2c->cg_base == 0x00 || i2c->base == 0x00)
+		return -I2C_EINVAL;
+
+	if (i2c->i2c_mode != I2C_SLAVE_MODE)
+		return -I2C_EINVAL;
+
+	mtk_mhal_i2c_init_hw(i2c);
+
+	i2c->dma_en = false;
+	i2c->irq_stat = 0;
+	mtk_hdl_i2c_slave_trigger_transfer(i2c->base, false);
+
+	return I2C_OK;
+}
+
+int mtk_mhal_i2c_slave_stream_irq(struct mtk_i2c_controller *i2c,
+				  u8 *is_read)
+{
+	i2c->irq_stat = 0;
+	mtk_hdl_i2c_slave_irq_handle(i2c->base, &i2c->irq_stat);
+
+	*is_read = mtk_hdl_i2c_slave_received_read(i2c->base);
+
+	if (i2c->irq_stat & I2C_S_FIFO_CHECK)
+		return -I2C_EFIFO;
+
+	return I2C_OK;
+}
+
+int mtk_mhal_i2c_slave_fifo_read(struct mtk_i2c_controller *i2c,
+				 u8 *buf, u16 max_len)
+{
+	return mtk_hdl_i2c_slave_read_fifo(i2c->base, buf, max_len);
+}
+
+int mtk_mhal_i2c_slave_fifo_write(struct mtk_i2c_controller *i2c,
+				  u8 *buf, u16 len)
+{
+	u16 room;
+
+	room = I2C_FIFO_MAX_LEN - mtk_hdl_i2c_slave_tx_fifo_size(i2c->base);
+	if (len > room)
+		len = room;
+
+	mtk_hdl_i2c_push_data_to_fifo(i2c->base, buf, len, I2C_SLAVE_TX);
+
+	return len;
+}
+
+int mtk_mhal_i2c_slave_tx_pending(struct mtk_i2c_controller *i2c)
+{
+	return mtk_hdl_i2c_slave_tx_fifo_size(i2c->base);
+}
+
+void mtk_mhal_i2c_slave_tx_flush(struct mtk_i2c_controller *i2c)
+{
+	mtk_hdl_i2c_slave_clear_tx_fifo(i2c->base);
+}
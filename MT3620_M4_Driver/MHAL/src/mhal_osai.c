@@ -37,6 +37,10 @@
 #include "mhal_osai.h"
 #include "os_hal_dma.h"
 
+/* OSAI_REG_MODEL builds take osai_delay_us(), osai_readl() and
+ * osai_writel() from a register model instead, see MT3620_M4_Host_Test.
+ */
+#ifndef OSAI_REG_MODEL
 void osai_delay_us(u32 us)
 {
 	u32 current_tick;
@@ -62,6 +66,7 @@ void osai_delay_us(u32 us)
 		return;
 	}
 }
+#endif
 
 #ifdef OSAI_FREERTOS
 #include "FreeRTOS.h"
@@ -91,6 +96,7 @@ void osai_delay_ms(u32 ms)
 }
 #endif
 
+#ifndef OSAI_REG_MODEL
 u32 osai_readl(void __iomem *addr)
 {
 	return *(volatile u32 *)(addr);
@@ -100,6 +106,7 @@ void osai_writel(u32 data, void __iomem *addr)
 {
 	*(volatile u32 *)(addr) = data;
 }
+#endif
 
 unsigned long osai_get_phyaddr(void *vir_addr)
 {
@@ -124,6 +131,11 @@ int osai_dma_allocate_chan(u8 chn)
 	return mtk_os_hal_dma_alloc_chan((enum dma_channel) chn);
 }
 
+int osai_dma_lease_chan(u8 chn)
+{
+	return mtk_os_hal_dma_lease_chan((enum dma_channel) chn);
+}
+
 int osai_dma_config(u8 chn, struct osai_dma_config *cfg_params)
 {
 	int ret = 0;
@@ -165,6 +177,12 @@ int osai_dma_config(u8 chn, struct osai_dma_config *cfg_params)
 	return mtk_os_hal_dma_config((enum dma_channel) chn, &settings);
 }
 
+int osai_dma_rearm(u8 chn, u32 src_addr, u32 dst_addr, u32 count)
+{
+	return mtk_os_hal_dma_rearm((enum dma_channel) chn, src_addr, dst_addr,
+				    count);
+}
+
 int osai_dma_start(u8 chn)
 {
 	return mtk_os_hal_dma_start((enum dma_channel) chn);
@@ -229,10 +247,18 @@ int osai_dma_allocate_chan(u8 chn)
 {
 	return 0;
 }
+int osai_dma_lease_chan(u8 chn)
+{
+	return 0;
+}
 int osai_dma_config(u8 chn, struct osai_dma_config *cfg_params)
 {
 	return 0;
 }
+int osai_dma_rearm(u8 chn, u32 src_addr, u32 dst_addr, u32 count)
+{
+	return 0;
+}
 int osai_dma_start(u8 chn)
 {
 	return 0;
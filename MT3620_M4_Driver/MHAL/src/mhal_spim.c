@@ -139,6 +139,21 @@ int mtk_mhal_spim_clear_irq_status(struct mtk_spi_controller *ctlr)
 	return 0;
 }
 
+int mtk_mhal_spim_poll_done(struct mtk_spi_controller *ctlr)
+{
+	if (!ctlr) {
+		spim_err("%s ctlr is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	if (!ctlr->base) {
+		spim_err("%s ctlr->base is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	return (mtk_hdl_spim_get_irq_status(ctlr->base) & SPI_OK) ? 1 : 0;
+}
+
 int mtk_mhal_spim_fifo_handle_rx(struct mtk_spi_controller *ctlr,
 				  struct mtk_spi_transfer *xfer)
 {
@@ -231,6 +246,7 @@ int mtk_mhal_spim_prepare_transfer(struct mtk_spi_controller *ctlr,
 
 	mtk_hdl_spim_prepare_transfer(ctlr->base, xfer->speed_khz,
 				      is_full_duplex);
+	ctlr->mdata->master_reg = osai_readl(SPI_REG_MASTER(ctlr->base));
 
 	return 0;
 }
@@ -344,18 +360,24 @@ int mtk_mhal_spim_allocate_dma_chan(struct mtk_spi_controller *ctlr)
 		return -SPIM_EPTR;
 	}
 
-	ret = osai_dma_allocate_chan(ctlr->dma_tx_chan);
+	/* lease the channels so that every transfer after the first one
+	 * only needs to re-arm address and count.
+	 */
+	ret = osai_dma_lease_chan(ctlr->dma_tx_chan);
 	if (ret) {
 		spim_err("%s:dma_tx_chan fail.\n", __func__);
 		return -SPIM_EBUSY;
 	}
 
-	ret = osai_dma_allocate_chan(ctlr->dma_rx_chan);
+	ret = osai_dma_lease_chan(ctlr->dma_rx_chan);
 	if (ret) {
 		spim_err("%s:dma_rx_chan fail.\n", __func__);
 		return -SPIM_EBUSY;
 	}
 
+	ctlr->mdata->tx_dma_armed = 0;
+	ctlr->mdata->rx_dma_armed = 0;
+
 	return 0;
 }
 
@@ -368,6 +390,9 @@ int mtk_mhal_spim_release_dma_chan(struct mtk_spi_controller *ctlr)
 		return -SPIM_EPTR;
 	}
 
+	ctlr->mdata->tx_dma_armed = 0;
+	ctlr->mdata->rx_dma_armed = 0;
+
 	ret = osai_dma_release_chan(ctlr->dma_tx_chan);
 	if (ret) {
 		spim_err("%s:dma_tx_chan fail.\n", __func__);
@@ -390,6 +415,7 @@ static int _mtk_mhal_spim_dma_config(struct mtk_spi_controller *ctlr,
 {
 	int is_dma_tx, chan_num, ret;
 	struct osai_dma_config config = {0};
+	u8 *armed;
 
 	/* 1: spim tx; 0: spim rx */
 	is_dma_tx = (dir == DMA_MEM_TO_DEV) ? 1 : 0;
@@ -414,37 +440,48 @@ static int _mtk_mhal_spim_dma_config(struct mtk_spi_controller *ctlr,
 		config.done_callback = _mtk_mhal_spim_dma_rx_callback;
 	}
 
+	/* only address and count differ from the previous transfer */
+	armed = is_dma_tx ? &ctlr->mdata->tx_dma_armed :
+		&ctlr->mdata->rx_dma_armed;
+	if (*armed) {
+		ret = osai_dma_rearm(chan_num, config.src_addr,
+				     config.dst_addr, config.count);
+		if (!ret)
+			return 0;
+	}
+
 	ret = osai_dma_config(chan_num, &config);
 	if (ret)
 		spim_err("%s:osai_dma_config fail.\n", __func__);
+	*armed = !ret;
 
 	return ret;
 }
 
-static int _mtk_mhal_spim_fill_dma_buffer(struct mtk_spi_controller *ctlr,
-					  struct mtk_spi_transfer *xfer)
+/* Only the words the HW consumes are written: data beyond the mosi bit
+ * count and opcode bytes beyond the cmd bit count are never sent, so
+ * the buffer is not cleared and tx data already in place is not copied.
+ */
+static void _mtk_mhal_spim_build_dma_buffer(struct mtk_spi_controller *ctlr,
+					    struct mtk_spi_transfer *xfer,
+					    u8 *buf)
 {
-	struct mtk_spi_private *mdata = ctlr->mdata;
-	int reg_val, ret = 0;
-
-	/* tx tmp buffer init */
-	mdata->tx_buf = ctlr->dma_tmp_tx_buf;
-
-	ctlr->current_xfer = xfer;
-	mdata->xfer_len = xfer->len;
-
-	memset(mdata->tx_buf, 0, MTK_SPIM_DMA_BUFFER_BYTES);
+	struct mtk_spi_dma_frame *frame = (struct mtk_spi_dma_frame *)buf;
+	u32 reg_val;
 
 	/* config opcode: 0DW=opcode */
-	memcpy(mdata->tx_buf, &xfer->opcode, xfer->opcode_len);
+	if (xfer->opcode_len < MTK_SPIM_MAX_OPCODE_LEN)
+		frame->opcode = xfer->opcode &
+				((1UL << (xfer->opcode_len * 8)) - 1);
+	else
+		frame->opcode = xfer->opcode;
 
 	/* config tx data: 1~8DW=tx data */
-	if (xfer->tx_buf)
-		memcpy(mdata->tx_buf + 4, xfer->tx_buf, xfer->len);
+	if (xfer->tx_buf && xfer->tx_buf != frame->data)
+		memcpy(frame->data, xfer->tx_buf, xfer->len);
 
-	/* config 0x28 reg */
-	reg_val = osai_readl(SPI_REG_MASTER(ctlr->base));
-	memcpy(mdata->tx_buf + 36, &reg_val, 4);
+	/* config 0x28 reg, cached by prepare_transfer */
+	frame->master = ctlr->mdata->master_reg;
 
 	/* config  0x2c reg: cmd&mosi_bit_cnt&miso_bit_cnt */
 	reg_val = (xfer->opcode_len * 8) << SPI_MBCTL_CMD_SHIFT;
@@ -452,16 +489,30 @@ static int _mtk_mhal_spim_fill_dma_buffer(struct mtk_spi_controller *ctlr,
 		reg_val |= (xfer->len * 8) << SPI_MBCTL_TXCNT_SHIFT;
 	if (xfer->rx_buf)
 		reg_val |= (xfer->len * 8) << SPI_MBCTL_RXCNT_SHIFT;
-	memcpy(mdata->tx_buf + 40, &reg_val, 4);
+	frame->mbctl = reg_val;
 
 	/* config 0x0 reg */
-	reg_val = SPI_CTL_ADDR_SIZE_24BIT | SPI_CTL_START;
-	memcpy(mdata->tx_buf + 44, &reg_val, 4);
+	frame->ctl = SPI_CTL_ADDR_SIZE_24BIT | SPI_CTL_START;
 
-	mtk_hdl_spim_print_packet("dma buffer", mdata->tx_buf, MTK_SPIM_DMA_BUFFER_BYTES);
+	mtk_hdl_spim_print_packet("dma buffer", buf, MTK_SPIM_DMA_BUFFER_BYTES);
+
+	osai_clean_cache(buf, MTK_SPIM_DMA_BUFFER_BYTES);
+}
+
+/* start a transfer whose tmp buffer has already been built */
+static int _mtk_mhal_spim_start_dma_buffer(struct mtk_spi_controller *ctlr,
+					   struct mtk_spi_transfer *xfer,
+					   u8 *buf)
+{
+	struct mtk_spi_private *mdata = ctlr->mdata;
+	int ret = 0;
+
+	mdata->tx_buf = buf;
+
+	ctlr->current_xfer = xfer;
+	mdata->xfer_len = xfer->len;
 
 	mdata->tx_dma = osai_get_phyaddr(mdata->tx_buf);
-	osai_clean_cache(mdata->tx_buf, MTK_SPIM_DMA_BUFFER_BYTES);
 
 	if (xfer->rx_buf) {
 		mdata->rx_dma = osai_get_phyaddr(xfer->rx_buf);
@@ -501,6 +552,328 @@ err_exit:
 	return ret;
 }
 
+static int _mtk_mhal_spim_fill_dma_buffer(struct mtk_spi_controller *ctlr,
+					  struct mtk_spi_transfer *xfer)
+{
+	u8 *buf = ctlr->dma_tmp_tx_buf;
+
+	/* zero-copy: the caller's frame already holds the tx data */
+	if (xfer->tx_frame)
+		buf = (u8 *)xfer->tx_frame;
+
+	_mtk_mhal_spim_build_dma_buffer(ctlr, xfer, buf);
+
+	return _mtk_mhal_spim_start_dma_buffer(ctlr, xfer, buf);
+}
+
+static u8 *_mtk_mhal_spim_stream_buf(struct mtk_spi_controller *ctlr, u8 idx)
+{
+	return idx ? ctlr->dma_stream_buf : ctlr->dma_tmp_tx_buf;
+}
+
+/* build the next segment of the stream into slot idx,
+ * return 1 if the whole stream has already been assigned.
+ */
+static int _mtk_mhal_spim_stream_build(struct mtk_spi_controller *ctlr,
+				       u8 idx)
+{
+	struct mtk_spi_private *mdata = ctlr->mdata;
+	struct mtk_spi_transfer *xfer = mdata->stream_xfer;
+	struct mtk_spi_transfer *seg = &mdata->stream_seg[idx];
+	u32 left = xfer->len - mdata->stream_pos;
+	const u8 *tx;
+
+	if (!left)
+		return 1;
+
+	seg->use_dma = 1;
+	seg->speed_khz = xfer->speed_khz;
+	seg->opcode = 0;
+	seg->opcode_len = 0;
+
+	if (mdata->stream_pos == 0 && xfer->opcode_len) {
+		seg->opcode = xfer->opcode;
+		seg->opcode_len = xfer->opcode_len;
+	}
+
+	if (xfer->rx_buf) {
+		seg->tx_buf = NULL;
+		seg->rx_buf = (u8 *)xfer->rx_buf + mdata->stream_pos;
+	} else {
+		/* tx only needs an opcode, borrow the next data byte */
+		tx = (const u8 *)xfer->tx_buf + mdata->stream_pos;
+		if (!seg->opcode_len) {
+			seg->opcode = *tx++;
+			seg->opcode_len = 1;
+			mdata->stream_pos++;
+			left--;
+		}
+		seg->tx_buf = tx;
+		seg->rx_buf = NULL;
+	}
+
+	seg->len = (left > MTK_SPIM_MAX_LENGTH_ONE_TRANS_HALF) ?
+		   MTK_SPIM_MAX_LENGTH_ONE_TRANS_HALF : left;
+	mdata->stream_pos += seg->len;
+
+	_mtk_mhal_spim_build_dma_buffer(ctlr, seg,
+					_mtk_mhal_spim_stream_buf(ctlr, idx));
+
+	return 0;
+}
+
+int mtk_mhal_spim_dma_stream_start(struct mtk_spi_controller *ctlr,
+				   struct mtk_spi_transfer *xfer)
+{
+	struct mtk_spi_private *mdata;
+	int ret;
+
+	if (!ctlr || !xfer) {
+		spim_err("%s ctlr or xfer is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	if (!ctlr->base) {
+		spim_err("%s ctlr->base is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	if (!ctlr->dma_tmp_tx_buf || !ctlr->dma_stream_buf) {
+		spim_err("%s stream buffer is NULL\n", __func__);
+		return -SPIM_ENOMEM;
+	}
+
+	if ((!xfer->tx_buf == !xfer->rx_buf) || (xfer->len == 0) ||
+	    (xfer->opcode_len > MTK_SPIM_MAX_OPCODE_LEN)) {
+		spim_err("stream should be half-duplex, len %d opcode_len %d\n",
+			 xfer->len, xfer->opcode_len);
+		return -SPIM_ELENGTH;
+	}
+
+	if (xfer->speed_khz > 40 * 1000) {
+		spim_err("spim support bus CLK <= 40Mhz, now %d khz.\n",
+			xfer->speed_khz);
+		return -SPIM_EPTR;
+	}
+
+	mtk_hdl_spim_prepare_transfer(ctlr->base, xfer->speed_khz, 0);
+	ctlr->mdata->master_reg = osai_readl(SPI_REG_MASTER(ctlr->base));
+
+	mdata = ctlr->mdata;
+	mdata->stream_xfer = xfer;
+	mdata->stream_pos = 0;
+	mdata->stream_cur = 0;
+
+	/* both slots are built before the first segment goes out, so
+	 * the completion of segment 0 always finds segment 1 ready.
+	 */
+	_mtk_mhal_spim_stream_build(ctlr, 0);
+	mdata->stream_ready = !_mtk_mhal_spim_stream_build(ctlr, 1);
+
+	mtk_hdl_spim_enable_dma(ctlr->base);
+	ret = _mtk_mhal_spim_start_dma_buffer(ctlr, &mdata->stream_seg[0],
+					      ctlr->dma_tmp_tx_buf);
+	if (ret)
+		mdata->stream_xfer = NULL;
+
+	return ret;
+}
+
+int mtk_mhal_spim_dma_stream_next(struct mtk_spi_controller *ctlr)
+{
+	struct mtk_spi_private *mdata = ctlr->mdata;
+	u8 next;
+	int ret;
+
+	if (!mdata->stream_xfer)
+		return 0;
+
+	if (!mdata->stream_ready) {
+		mdata->stream_xfer = NULL;
+		return 0;
+	}
+
+	next = mdata->stream_cur ^ 1;
+	ret = _mtk_mhal_spim_start_dma_buffer(ctlr, &mdata->stream_seg[next],
+					_mtk_mhal_spim_stream_buf(ctlr, next));
+	if (ret) {
+		mdata->stream_xfer = NULL;
+		return ret;
+	}
+	mdata->stream_cur = next;
+
+	/* the finished segment's slot is free, fill it while we wait */
+	mdata->stream_ready = !_mtk_mhal_spim_stream_build(ctlr, next ^ 1);
+
+	return 1;
+}
+
+int mtk_mhal_spim_dma_stream_stop(struct mtk_spi_controller *ctlr)
+{
+	if (!ctlr) {
+		spim_err("%s ctlr is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	ctlr->mdata->stream_xfer = NULL;
+
+	return 0;
+}
+
+int mtk_mhal_spim_dma_duplex_start(struct mtk_spi_controller *ctlr,
+				   struct mtk_spi_duplex *dx)
+{
+	struct mtk_spi_private *mdata;
+	struct mtk_spi_transfer *seg;
+	struct mtk_spi_dma_frame *frame;
+	int ret;
+
+	if (!ctlr || !dx || !dx->rx_buf[0] || !dx->rx_buf[1]) {
+		spim_err("%s ctlr, dx or rx_buf is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	if (!ctlr->base) {
+		spim_err("%s ctlr->base is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	if (!ctlr->dma_tmp_tx_buf) {
+		spim_err("%s dma buffer is NULL\n", __func__);
+		return -SPIM_ENOMEM;
+	}
+
+	if (dx->opcode_len < MTK_SPIM_MIN_OPCODE_LEN_FULL ||
+	    dx->opcode_len > MTK_SPIM_MAX_OPCODE_LEN ||
+	    dx->len == 0 || dx->len > MTK_SPIM_MAX_LENGTH_ONE_TRANS_FULL ||
+	    dx->frame_len == 0 || dx->frame_len % dx->len) {
+		spim_err("duplex opcode_len %d len %d frame_len %d invalid\n",
+			 dx->opcode_len, dx->len, dx->frame_len);
+		return -SPIM_ELENGTH;
+	}
+
+	if (dx->speed_khz > 40 * 1000) {
+		spim_err("spim support bus CLK <= 40Mhz, now %d khz.\n",
+			dx->speed_khz);
+		return -SPIM_EPTR;
+	}
+
+	mtk_hdl_spim_prepare_transfer(ctlr->base, dx->speed_khz, 1);
+	ctlr->mdata->master_reg = osai_readl(SPI_REG_MASTER(ctlr->base));
+
+	mdata = ctlr->mdata;
+	mdata->duplex = dx;
+	mdata->duplex_pos = 0;
+	mdata->duplex_cur = 0;
+	mdata->duplex_stop = 0;
+
+	/* tx data lives in the frame, every transaction reuses it as is */
+	frame = (struct mtk_spi_dma_frame *)ctlr->dma_tmp_tx_buf;
+	if (dx->tx_buf)
+		memcpy(frame->data, dx->tx_buf, dx->len);
+	else
+		memset(frame->data, 0, dx->len);
+
+	seg = &mdata->duplex_seg;
+	seg->opcode = dx->opcode;
+	seg->opcode_len = dx->opcode_len;
+	seg->tx_buf = frame->data;
+	seg->rx_buf = dx->rx_buf[0];
+	seg->len = dx->len;
+	seg->use_dma = 1;
+	seg->speed_khz = dx->speed_khz;
+	seg->tx_frame = NULL;
+
+	_mtk_mhal_spim_build_dma_buffer(ctlr, seg, ctlr->dma_tmp_tx_buf);
+
+	mtk_hdl_spim_enable_dma(ctlr->base);
+	ret = _mtk_mhal_spim_start_dma_buffer(ctlr, seg, ctlr->dma_tmp_tx_buf);
+	if (ret)
+		mdata->duplex = NULL;
+
+	return ret;
+}
+
+int mtk_mhal_spim_dma_duplex_next(struct mtk_spi_controller *ctlr,
+				  u8 **frame)
+{
+	struct mtk_spi_private *mdata = ctlr->mdata;
+	struct mtk_spi_duplex *dx = mdata->duplex;
+	int ret;
+
+	*frame = NULL;
+
+	if (!dx)
+		return 0;
+
+	mdata->duplex_pos += dx->len;
+	if (mdata->duplex_pos == dx->frame_len) {
+		*frame = dx->rx_buf[mdata->duplex_cur];
+		osai_invalid_cache(*frame, dx->frame_len);
+		mdata->duplex_cur ^= 1;
+		mdata->duplex_pos = 0;
+	}
+
+	if (mdata->duplex_stop) {
+		mdata->duplex = NULL;
+		return 0;
+	}
+
+	/* only the rx destination moves, the tx frame is sent again */
+	mdata->duplex_seg.rx_buf = dx->rx_buf[mdata->duplex_cur] +
+				   mdata->duplex_pos;
+	ret = _mtk_mhal_spim_start_dma_buffer(ctlr, &mdata->duplex_seg,
+					      ctlr->dma_tmp_tx_buf);
+	if (ret) {
+		mdata->duplex = NULL;
+		return ret;
+	}
+
+	return 1;
+}
+
+int mtk_mhal_spim_dma_duplex_stop(struct mtk_spi_controller *ctlr)
+{
+	if (!ctlr) {
+		spim_err("%s ctlr is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	ctlr->mdata->duplex_stop = 1;
+
+	return 0;
+}
+
+int mtk_mhal_spim_abort(struct mtk_spi_controller *ctlr)
+{
+	if (!ctlr) {
+		spim_err("%s ctlr is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	if (!ctlr->base || !ctlr->cg_base) {
+		spim_err("%s ctlr->base is NULL\n", __func__);
+		return -SPIM_EPTR;
+	}
+
+	ctlr->mdata->stream_xfer = NULL;
+	ctlr->mdata->duplex = NULL;
+
+	/* a channel reset also drops a done status that is still pending */
+	osai_dma_stop(ctlr->dma_tx_chan);
+	osai_dma_stop(ctlr->dma_rx_chan);
+	osai_dma_reset(ctlr->dma_tx_chan);
+	osai_dma_reset(ctlr->dma_rx_chan);
+	ctlr->mdata->tx_dma_armed = 0;
+	ctlr->mdata->rx_dma_armed = 0;
+
+	mtk_hdl_spim_disable_dma(ctlr->base);
+	mtk_hdl_spim_sw_reset(ctlr->cg_base);
+	mtk_hdl_spim_clear_irq_status(ctlr->base);
+
+	return 0;
+}
+
 int mtk_mhal_spim_dma_transfer_one(struct mtk_spi_controller *ctlr,
 				   struct mtk_spi_transfer *xfer)
 {
@@ -520,6 +893,12 @@ int mtk_mhal_spim_dma_transfer_one(struct mtk_spi_controller *ctlr,
 	if (ret)
 		return ret;
 
+	if (xfer->tx_frame && xfer->tx_buf &&
+	    xfer->tx_buf != xfer->tx_frame->data) {
+		spim_err("%s tx_buf should be tx_frame->data\n", __func__);
+		return -SPIM_EPTR;
+	}
+
 	mtk_hdl_spim_enable_dma(ctlr->base);
 	ret = _mtk_mhal_spim_fill_dma_buffer(ctlr, xfer);
 
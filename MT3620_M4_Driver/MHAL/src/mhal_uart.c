@@ -411,6 +411,13 @@ int mtk_mhal_uart_dma_rx_config(struct mtk_uart_controller *ctlr)
 		rx_config.interrupt_flag = OSAI_DMA_INT_VFIFO_THRESHOLD;
 		rx_config.vfifo_thrsh = ctlr->mdata->rx_len;
 		rx_config.vfifo_size = 0x4000;
+		if (ctlr->mdata->rx_timeout) {
+			/* an idle line ends the transfer with what arrived */
+			rx_config.interrupt_flag |= OSAI_DMA_INT_VFIFO_TIMEOUT;
+			rx_config.vfifo_timeout_cnt = ctlr->mdata->rx_timeout;
+			rx_config.excep_callback = _mtk_mhal_uart_dma_rx_callback;
+			rx_config.excep_callback_data = ctlr;
+		}
 	} else {
 		/** for Half-size DMA */
 		rx_config.interrupt_flag = OSAI_DMA_INT_COMPLETION;
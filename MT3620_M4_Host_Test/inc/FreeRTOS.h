@@ -0,0 +1,45 @@
+/*
+ * Host stand-in for the FreeRTOS kernel headers used by the OS-HAL.
+ *
+ * There is one thread of execution. A blocking call lets the simulated
+ * time of the host core run until an interrupt handler releases it, so
+ * the synchronous driver paths work unchanged. Tasks are recorded but
+ * never scheduled.
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE			((BaseType_t)0)
+#define pdTRUE			((BaseType_t)1)
+#define pdPASS			pdTRUE
+#define pdFAIL			pdFALSE
+
+#define configTICK_RATE_HZ	1000
+/* as in the FreeRTOSConfig.h of the samples */
+#define configCPU_CLOCK_HZ	197600000
+#define configMAX_PRIORITIES	10
+#define portMAX_DELAY		((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS	((TickType_t)1000 / configTICK_RATE_HZ)
+#define portTICK_RATE_MS	portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(xTimeInMs)					\
+	((TickType_t)(((TickType_t)(xTimeInMs) *			\
+		       (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+#define portYIELD_FROM_ISR(x)	((void)(x))
+#define configASSERT(x)		do { if (!(x)) host_assert_failed(	\
+				__FILE__, __LINE__); } while (0)
+
+void host_assert_failed(const char *file, int line);
+
+void *pvPortMalloc(size_t xSize);
+void vPortFree(void *pv);
+
+#endif /* INC_FREERTOS_H */
@@ -0,0 +1,163 @@
+/*
+ * Host stand-in for the CMSIS Cortex-M4 core header.
+ *
+ * mt3620.h includes "core_cm4.h" after it defines IRQn_Type, this header
+ * is found first on the host include path. The core registers the
+ * drivers touch are plain structs, NVIC and PRIMASK go to the host core
+ * (host_core.c) and the DSP intrinsics are C emulations with the same
+ * results as the instructions.
+ */
+
+#ifndef __CORE_CM4_H_GENERIC
+#define __CORE_CM4_H_GENERIC
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __CM4_REV		0x0001U
+#define __MPU_PRESENT		1
+#define __Vendor_SysTickConfig	0
+
+#define __ASM			__asm
+#define __INLINE		inline
+#define __STATIC_INLINE		static inline
+
+#define __I	volatile const
+#define __O	volatile
+#define __IO	volatile
+#define __IM	volatile const
+#define __OM	volatile
+#define __IOM	volatile
+
+typedef struct {
+	__IM uint32_t CPUID;
+	__IOM uint32_t ICSR;
+	__IOM uint32_t VTOR;
+	__IOM uint32_t AIRCR;
+	__IOM uint32_t SCR;
+	__IOM uint32_t CCR;
+} SCB_Type;
+
+#define SCB_ICSR_VECTACTIVE_Pos		0U
+#define SCB_ICSR_VECTACTIVE_Msk		(0x1FFUL << SCB_ICSR_VECTACTIVE_Pos)
+#define SCB_SCR_SLEEPDEEP_Pos		2U
+#define SCB_SCR_SLEEPDEEP_Msk		(1UL << SCB_SCR_SLEEPDEEP_Pos)
+
+typedef struct {
+	__IOM uint32_t CTRL;
+	__IOM uint32_t LOAD;
+	__IOM uint32_t VAL;
+	__IM uint32_t CALIB;
+} SysTick_Type;
+
+#define SysTick_CTRL_ENABLE_Pos		0U
+#define SysTick_CTRL_ENABLE_Msk		(1UL << SysTick_CTRL_ENABLE_Pos)
+#define SysTick_CTRL_TICKINT_Pos	1U
+#define SysTick_CTRL_TICKINT_Msk	(1UL << SysTick_CTRL_TICKINT_Pos)
+#define SysTick_CTRL_CLKSOURCE_Pos	2U
+#define SysTick_CTRL_CLKSOURCE_Msk	(1UL << SysTick_CTRL_CLKSOURCE_Pos)
+
+typedef struct {
+	__IOM uint32_t CTRL;
+	__IOM uint32_t CYCCNT;
+} DWT_Type;
+
+#define DWT_CTRL_CYCCNTENA_Pos		0U
+#define DWT_CTRL_CYCCNTENA_Msk		(1UL << DWT_CTRL_CYCCNTENA_Pos)
+
+typedef struct {
+	__IOM uint32_t DHCSR;
+	__OM uint32_t DCRSR;
+	__IOM uint32_t DCRDR;
+	__IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define CoreDebug_DEMCR_TRCENA_Pos	24U
+#define CoreDebug_DEMCR_TRCENA_Msk	(1UL << CoreDebug_DEMCR_TRCENA_Pos)
+
+extern SCB_Type host_scb;
+extern SysTick_Type host_systick;
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_core_debug;
+
+#define SCB		(&host_scb)
+#define SysTick		(&host_systick)
+#define DWT		(&host_dwt)
+#define CoreDebug	(&host_core_debug)
+
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+uint32_t NVIC_GetEnableIRQ(IRQn_Type IRQn);
+void NVIC_SetPendingIRQ(IRQn_Type IRQn);
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn);
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority);
+uint32_t NVIC_GetPriority(IRQn_Type IRQn);
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __enable_irq(void);
+void __disable_irq(void);
+uint32_t __get_IPSR(void);
+
+#define __NOP()		do {} while (0)
+#define __WFI()		do {} while (0)
+#define __WFE()		do {} while (0)
+#define __SEV()		do {} while (0)
+#define __ISB()		__atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define __DSB()		__atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define __DMB()		__atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+/* DSP (SIMD) intrinsics, bit-exact C versions of the instructions */
+#define __PKHBT(ARG1, ARG2, ARG3)					\
+	((((uint32_t)(ARG1)) & 0x0000FFFFUL) |				\
+	 ((((uint32_t)(ARG2)) << (ARG3)) & 0xFFFF0000UL))
+#define __PKHTB(ARG1, ARG2, ARG3)					\
+	((((uint32_t)(ARG1)) & 0xFFFF0000UL) |				\
+	 (((uint32_t)(((int32_t)(ARG2)) >> (ARG3))) & 0x0000FFFFUL))
+
+__STATIC_INLINE int32_t __host_ssat(int64_t val, uint32_t sat)
+{
+	const int64_t max = ((int64_t)1 << (sat - 1)) - 1;
+	const int64_t min = -max - 1;
+
+	if (val > max)
+		return (int32_t)max;
+	if (val < min)
+		return (int32_t)min;
+	return (int32_t)val;
+}
+
+#define __SSAT(ARG1, ARG2)	__host_ssat((int32_t)(ARG1), (ARG2))
+
+__STATIC_INLINE uint32_t __QADD16(uint32_t op1, uint32_t op2)
+{
+	uint32_t lo = (uint16_t)__host_ssat((int64_t)(int16_t)op1 +
+					     (int16_t)op2, 16);
+	uint32_t hi = (uint16_t)__host_ssat((int64_t)(int16_t)(op1 >> 16) +
+					     (int16_t)(op2 >> 16), 16);
+
+	return lo | (hi << 16);
+}
+
+__STATIC_INLINE uint32_t __SMUAD(uint32_t op1, uint32_t op2)
+{
+	int64_t lo = (int64_t)(int16_t)op1 * (int16_t)op2;
+	int64_t hi = (int64_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16);
+
+	return (uint32_t)(lo + hi);
+}
+
+__STATIC_INLINE uint32_t __SMLAD(uint32_t op1, uint32_t op2, uint32_t op3)
+{
+	return __SMUAD(op1, op2) + op3;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CORE_CM4_H_GENERIC */
@@ -0,0 +1,25 @@
+/*
+ * Forced into every host build unit (-include host_config.h).
+ *
+ * The .sysram output section is placed by host_sysram.ld, the DMA address
+ * check of os_hal_dma.c uses it in place of the 64 KiB SYSRAM window.
+ */
+
+#ifndef __HOST_CONFIG_H__
+#define __HOST_CONFIG_H__
+
+/* type_def.h typedefs size_t as a 32-bit type, include it once here with
+ * that typedef renamed so the C library size_t stays.
+ */
+#include <stddef.h>
+#define size_t host_bsp_size_t
+#include "type_def.h"
+#undef size_t
+
+extern char __sysram_start[];
+extern char __sysram_end[];
+
+#define DMA_SYSRAM_ORIGIN	((unsigned int)(unsigned long)__sysram_start)
+#define DMA_SYSRAM_SIZE		((unsigned int)(__sysram_end - __sysram_start))
+
+#endif /* __HOST_CONFIG_H__ */
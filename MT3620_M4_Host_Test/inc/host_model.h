@@ -0,0 +1,290 @@
+/*
+ * Host core for off-target runs of the HDL, M-HAL and OS-HAL code.
+ *
+ * osai_readl()/osai_writel() are routed to the register model that
+ * claims the address, every access costs host_bus_access_ns of simulated
+ * time. Models raise level interrupts with host_irq_set(), the handlers
+ * registered through NVIC_Register() run between two register accesses
+ * as long as PRIMASK is clear and the line is enabled. Addresses no model
+ * claims read back the last value written.
+ */
+
+#ifndef __HOST_MODEL_H__
+#define __HOST_MODEL_H__
+
+#include <stdint.h>
+#include "mhal_osai.h"
+
+#define HOST_NEVER		UINT64_MAX
+#define HOST_CPU_HZ		197600000ULL
+#define HOST_NS_PER_MS		1000000ULL
+#define HOST_NS_PER_US		1000ULL
+
+/** @brief One peripheral register model. */
+struct host_model {
+	const char *name;
+	/** First register address claimed by the model. */
+	u32 base;
+	/** Bytes claimed from base on. */
+	u32 size;
+	/** Register read, offset is relative to base. */
+	u32 (*read)(struct host_model *m, u32 offset);
+	/** Register write, offset is relative to base. */
+	void (*write)(struct host_model *m, u32 offset, u32 value);
+	/** DMA handshake, returns the bytes the FIFO register at offset can
+	 * hand out (to_periph 0) or take (to_periph 1) right now.
+	 */
+	u32 (*dreq)(struct host_model *m, u32 offset, int to_periph);
+	/** Absolute time in ns of the next event the model schedules on its
+	 * own, or HOST_NEVER.
+	 */
+	u64 (*next_event)(struct host_model *m);
+	/** Brings the model state up to now. */
+	void (*advance)(struct host_model *m, u64 now);
+	struct host_model *next;
+};
+
+/** @brief Bus and interrupt counters since host_reset(). */
+struct host_stats {
+	u64 reads;
+	u64 writes;
+	u64 irqs;
+	/* semaphore gives, the wake-ups of a blocked task */
+	u64 gives;
+};
+
+extern u32 host_bus_access_ns;
+extern struct host_stats host_stats;
+extern int host_failures;
+
+/* Drops all models, register contents, pending interrupts and counters,
+ * and restarts the simulated clock. Driver state is left alone.
+ */
+void host_reset(void);
+/* advance() runs in the order models were added, add the DMA model after
+ * the peripherals it serves so it sees their data in the same step
+ */
+void host_model_add(struct host_model *m);
+void host_model_remove(struct host_model *m);
+
+/* untimed accesses for models (the DMA model reaching a peripheral FIFO) */
+u32 host_bus_read(u32 addr);
+void host_bus_write(u32 addr, u32 value);
+u32 host_bus_dreq(u32 addr, int to_periph);
+
+/* DMA reaches SYSRAM only, the range placed by host_sysram.ld */
+int host_sysram_contains(u32 addr, u32 len);
+
+void host_irq_set(int irqn, int level);
+int host_irq_enabled(int irqn);
+
+u64 host_now(void);
+/* runs models and interrupt handlers until the clock reaches t */
+void host_run_until(u64 t);
+void host_run(u64 ns);
+/* runs until no model has an event left, or for max_ns at most */
+void host_run_idle(u64 max_ns);
+
+/* records a failure, the test binary exits non-zero */
+void host_fail(const char *fmt, ...);
+
+/* model_dma.c: the DMA engine at 0x21080000 on CM4_IRQ_M4DMA */
+struct host_dma_stats {
+	/* bytes moved by all channels */
+	u32 bytes;
+	/* memory accesses outside SYSRAM, the data is not moved */
+	u32 bus_errors;
+};
+
+extern struct host_dma_stats host_dma_stats;
+/* full-size (memory to memory) copy time per beat */
+extern u32 host_dma_ns_per_unit;
+/* clock of the DMA_TO (VFF timeout) counter */
+extern u32 host_dma_bus_hz;
+void host_dma_model_init(void);
+
+/* model_fifo.c: a peripheral data register with a receive stream and a
+ * transmit sink, reached by the CPU or by a DMA channel through dreq.
+ */
+#define HOST_FIFO_CAP		8192
+
+struct host_fifo {
+	struct host_model m;
+	/* bytes per data register access */
+	u32 width;
+	/* receive stream, src_len bytes arriving one per ns_per_byte */
+	u8 src[HOST_FIFO_CAP];
+	u32 src_len;
+	u32 src_pos;
+	u64 src_t0;
+	u64 ns_per_byte;
+	/* transmitted bytes */
+	u8 sink[HOST_FIFO_CAP];
+	u32 sink_len;
+};
+
+void host_fifo_init(struct host_fifo *f, const char *name, u32 base,
+		    u32 width);
+/* appends len bytes to the receive stream, arriving from now on */
+void host_fifo_feed(struct host_fifo *f, const u8 *data, u32 len,
+		    u64 ns_per_byte);
+/* received bytes not read yet */
+u32 host_fifo_pending(struct host_fifo *f);
+
+/* model_i2c.c: an ISU I2C master, its clock gate register and one
+ * register-file slave
+ */
+struct host_i2c {
+	struct host_model m;
+	/* the ISU clock gate register, clearing SW_RST resets the master */
+	struct host_model cg;
+	u32 cg_reg;
+	int irq;
+	u32 reg[0x100 / 4];
+	u32 int_sta;
+	u32 int_ctrl;
+	u32 ack_val;
+	u8 tx[8];
+	u8 rx[8];
+	u32 tx_cnt;
+	u32 rx_cnt;
+	/* transaction in progress: packet, byte of the packet (0 = address) */
+	u8 running;
+	u32 pkt;
+	u32 pos;
+	u32 bit_ns;
+	u64 start;
+	u64 next_t;
+	/* slave: 7-bit address, registers and the register pointer */
+	u8 addr;
+	u8 regs[256];
+	u8 ptr;
+	u8 first;
+	/* optional, stores val in regs[reg] if NULL */
+	void (*slave_write)(struct host_i2c *c, u8 reg, u8 val);
+	/* the slave holds SCL low, set with host_i2c_stall() once the
+	 * transaction is on the wire, a reset of the master ends it
+	 */
+	u8 stall;
+	/* transactions completed and cut off by a reset, data bytes and
+	 * bus time since init
+	 */
+	u32 xfers;
+	u32 aborts;
+	u32 bytes;
+	u64 busy_ns;
+};
+
+void host_i2c_init(struct host_i2c *c, const char *name, u32 base,
+		   u32 cg_base, int irq, u8 addr);
+/* on: stop the transaction on the wire, off: let it go on */
+void host_i2c_stall(struct host_i2c *c, int on);
+
+/* model_spis.c: the mhal_spis.h functions of one SPIS controller, with
+ * the SPI master on the other side of the bus. Not a register model, the
+ * SPIS register map is not part of this tree.
+ */
+struct mtk_spis_controller;
+
+struct host_spis {
+	/* the SPIS irq and the irq the DMA done callback runs in */
+	int irq;
+	int dma_irq;
+	/* SCK period */
+	u32 bit_ns;
+	/* set up by the driver */
+	struct mtk_spis_controller *ctlr;
+	u8 cpol;
+	u8 cpha;
+	u8 clk_on;
+	u8 irq_on;
+	u8 dma_on;
+	/* the transaction on the wire: mailbox, irq cause, armed data phase
+	 * and the last D2HMB state the slave sent
+	 */
+	u32 h2dmb;
+	u32 irq_status;
+	u8 armed;
+	u32 d2hmb;
+	/* H2DMBs handled, transactions with a data phase by FIFO and by
+	 * DMA, DMA buffers outside SYSRAM (not moved)
+	 */
+	u32 h2dmb_cnt;
+	u32 xfers;
+	u32 fifo_xfers;
+	u32 dma_xfers;
+	u32 dma_errors;
+};
+
+void host_spis_init(struct host_spis *s, int irq, int dma_irq);
+/* one master transaction of len bytes, 4~32 in double words. Returns the
+ * D2HMB state at the end: SPIS_DONE, or where it stopped.
+ */
+int host_spis_write(struct host_spis *s, const u8 *buf, u32 len, int dma);
+int host_spis_read(struct host_spis *s, u8 *buf, u32 len, int dma);
+
+/* model_spim.c: an ISU SPI master, its clock gate register and a slave
+ * answering miso_seed + i
+ */
+#define HOST_SPIM_LOG		1024
+
+struct host_spim {
+	struct host_model m;
+	/* the ISU clock gate register, bit 0 low holds the SPIM in reset */
+	struct host_model cg;
+	u32 cg_reg;
+	int irq;
+	u32 reg[0x100 / 4];
+	u32 status;
+	/* transaction in progress */
+	u8 running;
+	u64 start;
+	u64 next_t;
+	/* DMA mode: next word of the TX frame, received bytes to hand out */
+	u32 port_ptr;
+	u32 rx_pos;
+	u32 rx_end;
+	/* slave: opcode and data bytes it got, what it sends next */
+	u8 mosi[HOST_SPIM_LOG];
+	u32 mosi_len;
+	u8 miso_seed;
+	/* added to every transaction, a slave stretching the bus */
+	u64 extra_ns;
+	/* transactions completed and cut off by a reset, data bytes and
+	 * bus time since init
+	 */
+	u32 xfers;
+	u32 aborts;
+	u32 bytes;
+	u64 busy_ns;
+};
+
+void host_spim_init(struct host_spim *c, const char *name, u32 base,
+		    u32 cg_base, int irq);
+
+#define CHECK(cond)							\
+	do {								\
+		if (!(cond))						\
+			host_fail("%s:%d: CHECK(%s) failed\n",		\
+				  __FILE__, __LINE__, #cond);		\
+	} while (0)
+
+#define CHECK_EQ(a, b)							\
+	do {								\
+		long long _a = (long long)(a);				\
+		long long _b = (long long)(b);				\
+		if (_a != _b)						\
+			host_fail("%s:%d: %s == %lld, expected %lld\n",	\
+				  __FILE__, __LINE__, #a, _a, _b);	\
+	} while (0)
+
+#define HOST_RUN_TEST(fn)						\
+	do {								\
+		int _f = host_failures;					\
+		host_reset();						\
+		fn();							\
+		printf("%s %s\n", host_failures == _f ? "PASS" : "FAIL", \
+		       #fn);						\
+	} while (0)
+
+#endif /* __HOST_MODEL_H__ */
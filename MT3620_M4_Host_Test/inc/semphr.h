@@ -0,0 +1,34 @@
+/*
+ * Host stand-in for the FreeRTOS semaphore API, see FreeRTOS.h.
+ */
+
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include "FreeRTOS.h"
+
+typedef struct host_sem *QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount,
+					   UBaseType_t uxInitialCount);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore,
+			  TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t xSemaphore,
+				 BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore,
+				 BaseType_t *pxHigherPriorityTaskWoken);
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore);
+
+#define vSemaphoreCreateBinary(xSemaphore)				\
+	do {								\
+		(xSemaphore) = xSemaphoreCreateBinary();		\
+		if ((xSemaphore) != NULL)				\
+			(void)xSemaphoreGive((xSemaphore));		\
+	} while (0)
+
+#endif /* SEMAPHORE_H */
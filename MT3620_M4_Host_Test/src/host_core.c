@@ -0,0 +1,641 @@
+/*
+ * Host core: register bus, interrupt controller, simulated clock and the
+ * FreeRTOS/OSAI pieces the drivers need when they run off target.
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+#include "mt3620.h"
+#include "nvic.h"
+#include "mhal_osai.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include "host_model.h"
+
+#define HOST_IRQ_NUM		128
+#define HOST_REG_SLOTS		4096
+#define HOST_HEAP_SIZE		(128 * 1024)
+#define HOST_TASK_MAX		8
+/* handler runs in a row without going back to the thread, a stuck line */
+#define HOST_IRQ_STORM		100000
+
+SCB_Type host_scb;
+SysTick_Type host_systick;
+DWT_Type host_dwt;
+CoreDebug_Type host_core_debug;
+
+u32 host_bus_access_ns = 40;
+struct host_stats host_stats;
+int host_failures;
+
+struct host_reg {
+	u32 addr;
+	u32 value;
+	u8 used;
+};
+
+struct host_sem {
+	UBaseType_t count;
+	UBaseType_t max;
+};
+
+struct host_task {
+	TaskFunction_t func;
+	void *arg;
+	UBaseType_t notify;
+};
+
+static struct host_model *g_models;
+static struct host_reg g_regs[HOST_REG_SLOTS];
+static u64 g_now;
+
+static NVIC_IRQ_Handler g_vector[HOST_IRQ_NUM];
+static u8 g_irq_line[HOST_IRQ_NUM];
+static u8 g_irq_pend[HOST_IRQ_NUM];
+static u8 g_irq_en[HOST_IRQ_NUM];
+static u8 g_irq_prio[HOST_IRQ_NUM];
+static u32 g_primask;
+static u32 g_ipsr;
+
+static __attribute__((section(".sysram"), aligned(8)))
+	u8 g_heap[HOST_HEAP_SIZE];
+static u32 g_heap_top;
+
+static struct host_task g_tasks[HOST_TASK_MAX];
+
+void host_fail(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+	host_failures++;
+}
+
+void host_assert_failed(const char *file, int line)
+{
+	host_fail("%s:%d: configASSERT failed\n", file, line);
+	exit(2);
+}
+
+void _putchar(char character)
+{
+	putchar(character);
+}
+
+/* ---- register bus ---- */
+
+static struct host_model *_host_find_model(u32 addr)
+{
+	struct host_model *m;
+
+	for (m = g_models; m != NULL; m = m->next)
+		if (addr >= m->base && addr - m->base < m->size)
+			return m;
+	return NULL;
+}
+
+static struct host_reg *_host_reg_slot(u32 addr, int create)
+{
+	u32 i = (addr >> 2) % HOST_REG_SLOTS;
+	u32 n;
+
+	for (n = 0; n < HOST_REG_SLOTS; n++) {
+		struct host_reg *r = &g_regs[(i + n) % HOST_REG_SLOTS];
+
+		if (r->used && r->addr == addr)
+			return r;
+		if (!r->used) {
+			if (!create)
+				return NULL;
+			r->used = 1;
+			r->addr = addr;
+			r->value = 0;
+			return r;
+		}
+	}
+	host_fail("host: register table full\n");
+	exit(2);
+}
+
+u32 host_bus_read(u32 addr)
+{
+	struct host_model *m = _host_find_model(addr);
+	struct host_reg *r;
+
+	if (m != NULL)
+		return m->read ? m->read(m, addr - m->base) : 0;
+	r = _host_reg_slot(addr, 0);
+	return r ? r->value : 0;
+}
+
+void host_bus_write(u32 addr, u32 value)
+{
+	struct host_model *m = _host_find_model(addr);
+
+	if (m != NULL) {
+		if (m->write)
+			m->write(m, addr - m->base, value);
+		return;
+	}
+	_host_reg_slot(addr, 1)->value = value;
+}
+
+u32 host_bus_dreq(u32 addr, int to_periph)
+{
+	struct host_model *m = _host_find_model(addr);
+
+	if (m == NULL || m->dreq == NULL)
+		return 0;
+	return m->dreq(m, addr - m->base, to_periph);
+}
+
+int host_sysram_contains(u32 addr, u32 len)
+{
+	unsigned long start = (unsigned long)__sysram_start;
+	unsigned long end = (unsigned long)__sysram_end;
+
+	return addr >= start && (unsigned long)addr + len <= end;
+}
+
+static u32 _host_addr(void __iomem *addr)
+{
+	unsigned long a = (unsigned long)addr;
+
+	if (a > 0xFFFFFFFFUL) {
+		host_fail("host: register address %p above 4 GiB\n", addr);
+		exit(2);
+	}
+	return (u32)a;
+}
+
+u32 osai_readl(void __iomem *addr)
+{
+	u32 value;
+
+	host_stats.reads++;
+	value = host_bus_read(_host_addr(addr));
+	host_run(host_bus_access_ns);
+	return value;
+}
+
+void osai_writel(u32 data, void __iomem *addr)
+{
+	host_stats.writes++;
+	host_bus_write(_host_addr(addr), data);
+	host_run(host_bus_access_ns);
+}
+
+void host_model_add(struct host_model *m)
+{
+	struct host_model **p = &g_models;
+
+	/* keep registration order, advance() runs in it */
+	while (*p != NULL)
+		p = &(*p)->next;
+	m->next = NULL;
+	*p = m;
+}
+
+void host_model_remove(struct host_model *m)
+{
+	struct host_model **p;
+
+	for (p = &g_models; *p != NULL; p = &(*p)->next) {
+		if (*p == m) {
+			*p = m->next;
+			return;
+		}
+	}
+}
+
+/* ---- interrupts ---- */
+
+static int _host_irq_ok(int irqn)
+{
+	return irqn >= 0 && irqn < HOST_IRQ_NUM;
+}
+
+static void _host_irq_dispatch(void)
+{
+	u32 storm = 0;
+	int n;
+
+again:
+	if (g_primask || g_ipsr)
+		return;
+	for (n = 0; n < HOST_IRQ_NUM; n++) {
+		if (!(g_irq_line[n] || g_irq_pend[n]) || !g_irq_en[n] ||
+		    g_vector[n] == NULL)
+			continue;
+		if (++storm > HOST_IRQ_STORM) {
+			host_fail("host: irq %d never clears\n", n);
+			exit(2);
+		}
+		g_irq_pend[n] = 0;
+		host_stats.irqs++;
+		g_ipsr = n + 16;
+		SCB->ICSR = (SCB->ICSR & ~SCB_ICSR_VECTACTIVE_Msk) | g_ipsr;
+		g_vector[n]();
+		g_ipsr = 0;
+		SCB->ICSR &= ~SCB_ICSR_VECTACTIVE_Msk;
+		goto again;
+	}
+}
+
+void host_irq_set(int irqn, int level)
+{
+	if (!_host_irq_ok(irqn))
+		return;
+	g_irq_line[irqn] = !!level;
+}
+
+int host_irq_enabled(int irqn)
+{
+	return _host_irq_ok(irqn) && g_irq_en[irqn];
+}
+
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+	if (!_host_irq_ok(IRQn))
+		return;
+	g_irq_en[IRQn] = 1;
+	_host_irq_dispatch();
+}
+
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+	if (_host_irq_ok(IRQn))
+		g_irq_en[IRQn] = 0;
+}
+
+uint32_t NVIC_GetEnableIRQ(IRQn_Type IRQn)
+{
+	return host_irq_enabled(IRQn);
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+	if (!_host_irq_ok(IRQn))
+		return;
+	g_irq_pend[IRQn] = 1;
+	_host_irq_dispatch();
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+	if (_host_irq_ok(IRQn))
+		g_irq_pend[IRQn] = 0;
+}
+
+uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+	return _host_irq_ok(IRQn) && (g_irq_pend[IRQn] || g_irq_line[IRQn]);
+}
+
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+	if (_host_irq_ok(IRQn))
+		g_irq_prio[IRQn] = priority;
+}
+
+uint32_t NVIC_GetPriority(IRQn_Type IRQn)
+{
+	return _host_irq_ok(IRQn) ? g_irq_prio[IRQn] : 0;
+}
+
+int NVIC_Register(int irqn, NVIC_IRQ_Handler handler)
+{
+	if (!_host_irq_ok(irqn))
+		return -1;
+	NVIC_DisableIRQ(irqn);
+	NVIC_ClearPendingIRQ(irqn);
+	g_vector[irqn] = handler;
+	return 0;
+}
+
+int NVIC_UnRegister(int irqn)
+{
+	return NVIC_Register(irqn, NULL);
+}
+
+void CM4_Install_NVIC(int irqn, int prior, int edgetr,
+		      NVIC_IRQ_Handler handler, int enable)
+{
+	(void)edgetr;
+	NVIC_Register(irqn, handler);
+	NVIC_SetPriority(irqn, prior <= 0 ? DEFAULT_PRI : prior);
+	if (enable == TRUE)
+		NVIC_EnableIRQ(irqn);
+}
+
+uint32_t __get_PRIMASK(void)
+{
+	return g_primask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+	g_primask = priMask & 1;
+	_host_irq_dispatch();
+}
+
+void __enable_irq(void)
+{
+	__set_PRIMASK(0);
+}
+
+void __disable_irq(void)
+{
+	g_primask = 1;
+}
+
+uint32_t __get_IPSR(void)
+{
+	return g_ipsr;
+}
+
+/* ---- simulated clock ---- */
+
+u64 host_now(void)
+{
+	return g_now;
+}
+
+static u64 _host_next_event(void)
+{
+	struct host_model *m;
+	u64 t = HOST_NEVER;
+
+	for (m = g_models; m != NULL; m = m->next) {
+		if (m->next_event) {
+			u64 e = m->next_event(m);
+
+			if (e < t)
+				t = e;
+		}
+	}
+	return t;
+}
+
+static void _host_advance_models(void)
+{
+	struct host_model *m;
+
+	for (m = g_models; m != NULL; m = m->next)
+		if (m->advance)
+			m->advance(m, g_now);
+	host_dwt.CYCCNT = (u32)(g_now * HOST_CPU_HZ / 1000000000ULL);
+}
+
+void host_run_until(u64 t)
+{
+	u32 spin = 0;
+
+	for (;;) {
+		u64 e = _host_next_event();
+
+		if (e > t)
+			break;
+		if (e > g_now) {
+			g_now = e;
+			spin = 0;
+		} else if (++spin > HOST_IRQ_STORM) {
+			host_fail("host: model event at %llu does not move\n",
+				  e);
+			exit(2);
+		}
+		_host_advance_models();
+		_host_irq_dispatch();
+	}
+	if (t > g_now)
+		g_now = t;
+	_host_advance_models();
+	_host_irq_dispatch();
+}
+
+void host_run(u64 ns)
+{
+	host_run_until(g_now + ns);
+}
+
+void host_run_idle(u64 max_ns)
+{
+	u64 end = g_now + max_ns;
+
+	for (;;) {
+		u64 e = _host_next_event();
+
+		if (e == HOST_NEVER || e > end)
+			break;
+		host_run_until(e);
+	}
+}
+
+void host_reset(void)
+{
+	g_models = NULL;
+	memset(g_regs, 0, sizeof(g_regs));
+	memset(g_irq_line, 0, sizeof(g_irq_line));
+	memset(g_irq_pend, 0, sizeof(g_irq_pend));
+	memset(&host_stats, 0, sizeof(host_stats));
+	g_primask = 0;
+	g_ipsr = 0;
+	g_now = 0;
+	host_dwt.CYCCNT = 0;
+	host_systick.LOAD = HOST_CPU_HZ / configTICK_RATE_HZ - 1;
+}
+
+/* ---- OSAI ---- */
+
+void osai_delay_us(u32 us)
+{
+	host_run((u64)us * HOST_NS_PER_US);
+}
+
+/* ---- FreeRTOS ---- */
+
+void *pvPortMalloc(size_t xSize)
+{
+	u32 size = (xSize + 7) & ~7U;
+	void *p;
+
+	if (size > HOST_HEAP_SIZE - g_heap_top)
+		return NULL;
+	p = &g_heap[g_heap_top];
+	g_heap_top += size;
+	return p;
+}
+
+void vPortFree(void *pv)
+{
+	/* bump heap, a test binary never runs out of it */
+	(void)pv;
+}
+
+static SemaphoreHandle_t _host_sem_create(UBaseType_t max, UBaseType_t init)
+{
+	struct host_sem *s = calloc(1, sizeof(*s));
+
+	if (s != NULL) {
+		s->max = max;
+		s->count = init;
+	}
+	return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+	return _host_sem_create(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+	return _host_sem_create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount,
+					   UBaseType_t uxInitialCount)
+{
+	return _host_sem_create(uxMaxCount, uxInitialCount);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+	free(xSemaphore);
+}
+
+/* lets the clock run until *count is non-zero or ticks have passed */
+static BaseType_t _host_block_on(UBaseType_t *count, TickType_t ticks)
+{
+	u64 deadline = ticks == portMAX_DELAY ? HOST_NEVER :
+		g_now + (u64)ticks * HOST_NS_PER_MS * portTICK_PERIOD_MS;
+
+	while (*count == 0) {
+		u64 e;
+
+		if (g_ipsr) {
+			host_fail("host: blocking call in irq %u\n",
+				  g_ipsr - 16);
+			exit(2);
+		}
+		e = _host_next_event();
+		if (e == HOST_NEVER && deadline == HOST_NEVER) {
+			host_fail("host: wait forever with no event pending\n");
+			exit(2);
+		}
+		if (e >= deadline) {
+			host_run_until(deadline);
+			return *count != 0;
+		}
+		host_run_until(e);
+	}
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore,
+			  TickType_t xBlockTime)
+{
+	if (!_host_block_on(&xSemaphore->count, xBlockTime))
+		return pdFALSE;
+	xSemaphore->count--;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+	if (xSemaphore->count >= xSemaphore->max)
+		return pdFALSE;
+	xSemaphore->count++;
+	host_stats.gives++;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t xSemaphore,
+				 BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if (pxHigherPriorityTaskWoken != NULL)
+		*pxHigherPriorityTaskWoken = pdFALSE;
+	if (xSemaphore->count == 0)
+		return pdFALSE;
+	xSemaphore->count--;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore,
+				 BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if (pxHigherPriorityTaskWoken != NULL)
+		*pxHigherPriorityTaskWoken = pdFALSE;
+	return xSemaphoreGive(xSemaphore);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore)
+{
+	return xSemaphore->count;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName,
+		       uint16_t usStackDepth, void *pvParameters,
+		       UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask)
+{
+	int i;
+
+	(void)pcName;
+	(void)usStackDepth;
+	(void)uxPriority;
+	for (i = 0; i < HOST_TASK_MAX; i++) {
+		if (g_tasks[i].func == NULL) {
+			g_tasks[i].func = pxTaskCode;
+			g_tasks[i].arg = pvParameters;
+			g_tasks[i].notify = 0;
+			if (pxCreatedTask != NULL)
+				*pxCreatedTask = &g_tasks[i];
+			return pdPASS;
+		}
+	}
+	return pdFAIL;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+	if (xTaskToDelete != NULL)
+		memset(xTaskToDelete, 0, sizeof(*xTaskToDelete));
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+	host_run((u64)xTicksToDelay * HOST_NS_PER_MS * portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return (TickType_t)(g_now / (HOST_NS_PER_MS * portTICK_PERIOD_MS));
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+	xTaskToNotify->notify++;
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify,
+			    BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if (pxHigherPriorityTaskWoken != NULL)
+		*pxHigherPriorityTaskWoken = pdFALSE;
+	xTaskToNotify->notify++;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit,
+			  TickType_t xTicksToWait)
+{
+	(void)xClearCountOnExit;
+	(void)xTicksToWait;
+	/* only task bodies wait for notifications, tasks never run here */
+	host_fail("host: ulTaskNotifyTake() outside a task\n");
+	return 0;
+}
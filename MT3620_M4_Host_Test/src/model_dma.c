@@ -0,0 +1,488 @@
+/*
+ * Register model of the MT3620 M4 DMA engine.
+ *
+ * Covers what hdl_dma.c programs: SRC/DST/COUNT/CON/START, the interrupt
+ * status and ack registers, GLBSTA, channel reset/pause/clock and the VFF
+ * PGMADDR/FFSIZE/HWPTR/SWPTR/FFCNT/TO registers. The full-size channel
+ * copies memory at ns_per_unit per beat. Half-size and VFF channels move
+ * data as fast as the peripheral at FIXADDR hands it out or takes it
+ * (host_model.dreq). Memory outside SYSRAM is never touched, such an
+ * access only counts a bus error.
+ */
+
+#include <stdlib.h>
+
+#include "mt3620.h"
+#include "hdl_dma.h"
+#include "host_model.h"
+
+#define HOST_DMA_BASE		0x21080000
+#define HOST_DMA_SIZE		(DMA_GLB_REG_OFFSET + 0x100)
+#define HOST_DMA_REGS		(DMA_CHN_REG_OFFSET / 4)
+#define HOST_DMA_FULLSIZE	12
+
+#define R(ch, off)		((ch)->reg[(u32)(unsigned long)(off) / 4])
+
+enum host_dma_type {
+	HOST_DMA_NONE,
+	HOST_DMA_HALF,
+	HOST_DMA_FULL,
+	HOST_DMA_VFF,
+};
+
+struct host_dma_chan {
+	u32 reg[HOST_DMA_REGS];
+	u32 intsta;
+	u8 running;
+	u8 to_armed;
+	u8 err_seen;
+	/* beats moved since START */
+	u32 done;
+	u64 start;
+	u64 last_data;
+};
+
+struct host_dma {
+	struct host_model m;
+	struct host_dma_chan ch[DMA_CHANNEL_AMOUNT];
+	u32 ch_rst;
+	u32 ch_en;
+	u32 pause;
+};
+
+struct host_dma_stats host_dma_stats;
+u32 host_dma_ns_per_unit = 5;
+u32 host_dma_bus_hz = 197600000;
+
+static struct host_dma g_dma;
+
+static enum host_dma_type _type(u32 chn)
+{
+	if (chn <= 9)
+		return HOST_DMA_HALF;
+	if (chn == HOST_DMA_FULLSIZE)
+		return HOST_DMA_FULL;
+	if ((chn >= 13 && chn <= 22) || (chn >= 25 && chn <= 29))
+		return HOST_DMA_VFF;
+	return HOST_DMA_NONE;
+}
+
+static u32 _unit(struct host_dma_chan *ch)
+{
+	switch (R(ch, DMA_CON(0)) & DMA_CON_SIZE_MASK) {
+	case DMA_CON_SIZE_LONG:
+		return 4;
+	case DMA_CON_SIZE_SHORT:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+static u32 _count(struct host_dma_chan *ch)
+{
+	return R(ch, DMA_COUNT(0)) & DMA_COUNT_LEN_MSK;
+}
+
+static u8 *_mem(struct host_dma_chan *ch, u32 addr, u32 len)
+{
+	if (host_sysram_contains(addr, len))
+		return (u8 *)(unsigned long)addr;
+	host_dma_stats.bus_errors++;
+	if (!ch->err_seen)
+		printf("dma model: 0x%08x+%u is not SYSRAM\n", addr, len);
+	ch->err_seen = 1;
+	return NULL;
+}
+
+/* ---- VFF ring ---- */
+
+static u32 _vff_size(struct host_dma_chan *ch)
+{
+	return (R(ch, DMA_FFSIZE(0)) & DMA_FFSIZE_MSK) * _unit(ch);
+}
+
+static u32 _vff_fill(struct host_dma_chan *ch)
+{
+	u32 hw = R(ch, DMA_HWPTR(0));
+	u32 sw = R(ch, DMA_SWPTR(0));
+	u32 hw_off = hw & DMA_HWPTR_MSK;
+	u32 sw_off = sw & DMA_SWPTR_MSK;
+	int rx = !!(R(ch, DMA_CON(0)) & DMA_CON_DIR);
+	u32 wr = rx ? hw : sw;
+	u32 rd = rx ? sw : hw;
+	u32 wr_off = rx ? hw_off : sw_off;
+	u32 rd_off = rx ? sw_off : hw_off;
+
+	if ((wr & DMA_HWPTR_WARP) == (rd & DMA_HWPTR_WARP))
+		return wr_off - rd_off;
+	return _vff_size(ch) - rd_off + wr_off;
+}
+
+static void _vff_step_hwptr(struct host_dma_chan *ch, u32 bytes)
+{
+	u32 hw = R(ch, DMA_HWPTR(0));
+	u32 off = (hw & DMA_HWPTR_MSK) + bytes;
+
+	if (off >= _vff_size(ch)) {
+		off -= _vff_size(ch);
+		hw ^= DMA_HWPTR_WARP;
+	}
+	R(ch, DMA_HWPTR(0)) = (hw & DMA_HWPTR_WARP) | off;
+}
+
+static u64 _vff_timeout_at(struct host_dma_chan *ch)
+{
+	u32 to = R(ch, DMA_TO(0));
+
+	if (!ch->running || !ch->to_armed || !to ||
+	    !(R(ch, DMA_CON(0)) & DMA_CON_TOEN) || !_vff_fill(ch))
+		return HOST_NEVER;
+	return ch->last_data + (u64)to * 1000000000ULL / host_dma_bus_hz;
+}
+
+/* ---- data movement ---- */
+
+static void _move_unit(struct host_dma_chan *ch, u32 mem_addr, int to_periph)
+{
+	u32 fix = R(ch, DMA_FIXADDR(0));
+	u32 unit = _unit(ch);
+	u8 *mem = _mem(ch, mem_addr, unit);
+	u32 v = 0;
+
+	if (to_periph) {
+		if (mem != NULL)
+			memcpy(&v, mem, unit);
+		host_bus_write(fix, v);
+	} else {
+		v = host_bus_read(fix);
+		if (mem != NULL)
+			memcpy(mem, &v, unit);
+	}
+	host_dma_stats.bytes += unit;
+}
+
+static void _run_full(struct host_dma_chan *ch, u64 now)
+{
+	u32 unit = _unit(ch);
+	u32 target = (u32)((now - ch->start) / host_dma_ns_per_unit);
+	u32 n;
+
+	if (target > _count(ch))
+		target = _count(ch);
+	if (target <= ch->done)
+		return;
+	n = target - ch->done;
+	{
+		u32 off = ch->done * unit;
+		u8 *src = _mem(ch, R(ch, DMA_SRC(0)) + off, n * unit);
+		u8 *dst = _mem(ch, R(ch, DMA_DST(0)) + off, n * unit);
+
+		if (src != NULL && dst != NULL)
+			memmove(dst, src, n * unit);
+	}
+	ch->done = target;
+	host_dma_stats.bytes += n * unit;
+}
+
+static void _run_half(struct host_dma_chan *ch)
+{
+	int to_periph = !(R(ch, DMA_CON(0)) & DMA_CON_DIR);
+	u32 fix = R(ch, DMA_FIXADDR(0));
+	u32 unit = _unit(ch);
+	u32 half = (_count(ch) + 1) / 2;
+
+	while (ch->done < _count(ch) &&
+	       host_bus_dreq(fix, to_periph) >= unit) {
+		_move_unit(ch, R(ch, DMA_PGMADDR(0)) + ch->done * unit,
+			   to_periph);
+		ch->done++;
+		if (ch->done == half &&
+		    (R(ch, DMA_CON(0)) & DMA_CON_HITEN))
+			ch->intsta |= DMA_HINTSTA_BIT;
+	}
+}
+
+static void _run_vff(struct host_dma_chan *ch, u64 now)
+{
+	int rx = !!(R(ch, DMA_CON(0)) & DMA_CON_DIR);
+	u32 fix = R(ch, DMA_FIXADDR(0));
+	u32 unit = _unit(ch);
+	u32 size = _vff_size(ch);
+
+	if (!size)
+		return;
+	for (;;) {
+		u32 fill = _vff_fill(ch);
+		u32 at = R(ch, DMA_PGMADDR(0)) +
+			(R(ch, DMA_HWPTR(0)) & DMA_HWPTR_MSK);
+
+		if (rx ? size - fill < unit : fill < unit)
+			break;
+		if (host_bus_dreq(fix, !rx) < unit)
+			break;
+		_move_unit(ch, at, !rx);
+		_vff_step_hwptr(ch, unit);
+		if (rx) {
+			ch->last_data = now;
+			ch->to_armed = 1;
+		}
+	}
+}
+
+static void _update_status(struct host_dma_chan *ch, u32 chn, u64 now)
+{
+	u32 con = R(ch, DMA_CON(0));
+
+	switch (_type(chn)) {
+	case HOST_DMA_FULL:
+	case HOST_DMA_HALF:
+		if (ch->running && ch->done >= _count(ch)) {
+			ch->running = 0;
+			if (con & DMA_CON_ITEN)
+				ch->intsta |= DMA_INTSTA_BIT;
+		}
+		break;
+	case HOST_DMA_VFF:
+		if (!ch->running)
+			break;
+		if (con & DMA_CON_ITEN) {
+			u32 cnt = _vff_fill(ch) / _unit(ch);
+
+			if ((con & DMA_CON_DIR) ? cnt >= _count(ch) :
+			    cnt <= _count(ch))
+				ch->intsta |= DMA_INTSTA_BIT;
+		}
+		if (now >= _vff_timeout_at(ch)) {
+			ch->intsta |= DMA_TOINTSTA_BIT;
+			/* once per idle period, new data re-arms it */
+			ch->to_armed = 0;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static void _update_irq(struct host_dma *dma)
+{
+	u32 chn;
+	int line = 0;
+
+	for (chn = 0; chn < DMA_CHANNEL_AMOUNT; chn++)
+		if (dma->ch[chn].intsta)
+			line = 1;
+	host_irq_set(CM4_IRQ_M4DMA, line);
+}
+
+static void _dma_advance(struct host_model *m, u64 now)
+{
+	struct host_dma *dma = (struct host_dma *)m;
+	u32 chn;
+
+	for (chn = 0; chn < DMA_CHANNEL_AMOUNT; chn++) {
+		struct host_dma_chan *ch = &dma->ch[chn];
+
+		if (ch->running && !(dma->pause & (1U << chn))) {
+			switch (_type(chn)) {
+			case HOST_DMA_FULL:
+				_run_full(ch, now);
+				break;
+			case HOST_DMA_HALF:
+				_run_half(ch);
+				break;
+			case HOST_DMA_VFF:
+				_run_vff(ch, now);
+				break;
+			default:
+				break;
+			}
+		}
+		_update_status(ch, chn, now);
+	}
+	_update_irq(dma);
+}
+
+static u64 _dma_next_event(struct host_model *m)
+{
+	struct host_dma *dma = (struct host_dma *)m;
+	u64 t = HOST_NEVER;
+	u32 chn;
+
+	for (chn = 0; chn < DMA_CHANNEL_AMOUNT; chn++) {
+		struct host_dma_chan *ch = &dma->ch[chn];
+		u64 e = HOST_NEVER;
+
+		if (!ch->running || (dma->pause & (1U << chn)))
+			continue;
+		if (_type(chn) == HOST_DMA_FULL)
+			e = ch->start + (u64)_count(ch) * host_dma_ns_per_unit;
+		else if (_type(chn) == HOST_DMA_VFF)
+			e = _vff_timeout_at(ch);
+		if (e < t)
+			t = e;
+	}
+	return t;
+}
+
+/* ---- registers ---- */
+
+static void _reset_chan(struct host_dma_chan *ch)
+{
+	memset(ch, 0, sizeof(*ch));
+}
+
+static u32 _glbsta(struct host_dma *dma, u32 first)
+{
+	u32 v = 0;
+	u32 chn;
+
+	for (chn = first; chn < first + 16 && chn < DMA_CHANNEL_AMOUNT;
+	     chn++) {
+		if (dma->ch[chn].running)
+			v |= DMA_GLBSTA_RUN(chn);
+		if (dma->ch[chn].intsta)
+			v |= DMA_GLBSTA_IT(chn);
+	}
+	return v;
+}
+
+static u32 _dma_read(struct host_model *m, u32 offset)
+{
+	struct host_dma *dma = (struct host_dma *)m;
+	struct host_dma_chan *ch;
+	u32 chn, reg;
+
+	if (offset >= DMA_GLB_REG_OFFSET) {
+		switch (offset - DMA_GLB_REG_OFFSET) {
+		case 0x00:
+			return _glbsta(dma, 0);
+		case 0x04:
+			return _glbsta(dma, 16);
+		case 0x08:
+			return dma->ch_rst;
+		case 0x20:
+		case 0x24:
+			return dma->ch_en;
+		case 0x30:
+		case 0x34:
+			return dma->pause;
+		default:
+			return 0;
+		}
+	}
+	chn = offset / DMA_CHN_REG_OFFSET;
+	reg = offset % DMA_CHN_REG_OFFSET;
+	if (chn >= DMA_CHANNEL_AMOUNT)
+		return 0;
+	ch = &dma->ch[chn];
+	switch (reg) {
+	case 0x18:
+		return ch->running ? DMA_START_BIT : 0;
+	case 0x1C:
+		return ch->intsta;
+	case 0x24:
+		return ch->done < _count(ch) ? _count(ch) - ch->done : 0;
+	case 0x38:
+		return _type(chn) == HOST_DMA_VFF ?
+			_vff_fill(ch) / _unit(ch) : 0;
+	case 0x3C:
+		if (_type(chn) != HOST_DMA_VFF)
+			return 0;
+		if (!_vff_fill(ch))
+			return DMA_FFSTA_EMPTY;
+		return _vff_fill(ch) == _vff_size(ch) ? DMA_FFSTA_FULL : 0;
+	default:
+		return ch->reg[reg / 4];
+	}
+}
+
+static void _dma_write(struct host_model *m, u32 offset, u32 value)
+{
+	struct host_dma *dma = (struct host_dma *)m;
+	struct host_dma_chan *ch;
+	u32 chn, reg;
+
+	if (offset >= DMA_GLB_REG_OFFSET) {
+		switch (offset - DMA_GLB_REG_OFFSET) {
+		case 0x08:
+			/* a channel resets on a 0 to 1 edge of its bit */
+			for (chn = 0; chn < DMA_CHANNEL_AMOUNT; chn++)
+				if ((value & ~dma->ch_rst) & (1U << chn))
+					_reset_chan(&dma->ch[chn]);
+			dma->ch_rst = value;
+			break;
+		case 0x24:
+			dma->ch_en |= value;
+			break;
+		case 0x28:
+			dma->ch_en &= ~value;
+			break;
+		case 0x30:
+			dma->pause = value;
+			break;
+		default:
+			break;
+		}
+		_update_irq(dma);
+		return;
+	}
+	chn = offset / DMA_CHN_REG_OFFSET;
+	reg = offset % DMA_CHN_REG_OFFSET;
+	if (chn >= DMA_CHANNEL_AMOUNT || _type(chn) == HOST_DMA_NONE)
+		return;
+	ch = &dma->ch[chn];
+	switch (reg) {
+	case 0x18:
+		if (value & DMA_START_BIT) {
+			if (!(dma->ch_en & (1U << chn)))
+				printf("dma model: chn %u started with its clock off\n",
+				       chn);
+			ch->running = 1;
+			ch->done = 0;
+			ch->err_seen = 0;
+			ch->start = host_now();
+			ch->last_data = host_now();
+			ch->to_armed = 0;
+		} else {
+			ch->running = 0;
+		}
+		break;
+	case 0x1C:
+	case 0x38:
+	case 0x3C:
+		/* read only */
+		break;
+	case 0x20:
+		ch->intsta &= ~value;
+		break;
+	case 0x2C:
+	case 0x44:
+		/* a new ring restarts the hardware pointer */
+		ch->reg[reg / 4] = value;
+		R(ch, DMA_HWPTR(0)) = 0;
+		break;
+	case 0x58:
+		/* HWPTR is owned by the engine */
+		break;
+	default:
+		ch->reg[reg / 4] = value;
+		break;
+	}
+	/* a write (START, SWPTR, ACK) can make data move or an irq assert */
+	_dma_advance(m, host_now());
+}
+
+void host_dma_model_init(void)
+{
+	memset(&g_dma, 0, sizeof(g_dma));
+	memset(&host_dma_stats, 0, sizeof(host_dma_stats));
+	g_dma.m.name = "dma";
+	g_dma.m.base = HOST_DMA_BASE;
+	g_dma.m.size = HOST_DMA_SIZE;
+	g_dma.m.read = _dma_read;
+	g_dma.m.write = _dma_write;
+	g_dma.m.next_event = _dma_next_event;
+	g_dma.m.advance = _dma_advance;
+	host_model_add(&g_dma.m);
+}
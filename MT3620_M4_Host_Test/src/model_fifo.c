@@ -0,0 +1,95 @@
+/*
+ * A peripheral data register with a timed receive stream and a transmit
+ * sink. It stands in for the FIFO end of a peripheral in DMA tests.
+ */
+
+#include "host_model.h"
+
+static u32 _fifo_arrived(struct host_fifo *f, u64 now)
+{
+	u64 n;
+
+	if (!f->ns_per_byte)
+		return f->src_len;
+	n = (now - f->src_t0) / f->ns_per_byte;
+	return n < f->src_len ? (u32)n : f->src_len;
+}
+
+u32 host_fifo_pending(struct host_fifo *f)
+{
+	return _fifo_arrived(f, host_now()) - f->src_pos;
+}
+
+static u32 _fifo_read(struct host_model *m, u32 offset)
+{
+	struct host_fifo *f = (struct host_fifo *)m;
+	u32 v = 0;
+	u32 i;
+
+	(void)offset;
+	for (i = 0; i < f->width && host_fifo_pending(f); i++)
+		v |= (u32)f->src[f->src_pos++] << (8 * i);
+	return v;
+}
+
+static void _fifo_write(struct host_model *m, u32 offset, u32 value)
+{
+	struct host_fifo *f = (struct host_fifo *)m;
+	u32 i;
+
+	(void)offset;
+	for (i = 0; i < f->width && f->sink_len < HOST_FIFO_CAP; i++)
+		f->sink[f->sink_len++] = value >> (8 * i);
+}
+
+static u32 _fifo_dreq(struct host_model *m, u32 offset, int to_periph)
+{
+	struct host_fifo *f = (struct host_fifo *)m;
+
+	(void)offset;
+	if (to_periph)
+		return HOST_FIFO_CAP - f->sink_len;
+	return host_fifo_pending(f);
+}
+
+static u64 _fifo_next_event(struct host_model *m)
+{
+	struct host_fifo *f = (struct host_fifo *)m;
+	u32 n = _fifo_arrived(f, host_now());
+
+	if (n >= f->src_len)
+		return HOST_NEVER;
+	return f->src_t0 + (u64)(n + 1) * f->ns_per_byte;
+}
+
+void host_fifo_init(struct host_fifo *f, const char *name, u32 base,
+		    u32 width)
+{
+	memset(f, 0, sizeof(*f));
+	f->m.name = name;
+	f->m.base = base;
+	f->m.size = 4;
+	f->m.read = _fifo_read;
+	f->m.write = _fifo_write;
+	f->m.dreq = _fifo_dreq;
+	f->m.next_event = _fifo_next_event;
+	f->width = width;
+	host_model_add(&f->m);
+}
+
+void host_fifo_feed(struct host_fifo *f, const u8 *data, u32 len,
+		    u64 ns_per_byte)
+{
+	u32 left = _fifo_arrived(f, host_now()) - f->src_pos;
+
+	/* keep what arrived and was not read, the rest starts over */
+	memmove(f->src, f->src + f->src_pos, left);
+	if (len > HOST_FIFO_CAP - left)
+		len = HOST_FIFO_CAP - left;
+	memcpy(f->src + left, data, len);
+	f->src_pos = 0;
+	f->src_len = left + len;
+	f->ns_per_byte = ns_per_byte;
+	/* byte left + k arrives at now + (k + 1) * ns_per_byte */
+	f->src_t0 = host_now() - (u64)left * ns_per_byte;
+}
@@ -0,0 +1,317 @@
+/*
+ * Register model of an MT3620 ISU I2C master with one slave on the bus.
+ *
+ * Covers what hdl_i2c.c programs for master transfers: MM_CON0 START,
+ * PACK_CON0 and the per-packet byte counts, the slave ID, ACK_VAL, the
+ * 8-byte TX/RX FIFOs (by CPU or by DMA handshake) and the interrupt
+ * status. A transaction takes 9 SCL periods per byte plus the START and
+ * repeated START bits, the SCL period follows the MM_CNT_VAL phases. The
+ * slave is a register file with an auto-incremented address: the first
+ * byte of a write sets the address, the next ones are stored.
+ *
+ * The ISU clock gate register is part of the model: clearing its SW_RST
+ * bit (mtk_hdl_i2c_init_hw) aborts the transaction and empties the FIFOs.
+ * With stall set the slave holds SCL low and a transaction does not move
+ * on until host_i2c_stall(c, 0) or a reset of the master.
+ */
+
+#include "hdl_i2c.h"
+#include "host_model.h"
+
+#define I2C_SRC_NS		25	/* 40 MHz source clock */
+
+static u32 _i2c_bit_ns(struct host_i2c *c)
+{
+	u32 phl = c->reg[OFFSET_MM_CNT_VAL_PHL / 4];
+	u32 phh = c->reg[OFFSET_MM_CNT_VAL_PHH / 4];
+	u32 cnt = (phl & 0xff) + ((phl >> 8) & 0xff) +
+		  (phh & 0xff) + ((phh >> 8) & 0xff) + 4;
+
+	return cnt * I2C_SRC_NS;
+}
+
+static u32 _i2c_pkt_len(struct host_i2c *c, u32 pkt)
+{
+	if (pkt == 0)
+		return c->reg[OFFSET_MM_CNT_BYTE_VAL_PK0 / 4] & 0xffff;
+	return c->reg[OFFSET_MM_CNT_BYTE_VAL_PK1 / 4] & 0xffff;
+}
+
+static int _i2c_pkt_rd(struct host_i2c *c, u32 pkt)
+{
+	return (c->reg[OFFSET_MM_PACK_CON0 / 4] >> (I2C_MM_PACK_RW0 + pkt)) & 1;
+}
+
+static void _i2c_update_irq(struct host_i2c *c)
+{
+	host_irq_set(c->irq, (c->int_sta & I2C_MM_INT_STA) &&
+			     (c->int_ctrl & I2C_MM_INT_EN));
+}
+
+/* the byte at the current position can go out on the bus */
+static int _i2c_can_step(struct host_i2c *c)
+{
+	if (c->pos == 0)
+		return 1;
+	if (_i2c_pkt_rd(c, c->pkt))
+		return c->rx_cnt < I2C_FIFO_MAX_LEN;
+	return c->tx_cnt > 0;
+}
+
+static void _i2c_schedule(struct host_i2c *c, u64 now)
+{
+	u32 bits = 9;
+
+	if (!c->running || c->stall || !_i2c_can_step(c)) {
+		c->next_t = HOST_NEVER;
+		return;
+	}
+	/* START or repeated START before the address byte */
+	if (c->pos == 0)
+		bits++;
+	c->next_t = now + (u64)bits * c->bit_ns;
+}
+
+static void _i2c_slave_write(struct host_i2c *c, u8 val)
+{
+	if (c->first) {
+		c->ptr = val;
+		c->first = 0;
+		return;
+	}
+	if (c->slave_write)
+		c->slave_write(c, c->ptr, val);
+	else
+		c->regs[c->ptr] = val;
+	c->ptr++;
+}
+
+static void _i2c_stop(struct host_i2c *c, u64 now)
+{
+	c->running = 0;
+	c->next_t = HOST_NEVER;
+	c->reg[OFFSET_MM_CON0 / 4] &= ~I2C_MM_START_EN;
+	c->int_sta |= I2C_MM_INT_STA;
+	c->xfers++;
+	c->busy_ns += now - c->start;
+	_i2c_update_irq(c);
+}
+
+/* one byte (or the address) of the current packet goes over the bus */
+static void _i2c_step(struct host_i2c *c, u64 now)
+{
+	u32 num = ((c->reg[OFFSET_MM_PACK_CON0 / 4] & I2C_MM_PACK_VAL_MASK) >>
+		   I2C_MM_PACK_VAL_OFFSET) + 1;
+	u32 id = c->reg[OFFSET_MM_ID_CON0 / 4] & I2C_MM_SLAVE_ID_MASK;
+	u8 b;
+
+	if (c->pos == 0) {
+		if (id != c->addr) {
+			c->ack_val |= BIT(I2C_ACK_PKT0_OFFSET + c->pkt);
+			_i2c_stop(c, now);
+			return;
+		}
+		c->first = !_i2c_pkt_rd(c, c->pkt);
+	} else if (_i2c_pkt_rd(c, c->pkt)) {
+		c->rx[c->rx_cnt++] = c->regs[c->ptr++];
+		c->bytes++;
+	} else {
+		b = c->tx[0];
+		memmove(c->tx, c->tx + 1, --c->tx_cnt);
+		_i2c_slave_write(c, b);
+		c->bytes++;
+	}
+
+	if (c->pos++ == _i2c_pkt_len(c, c->pkt)) {
+		c->pos = 0;
+		if (++c->pkt == num) {
+			_i2c_stop(c, now);
+			return;
+		}
+	}
+	_i2c_schedule(c, now);
+}
+
+static void _i2c_start(struct host_i2c *c, u64 now)
+{
+	c->running = 1;
+	c->pkt = 0;
+	c->pos = 0;
+	c->ack_val = 0;
+	c->bit_ns = _i2c_bit_ns(c);
+	c->start = now;
+	_i2c_schedule(c, now);
+}
+
+static u32 _i2c_fifo_status(struct host_i2c *c)
+{
+	u32 v = 0;
+
+	if (!c->tx_cnt)
+		v |= MM_TX_FIFO_EMP;
+	if (c->tx_cnt == I2C_FIFO_MAX_LEN)
+		v |= MM_TX_FIFO_FUL;
+	if (!c->rx_cnt)
+		v |= MM_RX_FIFO_EMP;
+	if (c->rx_cnt == I2C_FIFO_MAX_LEN)
+		v |= MM_RX_FIFO_FUL;
+	return v;
+}
+
+static u32 _i2c_read(struct host_model *m, u32 off)
+{
+	struct host_i2c *c = (struct host_i2c *)m;
+	u32 v;
+
+	switch (off) {
+	case OFFSET_I2C_INT_CTRL:
+		return c->int_sta | c->int_ctrl;
+	case OFFSET_MM_STATUS:
+		return c->running ? 0 : I2C_MM_START_READY;
+	case OFFSET_MM_ACK_VAL:
+		return c->ack_val;
+	case OFFSET_MM_FIFO_STATUS:
+		return _i2c_fifo_status(c);
+	case OFFSET_MM_FIFO_PTR:
+		/* read pointers stay at 0, the write pointers are the levels.
+		 * I2C_MM_TX_FIFO_WPTR_OFFSET is BIT(12), not 12.
+		 */
+		return (c->rx_cnt << I2C_MM_RX_FIFO_WPTR_OFFSET) |
+		       (c->tx_cnt << 12);
+	case OFFSET_MM_FIFO_DATA:
+		if (!c->rx_cnt)
+			return 0;
+		v = c->rx[0];
+		memmove(c->rx, c->rx + 1, --c->rx_cnt);
+		if (c->running && c->next_t == HOST_NEVER)
+			_i2c_schedule(c, host_now());
+		return v;
+	default:
+		return c->reg[off / 4];
+	}
+}
+
+static void _i2c_write(struct host_model *m, u32 off, u32 val)
+{
+	struct host_i2c *c = (struct host_i2c *)m;
+
+	switch (off) {
+	case OFFSET_I2C_INT_CTRL:
+		c->int_sta &= ~(val & (I2C_MM_INT_STA | I2C_S_INT_STA));
+		c->int_ctrl = val & ~(I2C_MM_INT_STA | I2C_S_INT_STA);
+		_i2c_update_irq(c);
+		break;
+	case OFFSET_MM_CON0:
+		c->reg[off / 4] = val;
+		if ((val & I2C_MM_START_EN) && !c->running)
+			_i2c_start(c, host_now());
+		break;
+	case OFFSET_MM_FIFO_CON0:
+		if (val & I2C_MM_TX_FIFO_CLR)
+			c->tx_cnt = 0;
+		if (val & I2C_MM_RX_FIFO_CLR)
+			c->rx_cnt = 0;
+		break;
+	case OFFSET_MM_FIFO_DATA:
+		if (c->tx_cnt < I2C_FIFO_MAX_LEN)
+			c->tx[c->tx_cnt++] = val;
+		if (c->running && c->next_t == HOST_NEVER)
+			_i2c_schedule(c, host_now());
+		break;
+	default:
+		c->reg[off / 4] = val;
+		break;
+	}
+}
+
+static void _i2c_reset(struct host_i2c *c)
+{
+	if (c->running)
+		c->aborts++;
+	c->running = 0;
+	c->stall = 0;
+	c->next_t = HOST_NEVER;
+	c->reg[OFFSET_MM_CON0 / 4] &= ~I2C_MM_START_EN;
+	c->tx_cnt = 0;
+	c->rx_cnt = 0;
+	c->int_sta = 0;
+	_i2c_update_irq(c);
+}
+
+static u32 _i2c_dreq(struct host_model *m, u32 off, int to_periph)
+{
+	struct host_i2c *c = (struct host_i2c *)m;
+
+	if (off != OFFSET_MM_FIFO_DATA ||
+	    !(c->reg[OFFSET_DMA_CON0 / 4] & I2C_DMA_HANDSHAKE_EN))
+		return 0;
+	if (to_periph)
+		return I2C_FIFO_MAX_LEN - c->tx_cnt;
+	return c->rx_cnt;
+}
+
+static u64 _i2c_next_event(struct host_model *m)
+{
+	return ((struct host_i2c *)m)->next_t;
+}
+
+static void _i2c_advance(struct host_model *m, u64 now)
+{
+	struct host_i2c *c = (struct host_i2c *)m;
+
+	while (c->next_t <= now)
+		_i2c_step(c, c->next_t);
+}
+
+static u32 _i2c_cg_read(struct host_model *m, u32 off)
+{
+	struct host_i2c *c = (struct host_i2c *)((u8 *)m -
+			     offsetof(struct host_i2c, cg));
+
+	(void)off;
+	return c->cg_reg;
+}
+
+static void _i2c_cg_write(struct host_model *m, u32 off, u32 val)
+{
+	struct host_i2c *c = (struct host_i2c *)((u8 *)m -
+			     offsetof(struct host_i2c, cg));
+
+	(void)off;
+	if (!(val & ISU_CR_SW_RST))
+		_i2c_reset(c);
+	c->cg_reg = val;
+}
+
+void host_i2c_stall(struct host_i2c *c, int on)
+{
+	c->stall = !!on;
+	if (c->stall)
+		c->next_t = HOST_NEVER;
+	else if (c->running && c->next_t == HOST_NEVER)
+		_i2c_schedule(c, host_now());
+}
+
+void host_i2c_init(struct host_i2c *c, const char *name, u32 base,
+		   u32 cg_base, int irq, u8 addr)
+{
+	memset(c, 0, sizeof(*c));
+	c->m.name = name;
+	c->m.base = base;
+	c->m.size = 0x100;
+	c->m.read = _i2c_read;
+	c->m.write = _i2c_write;
+	c->m.dreq = _i2c_dreq;
+	c->m.next_event = _i2c_next_event;
+	c->m.advance = _i2c_advance;
+	c->cg.name = name;
+	c->cg.base = cg_base;
+	c->cg.size = 4;
+	c->cg.read = _i2c_cg_read;
+	c->cg.write = _i2c_cg_write;
+	c->irq = irq;
+	c->addr = addr;
+	c->next_t = HOST_NEVER;
+	host_model_add(&c->m);
+	host_model_add(&c->cg);
+}
@@ -0,0 +1,262 @@
+/*
+ * Register model of an MT3620 ISU SPI master with one slave on the bus.
+ *
+ * Covers what hdl_spim.c programs: OPCODE, the SDOR/SDIR data registers,
+ * MASTER (clock divider, duplex, interrupt enable), MOREBUF bit counts,
+ * CTL START/BUSY, the read-to-clear STATUS and the DMA mode bit of
+ * CS_POLAR. In DMA mode the TX channel writes a struct mtk_spi_dma_frame
+ * to DATAPORT, word by word into OPCODE, SDOR0-7, MASTER and MOREBUF and
+ * then CTL, which starts the transaction. The RX channel reads the bytes
+ * received by a DMA mode transaction from DATAPORT once it has ended.
+ *
+ * The ISU clock gate register is part of the model: clearing its bit 0
+ * (mtk_hdl_spim_sw_reset) aborts the transaction on the wire and clears
+ * all registers. A transaction takes the opcode and data bits at the SCK
+ * rate of the MASTER divider, plus the CS setup and hold delays of
+ * CS_POLAR in SCK periods. The slave returns miso_seed + i for byte i and
+ * increments miso_seed after each transaction.
+ */
+
+#include "hdl_spim.h"
+#include "host_model.h"
+
+#define SPIM_SRC_HZ		80000000ULL
+#define SPIM_FRAME_WORDS	13
+#define SPIM_FRAME_CTL		11
+#define SPIM_FULL_RX_OFF	16
+
+#define REG(c, off)		((c)->reg[(off) / 4])
+
+static int _spim_dma_mode(struct host_spim *c)
+{
+	return !!(REG(c, 0x38) & SPI_HALF_DMA_MODE_EN);
+}
+
+static int _spim_full_duplex(struct host_spim *c)
+{
+	return !!(REG(c, 0x28) & FULL_DUPLEX);
+}
+
+static u64 _spim_sck_ns(struct host_spim *c)
+{
+	u32 div = (REG(c, 0x28) >> SPI_MASTER_CLOCK_DIV_SHIFT) & 0xfff;
+
+	return (div + 2) * 1000000000ULL / SPIM_SRC_HZ;
+}
+
+static void _spim_update_irq(struct host_spim *c)
+{
+	host_irq_set(c->irq, c->status && (REG(c, 0x28) & SPI_M_INT_ENABLE));
+}
+
+static void _spim_start(struct host_spim *c, u64 now)
+{
+	u32 mb = REG(c, 0x2c);
+	u32 cmd = (mb & SPI_MBCTL_CMD_MASK) >> SPI_MBCTL_CMD_SHIFT;
+	u32 tx = (mb & SPI_MBCTL_TXCNT_MASK) >> SPI_MBCTL_TXCNT_SHIFT;
+	u32 rx = (mb & SPI_MBCTL_RXCNT_MASK) >> SPI_MBCTL_RXCNT_SHIFT;
+	u32 cs = REG(c, 0x38);
+	u32 bits;
+
+	bits = cmd + (_spim_full_duplex(c) ? (tx > rx ? tx : rx) : tx + rx);
+	bits += ((cs & CMD_DELAY_SEL_MASK) >> CMD_DELAY_SEL_OFFSET) +
+		((cs & END_DELAY_SEL_MASK) >> END_DELAY_SEL_OFFSET) + 2;
+
+	c->running = 1;
+	c->start = now;
+	c->next_t = now + bits * _spim_sck_ns(c) + c->extra_ns;
+	/* the data of the previous transaction is gone */
+	c->rx_pos = 0;
+	c->rx_end = 0;
+}
+
+static void _spim_log(struct host_spim *c, u8 b)
+{
+	if (c->mosi_len < HOST_SPIM_LOG)
+		c->mosi[c->mosi_len++] = b;
+}
+
+static void _spim_end(struct host_spim *c, u64 now)
+{
+	u32 mb = REG(c, 0x2c);
+	u32 cmd = ((mb & SPI_MBCTL_CMD_MASK) >> SPI_MBCTL_CMD_SHIFT) / 8;
+	u32 tx = ((mb & SPI_MBCTL_TXCNT_MASK) >> SPI_MBCTL_TXCNT_SHIFT) / 8;
+	u32 rx = ((mb & SPI_MBCTL_RXCNT_MASK) >> SPI_MBCTL_RXCNT_SHIFT) / 8;
+	u32 off = _spim_full_duplex(c) ? SPIM_FULL_RX_OFF : 0;
+	u8 *sdor = (u8 *)&REG(c, 0x08);
+	u8 *sdir = (u8 *)&REG(c, 0x48);
+	u32 i;
+
+	for (i = 0; i < cmd && i < 4; i++)
+		_spim_log(c, REG(c, 0x04) >> (8 * i));
+	for (i = 0; i < tx && i < 32; i++)
+		_spim_log(c, sdor[i]);
+	for (i = 0; i < rx && off + i < 32; i++)
+		sdir[off + i] = c->miso_seed + i;
+	c->miso_seed++;
+
+	c->running = 0;
+	c->next_t = HOST_NEVER;
+	c->status = SPI_OK | (tx ? SPI_TX_OK : 0) | (rx ? SPI_RX_OK : 0);
+	if (_spim_dma_mode(c) && rx) {
+		c->rx_pos = off;
+		c->rx_end = off + ((rx + 3) & ~3);
+	}
+	c->xfers++;
+	c->bytes += cmd + (tx > rx ? tx : rx);
+	c->busy_ns += now - c->start;
+	_spim_update_irq(c);
+}
+
+static void _spim_reset(struct host_spim *c)
+{
+	if (c->running)
+		c->aborts++;
+	memset(c->reg, 0, sizeof(c->reg));
+	c->running = 0;
+	c->next_t = HOST_NEVER;
+	c->status = 0;
+	c->port_ptr = 0;
+	c->rx_pos = 0;
+	c->rx_end = 0;
+	_spim_update_irq(c);
+}
+
+/* a DMA frame word goes to the register the frame layout puts it in */
+static void _spim_port_write(struct host_spim *c, u32 val)
+{
+	u32 k = c->port_ptr;
+
+	c->port_ptr = (k + 1) % SPIM_FRAME_WORDS;
+	if (k < SPIM_FRAME_CTL)
+		c->reg[1 + k] = val;
+	else if (k == SPIM_FRAME_CTL && (val & SPI_CTL_START) && !c->running)
+		_spim_start(c, host_now());
+}
+
+static u32 _spim_read(struct host_model *m, u32 off)
+{
+	struct host_spim *c = (struct host_spim *)m;
+	u32 v;
+
+	switch (off) {
+	case 0x00:
+		return REG(c, 0x00) | (c->running ? SPI_CTL_BUSY : 0);
+	case 0x34:
+		v = c->status;
+		c->status = 0;
+		_spim_update_irq(c);
+		return v;
+	case 0x40:
+		if (c->rx_pos >= c->rx_end)
+			return 0;
+		v = c->reg[0x48 / 4 + c->rx_pos / 4];
+		c->rx_pos += 4;
+		return v;
+	default:
+		return c->reg[off / 4];
+	}
+}
+
+static void _spim_write(struct host_model *m, u32 off, u32 val)
+{
+	struct host_spim *c = (struct host_spim *)m;
+
+	switch (off) {
+	case 0x00:
+		REG(c, 0x00) = val & ~SPI_CTL_START;
+		if ((val & SPI_CTL_START) && !c->running)
+			_spim_start(c, host_now());
+		break;
+	case 0x28:
+		REG(c, 0x28) = val;
+		_spim_update_irq(c);
+		break;
+	case 0x34:
+		break;
+	case 0x38:
+		/* the DMA frame starts over when DMA mode is switched on */
+		if ((val & ~REG(c, 0x38)) & SPI_HALF_DMA_MODE_EN)
+			c->port_ptr = 0;
+		REG(c, 0x38) = val;
+		break;
+	case 0x40:
+		if (_spim_dma_mode(c))
+			_spim_port_write(c, val);
+		break;
+	default:
+		c->reg[off / 4] = val;
+		break;
+	}
+}
+
+static u32 _spim_dreq(struct host_model *m, u32 off, int to_periph)
+{
+	struct host_spim *c = (struct host_spim *)m;
+
+	if (off != 0x40 || !_spim_dma_mode(c))
+		return 0;
+	if (to_periph) {
+		/* the word after CTL is taken while the frame runs */
+		if (c->running)
+			return c->port_ptr == SPIM_FRAME_CTL + 1 ? 4 : 0;
+		return (SPIM_FRAME_WORDS - c->port_ptr) * 4;
+	}
+	return c->running ? 0 : c->rx_end - c->rx_pos;
+}
+
+static u64 _spim_next_event(struct host_model *m)
+{
+	return ((struct host_spim *)m)->next_t;
+}
+
+static void _spim_advance(struct host_model *m, u64 now)
+{
+	struct host_spim *c = (struct host_spim *)m;
+
+	if (c->next_t <= now)
+		_spim_end(c, c->next_t);
+}
+
+static u32 _spim_cg_read(struct host_model *m, u32 off)
+{
+	struct host_spim *c = (struct host_spim *)((u8 *)m -
+			      offsetof(struct host_spim, cg));
+
+	(void)off;
+	return c->cg_reg;
+}
+
+static void _spim_cg_write(struct host_model *m, u32 off, u32 val)
+{
+	struct host_spim *c = (struct host_spim *)((u8 *)m -
+			      offsetof(struct host_spim, cg));
+
+	(void)off;
+	if (!(val & 1))
+		_spim_reset(c);
+	c->cg_reg = val;
+}
+
+void host_spim_init(struct host_spim *c, const char *name, u32 base,
+		    u32 cg_base, int irq)
+{
+	memset(c, 0, sizeof(*c));
+	c->m.name = name;
+	c->m.base = base;
+	c->m.size = 0x100;
+	c->m.read = _spim_read;
+	c->m.write = _spim_write;
+	c->m.dreq = _spim_dreq;
+	c->m.next_event = _spim_next_event;
+	c->m.advance = _spim_advance;
+	c->cg.name = name;
+	c->cg.base = cg_base;
+	c->cg.size = 4;
+	c->cg.read = _spim_cg_read;
+	c->cg.write = _spim_cg_write;
+	c->irq = irq;
+	c->next_t = HOST_NEVER;
+	host_model_add(&c->m);
+	host_model_add(&c->cg);
+}
@@ -0,0 +1,309 @@
+/*
+ * Stub of the SPIS M-HAL (mhal_spis.h) for one controller, with the SPI
+ * master on the other side of the bus.
+ *
+ * This tree has no mhal_spis.c, no SPIS HDL and no SPIS register map, so
+ * unlike the other models this one stands in for the M-HAL functions
+ * instead of the registers. It keeps to what mhal_spis.h documents: the
+ * H2DMB carries the direction, the FIFO/DMA mode and the length in
+ * double words, handle_h2dmb() fills the transfer and calls the OS-HAL
+ * handle_transfer callback, *_transfer_one() arms the data phase and
+ * send_d2hmb() reports the state to the master. A FIFO data phase ends
+ * in the SPIS irq, a DMA one in the DMA irq, which calls the dma_done
+ * callback.
+ *
+ * host_spis_write() / host_spis_read() run one transaction of the master:
+ * the H2DMB and the SPIS irq, the data phase at bit_ns per bit and the
+ * completion irq. The data is copied when the data phase ends.
+ */
+
+#include "nvic.h"
+#include "mhal_spis.h"
+#include "host_model.h"
+
+/* what the next SPIS irq reports */
+#define SPIS_IRQ_H2DMB		1
+#define SPIS_IRQ_DATA_DONE	2
+
+/* the data phase armed by the OS-HAL */
+#define SPIS_ARMED_FIFO		1
+#define SPIS_ARMED_DMA		2
+
+static struct host_spis *g_spis;
+
+static int _spis_ok(struct mtk_spis_controller *ctlr)
+{
+	return ctlr && ctlr->mdata && g_spis;
+}
+
+static void _spis_dma_irq(void)
+{
+	struct mtk_spis_private *mdata = g_spis->ctlr->mdata;
+
+	host_irq_set(g_spis->dma_irq, 0);
+	if (mdata->dma_done_callback)
+		mdata->dma_done_callback(mdata->user_data);
+}
+
+int mtk_mhal_spis_dump_reg(struct mtk_spis_controller *ctlr)
+{
+	return _spis_ok(ctlr) ? 0 : -EPTR;
+}
+
+int mtk_mhal_spis_get_irq_status(struct mtk_spis_controller *ctlr)
+{
+	return _spis_ok(ctlr) ? g_spis->irq_status : -EPTR;
+}
+
+int mtk_mhal_spis_clear_irq_status(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	g_spis->irq_status = 0;
+	host_irq_set(g_spis->irq, 0);
+	return 0;
+}
+
+int mtk_mhal_spis_handle_h2dmb(struct mtk_spis_controller *ctlr)
+{
+	struct mtk_spis_private *mdata;
+	struct mtk_spis_transfer *xfer;
+	u32 h2dmb, dwords;
+
+	if (!_spis_ok(ctlr) || !ctlr->xfer)
+		return -EPTR;
+
+	mdata = ctlr->mdata;
+	xfer = ctlr->xfer;
+	h2dmb = g_spis->h2dmb;
+	g_spis->h2dmb_cnt++;
+
+	if (!(h2dmb & BIT(6))) {
+		mdata->d2hmb_state = SPIS_ERR;
+		return -EH2DMB;
+	}
+	dwords = h2dmb & 0xf;
+	if (dwords < 1 || dwords > 8) {
+		mdata->d2hmb_state = SPIS_ERR;
+		return -ELENGTH;
+	}
+
+	xfer->direction = (h2dmb >> 5) & 1;
+	xfer->use_dma = (h2dmb >> 4) & 1;
+	xfer->len = dwords * 4;
+	if (mdata->handle_transfer_callback)
+		mdata->handle_transfer_callback(mdata->user_data,
+						xfer->direction);
+	mdata->d2hmb_state = SPIS_READY;
+
+	return 0;
+}
+
+int mtk_mhal_spis_send_d2hmb(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	g_spis->d2hmb = ctlr->mdata->d2hmb_state;
+	return 0;
+}
+
+int mtk_mhal_spis_handle_rx(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	ctlr->mdata->d2hmb_state = SPIS_DONE;
+	return 0;
+}
+
+int mtk_mhal_spis_handle_tx(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	ctlr->mdata->d2hmb_state = SPIS_DONE;
+	return 0;
+}
+
+int mtk_mhal_spis_setup_hw(struct mtk_spis_controller *ctlr,
+			   struct mtk_spis_config *config)
+{
+	if (!_spis_ok(ctlr) || !config)
+		return -EPTR;
+	g_spis->ctlr = ctlr;
+	g_spis->cpol = config->cpol;
+	g_spis->cpha = config->cpha;
+	return 0;
+}
+
+int mtk_mhal_spis_enable_irq(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	g_spis->irq_on = 1;
+	return 0;
+}
+
+int mtk_mhal_spis_handle_transfer_callback_register(
+					struct mtk_spis_controller *ctlr,
+					spis_handle_transfer_callback callback)
+{
+	if (!_spis_ok(ctlr) || !callback)
+		return -EPTR;
+	ctlr->mdata->handle_transfer_callback = callback;
+	return 0;
+}
+
+static int _spis_arm(struct mtk_spis_controller *ctlr,
+		     struct mtk_spis_transfer *xfer, u8 mode)
+{
+	if (!_spis_ok(ctlr) || !xfer)
+		return -EPTR;
+	if (xfer->len < 4 || xfer->len > 32 || xfer->len % 4)
+		return -ELENGTH;
+	g_spis->armed = mode;
+	return 0;
+}
+
+int mtk_mhal_spis_fifo_transfer_one(struct mtk_spis_controller *ctlr,
+				    struct mtk_spis_transfer *xfer)
+{
+	return _spis_arm(ctlr, xfer, SPIS_ARMED_FIFO);
+}
+
+int mtk_mhal_spis_dma_done_callback_register(
+					struct mtk_spis_controller *ctlr,
+					spis_dma_done_callback callback)
+{
+	if (!_spis_ok(ctlr) || !callback)
+		return -EPTR;
+	ctlr->mdata->dma_done_callback = callback;
+	return 0;
+}
+
+int mtk_mhal_spis_dma_transfer_one(struct mtk_spis_controller *ctlr,
+				   struct mtk_spis_transfer *xfer)
+{
+	return _spis_arm(ctlr, xfer, SPIS_ARMED_DMA);
+}
+
+int mtk_mhal_spis_allocate_dma_chan(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	if (g_spis->dma_on)
+		return -EBUSY;
+	g_spis->dma_on = 1;
+	CM4_Install_NVIC(g_spis->dma_irq, DEFAULT_PRI, IRQ_LEVEL_TRIGGER,
+			 _spis_dma_irq, TRUE);
+	return 0;
+}
+
+int mtk_mhal_spis_release_dma_chan(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	if (!g_spis->dma_on)
+		return -EBUSY;
+	g_spis->dma_on = 0;
+	NVIC_DisableIRQ((IRQn_Type)g_spis->dma_irq);
+	return 0;
+}
+
+int mtk_mhal_spis_enable_clk(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	g_spis->clk_on = 1;
+	return 0;
+}
+
+int mtk_mhal_spis_disable_clk(struct mtk_spis_controller *ctlr)
+{
+	if (!_spis_ok(ctlr))
+		return -EPTR;
+	g_spis->clk_on = 0;
+	g_spis->irq_on = 0;
+	return 0;
+}
+
+/* the data phase moves len bytes between the master and the buffer the
+ * OS-HAL gave for it
+ */
+static void _spis_data(struct host_spis *s, int write, u8 *buf, u32 len)
+{
+	struct mtk_spis_transfer *xfer = s->ctlr->xfer;
+	u8 *mem = write ? xfer->rx_buf : xfer->tx_buf;
+
+	if (s->armed == SPIS_ARMED_DMA) {
+		s->dma_xfers++;
+		/* DMA reaches SYSRAM only */
+		if (!mem || !host_sysram_contains((u32)(uintptr_t)mem, len)) {
+			s->dma_errors++;
+			if (!write)
+				memset(buf, 0, len);
+			return;
+		}
+	} else {
+		s->fifo_xfers++;
+	}
+
+	if (write && mem)
+		memcpy(mem, buf, len);
+	else if (!write && mem)
+		memcpy(buf, mem, len);
+	else if (!write)
+		memset(buf, 0, len);
+}
+
+static int _spis_xfer(struct host_spis *s, int write, u8 *buf, u32 len,
+		      int dma)
+{
+	s->d2hmb = SPIS_IDLE;
+	s->armed = 0;
+	if (!s->ctlr || !s->clk_on || !s->irq_on)
+		return s->d2hmb;
+
+	/* the SEND_H2DMB opcode and the mailbox byte */
+	s->h2dmb = SET_TRANSFER_H2DMB(!!write, !!dma, len / 4);
+	host_run(16 * s->bit_ns);
+	s->irq_status = SPIS_IRQ_H2DMB;
+	host_irq_set(s->irq, 1);
+	/* the master polls SPIS_STATUS until the slave is ready */
+	host_run(16 * s->bit_ns);
+	if (s->d2hmb != SPIS_READY || !s->armed)
+		return s->d2hmb;
+
+	/* the opcode and the data */
+	host_run((8 + len * 8) * s->bit_ns);
+	_spis_data(s, write, buf, len);
+	if (s->armed == SPIS_ARMED_DMA) {
+		host_irq_set(s->dma_irq, 1);
+	} else {
+		s->irq_status = SPIS_IRQ_DATA_DONE;
+		host_irq_set(s->irq, 1);
+	}
+	s->armed = 0;
+	host_run(16 * s->bit_ns);
+	s->xfers++;
+
+	return s->d2hmb;
+}
+
+int host_spis_write(struct host_spis *s, const u8 *buf, u32 len, int dma)
+{
+	return _spis_xfer(s, 1, (u8 *)buf, len, dma);
+}
+
+int host_spis_read(struct host_spis *s, u8 *buf, u32 len, int dma)
+{
+	return _spis_xfer(s, 0, buf, len, dma);
+}
+
+void host_spis_init(struct host_spis *s, int irq, int dma_irq)
+{
+	memset(s, 0, sizeof(*s));
+	s->irq = irq;
+	s->dma_irq = dma_irq;
+	/* 10 MHz SCK */
+	s->bit_ns = 100;
+	g_spis = s;
+}
@@ -0,0 +1,33 @@
+/*
+ * os_hal_audio.c with the portable C kernels and dot product, under c_
+ * names so it links next to the MTK_AUDIO_SIMD=1 build of mt3620_host.
+ * See audio_c.h.
+ */
+
+#define MTK_AUDIO_SIMD 0
+
+#define mtk_os_hal_audio_s16_to_s32	c_mtk_os_hal_audio_s16_to_s32
+#define mtk_os_hal_audio_s16_to_s32_ref	c_mtk_os_hal_audio_s16_to_s32_ref
+#define mtk_os_hal_audio_s32_to_s16	c_mtk_os_hal_audio_s32_to_s16
+#define mtk_os_hal_audio_s32_to_s16_ref	c_mtk_os_hal_audio_s32_to_s16_ref
+#define mtk_os_hal_audio_deinterleave_s16	c_mtk_os_hal_audio_deinterleave_s16
+#define mtk_os_hal_audio_deinterleave_s16_ref	c_mtk_os_hal_audio_deinterleave_s16_ref
+#define mtk_os_hal_audio_interleave_s16	c_mtk_os_hal_audio_interleave_s16
+#define mtk_os_hal_audio_interleave_s16_ref	c_mtk_os_hal_audio_interleave_s16_ref
+#define mtk_os_hal_audio_gain_s16	c_mtk_os_hal_audio_gain_s16
+#define mtk_os_hal_audio_gain_s16_ref	c_mtk_os_hal_audio_gain_s16_ref
+#define mtk_os_hal_audio_mix_s16	c_mtk_os_hal_audio_mix_s16
+#define mtk_os_hal_audio_mix_s16_ref	c_mtk_os_hal_audio_mix_s16_ref
+#define mtk_os_hal_audio_mix_gain_s16	c_mtk_os_hal_audio_mix_gain_s16
+#define mtk_os_hal_audio_mix_gain_s16_ref	c_mtk_os_hal_audio_mix_gain_s16_ref
+#define mtk_os_hal_audio_rs_init	c_mtk_os_hal_audio_rs_init
+#define mtk_os_hal_audio_rs_reset	c_mtk_os_hal_audio_rs_reset
+#define mtk_os_hal_audio_mixer_init	c_mtk_os_hal_audio_mixer_init
+#define mtk_os_hal_audio_mixer_add	c_mtk_os_hal_audio_mixer_add
+#define mtk_os_hal_audio_mixer_remove	c_mtk_os_hal_audio_mixer_remove
+#define mtk_os_hal_audio_mix_start	c_mtk_os_hal_audio_mix_start
+#define mtk_os_hal_audio_mix_stop	c_mtk_os_hal_audio_mix_stop
+#define mtk_os_hal_audio_mix_set_gain	c_mtk_os_hal_audio_mix_set_gain
+#define mtk_os_hal_audio_mixer_render	c_mtk_os_hal_audio_mixer_render
+
+#include "os_hal_audio.c"
@@ -0,0 +1,21 @@
+/*
+ * The mixer of os_hal_audio.c built a second time with MTK_AUDIO_SIMD=0
+ * (audio_c.c), every public function renamed with a c_ prefix, so a test
+ * can run the SIMD and the portable C build side by side.
+ */
+
+#ifndef __AUDIO_C_H__
+#define __AUDIO_C_H__
+
+#include "os_hal_audio.h"
+
+int c_mtk_os_hal_audio_mixer_init(struct mtk_audio_mixer *mixer, u32 rate);
+int c_mtk_os_hal_audio_mixer_add(struct mtk_audio_mixer *mixer,
+				 struct mtk_audio_mix_input *input,
+				 const struct mtk_audio_mix_config *cfg);
+void c_mtk_os_hal_audio_mix_set_gain(struct mtk_audio_mix_input *input,
+				     int16_t gain);
+int c_mtk_os_hal_audio_mixer_render(struct mtk_audio_mixer *mixer,
+				    int32_t *dst, u32 frames);
+
+#endif /* __AUDIO_C_H__ */
@@ -0,0 +1,37 @@
+/*
+ * The audio benchmark of MT3620_RTApp_FreeRTOS_Audio_Benchmark on the
+ * host: the SIMD kernels against their references, and the THD+N of the
+ * resampler presets against the limits in audio_bench.c. Those results
+ * are the same as on the board. Computation takes no simulated time, so
+ * the cycles come from the process CPU time at HOST_CPU_HZ. They only
+ * show how the presets and kernels compare, the M4 cycles and CPU load
+ * come from a board run.
+ */
+
+#include <time.h>
+#include "FreeRTOS.h"
+#include "host_model.h"
+#include "audio_bench.h"
+
+uint32_t audio_bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+	return (uint32_t)(((u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec) *
+			  HOST_CPU_HZ / 1000000000ULL);
+}
+
+static void bench_audio(void)
+{
+	CHECK_EQ(audio_bench_init(), 0);
+	CHECK_EQ(audio_bench_run(), 0);
+}
+
+int main(void)
+{
+	HOST_RUN_TEST(bench_audio);
+
+	return host_failures != 0;
+}
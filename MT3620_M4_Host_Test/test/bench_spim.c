@@ -0,0 +1,58 @@
+/*
+ * The SPIM benchmark of MT3620_RTApp_FreeRTOS_SPIM_Benchmark against the
+ * SPIM and DMA register models, same bus, clock and sizes as on the
+ * board. Cycles are CPU cycles of simulated time, so the driver overhead
+ * comes from the register accesses (host_bus_access_ns each) and the
+ * model wire time, not from instruction timing. Compare the columns
+ * relative to "wire" with a board run rather than the absolute numbers.
+ */
+
+#include "FreeRTOS.h"
+#include "nvic.h"
+#include "os_hal_spim.h"
+#include "os_hal_dma.h"
+#include "host_model.h"
+#include "spim_bench.h"
+
+#define SPIM_BUS	OS_HAL_SPIM_ISU1
+#define SPIM_BASE	0x38080300
+#define SPIM_CG_BASE	0x38080000
+#define SPIM_KHZ	10000
+
+static struct host_spim g_spim;
+
+/* one pass of the spin loop of the RTApp: a load of the done flag */
+void spim_bench_wait(void)
+{
+	host_run(host_bus_access_ns);
+}
+
+static void bench_spim(void)
+{
+	u64 t;
+
+	host_spim_init(&g_spim, "spim1", SPIM_BASE, SPIM_CG_BASE,
+		       CM4_IRQ_ISU_G1_SPIM);
+	host_dma_model_init();
+	CHECK_EQ(mtk_os_hal_spim_ctlr_init(SPIM_BUS), 0);
+	CHECK_EQ(spim_bench_init(SPIM_BUS, SPIM_KHZ), 0);
+
+	t = host_now();
+	CHECK_EQ(spim_bench_run(), 0);
+	t = host_now() - t;
+
+	printf("\n%u transactions, bus busy %llu of %llu us, %llu register accesses\n",
+	       g_spim.xfers, g_spim.busy_ns / HOST_NS_PER_US,
+	       t / HOST_NS_PER_US, host_stats.reads + host_stats.writes);
+	CHECK_EQ(g_spim.aborts, 0);
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+
+	CHECK_EQ(mtk_os_hal_spim_ctlr_deinit(SPIM_BUS), 0);
+}
+
+int main(void)
+{
+	HOST_RUN_TEST(bench_spim);
+
+	return host_failures != 0;
+}
@@ -0,0 +1,351 @@
+/*
+ * os_hal_audio.c kernels built with MTK_AUDIO_SIMD=1, the DSP
+ * instructions taken from the C versions in inc/core_cm4.h. Every SIMD
+ * kernel must match its *_ref version bit for bit, for any length and
+ * alignment and with full scale inputs. The mixer and resampler must
+ * render the same as the MTK_AUDIO_SIMD=0 build of audio_c.c.
+ */
+
+#include "host_model.h"
+#include "os_hal_audio.h"
+#include "audio_c.h"
+
+/* odd and even, below and above a SIMD pair */
+#define AUDIO_MAX_LEN	515
+/* one spare sample in front for the unaligned runs */
+#define AUDIO_BUF_LEN	(2 * AUDIO_MAX_LEN + 2)
+
+#define AUDIO_CNT(x)	(sizeof(x) / sizeof((x)[0]))
+
+/* mixer runs: inputs pulled in AUDIO_BLOCKS blocks of AUDIO_BLOCK frames,
+ * rendered until the 16 kHz one has drained
+ */
+#define AUDIO_MIX_RATE	48000
+#define AUDIO_BLOCK	80
+#define AUDIO_BLOCKS	6
+#define AUDIO_MIX_FRAMES	1680
+#define AUDIO_MIX_INPUTS	3
+#define AUDIO_COEF_LEN	MTK_AUDIO_RS_COEF_LEN(MTK_AUDIO_RS_TAPS_MAX, \
+					      MTK_AUDIO_RS_PHASES_MAX)
+
+static u32 g_seed = 1;
+
+static int16_t g_a[AUDIO_BUF_LEN];
+static int16_t g_b[AUDIO_BUF_LEN];
+static int32_t g_slot[AUDIO_BUF_LEN];
+static int16_t g_out16[2][AUDIO_BUF_LEN];
+static int32_t g_out32[2][AUDIO_BUF_LEN];
+
+/* mixer API of one build, [0] SIMD and [1] portable C */
+struct audio_build {
+	int (*init)(struct mtk_audio_mixer *mixer, u32 rate);
+	int (*add)(struct mtk_audio_mixer *mixer,
+		   struct mtk_audio_mix_input *input,
+		   const struct mtk_audio_mix_config *cfg);
+	void (*set_gain)(struct mtk_audio_mix_input *input, int16_t gain);
+	int (*render)(struct mtk_audio_mixer *mixer, int32_t *dst,
+		      u32 frames);
+};
+
+static const struct audio_build g_build[2] = {
+	{
+		mtk_os_hal_audio_mixer_init,
+		mtk_os_hal_audio_mixer_add,
+		mtk_os_hal_audio_mix_set_gain,
+		mtk_os_hal_audio_mixer_render,
+	},
+	{
+		c_mtk_os_hal_audio_mixer_init,
+		c_mtk_os_hal_audio_mixer_add,
+		c_mtk_os_hal_audio_mix_set_gain,
+		c_mtk_os_hal_audio_mixer_render,
+	},
+};
+
+/* one mixer input fed from g_a or g_b */
+struct audio_src {
+	const int16_t *data;
+	u32 rate;
+	u8 channels;
+	u32 blocks;
+};
+
+static struct mtk_audio_mixer g_mixer;
+static struct mtk_audio_mix_input g_input[AUDIO_MIX_INPUTS];
+static struct audio_src g_src[AUDIO_MIX_INPUTS];
+static int16_t g_coef[AUDIO_MIX_INPUTS][AUDIO_COEF_LEN];
+static int32_t g_mix[2][2 * AUDIO_MIX_FRAMES];
+
+/* xorshift, with full scale values mixed in to hit saturation */
+static int16_t _rand16(void)
+{
+	g_seed ^= g_seed << 13;
+	g_seed ^= g_seed >> 17;
+	g_seed ^= g_seed << 5;
+
+	switch (g_seed & 0x7) {
+	case 0:
+		return INT16_MIN;
+	case 1:
+		return INT16_MAX;
+	default:
+		return (int16_t)(g_seed >> 8);
+	}
+}
+
+static void _fill(void)
+{
+	u32 i;
+
+	for (i = 0; i < AUDIO_BUF_LEN; i++) {
+		g_a[i] = _rand16();
+		g_b[i] = _rand16();
+		g_slot[i] = ((int32_t)_rand16() << 16) | (u16)_rand16();
+	}
+	/* the tail past the kernel's count must stay as it is */
+	memset(g_out16, 0x5a, sizeof(g_out16));
+	memset(g_out32, 0x5a, sizeof(g_out32));
+}
+
+static void _check16(const char *name, u32 len, u32 off)
+{
+	if (memcmp(g_out16[0], g_out16[1], sizeof(g_out16[0])))
+		host_fail("%s: len %u, offset %u: SIMD and ref differ\n",
+			  name, len, off);
+}
+
+static void _check32(const char *name, u32 len, u32 off)
+{
+	if (memcmp(g_out32[0], g_out32[1], sizeof(g_out32[0])))
+		host_fail("%s: len %u, offset %u: SIMD and ref differ\n",
+			  name, len, off);
+}
+
+/* off 1 moves every buffer to a 2-byte boundary */
+static void _run_kernels(u32 len, u32 off)
+{
+	const int16_t *a = g_a + off, *b = g_b + off;
+	const int32_t *slot = g_slot + off;
+	int16_t *o16[2] = { g_out16[0] + off, g_out16[1] + off };
+	int32_t *o32[2] = { g_out32[0] + off, g_out32[1] + off };
+
+	_fill();
+	mtk_os_hal_audio_s16_to_s32(a, o32[0], len);
+	mtk_os_hal_audio_s16_to_s32_ref(a, o32[1], len);
+	_check32("s16_to_s32", len, off);
+
+	_fill();
+	mtk_os_hal_audio_s32_to_s16(slot, o16[0], len);
+	mtk_os_hal_audio_s32_to_s16_ref(slot, o16[1], len);
+	_check16("s32_to_s16", len, off);
+
+	_fill();
+	mtk_os_hal_audio_deinterleave_s16(a, o16[0], o16[0] + len, len);
+	mtk_os_hal_audio_deinterleave_s16_ref(a, o16[1], o16[1] + len, len);
+	_check16("deinterleave", len, off);
+
+	_fill();
+	mtk_os_hal_audio_interleave_s16(a, b, o16[0], len);
+	mtk_os_hal_audio_interleave_s16_ref(a, b, o16[1], len);
+	_check16("interleave", len, off);
+
+	_fill();
+	mtk_os_hal_audio_mix_s16(a, b, o16[0], len);
+	mtk_os_hal_audio_mix_s16_ref(a, b, o16[1], len);
+	_check16("mix", len, off);
+}
+
+static void test_kernels_bit_exact(void)
+{
+	u32 len, off;
+
+	for (off = 0; off < 2; off++) {
+		for (len = 0; len <= 9; len++)
+			_run_kernels(len, off);
+		_run_kernels(AUDIO_MAX_LEN - 1, off);
+		_run_kernels(AUDIO_MAX_LEN, off);
+	}
+}
+
+static void test_gain_bit_exact(void)
+{
+	static const int16_t gain[] = {
+		0, 1, -1, 16384, INT16_MAX, INT16_MIN, -12345,
+	};
+	u32 g, shift, off;
+
+	for (off = 0; off < 2; off++) {
+		for (g = 0; g < AUDIO_CNT(gain); g++) {
+			for (shift = 0; shift <= 16; shift++) {
+				_fill();
+				mtk_os_hal_audio_gain_s16(g_a + off,
+					g_out16[0] + off, AUDIO_MAX_LEN,
+					gain[g], shift);
+				mtk_os_hal_audio_gain_s16_ref(g_a + off,
+					g_out16[1] + off, AUDIO_MAX_LEN,
+					gain[g], shift);
+				_check16("gain", AUDIO_MAX_LEN, off);
+			}
+		}
+	}
+}
+
+static void test_mix_gain_bit_exact(void)
+{
+	static const int16_t gain[][2] = {
+		{ 16384, 16384 }, { INT16_MAX, INT16_MAX },
+		{ INT16_MIN, INT16_MIN }, { INT16_MAX, INT16_MIN },
+		{ 0, -1 }, { 1234, -30000 },
+	};
+	u32 g, off;
+
+	for (off = 0; off < 2; off++) {
+		for (g = 0; g < AUDIO_CNT(gain); g++) {
+			_fill();
+			mtk_os_hal_audio_mix_gain_s16(g_a + off, g_b + off,
+					g_out16[0] + off, AUDIO_MAX_LEN,
+					gain[g][0], gain[g][1]);
+			mtk_os_hal_audio_mix_gain_s16_ref(g_a + off, g_b + off,
+					g_out16[1] + off, AUDIO_MAX_LEN,
+					gain[g][0], gain[g][1]);
+			_check16("mix_gain", AUDIO_MAX_LEN, off);
+		}
+	}
+}
+
+/* the reference is what the header documents */
+static void test_ref_values(void)
+{
+	static const int16_t a[] = { INT16_MAX, INT16_MIN, 1000, -1 };
+	static const int16_t b[] = { 1, -1, -3000, -1 };
+	int16_t out[4];
+	int32_t slot[4];
+
+	mtk_os_hal_audio_mix_s16(a, b, out, 4);
+	CHECK_EQ(out[0], INT16_MAX);
+	CHECK_EQ(out[1], INT16_MIN);
+	CHECK_EQ(out[2], -2000);
+	CHECK_EQ(out[3], -2);
+
+	/* 0.5 << 2 is a gain of 2 */
+	mtk_os_hal_audio_gain_s16(a, out, 4, 16384, 2);
+	CHECK_EQ(out[0], INT16_MAX);
+	CHECK_EQ(out[1], INT16_MIN);
+	CHECK_EQ(out[2], 2000);
+	CHECK_EQ(out[3], -2);
+
+	/* the two -1.0 * -1.0 products wrap the accumulator, like SMLAD */
+	mtk_os_hal_audio_mix_gain_s16(&a[1], &a[1], out, 1, INT16_MIN,
+				      INT16_MIN);
+	CHECK_EQ(out[0], INT16_MIN);
+
+	mtk_os_hal_audio_s16_to_s32(a, slot, 4);
+	CHECK_EQ(slot[0], (int32_t)0x7fff0000);
+	CHECK_EQ(slot[1], (int32_t)0x80000000);
+	CHECK_EQ(slot[3], (int32_t)0xffff0000);
+	mtk_os_hal_audio_s32_to_s16(slot, out, 4);
+	CHECK(memcmp(out, a, sizeof(a)) == 0);
+}
+
+static u32 _pull(void *context, const int16_t **buf)
+{
+	struct audio_src *src = context;
+
+	if (src->blocks == AUDIO_BLOCKS)
+		return 0;
+	*buf = src->data + src->blocks++ * AUDIO_BLOCK * src->channels;
+
+	return AUDIO_BLOCK;
+}
+
+/* voice, a stereo tone and a bypassed input, rendered in uneven chunks
+ * with a gain change half way; return the inputs left active
+ */
+static int _run_mixer(const struct audio_build *b, int32_t *out,
+		      const struct mtk_audio_rs_quality *quality,
+		      int16_t gain)
+{
+	static const u32 chunk[] = { 1, 7, 64, 100, 333, 2 };
+	struct mtk_audio_mix_config cfg;
+	u32 i, n, done = 0;
+	int active = -1;
+
+	g_src[0] = (struct audio_src){ g_a, 16000, 1, 0 };
+	g_src[1] = (struct audio_src){ g_b, 44100, 2, 0 };
+	g_src[2] = (struct audio_src){ g_a + 1, AUDIO_MIX_RATE, 1, 0 };
+
+	CHECK_EQ(b->init(&g_mixer, AUDIO_MIX_RATE), 0);
+	for (i = 0; i < AUDIO_MIX_INPUTS; i++) {
+		memset(&cfg, 0, sizeof(cfg));
+		cfg.rate = g_src[i].rate;
+		cfg.channels = g_src[i].channels;
+		cfg.quality = *quality;
+		cfg.coef = g_src[i].rate == AUDIO_MIX_RATE ? NULL : g_coef[i];
+		cfg.gain = gain;
+		cfg.pull = _pull;
+		cfg.context = &g_src[i];
+		CHECK_EQ(b->add(&g_mixer, &g_input[i], &cfg), 0);
+	}
+
+	for (i = 0; done < AUDIO_MIX_FRAMES; i++) {
+		n = chunk[i % AUDIO_CNT(chunk)];
+		if (n > AUDIO_MIX_FRAMES - done)
+			n = AUDIO_MIX_FRAMES - done;
+		if (done < AUDIO_MIX_FRAMES / 2 &&
+		    done + n >= AUDIO_MIX_FRAMES / 2)
+			b->set_gain(&g_input[0], -gain);
+		active = b->render(&g_mixer, out + 2 * done, n);
+		done += n;
+	}
+
+	return active;
+}
+
+static void test_mixer_bit_exact(void)
+{
+	static const struct mtk_audio_rs_quality quality[] = {
+		MTK_AUDIO_RS_QUALITY_FAST,
+		MTK_AUDIO_RS_QUALITY_GOOD,
+		MTK_AUDIO_RS_QUALITY_BEST,
+		{ 4, 1, 0 },
+		{ MTK_AUDIO_RS_TAPS_MAX, MTK_AUDIO_RS_PHASES_MAX, 1 },
+	};
+	static const int16_t gain[] = { INT16_MAX, 16384, -20000 };
+	u32 q, g, i;
+	int nonzero;
+
+	for (q = 0; q < AUDIO_CNT(quality); q++) {
+		for (g = 0; g < AUDIO_CNT(gain); g++) {
+			_fill();
+			memset(g_mix, 0x5a, sizeof(g_mix));
+			/* every input drains to the end within the run */
+			CHECK_EQ(_run_mixer(&g_build[0], g_mix[0], &quality[q],
+					    gain[g]), 0);
+			CHECK_EQ(_run_mixer(&g_build[1], g_mix[1], &quality[q],
+					    gain[g]), 0);
+			if (memcmp(g_mix[0], g_mix[1], sizeof(g_mix[0])))
+				host_fail("mixer: taps %u, phases %u, gain %d: "
+					  "SIMD and C differ\n",
+					  quality[q].taps, quality[q].phases,
+					  gain[g]);
+
+			nonzero = 0;
+			for (i = 0; i < 2 * AUDIO_MIX_FRAMES; i++)
+				nonzero |= g_mix[0][i] != 0;
+			CHECK(nonzero);
+			/* all inputs have ended, the last frame is silence */
+			CHECK_EQ(g_mix[0][2 * AUDIO_MIX_FRAMES - 1], 0);
+		}
+	}
+}
+
+int main(void)
+{
+	HOST_RUN_TEST(test_kernels_bit_exact);
+	HOST_RUN_TEST(test_gain_bit_exact);
+	HOST_RUN_TEST(test_mix_gain_bit_exact);
+	HOST_RUN_TEST(test_ref_values);
+	HOST_RUN_TEST(test_mixer_bit_exact);
+
+	return host_failures != 0;
+}
@@ -0,0 +1,544 @@
+/*
+ * os_hal_i2c.c / mhal_i2c.c / hdl_i2c.c against the I2C and DMA register
+ * models, with the Accelerometer sample's lsm6dso driver on top.
+ */
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include "nvic.h"
+#include "os_hal_i2c.h"
+#include "host_model.h"
+#include "lsm6dso_driver.h"
+#include "lsm6dso_reg.h"
+
+/* bus, speed and address of the Accelerometer sample */
+#define I2C_BUS		OS_HAL_I2C_ISU2
+#define I2C_BASE	0x38090200
+#define I2C_CG_BASE	0x38090000
+#define I2C_SPEED	I2C_SCL_50kHz
+#define LSM_ADDR	(LSM6DSO_I2C_ADD_L >> 1)
+#define I2C_MAX_LEN	64
+
+static struct host_i2c g_i2c;
+/* main.c takes these from pvPortMalloc(), which is in SYSRAM too */
+static __attribute__((section(".sysram"))) u8 i2c_tx_buf[I2C_MAX_LEN];
+static __attribute__((section(".sysram"))) u8 i2c_rx_buf[I2C_MAX_LEN];
+
+/* the callbacks of the sample's main.c */
+static int32_t i2c_write(int *fD, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+	(void)fD;
+	if (buf == NULL || len > I2C_MAX_LEN - 1)
+		return -1;
+
+	i2c_tx_buf[0] = reg;
+	memcpy(&i2c_tx_buf[1], buf, len);
+	mtk_os_hal_i2c_write(I2C_BUS, LSM_ADDR, i2c_tx_buf, len + 1);
+	return 0;
+}
+
+static int32_t i2c_read(int *fD, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+	(void)fD;
+	if (buf == NULL || len > I2C_MAX_LEN)
+		return -1;
+
+	mtk_os_hal_i2c_write_read(I2C_BUS, LSM_ADDR, &reg, i2c_rx_buf, 1, len);
+	memcpy(buf, i2c_rx_buf, len);
+	return 0;
+}
+
+static int32_t i2c_burst_read(int *fD, uint8_t reg,
+			      const struct mtk_i2c_burst_seg *segs,
+			      uint32_t seg_cnt)
+{
+	(void)fD;
+	i2c_tx_buf[0] = reg;
+	return mtk_os_hal_i2c_burst_read(I2C_BUS, LSM_ADDR, i2c_tx_buf, 1,
+					 segs, seg_cnt);
+}
+
+/* SW_RESET of CTRL3_C clears itself once the reset is done */
+static void _lsm_write(struct host_i2c *c, u8 reg, u8 val)
+{
+	if (reg == LSM6DSO_CTRL3_C)
+		val &= ~0x01;
+	c->regs[reg] = val;
+}
+
+static void _setup(void)
+{
+	u32 i;
+
+	host_i2c_init(&g_i2c, "i2c2", I2C_BASE, I2C_CG_BASE,
+		      CM4_IRQ_ISU_G2_I2C, LSM_ADDR);
+	g_i2c.slave_write = _lsm_write;
+	host_dma_model_init();
+
+	for (i = 0; i < sizeof(g_i2c.regs); i++)
+		g_i2c.regs[i] = (u8)(i * 13 + 5);
+	g_i2c.regs[LSM6DSO_WHO_AM_I] = LSM6DSO_ID;
+	/* XLDA, GDA and TDA: new data of all three */
+	g_i2c.regs[LSM6DSO_STATUS_REG] = 0x07;
+
+	CHECK_EQ(mtk_os_hal_i2c_ctrl_init(I2C_BUS), 0);
+	CHECK_EQ(mtk_os_hal_i2c_speed_init(I2C_BUS, I2C_SPEED), 0);
+}
+
+static void _teardown(void)
+{
+	CHECK_EQ(mtk_os_hal_i2c_ctrl_deinit(I2C_BUS), 0);
+}
+
+static void test_burst_read_dma(void)
+{
+	/* on the stack, like the sample's segment destinations */
+	u8 reg = LSM6DSO_STATUS_REG;
+	u8 status = 0, temp[2], gyro[6], accel[6];
+	const struct mtk_i2c_burst_seg segs[] = {
+		{ &status, 1 },
+		{ NULL, 1 },
+		{ temp, 2 },
+		{ gyro, 6 },
+		{ accel, 6 },
+	};
+
+	_setup();
+
+	/* 16 bytes are more than the FIFO holds, both messages go by DMA */
+	CHECK_EQ(mtk_os_hal_i2c_burst_read(I2C_BUS, LSM_ADDR, &reg, 1, segs,
+					   5), 0);
+	CHECK_EQ(g_i2c.xfers, 1);
+	CHECK_EQ(host_dma_stats.bytes, 1 + 16);
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+	CHECK_EQ(status, 0x07);
+	CHECK(memcmp(temp, &g_i2c.regs[0x20], 2) == 0);
+	CHECK(memcmp(gyro, &g_i2c.regs[0x22], 6) == 0);
+	CHECK(memcmp(accel, &g_i2c.regs[0x28], 6) == 0);
+
+	/* a short burst stays in the FIFO */
+	CHECK_EQ(mtk_os_hal_i2c_burst_read(I2C_BUS, LSM_ADDR, &reg, 1, segs,
+					   1), 0);
+	CHECK_EQ(g_i2c.xfers, 2);
+	CHECK_EQ(host_dma_stats.bytes, 1 + 16);
+	CHECK_EQ(status, 0x07);
+
+	_teardown();
+}
+
+static void test_burst_read_limits(void)
+{
+	u8 wr[9] = { LSM6DSO_STATUS_REG };
+	u8 rd[33];
+	struct mtk_i2c_burst_seg seg = { rd, sizeof(rd) };
+
+	_setup();
+
+	CHECK_EQ(mtk_os_hal_i2c_burst_read(I2C_BUS, LSM_ADDR, wr, 1, &seg, 1),
+		 -I2C_EINVAL);
+	seg.len = 32;
+	CHECK_EQ(mtk_os_hal_i2c_burst_read(I2C_BUS, LSM_ADDR, wr, 9, &seg, 1),
+		 -I2C_EINVAL);
+	CHECK_EQ(mtk_os_hal_i2c_burst_read(I2C_BUS, LSM_ADDR, wr, 0, &seg, 1),
+		 -I2C_EINVAL);
+	CHECK_EQ(mtk_os_hal_i2c_burst_read(I2C_BUS, LSM_ADDR, wr, 1, &seg, 0),
+		 -I2C_EINVAL);
+	CHECK_EQ(g_i2c.xfers, 0);
+
+	/* the slave stores wr[1..7], the read goes on after them */
+	CHECK_EQ(mtk_os_hal_i2c_burst_read(I2C_BUS, LSM_ADDR, wr, 8, &seg, 1),
+		 0);
+	CHECK_EQ(g_i2c.regs[LSM6DSO_STATUS_REG], 0);
+	CHECK(memcmp(rd, &g_i2c.regs[LSM6DSO_STATUS_REG + 7], 32) == 0);
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+
+	_teardown();
+}
+
+/* lsm6dso_show_result() of the sample, per register group and burst */
+static void test_accelerometer_sample(void)
+{
+	u32 xfers[2];
+	u64 bus_ns[2], ns[2];
+	u64 t;
+	int burst;
+
+	_setup();
+
+	for (burst = 0; burst < 2; burst++) {
+		CHECK_EQ(lsm6dso_init(i2c_write, i2c_read,
+				      burst ? i2c_burst_read : NULL), 0);
+		/* without the callback there is no burst to read with */
+		if (!burst)
+			CHECK_EQ(lsm6dso_read_all(), -1);
+		xfers[burst] = g_i2c.xfers;
+		bus_ns[burst] = g_i2c.busy_ns;
+		t = host_now();
+
+		lsm6dso_show_result();
+
+		xfers[burst] = g_i2c.xfers - xfers[burst];
+		bus_ns[burst] = g_i2c.busy_ns - bus_ns[burst];
+		ns[burst] = host_now() - t;
+	}
+
+	printf("  per sample  xfers  bus us  total us\n");
+	printf("  per group   %5u  %6llu  %8llu\n", xfers[0],
+	       bus_ns[0] / 1000, ns[0] / 1000);
+	printf("  burst       %5u  %6llu  %8llu\n", xfers[1],
+	       bus_ns[1] / 1000, ns[1] / 1000);
+
+	CHECK_EQ(xfers[0], 6);
+	CHECK_EQ(xfers[1], 1);
+	CHECK(bus_ns[1] < bus_ns[0]);
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+
+	_teardown();
+}
+
+/* gives of one blocking write: the bus lock and the completion */
+static u64 _write_gives(void)
+{
+	static __attribute__((section(".sysram"))) u8 wr[2] = { 0x60, 0x5a };
+	u64 gives = host_stats.gives;
+
+	CHECK_EQ(mtk_os_hal_i2c_write(I2C_BUS, LSM_ADDR, wr, 2), 0);
+	return host_stats.gives - gives;
+}
+
+static void test_write_regs(void)
+{
+	/* the accelerometer and gyro setup of a sensor driver */
+	static const u8 regs[] = {
+		LSM6DSO_CTRL1_XL, 0x4a,
+		LSM6DSO_CTRL2_G, 0x4c,
+		LSM6DSO_INT1_CTRL, 0x03,
+		LSM6DSO_CTRL4_C, 0x04,
+		LSM6DSO_CTRL6_C, 0x10,
+	};
+	u64 gives, irqs, one;
+	u32 fail_idx, i;
+
+	_setup();
+	one = _write_gives();
+	CHECK_EQ(g_i2c.xfers, 1);
+
+	gives = host_stats.gives;
+	irqs = host_stats.irqs;
+	CHECK_EQ(mtk_os_hal_i2c_write_regs(I2C_BUS, LSM_ADDR, regs, 5,
+					   &fail_idx), 0);
+	CHECK_EQ(fail_idx, 5);
+	for (i = 0; i < 5; i++)
+		CHECK_EQ(g_i2c.regs[regs[i * 2]], regs[i * 2 + 1]);
+	CHECK_EQ(g_i2c.xfers, 1 + 5);
+	/* each pair is started from the irq of the one before it and the
+	 * caller is woken once, like for a single write
+	 */
+	CHECK_EQ(host_stats.irqs - irqs, 5);
+	CHECK_EQ(host_stats.gives - gives, one);
+
+	/* nobody at the address: the first pair fails */
+	CHECK_EQ(mtk_os_hal_i2c_write_regs(I2C_BUS, LSM_ADDR + 1, regs, 5,
+					   &fail_idx), -I2C_ENXIO);
+	CHECK_EQ(fail_idx, 0);
+	CHECK_EQ(g_i2c.xfers, 1 + 5 + 1);
+
+	CHECK_EQ(mtk_os_hal_i2c_write_regs(I2C_BUS, LSM_ADDR, NULL, 5,
+					   &fail_idx), -I2C_EINVAL);
+	CHECK_EQ(mtk_os_hal_i2c_write_regs(I2C_BUS, LSM_ADDR, regs, 0,
+					   &fail_idx), -I2C_EINVAL);
+
+	_teardown();
+}
+
+static void test_transfer_seq(void)
+{
+	static __attribute__((section(".sysram"))) u8 wr0[4] = { 0x40, 0xc1,
+								 0xc2, 0xc3 };
+	static __attribute__((section(".sysram"))) u8 reg1 = 0x40, rd1[16];
+	static __attribute__((section(".sysram"))) u8 wr2[12], rd3[4];
+	struct mtk_i2c_seq_msg seq[] = {
+		/* FIFO write */
+		{ LSM_ADDR, wr0, sizeof(wr0), NULL, 0 },
+		/* the read is too long for the FIFO, both messages go by DMA */
+		{ LSM_ADDR, &reg1, 1, rd1, sizeof(rd1) },
+		/* DMA write */
+		{ LSM_ADDR, wr2, sizeof(wr2), NULL, 0 },
+		/* FIFO read, on from where the write stopped */
+		{ LSM_ADDR, NULL, 0, rd3, sizeof(rd3) },
+	};
+	struct i2c_bus_stats stats[2];
+	u64 gives, one;
+	u32 fail_idx, i;
+
+	_setup();
+	for (i = 0; i < sizeof(wr2); i++)
+		wr2[i] = (u8)(0x50 + i * 3);
+	one = _write_gives();
+
+	gives = host_stats.gives;
+	CHECK_EQ(mtk_os_hal_i2c_transfer_seq(I2C_BUS, seq, 4, &fail_idx), 0);
+	CHECK_EQ(fail_idx, 4);
+	CHECK_EQ(g_i2c.xfers, 1 + 4);
+	CHECK_EQ(host_stats.gives - gives, one);
+	CHECK_EQ(host_dma_stats.bytes, 1 + sizeof(rd1) + sizeof(wr2));
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+	/* rd1 sees the write of record 0 */
+	CHECK(memcmp(rd1, &wr0[1], 3) == 0);
+	CHECK(memcmp(rd1 + 3, &g_i2c.regs[0x43], 13) == 0);
+	CHECK(memcmp(&g_i2c.regs[0x50], &wr2[1], 11) == 0);
+	CHECK(memcmp(rd3, &g_i2c.regs[0x5b], 4) == 0);
+
+	/* record 1 is NACKed: record 2 never runs */
+	CHECK_EQ(mtk_os_hal_i2c_get_stats(I2C_BUS, &stats[0]), 0);
+	memset(&g_i2c.regs[0x50], 0, 11);
+	seq[1].addr = LSM_ADDR + 1;
+	gives = host_stats.gives;
+	CHECK_EQ(mtk_os_hal_i2c_transfer_seq(I2C_BUS, seq, 4, &fail_idx),
+		 -I2C_ENXIO);
+	CHECK_EQ(fail_idx, 1);
+	CHECK_EQ(g_i2c.xfers, 1 + 4 + 2);
+	CHECK_EQ(host_stats.gives - gives, one);
+	CHECK_EQ(g_i2c.regs[0x50], 0);
+	CHECK_EQ(mtk_os_hal_i2c_get_stats(I2C_BUS, &stats[1]), 0);
+	CHECK_EQ(stats[1].nack_cnt - stats[0].nack_cnt, 1);
+
+	/* the bus is usable again after the failed record */
+	seq[1].addr = LSM_ADDR;
+	CHECK_EQ(mtk_os_hal_i2c_transfer_seq(I2C_BUS, seq, 4, &fail_idx), 0);
+	CHECK_EQ(fail_idx, 4);
+	CHECK(memcmp(&g_i2c.regs[0x50], &wr2[1], 11) == 0);
+
+	_teardown();
+}
+
+/* async completions in the order they came */
+#define ASYNC_MAX	64
+
+static struct {
+	u32 cnt;
+	void *ctx[ASYNC_MAX];
+	int status[ASYNC_MAX];
+	u8 in_irq[ASYNC_MAX];
+} g_done;
+
+/* submissions left for _async_resubmit */
+static u32 g_resubmit;
+
+static void _async_done(void *context, int status)
+{
+	if (g_done.cnt < ASYNC_MAX) {
+		g_done.ctx[g_done.cnt] = context;
+		g_done.status[g_done.cnt] = status;
+		g_done.in_irq[g_done.cnt] = __get_IPSR() != 0;
+	}
+	g_done.cnt++;
+}
+
+/* queue the request again from its own callback, like a polling loop */
+static void _async_resubmit(void *context, int status)
+{
+	struct mtk_i2c_request *req = context;
+
+	_async_done(context, status);
+	if (!g_resubmit)
+		return;
+	g_resubmit--;
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write_read(req->dev, req,
+			req->wr_buf, req->rd_buf, req->wr_len, req->rd_len,
+			_async_resubmit, req), 0);
+}
+
+static void test_async_queue_order(void)
+{
+	static __attribute__((section(".sysram"))) u8 wr0[3] = { 0x10, 0xa1,
+								 0xa2 };
+	static __attribute__((section(".sysram"))) u8 wr2[2] = { 0x30, 0xb3 };
+	static __attribute__((section(".sysram"))) u8 reg1 = 0x10, reg3 = 0x2e;
+	static __attribute__((section(".sysram"))) u8 rd1[2], rd3[4];
+	struct mtk_i2c_device dev;
+	struct mtk_i2c_request req[4];
+	struct i2c_bus_stats stats[2];
+	u32 i;
+
+	_setup();
+	memset(&g_done, 0, sizeof(g_done));
+	CHECK_EQ(mtk_os_hal_i2c_get_stats(I2C_BUS, &stats[0]), 0);
+	CHECK_EQ(mtk_os_hal_i2c_device_init(&dev, I2C_BUS, LSM_ADDR, 0, 10),
+		 0);
+
+	/* the read of 0x10 only sees the write if it runs after it */
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write(&dev, &req[0], wr0, 3,
+						   _async_done, &req[0]), 0);
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write_read(&dev, &req[1], &reg1,
+			rd1, 1, 2, _async_done, &req[1]), 0);
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write(&dev, &req[2], wr2, 2,
+						   _async_done, &req[2]), 0);
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write_read(&dev, &req[3], &reg3,
+			rd3, 1, 4, _async_done, &req[3]), 0);
+	CHECK_EQ(g_done.cnt, 0);
+
+	/* the irq starts each request when the one before it is done */
+	vTaskDelay(20);
+	CHECK_EQ(g_done.cnt, 4);
+	for (i = 0; i < 4; i++) {
+		CHECK(g_done.ctx[i] == &req[i]);
+		CHECK_EQ(g_done.status[i], 0);
+		CHECK_EQ(req[i].status, 0);
+		CHECK_EQ(g_done.in_irq[i], 1);
+	}
+	CHECK_EQ(rd1[0], 0xa1);
+	CHECK_EQ(rd1[1], 0xa2);
+	/* 0x2e..0x31, read after req[2] wrote 0x30 */
+	CHECK_EQ(rd3[0], (u8)(0x2e * 13 + 5));
+	CHECK_EQ(rd3[2], 0xb3);
+	CHECK_EQ(g_i2c.regs[0x30], 0xb3);
+	CHECK_EQ(g_i2c.xfers, 4);
+	CHECK_EQ(mtk_os_hal_i2c_get_stats(I2C_BUS, &stats[1]), 0);
+	CHECK_EQ(stats[1].xfer_cnt - stats[0].xfer_cnt, 4);
+
+	_teardown();
+}
+
+static void test_async_chain_from_callback(void)
+{
+	static __attribute__((section(".sysram"))) u8 reg = 0x28, rd[6];
+	struct mtk_i2c_device dev;
+	struct mtk_i2c_request req;
+	u32 i;
+
+	_setup();
+	memset(&g_done, 0, sizeof(g_done));
+	CHECK_EQ(mtk_os_hal_i2c_device_init(&dev, I2C_BUS, LSM_ADDR, 0, 10),
+		 0);
+
+	g_resubmit = 4;
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write_read(&dev, &req, &reg, rd,
+			1, 6, _async_resubmit, &req), 0);
+	vTaskDelay(20);
+
+	CHECK_EQ(g_resubmit, 0);
+	CHECK_EQ(g_done.cnt, 5);
+	for (i = 0; i < 5; i++) {
+		CHECK_EQ(g_done.status[i], 0);
+		CHECK_EQ(g_done.in_irq[i], 1);
+	}
+	CHECK(memcmp(rd, &g_i2c.regs[0x28], 6) == 0);
+	CHECK_EQ(g_i2c.xfers, 5);
+
+	_teardown();
+}
+
+/* a callback that always queues again must not lock out blocking calls */
+static void test_async_blocking_interleave(void)
+{
+	static __attribute__((section(".sysram"))) u8 reg = 0x28, rd[6];
+	static __attribute__((section(".sysram"))) u8 sreg = 0x20, srd[2];
+	struct mtk_i2c_device dev;
+	struct mtk_i2c_request req;
+
+	_setup();
+	memset(&g_done, 0, sizeof(g_done));
+	CHECK_EQ(mtk_os_hal_i2c_device_init(&dev, I2C_BUS, LSM_ADDR, 0, 10),
+		 0);
+
+	g_resubmit = 50;
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write_read(&dev, &req, &reg, rd,
+			1, 6, _async_resubmit, &req), 0);
+
+	/* waits for the request on the wire only, its resubmission waits */
+	CHECK_EQ(mtk_os_hal_i2c_write_read(I2C_BUS, LSM_ADDR, &sreg, srd, 1,
+					   2), 0);
+	CHECK_EQ(g_done.cnt, 1);
+	CHECK_EQ(g_resubmit, 49);
+	CHECK_EQ(g_i2c.xfers, 2);
+	CHECK(memcmp(srd, &g_i2c.regs[0x20], 2) == 0);
+
+	/* the unlock starts the held queue again */
+	vTaskDelay(100);
+	CHECK_EQ(g_resubmit, 0);
+	CHECK_EQ(g_done.cnt, 51);
+	CHECK_EQ(g_i2c.xfers, 52);
+
+	_teardown();
+}
+
+/* the slave holds SCL: a blocking call aborts the async request after
+ * the device timeout, and so does a recovery
+ */
+static void test_async_timeout(void)
+{
+	static __attribute__((section(".sysram"))) u8 reg = 0x28, rd[6];
+	static __attribute__((section(".sysram"))) u8 sreg = 0x20, srd[2];
+	struct mtk_i2c_device dev;
+	struct mtk_i2c_request req[2];
+	struct i2c_bus_stats stats[2];
+	u64 t;
+
+	_setup();
+	memset(&g_done, 0, sizeof(g_done));
+	CHECK_EQ(mtk_os_hal_i2c_get_stats(I2C_BUS, &stats[0]), 0);
+	CHECK_EQ(mtk_os_hal_i2c_device_init(&dev, I2C_BUS, LSM_ADDR, 0, 5),
+		 0);
+
+	/* stuck once it is on the wire */
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write_read(&dev, &req[0], &reg,
+			rd, 1, 6, _async_done, &req[0]), 0);
+	host_i2c_stall(&g_i2c, 1);
+	CHECK_EQ(mtk_os_hal_i2c_device_async_write_read(&dev, &req[1], &reg,
+			rd, 1, 6, _async_done, &req[1]), 0);
+
+	t = host_now();
+	CHECK_EQ(mtk_os_hal_i2c_write_read(I2C_BUS, LSM_ADDR, &sreg, srd, 1,
+					   2), 0);
+	CHECK(host_now() - t >= 5 * HOST_NS_PER_MS);
+	CHECK(host_now() - t < 10 * HOST_NS_PER_MS);
+	CHECK(memcmp(srd, &g_i2c.regs[0x20], 2) == 0);
+	CHECK_EQ(g_i2c.aborts, 1);
+	CHECK_EQ(g_done.cnt, 1);
+	CHECK(g_done.ctx[0] == &req[0]);
+	CHECK_EQ(g_done.status[0], -I2C_ETIMEDOUT);
+	CHECK_EQ(req[0].status, -I2C_ETIMEDOUT);
+	CHECK_EQ(mtk_os_hal_i2c_get_stats(I2C_BUS, &stats[1]), 0);
+	CHECK_EQ(stats[1].timeout_cnt - stats[0].timeout_cnt, 1);
+	CHECK_EQ(stats[1].xfer_cnt - stats[0].xfer_cnt, 2);
+
+	/* the request queued behind it still runs */
+	vTaskDelay(10);
+	CHECK_EQ(g_done.cnt, 2);
+	CHECK(g_done.ctx[1] == &req[1]);
+	CHECK_EQ(g_done.status[1], 0);
+	CHECK(memcmp(rd, &g_i2c.regs[0x28], 6) == 0);
+
+	/* a recovery does not wait forever either */
+	CHECK_EQ(mtk_os_hal_i2c_device_async_read(&dev, &req[0], rd, 6,
+						  _async_done, &req[0]), 0);
+	host_i2c_stall(&g_i2c, 1);
+	CHECK_EQ(mtk_os_hal_i2c_recover(I2C_BUS), 0);
+	CHECK_EQ(g_i2c.aborts, 2);
+	CHECK_EQ(g_done.cnt, 3);
+	CHECK_EQ(g_done.status[2], -I2C_ETIMEDOUT);
+	CHECK_EQ(mtk_os_hal_i2c_get_stats(I2C_BUS, &stats[1]), 0);
+	CHECK_EQ(stats[1].timeout_cnt - stats[0].timeout_cnt, 2);
+	CHECK_EQ(stats[1].recover_cnt - stats[0].recover_cnt, 1);
+	CHECK_EQ(mtk_os_hal_i2c_write_read(I2C_BUS, LSM_ADDR, &sreg, srd, 1,
+					   2), 0);
+
+	_teardown();
+}
+
+int main(void)
+{
+	HOST_RUN_TEST(test_burst_read_dma);
+	HOST_RUN_TEST(test_burst_read_limits);
+	HOST_RUN_TEST(test_accelerometer_sample);
+	HOST_RUN_TEST(test_write_regs);
+	HOST_RUN_TEST(test_transfer_seq);
+	HOST_RUN_TEST(test_async_queue_order);
+	HOST_RUN_TEST(test_async_chain_from_callback);
+	HOST_RUN_TEST(test_async_blocking_interleave);
+	HOST_RUN_TEST(test_async_timeout);
+
+	return host_failures != 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * os_hal_spim.c / mhal_spim.c / hdl_spim.c against the SPIM and DMA
+ * register models: transfers that time out are cut off on the wire and
+ * leave nothing behind for the transfers after them.
+ */
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "nvic.h"
+#include "os_hal_spim.h"
+#include "os_hal_dma.h"
+#include "host_model.h"
+
+#define SPIM_BUS	OS_HAL_SPIM_ISU1
+#define SPIM_BASE	0x38080300
+#define SPIM_CG_BASE	0x38080000
+#define SPIM_KHZ	10000
+#define SPIM_OPCODE	0x0b
+/* the slave holds the bus past the 1000 ms of mtk_os_hal_spim_transfer() */
+#define SPIM_STALL_NS	(1500 * HOST_NS_PER_MS)
+/* the RX DMA moves whole words */
+#define SPIM_BUF_LEN	36
+
+static struct host_spim g_spim;
+static __attribute__((section(".sysram"))) u8 g_rx_a[SPIM_BUF_LEN];
+static __attribute__((section(".sysram"))) u8 g_rx_b[SPIM_BUF_LEN];
+
+static struct mtk_spi_config g_config = {
+	.cpol = SPI_CPOL_0,
+	.cpha = SPI_CPHA_0,
+	.rx_mlsb = SPI_MSB,
+	.tx_mlsb = SPI_MSB,
+	.slave_sel = SPI_SELECT_DEVICE_0,
+};
+
+static void _setup(void)
+{
+	host_spim_init(&g_spim, "spim1", SPIM_BASE, SPIM_CG_BASE,
+		       CM4_IRQ_ISU_G1_SPIM);
+	host_dma_model_init();
+	CHECK_EQ(mtk_os_hal_spim_ctlr_init(SPIM_BUS), 0);
+}
+
+static void _read_xfer(struct mtk_spi_transfer *xfer, u8 *buf, u32 len,
+		       u32 use_dma)
+{
+	memset(xfer, 0, sizeof(*xfer));
+	xfer->rx_buf = buf;
+	xfer->len = len;
+	xfer->opcode = SPIM_OPCODE;
+	xfer->opcode_len = 1;
+	xfer->use_dma = use_dma;
+	xfer->speed_khz = SPIM_KHZ;
+}
+
+/* a read that completes in time returns what the slave sent */
+static void _check_read(u32 len, u32 use_dma)
+{
+	struct mtk_spi_transfer xfer;
+	u8 seed = g_spim.miso_seed;
+	u32 i;
+
+	memset(g_rx_b, 0, sizeof(g_rx_b));
+	_read_xfer(&xfer, g_rx_b, len, use_dma);
+	CHECK_EQ(mtk_os_hal_spim_transfer(SPIM_BUS, &g_config, &xfer), 0);
+	for (i = 0; i < len; i++)
+		CHECK_EQ(g_rx_b[i], (u8)(seed + i));
+}
+
+static void _timeout_then_recover(u32 len, u32 use_dma)
+{
+	static struct mtk_spi_transfer xfer;
+	u32 i, xfers;
+	u64 t;
+
+	_setup();
+
+	memset(g_rx_a, 0xee, sizeof(g_rx_a));
+	_read_xfer(&xfer, g_rx_a, len, use_dma);
+	g_spim.extra_ns = SPIM_STALL_NS;
+	t = host_now();
+	CHECK(mtk_os_hal_spim_transfer(SPIM_BUS, &g_config, &xfer) < 0);
+	CHECK(host_now() - t >= 1000 * HOST_NS_PER_MS);
+	CHECK(host_now() - t < SPIM_STALL_NS);
+	g_spim.extra_ns = 0;
+	CHECK_EQ(g_spim.aborts, 1);
+
+	/* the next transfer goes out at once and gets its own data */
+	xfers = g_spim.xfers;
+	_check_read(8, 0);
+	CHECK_EQ(g_spim.xfers, xfers + 1);
+
+	/* nothing of the cut off transfer shows up later */
+	host_run(SPIM_STALL_NS);
+	for (i = 0; i < sizeof(g_rx_a); i++)
+		CHECK_EQ(g_rx_a[i], 0xee);
+	CHECK_EQ(g_spim.xfers, xfers + 1);
+
+	_check_read(16, 1);
+	_check_read(8, 0);
+	CHECK_EQ(g_spim.xfers, xfers + 3);
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+
+	CHECK_EQ(mtk_os_hal_spim_ctlr_deinit(SPIM_BUS), 0);
+}
+
+static void test_read(void)
+{
+	_setup();
+
+	/* polled, by irq and by DMA */
+	_check_read(2, 0);
+	_check_read(8, 0);
+	_check_read(32, 1);
+	CHECK_EQ(g_spim.xfers, 3);
+	CHECK_EQ(g_spim.aborts, 0);
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+
+	CHECK_EQ(mtk_os_hal_spim_ctlr_deinit(SPIM_BUS), 0);
+}
+
+static void test_timeout_fifo(void)
+{
+	_timeout_then_recover(8, 0);
+}
+
+static void test_timeout_dma(void)
+{
+	_timeout_then_recover(16, 1);
+}
+
+int main(void)
+{
+	HOST_RUN_TEST(test_read);
+	HOST_RUN_TEST(test_timeout_fifo);
+	HOST_RUN_TEST(test_timeout_dma);
+
+	return host_failures != 0;
+}
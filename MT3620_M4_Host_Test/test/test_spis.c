@@ -0,0 +1,314 @@
+/*
+ * os_hal_spis.c against the SPIS M-HAL stub, with the SPI master running
+ * H2DMB transactions from the test.
+ */
+
+#include "FreeRTOS.h"
+#include "nvic.h"
+#include "os_hal_spis.h"
+#include "host_model.h"
+
+#define SPIS_BUS	OS_HAL_SPIS_ISU2
+#define SPIS_IRQ	CM4_IRQ_ISU_G2_SPIS
+#define FRAME		MTK_SPIS_FRAME_BYTES
+#define RING		MTK_SPIS_RING_FRAMES
+#define LOG_MAX		64
+
+static struct host_spis g_spis;
+
+/* the per-frame callbacks, in the order they were called */
+static struct {
+	u32 rx_cnt;
+	u8 rx[LOG_MAX][FRAME];
+	u32 rx_len[LOG_MAX];
+	u8 *rx_slot[LOG_MAX];
+	u32 tx_cnt;
+	u32 tx_len[LOG_MAX];
+	u32 not_in_irq;
+	/* frames tx_done queues, the counter goes in the first byte */
+	u32 refill;
+	u8 next;
+} g_log;
+
+static void _rx_done(void *context, u8 *frame, u32 len)
+{
+	CHECK(context == &g_log);
+	if (!__get_IPSR())
+		g_log.not_in_irq++;
+	if (g_log.rx_cnt < LOG_MAX) {
+		memcpy(g_log.rx[g_log.rx_cnt], frame, len);
+		g_log.rx_len[g_log.rx_cnt] = len;
+		g_log.rx_slot[g_log.rx_cnt] = frame;
+	}
+	g_log.rx_cnt++;
+}
+
+static void _tx_done(void *context, u32 len)
+{
+	u8 frame[8];
+
+	CHECK(context == &g_log);
+	if (!__get_IPSR())
+		g_log.not_in_irq++;
+	if (g_log.tx_cnt < LOG_MAX)
+		g_log.tx_len[g_log.tx_cnt] = len;
+	g_log.tx_cnt++;
+
+	/* queue the next reply from the irq */
+	if (g_log.refill) {
+		g_log.refill--;
+		memset(frame, 0, sizeof(frame));
+		frame[0] = g_log.next++;
+		CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, frame, sizeof(frame)),
+			 0);
+	}
+}
+
+static void _frame(u8 *buf, u32 len, u32 seed)
+{
+	u32 i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = (u8)(seed * 7 + i);
+}
+
+static void _setup(void)
+{
+	struct mtk_spis_config config = { SPIS_CPOL_0, SPIS_CPHA_0 };
+
+	host_spis_init(&g_spis, SPIS_IRQ, CM4_IRQ_M4DMA);
+	memset(&g_log, 0, sizeof(g_log));
+
+	CHECK_EQ(mtk_os_hal_spis_ctlr_init(SPIS_BUS, &config), 0);
+	CHECK_EQ(mtk_os_hal_spis_register_callback(SPIS_BUS, _rx_done,
+						   _tx_done, &g_log), 0);
+	CHECK_EQ(g_spis.clk_on, 1);
+	CHECK_EQ(g_spis.irq_on, 1);
+	CHECK_EQ(g_spis.dma_on, 1);
+}
+
+static void _teardown(void)
+{
+	CHECK_EQ(g_log.not_in_irq, 0);
+	CHECK_EQ(g_spis.dma_errors, 0);
+	CHECK_EQ(mtk_os_hal_spis_ctlr_deinit(SPIS_BUS), 0);
+	CHECK_EQ(g_spis.clk_on, 0);
+	CHECK_EQ(g_spis.dma_on, 0);
+}
+
+/* 3 rounds of 5 frames go around the 8-slot ring twice */
+static void test_rx_ring_wrap(void)
+{
+	u8 frame[FRAME], buf[FRAME];
+	u32 round, i, n = 0, len;
+
+	_setup();
+
+	for (round = 0; round < 3; round++) {
+		for (i = 0; i < 5; i++) {
+			len = 4 * (1 + (n + i) % 8);
+			_frame(frame, len, n + i);
+			/* odd frames by DMA, even ones by FIFO */
+			CHECK_EQ(host_spis_write(&g_spis, frame, len,
+						 (n + i) & 1), SPIS_DONE);
+		}
+		CHECK_EQ(g_log.rx_cnt, n + 5);
+
+		for (i = 0; i < 5; i++, n++) {
+			len = 4 * (1 + n % 8);
+			_frame(frame, len, n);
+			CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf,
+						      sizeof(buf)), len);
+			CHECK(memcmp(buf, frame, len) == 0);
+			CHECK_EQ(g_log.rx_len[n], len);
+			CHECK(memcmp(g_log.rx[n], frame, len) == 0);
+		}
+		CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf, sizeof(buf)), 0);
+	}
+	CHECK_EQ(g_spis.fifo_xfers, 8);
+	CHECK_EQ(g_spis.dma_xfers, 7);
+	/* the DMA wrote RING slots in turn, FRAME bytes apart */
+	for (n = 1; n < 15; n++)
+		CHECK(g_log.rx_slot[n] == g_log.rx_slot[0] +
+		      (n % RING) * FRAME);
+
+	/* a short buffer takes the start of the frame */
+	_frame(frame, FRAME, 99);
+	CHECK_EQ(host_spis_write(&g_spis, frame, FRAME, 1), SPIS_DONE);
+	CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf, 6), 6);
+	CHECK(memcmp(buf, frame, 6) == 0);
+	CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf, sizeof(buf)), 0);
+
+	_teardown();
+}
+
+/* host writes beyond the ring are answered and dropped */
+static void test_rx_full_drops(void)
+{
+	u8 frame[FRAME], buf[FRAME];
+	u32 i, overrun;
+
+	_setup();
+
+	for (i = 0; i < RING + 3; i++) {
+		_frame(frame, 16, i);
+		CHECK_EQ(host_spis_write(&g_spis, frame, 16, i & 1),
+			 SPIS_DONE);
+	}
+	CHECK_EQ(mtk_os_hal_spis_get_overrun(SPIS_BUS, &overrun), 0);
+	CHECK_EQ(overrun, 3);
+	/* no callback for the dropped ones */
+	CHECK_EQ(g_log.rx_cnt, RING);
+
+	/* the oldest frames are kept */
+	for (i = 0; i < RING; i++) {
+		_frame(frame, 16, i);
+		CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf, sizeof(buf)), 16);
+		CHECK(memcmp(buf, frame, 16) == 0);
+	}
+	CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf, sizeof(buf)), 0);
+
+	/* room again */
+	_frame(frame, 8, 42);
+	CHECK_EQ(host_spis_write(&g_spis, frame, 8, 0), SPIS_DONE);
+	CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf, sizeof(buf)), 8);
+	CHECK(memcmp(buf, frame, 8) == 0);
+	CHECK_EQ(mtk_os_hal_spis_get_overrun(SPIS_BUS, &overrun), 0);
+	CHECK_EQ(overrun, 3);
+
+	_teardown();
+}
+
+/* with nothing queued the host reads the pre-loaded reply */
+static void test_tx_response(void)
+{
+	static const u8 status[] = { 0x5a, 0x01, 0x02 };
+	u8 frame[FRAME], buf[FRAME];
+	u32 i;
+
+	_setup();
+
+	/* nothing loaded: zeros */
+	memset(buf, 0xff, sizeof(buf));
+	CHECK_EQ(host_spis_read(&g_spis, buf, 8, 0), SPIS_DONE);
+	for (i = 0; i < 8; i++)
+		CHECK_EQ(buf[i], 0);
+
+	CHECK_EQ(mtk_os_hal_spis_set_response(SPIS_BUS, status,
+					      sizeof(status)), 0);
+	for (i = 0; i < 3; i++) {
+		memset(buf, 0xff, sizeof(buf));
+		CHECK_EQ(host_spis_read(&g_spis, buf, 8, i & 1), SPIS_DONE);
+		CHECK(memcmp(buf, status, sizeof(status)) == 0);
+		CHECK_EQ(buf[3], 0);
+		CHECK_EQ(buf[7], 0);
+	}
+
+	/* queued frames go first, in order, then the reply again */
+	for (i = 0; i < 3; i++) {
+		_frame(frame, 12, i);
+		CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, frame, 12), 0);
+	}
+	for (i = 0; i < 3; i++) {
+		_frame(frame, 12, i);
+		CHECK_EQ(host_spis_read(&g_spis, buf, 12, i & 1), SPIS_DONE);
+		CHECK(memcmp(buf, frame, 12) == 0);
+	}
+	CHECK_EQ(host_spis_read(&g_spis, buf, 8, 0), SPIS_DONE);
+	CHECK(memcmp(buf, status, sizeof(status)) == 0);
+
+	/* the host reads 4 of 12 bytes, the rest of the frame is dropped */
+	_frame(frame, 12, 10);
+	CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, frame, 12), 0);
+	_frame(frame, 12, 11);
+	CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, frame, 12), 0);
+	CHECK_EQ(host_spis_read(&g_spis, buf, 4, 0), SPIS_DONE);
+	_frame(frame, 12, 10);
+	CHECK(memcmp(buf, frame, 4) == 0);
+	CHECK_EQ(host_spis_read(&g_spis, buf, 12, 0), SPIS_DONE);
+	_frame(frame, 12, 11);
+	CHECK(memcmp(buf, frame, 12) == 0);
+
+	/* the TX ring holds RING frames */
+	for (i = 0; i < RING; i++)
+		CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, frame, 4), 0);
+	CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, frame, 4), -EBUSY);
+	CHECK_EQ(host_spis_read(&g_spis, buf, 4, 0), SPIS_DONE);
+	CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, frame, 4), 0);
+
+	/* one tx_done per host read */
+	CHECK_EQ(g_log.tx_cnt, 1 + 3 + 3 + 1 + 2 + 1);
+	CHECK_EQ(g_log.tx_len[0], 8);
+	CHECK_EQ(g_log.tx_len[4], 12);
+	CHECK_EQ(g_log.tx_len[8], 4);
+	CHECK_EQ(g_log.rx_cnt, 0);
+
+	_teardown();
+}
+
+/* tx_done queues each reply from the irq, like a command/response link */
+static void test_tx_refill_from_callback(void)
+{
+	u8 first[4] = { 0 }, buf[8];
+	u32 i;
+
+	_setup();
+
+	g_log.next = 1;
+	g_log.refill = 9;
+	CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, first, sizeof(first)), 0);
+	for (i = 0; i < 10; i++) {
+		CHECK_EQ(host_spis_read(&g_spis, buf, 8, i & 1), SPIS_DONE);
+		CHECK_EQ(buf[0], i);
+	}
+	CHECK_EQ(g_log.tx_cnt, 10);
+	CHECK_EQ(g_log.refill, 0);
+
+	_teardown();
+}
+
+static void test_args(void)
+{
+	struct mtk_spis_config config = { SPIS_CPOL_0, SPIS_CPHA_0 };
+	u8 buf[FRAME + 1] = { 0 };
+	u32 overrun;
+
+	_setup();
+
+	CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, buf, 0), -ELENGTH);
+	CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, buf, FRAME + 1), -ELENGTH);
+	CHECK_EQ(mtk_os_hal_spis_write(SPIS_BUS, NULL, 4), -EPTR);
+	CHECK_EQ(mtk_os_hal_spis_set_response(SPIS_BUS, buf, FRAME + 1),
+		 -ELENGTH);
+	CHECK_EQ(mtk_os_hal_spis_set_response(SPIS_BUS, NULL, 4), -EPTR);
+	CHECK_EQ(mtk_os_hal_spis_set_response(SPIS_BUS, NULL, 0), 0);
+	CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, NULL, 4), -EPTR);
+	CHECK_EQ(mtk_os_hal_spis_read(OS_HAL_SPIS_ISU_MAX, buf, 4), -EPTR);
+	CHECK_EQ(mtk_os_hal_spis_ctlr_init(SPIS_BUS, NULL), -EPTR);
+	CHECK_EQ(mtk_os_hal_spis_get_overrun(OS_HAL_SPIS_ISU3, &overrun),
+		 -EPTR);
+
+	_teardown();
+
+	/* the bus is closed, the calls fail and the master gets no reply */
+	CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf, 4), -EPTR);
+	CHECK_EQ(host_spis_write(&g_spis, buf, 4, 0), SPIS_IDLE);
+	CHECK_EQ(mtk_os_hal_spis_ctlr_deinit(SPIS_BUS), -EPTR);
+
+	/* and it opens again */
+	CHECK_EQ(mtk_os_hal_spis_ctlr_init(SPIS_BUS, &config), 0);
+	CHECK_EQ(host_spis_write(&g_spis, buf, 4, 0), SPIS_DONE);
+	CHECK_EQ(mtk_os_hal_spis_read(SPIS_BUS, buf, FRAME), 4);
+	CHECK_EQ(mtk_os_hal_spis_ctlr_deinit(SPIS_BUS), 0);
+}
+
+int main(void)
+{
+	HOST_RUN_TEST(test_rx_ring_wrap);
+	HOST_RUN_TEST(test_rx_full_drops);
+	HOST_RUN_TEST(test_tx_response);
+	HOST_RUN_TEST(test_tx_refill_from_callback);
+	HOST_RUN_TEST(test_args);
+
+	return host_failures != 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * VFF DMA receive timeouts of os_hal_uart.c and os_hal_adc.c against the
+ * DMA model, with FIFO models in place of the UART and ADC data ports.
+ */
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "os_hal_uart.h"
+#include "os_hal_adc.h"
+#include "os_hal_dma.h"
+#include "host_model.h"
+
+/* ISU0 UART at 115200 8N1, one byte every 86.8 us */
+#define UART_PORT		OS_HAL_UART_ISU0
+#define UART_RBR		0x38070500
+#define UART_RX_CHN		VDMA_ISU0_RX_CH14
+#define UART_NS_PER_BYTE	86800
+/* 200 us of DMA bus cycles, a bit more than two byte times */
+#define UART_RX_TO		39520
+#define UART_WAIT_MS		100
+
+/* ADC channel 0 at 1 kHz, 4 bytes per sample */
+#define ADC_RBR			0x38000200
+#define ADC_NS_PER_SAMPLE	1000000
+#define ADC_VFIFO_LEN		16
+#define ADC_PERIOD		8
+/* 2 ms of DMA bus cycles */
+#define ADC_RX_TO		395200
+
+static struct host_fifo g_port;
+/* mhal_uart.c sets up the RX Virtual FIFO with 0x4000 bytes */
+static __attribute__((section(".sysram"))) u8 g_uart_rx[0x4000];
+static __attribute__((section(".sysram"))) u32 g_adc_buf[ADC_VFIFO_LEN];
+
+static void _uart_setup(void)
+{
+	host_fifo_init(&g_port, "uart0", UART_RBR, 1);
+	host_dma_model_init();
+	CHECK_EQ(mtk_os_hal_uart_ctlr_init(UART_PORT), 0);
+}
+
+static void test_uart_rx_timeout(void)
+{
+	static const u8 msg[] = "AT+GMR\r\n";
+	u32 len = sizeof(msg) - 1;
+	struct dma_vff_stats st;
+	u64 t;
+
+	_uart_setup();
+
+	/* without the timeout the short reply waits for the OS-HAL timeout */
+	CHECK_EQ(mtk_os_hal_uart_dma_set_rx_timeout(UART_PORT, 0), 0);
+	host_fifo_feed(&g_port, msg, len, UART_NS_PER_BYTE);
+	t = host_now();
+	CHECK_EQ(mtk_os_hal_uart_dma_get_data(UART_PORT, g_uart_rx, 64, true,
+					      UART_WAIT_MS), len);
+	CHECK(host_now() - t >= UART_WAIT_MS * HOST_NS_PER_MS);
+
+	/* with it the reply is back once the line went idle */
+	memset(g_uart_rx, 0, 64);
+	CHECK_EQ(mtk_os_hal_uart_dma_set_rx_timeout(UART_PORT, UART_RX_TO), 0);
+	host_fifo_feed(&g_port, msg, len, UART_NS_PER_BYTE);
+	t = host_now();
+	CHECK_EQ(mtk_os_hal_uart_dma_get_data(UART_PORT, g_uart_rx, 64, true,
+					      UART_WAIT_MS), len);
+	t = host_now() - t;
+	printf("  %u bytes back after %llu us\n", len, t / HOST_NS_PER_US);
+	CHECK(memcmp(g_uart_rx, msg, len) == 0);
+	CHECK(t >= len * UART_NS_PER_BYTE + 200 * HOST_NS_PER_US);
+	CHECK(t < len * UART_NS_PER_BYTE + 300 * HOST_NS_PER_US);
+	CHECK_EQ(mtk_os_hal_dma_get_vff_stats(UART_RX_CHN, &st), 0);
+	CHECK_EQ(st.timeout_cnt, 1);
+	CHECK_EQ(st.timeout_bytes, len);
+	CHECK_EQ(st.thrsh_cnt, 0);
+
+	/* a full buffer still completes on the threshold */
+	host_fifo_feed(&g_port, msg, len, UART_NS_PER_BYTE);
+	CHECK_EQ(mtk_os_hal_uart_dma_get_data(UART_PORT, g_uart_rx, 4, true,
+					      UART_WAIT_MS), 4);
+	CHECK(memcmp(g_uart_rx, msg, 4) == 0);
+	CHECK_EQ(mtk_os_hal_dma_get_vff_stats(UART_RX_CHN, &st), 0);
+	CHECK_EQ(st.thrsh_cnt, 1);
+	CHECK_EQ(st.timeout_cnt, 0);
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+
+	mtk_os_hal_uart_dma_set_rx_timeout(UART_PORT, 0);
+	CHECK_EQ(mtk_os_hal_uart_ctlr_deinit(UART_PORT), 0);
+}
+
+static u32 g_cb_off[8];
+static u32 g_cb_len[8];
+static u32 g_cb_cnt;
+
+static void _adc_rx_callback(void *data)
+{
+	(void)data;
+	if (g_cb_cnt < 8) {
+		mtk_os_hal_adc_get_rx_info(&g_cb_off[g_cb_cnt],
+					   &g_cb_len[g_cb_cnt]);
+		g_cb_cnt++;
+	}
+}
+
+static void _adc_feed(u32 first, u32 cnt)
+{
+	u32 samples[ADC_VFIFO_LEN];
+	u32 i;
+
+	for (i = 0; i < cnt; i++)
+		samples[i] = (first + i) << 4;
+	host_fifo_feed(&g_port, (u8 *)samples, cnt * 4, ADC_NS_PER_SAMPLE / 4);
+}
+
+static void test_adc_rx_timeout(void)
+{
+	struct adc_fsm_param param;
+	struct dma_vff_stats st;
+	u32 i;
+
+	host_fifo_init(&g_port, "adc", ADC_RBR, 4);
+	host_dma_model_init();
+	g_cb_cnt = 0;
+
+	memset(&param, 0, sizeof(param));
+	param.pmode = ADC_PMODE_PERIODIC;
+	param.channel_map = BIT(0);
+	param.sample_rate = 1000;
+	param.fifo_mode = ADC_FIFO_DMA;
+	param.ier_mode = ADC_FIFO_IER_RXFULL;
+	param.vfifo_addr = g_adc_buf;
+	param.vfifo_len = ADC_VFIFO_LEN;
+	param.rx_period_len = ADC_PERIOD;
+	param.rx_callback_func = _adc_rx_callback;
+
+	CHECK_EQ(mtk_os_hal_adc_ctlr_init(), 0);
+	CHECK_EQ(mtk_os_hal_adc_set_rx_timeout(ADC_RX_TO), 0);
+	CHECK_EQ(mtk_os_hal_adc_fsm_param_set(&param), 0);
+	CHECK_EQ(mtk_os_hal_adc_period_start(), 0);
+
+	/* a full period, then 3 samples the timeout hands over */
+	_adc_feed(0, 11);
+	host_run(20 * HOST_NS_PER_MS);
+	/* 7 more, the last ones wrap to the start of the Virtual FIFO */
+	_adc_feed(11, 7);
+	host_run(20 * HOST_NS_PER_MS);
+	/* and a full period again */
+	_adc_feed(18, 8);
+	host_run(20 * HOST_NS_PER_MS);
+
+	CHECK_EQ(g_cb_cnt, 4);
+	CHECK_EQ(g_cb_off[0], 0);
+	CHECK_EQ(g_cb_len[0], ADC_PERIOD);
+	CHECK_EQ(g_cb_off[1], 8);
+	CHECK_EQ(g_cb_len[1], 3);
+	CHECK_EQ(g_cb_off[2], 11);
+	CHECK_EQ(g_cb_len[2], 7);
+	CHECK_EQ(g_cb_off[3], 2);
+	CHECK_EQ(g_cb_len[3], ADC_PERIOD);
+	/* samples 16..25 sit at 0..9 */
+	for (i = 0; i < 10; i++)
+		CHECK_EQ(g_adc_buf[i], (16 + i) << 4);
+	for (i = 10; i < ADC_VFIFO_LEN; i++)
+		CHECK_EQ(g_adc_buf[i], i << 4);
+
+	CHECK_EQ(mtk_os_hal_dma_get_vff_stats(VDMA_ADC_RX_CH29, &st), 0);
+	CHECK_EQ(st.thrsh_cnt, 2);
+	CHECK_EQ(st.timeout_cnt, 2);
+	CHECK_EQ(st.timeout_bytes, (3 + 7) * 4);
+	CHECK_EQ(host_dma_stats.bus_errors, 0);
+
+	CHECK_EQ(mtk_os_hal_adc_period_stop(), 0);
+	mtk_os_hal_adc_set_rx_timeout(0);
+	CHECK_EQ(mtk_os_hal_adc_ctlr_deinit(), 0);
+}
+
+int main(void)
+{
+	HOST_RUN_TEST(test_uart_rx_timeout);
+	HOST_RUN_TEST(test_adc_rx_timeout);
+
+	return host_failures != 0;
+}
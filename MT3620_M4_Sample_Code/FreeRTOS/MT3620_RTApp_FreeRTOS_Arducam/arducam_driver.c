@@ -105,22 +105,24 @@ int arducam_i2c_write_reg(uint8_t reg_addr, uint8_t reg_data)
 
 int arducam_i2c_write_regs(const struct sensor_reg reglist[])
 {
-	uint8_t reg_addr = 0;
-	uint8_t reg_val = 0;
-	const struct sensor_reg *next = reglist;
+	uint32_t cnt = 0;
+	uint32_t fail_idx = 0;
+	int ret = 0;
 
 	if (reglist == NULL)
 		return -1;
 
-	reg_addr = next->reg;
-	reg_val = next->val;
-	while ((reg_addr != 0xff) | (reg_val != 0xff)) {
-		arducam_i2c_write_reg(reg_addr, reg_val);
-		next++;
-		reg_addr = next->reg;
-		reg_val = next->val;
-	}
-	return 0;
+	while ((reglist[cnt].reg != 0xff) | (reglist[cnt].val != 0xff))
+		cnt++;
+	if (cnt == 0)
+		return 0;
+
+	/* the whole table goes out back to back with one completion */
+	ret = mtk_os_hal_i2c_write_regs(i2c_master_port_num_arducam, i2c_arducam_write_addr,
+					(const uint8_t *)reglist, cnt, &fail_idx);
+	if (ret)
+		printf("OV2640 reg 0x%02x write fail at %ld\n", reglist[fail_idx].reg, (long)fail_idx);
+	return ret;
 }
 
 int arducam_spi_read_burst(uint8_t reg_addr, uint8_t len)
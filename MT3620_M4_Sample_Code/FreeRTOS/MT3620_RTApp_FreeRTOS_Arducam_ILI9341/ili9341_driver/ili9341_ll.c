@@ -388,29 +388,21 @@ int ili9341_ll_spi_tx(uint8_t *p_data, uint32_t tx_len)
 
 #elif defined(AzureSphere_CM4)
 	int ret = 0;
-	uint32_t transfer_len = 0;
-	uint32_t index = 0;
-
-	while (tx_len > 0) {
-		transfer_len = tx_len > SPI_MAX_BUF_SIZE ? SPI_MAX_BUF_SIZE : tx_len;
-		
-		memset(spim_tx_buf, 0, SPI_MAX_BUF_SIZE);
-		memcpy(spim_tx_buf, &p_data[index], transfer_len);
-		spim_xfer.tx_buf = &spim_tx_buf[1];
-		spim_xfer.rx_buf = NULL;
-		spim_xfer.opcode = spim_tx_buf[0];
-		spim_xfer.opcode_len = 1;
-		spim_xfer.len = transfer_len-1;
-
-		ret = mtk_os_hal_spim_transfer(spi_master_port_num_ili9341, &spi_default_config_ili9341, &spim_xfer);
-		if (ret) {
-			printf("mtk_os_hal_spim_transfer failed\n");
-			return ret;
-		}
+	struct mtk_spi_transfer stream_xfer;
 
-		tx_len -= transfer_len;
-		index += transfer_len;
-	}
+	if (tx_len == 0)
+		return 0;
+
+	/* one call for the whole buffer, segmented by the SPIM driver */
+	memset(&stream_xfer, 0, sizeof(stream_xfer));
+	stream_xfer.tx_buf = p_data;
+	stream_xfer.rx_buf = NULL;
+	stream_xfer.len = tx_len;
+	stream_xfer.speed_khz = spi_master_speed_khz_ili9341;
+
+	ret = mtk_os_hal_spim_stream_transfer(spi_master_port_num_ili9341, &spi_default_config_ili9341, &stream_xfer);
+	if (ret)
+		printf("mtk_os_hal_spim_stream_transfer failed\n");
 
 	return ret;
 #endif
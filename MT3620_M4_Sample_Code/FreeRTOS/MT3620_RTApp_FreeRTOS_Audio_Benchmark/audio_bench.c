@@ -0,0 +1,503 @@
+/*
+ * (C) 2005-2020 MediaTek Inc. All rights reserved.
+ *
+ * Copyright Statement:
+ *
+ * This MT3620 driver software/firmware and related documentation
+ * ("MediaTek Software") are protected under relevant copyright laws.
+ * The information contained herein is confidential and proprietary to
+ * MediaTek Inc. ("MediaTek"). You may only use, reproduce, modify, or
+ * distribute (as applicable) MediaTek Software if you have agreed to and been
+ * bound by this Statement and the applicable license agreement with MediaTek
+ * ("License Agreement") and been granted explicit permission to do so within
+ * the License Agreement ("Permitted User"). If you are not a Permitted User,
+ * please cease any access or use of MediaTek Software immediately.
+ *
+ * BY OPENING THIS FILE, RECEIVER HEREBY UNEQUIVOCALLY ACKNOWLEDGES AND AGREES
+ * THAT MEDIATEK SOFTWARE RECEIVED FROM MEDIATEK AND/OR ITS REPRESENTATIVES ARE
+ * PROVIDED TO RECEIVER ON AN "AS-IS" BASIS ONLY. MEDIATEK EXPRESSLY DISCLAIMS
+ * ANY AND ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE OR
+ * NONINFRINGEMENT. NEITHER DOES MEDIATEK PROVIDE ANY WARRANTY WHATSOEVER WITH
+ * RESPECT TO THE SOFTWARE OF ANY THIRD PARTY WHICH MAY BE USED BY,
+ * INCORPORATED IN, OR SUPPLIED WITH MEDIATEK SOFTWARE, AND RECEIVER AGREES TO
+ * LOOK ONLY TO SUCH THIRD PARTY FOR ANY WARRANTY CLAIM RELATING THERETO.
+ * RECEIVER EXPRESSLY ACKNOWLEDGES THAT IT IS RECEIVER'S SOLE RESPONSIBILITY TO
+ * OBTAIN FROM ANY THIRD PARTY ALL PROPER LICENSES CONTAINED IN MEDIATEK
+ * SOFTWARE. MEDIATEK SHALL ALSO NOT BE RESPONSIBLE FOR ANY MEDIATEK SOFTWARE
+ * RELEASES MADE TO RECEIVER'S SPECIFICATION OR TO CONFORM TO A PARTICULAR
+ * STANDARD OR OPEN FORUM. RECEIVER'S SOLE AND EXCLUSIVE REMEDY AND MEDIATEK'S
+ * ENTIRE AND CUMULATIVE LIABILITY WITH RESPECT TO MEDIATEK SOFTWARE RELEASED
+ * HEREUNDER WILL BE ANY SOFTWARE LICENSE FEES OR SERVICE CHARGE PAID BY
+ * RECEIVER TO MEDIATEK DURING THE PRECEDING TWELVE (12) MONTHS FOR SUCH
+ * MEDIATEK SOFTWARE AT ISSUE.
+ */
+
+#include "FreeRTOS.h"
+#include "printf.h"
+#include "mt3620.h"
+
+#include "os_hal_audio.h"
+#include "audio_bench.h"
+
+/****************************************************************************/
+/* Configurations */
+/****************************************************************************/
+/* stereo frames per call, one 4KB period of 32-bit I2S slots */
+#define BENCH_FRAMES 512
+#define BENCH_SAMPLES (BENCH_FRAMES * 2)
+/* calls averaged for each result */
+#define BENCH_ITERATIONS 20
+
+/* 0.5 and 2.0 in Q15 fraction and shift */
+#define BENCH_GAIN_A 16384
+#define BENCH_GAIN_B 16384
+#define BENCH_GAIN 16384
+#define BENCH_GAIN_SHIFT 2
+
+/* resampler test: two inputs mixed to 48 kHz, as voice and tone */
+#define RS_OUT_RATE 48000
+#define RS_VOICE_RATE 16000
+#define RS_TONE_RATE 44100
+/* tones with a whole number of periods at their rate and in RS_FRAMES */
+#define RS_VOICE_FREQ 1000
+#define RS_VOICE_PERIOD (RS_VOICE_RATE / RS_VOICE_FREQ)
+#define RS_TONE_FREQ 1050
+#define RS_TONE_PERIOD (RS_TONE_RATE / RS_TONE_FREQ)
+/* frames analyzed for THD+N, after RS_SETTLE frames */
+#define RS_FRAMES 960
+#define RS_CHUNK 480
+#define RS_SETTLE 480
+/* -1 dBFS */
+#define RS_AMPLITUDE 29204.0f
+/* each input at -6 dB in the load test */
+#define RS_MIX_GAIN 16384
+#define RS_QUALITY_MAX 3
+
+/****************************************************************************/
+/* Global Variables */
+/****************************************************************************/
+enum bench_kernel {
+	BENCH_S16_TO_S32,
+	BENCH_S32_TO_S16,
+	BENCH_DEINTERLEAVE,
+	BENCH_INTERLEAVE,
+	BENCH_GAIN_S16,
+	BENCH_MIX,
+	BENCH_MIX_GAIN,
+	BENCH_KERNEL_MAX,
+};
+
+static const char * const bench_name[BENCH_KERNEL_MAX] = {
+	"s16_to_s32",
+	"s32_to_s16",
+	"deinterleave",
+	"interleave",
+	"gain",
+	"mix",
+	"mix_gain",
+};
+
+static int16_t *pcm_a;
+static int16_t *pcm_b;
+static int32_t *slot_in;
+static int16_t *out16[2];
+static int32_t *out32[2];
+static uint32_t seed = 1;
+
+static const char * const rs_name[RS_QUALITY_MAX] = {
+	"fast",
+	"good",
+	"best",
+};
+
+static const struct mtk_audio_rs_quality rs_quality[RS_QUALITY_MAX] = {
+	MTK_AUDIO_RS_QUALITY_FAST,
+	MTK_AUDIO_RS_QUALITY_GOOD,
+	MTK_AUDIO_RS_QUALITY_BEST,
+};
+
+/* THD+N each preset has to reach on both inputs, in dB: a few dB of
+ * margin over what the filters give, fast is bound by its images
+ */
+static const float rs_limit[RS_QUALITY_MAX] = {
+	-45.0f,
+	-84.0f,
+	-84.0f,
+};
+
+static int16_t rs_voice[RS_VOICE_PERIOD];
+static int16_t rs_tone[RS_TONE_PERIOD];
+static int16_t rs_coef[2][MTK_AUDIO_RS_COEF_LEN(32, 128)];
+static struct mtk_audio_mixer rs_mixer;
+static struct mtk_audio_mix_input rs_input[2];
+
+/****************************************************************************/
+/* Functions */
+/****************************************************************************/
+/* xorshift, with full scale values mixed in to hit saturation */
+static int16_t bench_rand16(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	switch (seed & 0x7) {
+	case 0:
+		return INT16_MIN;
+	case 1:
+		return INT16_MAX;
+	default:
+		return (int16_t)(seed >> 8);
+	}
+}
+
+static void bench_fill(void)
+{
+	int i;
+
+	for (i = 0; i < BENCH_SAMPLES; i++) {
+		pcm_a[i] = bench_rand16();
+		pcm_b[i] = bench_rand16();
+		slot_in[i] = ((int32_t)bench_rand16() << 16) |
+			     (uint16_t)bench_rand16();
+	}
+}
+
+/* the libc math is not linked, these are plenty for a test signal */
+static float bench_sin(float x)
+{
+	float x2, term, sum;
+	int i;
+
+	while (x > 3.14159265f)
+		x -= 2 * 3.14159265f;
+	while (x < -3.14159265f)
+		x += 2 * 3.14159265f;
+
+	x2 = x * x;
+	term = x;
+	sum = x;
+	for (i = 2; i <= 16; i += 2) {
+		term *= -x2 / (float)(i * (i + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+/* 10 * log10(ratio) for 0 < ratio <= 1 */
+static float bench_db(double ratio)
+{
+	double z, z2, ln = 0;
+	float db = 0;
+	int i;
+
+	while (ratio < 0.5) {
+		ratio *= 2;
+		db -= 3.0103f;
+	}
+	z = (ratio - 1) / (ratio + 1);
+	z2 = z * z;
+	for (i = 1; i < 20; i += 2, z *= z2)
+		ln += 2 * z / i;
+
+	return db + (float)(ln * 4.3429448);
+}
+
+/* one period of each tone, looped by the pull callback */
+static u32 rs_pull(void *context, const int16_t **buf)
+{
+	*buf = context;
+
+	return context == rs_voice ? RS_VOICE_PERIOD : RS_TONE_PERIOD;
+}
+
+static void rs_fill(void)
+{
+	int i;
+
+	for (i = 0; i < RS_VOICE_PERIOD; i++)
+		rs_voice[i] = (int16_t)(RS_AMPLITUDE *
+			bench_sin(2 * 3.14159265f * i / RS_VOICE_PERIOD));
+	for (i = 0; i < RS_TONE_PERIOD; i++)
+		rs_tone[i] = (int16_t)(RS_AMPLITUDE *
+			bench_sin(2 * 3.14159265f * i / RS_TONE_PERIOD));
+}
+
+/* mixer with the voice, the tone or both (which = 0, 1, 2) */
+static int rs_setup(int quality, int which, int16_t gain)
+{
+	struct mtk_audio_mix_config cfg;
+	int i, ret;
+
+	mtk_os_hal_audio_mixer_init(&rs_mixer, RS_OUT_RATE);
+	for (i = 0; i < 2; i++) {
+		if (which != 2 && which != i)
+			continue;
+		memset(&cfg, 0, sizeof(cfg));
+		cfg.rate = i ? RS_TONE_RATE : RS_VOICE_RATE;
+		cfg.channels = 1;
+		cfg.quality = rs_quality[quality];
+		cfg.coef = rs_coef[i];
+		cfg.gain = gain;
+		cfg.pull = rs_pull;
+		cfg.context = i ? rs_tone : rs_voice;
+		ret = mtk_os_hal_audio_mixer_add(&rs_mixer, &rs_input[i], &cfg);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * THD+N in dB of one input: the sine at its known frequency and the DC
+ * are fitted over whole periods, everything else is distortion and
+ * noise, including the images the filter let through.
+ */
+static float rs_thdn(int quality, int which)
+{
+	uint32_t freq = which ? RS_TONE_FREQ : RS_VOICE_FREQ;
+	int16_t *y = out16[0];
+	double sum = 0, sum_sin = 0, sum_cos = 0, sig = 0, res = 0;
+	double a, b, dc, fit;
+	float phase;
+	int i, n;
+
+	if (rs_setup(quality, which, INT16_MAX))
+		return 0;
+	mtk_os_hal_audio_mixer_render(&rs_mixer, out32[0], RS_SETTLE);
+
+	for (n = 0; n < RS_FRAMES; n += RS_CHUNK) {
+		mtk_os_hal_audio_mixer_render(&rs_mixer, out32[0], RS_CHUNK);
+		for (i = 0; i < RS_CHUNK; i++)
+			y[n + i] = out32[0][2 * i] >> 16;
+	}
+
+	/* sin, cos and DC are orthogonal over whole periods */
+	for (i = 0; i < RS_FRAMES; i++) {
+		phase = 2 * 3.14159265f *
+			(freq * i % RS_OUT_RATE) / RS_OUT_RATE;
+		sum += y[i];
+		sum_sin += y[i] * (double)bench_sin(phase);
+		sum_cos += y[i] * (double)bench_sin(phase + 3.14159265f / 2);
+	}
+	a = 2 * sum_sin / RS_FRAMES;
+	b = 2 * sum_cos / RS_FRAMES;
+	dc = sum / RS_FRAMES;
+
+	/* sum the residual itself, the difference of the powers is too
+	 * coarse at -90 dB
+	 */
+	for (i = 0; i < RS_FRAMES; i++) {
+		phase = 2 * 3.14159265f *
+			(freq * i % RS_OUT_RATE) / RS_OUT_RATE;
+		fit = a * bench_sin(phase) +
+		      b * bench_sin(phase + 3.14159265f / 2);
+		sig += fit * fit;
+		res += (y[i] - fit - dc) * (y[i] - fit - dc);
+	}
+	if (res <= 0 || sig <= 0)
+		return -120.0f;
+
+	return bench_db(res / sig);
+}
+
+/* average CPU cycles per output frame of both inputs, times 100 */
+static uint32_t rs_cycles(int quality)
+{
+	uint32_t start;
+	int i;
+
+	if (rs_setup(quality, 2, RS_MIX_GAIN))
+		return 0;
+	mtk_os_hal_audio_mixer_render(&rs_mixer, out32[0], BENCH_FRAMES);
+
+	start = audio_bench_now();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+		mtk_os_hal_audio_mixer_render(&rs_mixer, out32[0],
+					      BENCH_FRAMES);
+
+	return (uint64_t)(audio_bench_now() - start) * 100 /
+	       ((uint64_t)BENCH_ITERATIONS * BENCH_FRAMES);
+}
+
+/* return the number of presets above their THD+N limit */
+static int rs_report(void)
+{
+	uint32_t cycles, load;
+	float voice, tone;
+	int quality, fail = 0;
+
+	printf("\nResampler + mixer, %d Hz voice and %d Hz tone to %d Hz\n",
+	       RS_VOICE_RATE, RS_TONE_RATE, RS_OUT_RATE);
+	printf("quality  thd+n voice  thd+n tone  cycles/frame  cpu\n");
+
+	for (quality = 0; quality < RS_QUALITY_MAX; quality++) {
+		cycles = rs_cycles(quality);
+		/* percent of the core at RS_OUT_RATE frames per second */
+		load = (uint64_t)cycles * RS_OUT_RATE * 100 /
+		       configCPU_CLOCK_HZ;
+		voice = rs_thdn(quality, 0);
+		tone = rs_thdn(quality, 1);
+		printf("%-8s %6.1f dB    %6.1f dB   %4lu.%02lu       "
+		       "%lu.%02lu%%\n",
+		       rs_name[quality], voice, tone,
+		       (unsigned long)(cycles / 100),
+		       (unsigned long)(cycles % 100),
+		       (unsigned long)(load / 100),
+		       (unsigned long)(load % 100));
+		if (voice > rs_limit[quality] || tone > rs_limit[quality]) {
+			printf("%s: THD+N above %.0f dB!\n",
+			       rs_name[quality], rs_limit[quality]);
+			fail++;
+		}
+	}
+
+	return fail;
+}
+
+/* run one kernel, ref selects the C reference; out is index 0 or 1 */
+static void bench_call(enum bench_kernel kernel, int ref, int out)
+{
+	int16_t *dst = out16[out];
+
+	switch (kernel) {
+	case BENCH_S16_TO_S32:
+		if (ref)
+			mtk_os_hal_audio_s16_to_s32_ref(pcm_a, out32[out],
+							BENCH_SAMPLES);
+		else
+			mtk_os_hal_audio_s16_to_s32(pcm_a, out32[out],
+						    BENCH_SAMPLES);
+		break;
+	case BENCH_S32_TO_S16:
+		if (ref)
+			mtk_os_hal_audio_s32_to_s16_ref(slot_in, dst,
+							BENCH_SAMPLES);
+		else
+			mtk_os_hal_audio_s32_to_s16(slot_in, dst,
+						    BENCH_SAMPLES);
+		break;
+	case BENCH_DEINTERLEAVE:
+		if (ref)
+			mtk_os_hal_audio_deinterleave_s16_ref(pcm_a, dst,
+					dst + BENCH_FRAMES, BENCH_FRAMES);
+		else
+			mtk_os_hal_audio_deinterleave_s16(pcm_a, dst,
+					dst + BENCH_FRAMES, BENCH_FRAMES);
+		break;
+	case BENCH_INTERLEAVE:
+		if (ref)
+			mtk_os_hal_audio_interleave_s16_ref(pcm_a,
+					pcm_a + BENCH_FRAMES, dst, BENCH_FRAMES);
+		else
+			mtk_os_hal_audio_interleave_s16(pcm_a,
+					pcm_a + BENCH_FRAMES, dst, BENCH_FRAMES);
+		break;
+	case BENCH_GAIN_S16:
+		if (ref)
+			mtk_os_hal_audio_gain_s16_ref(pcm_a, dst,
+					BENCH_SAMPLES, BENCH_GAIN,
+					BENCH_GAIN_SHIFT);
+		else
+			mtk_os_hal_audio_gain_s16(pcm_a, dst,
+					BENCH_SAMPLES, BENCH_GAIN,
+					BENCH_GAIN_SHIFT);
+		break;
+	case BENCH_MIX:
+		if (ref)
+			mtk_os_hal_audio_mix_s16_ref(pcm_a, pcm_b, dst,
+						     BENCH_SAMPLES);
+		else
+			mtk_os_hal_audio_mix_s16(pcm_a, pcm_b, dst,
+						 BENCH_SAMPLES);
+		break;
+	case BENCH_MIX_GAIN:
+		if (ref)
+			mtk_os_hal_audio_mix_gain_s16_ref(pcm_a, pcm_b, dst,
+					BENCH_SAMPLES, BENCH_GAIN_A,
+					BENCH_GAIN_B);
+		else
+			mtk_os_hal_audio_mix_gain_s16(pcm_a, pcm_b, dst,
+					BENCH_SAMPLES, BENCH_GAIN_A,
+					BENCH_GAIN_B);
+		break;
+	default:
+		break;
+	}
+}
+
+/* average CPU cycles per sample, times 100 */
+static uint32_t bench_cycles(enum bench_kernel kernel, int ref)
+{
+	uint32_t start;
+	int i;
+
+	start = audio_bench_now();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+		bench_call(kernel, ref, ref);
+
+	return (uint64_t)(audio_bench_now() - start) * 100 /
+	       ((uint64_t)BENCH_ITERATIONS * BENCH_SAMPLES);
+}
+
+/* the SIMD kernel has to match the reference bit for bit */
+static int bench_check(enum bench_kernel kernel)
+{
+	if (kernel == BENCH_S16_TO_S32)
+		return memcmp(out32[0], out32[1],
+			      BENCH_SAMPLES * sizeof(int32_t));
+
+	return memcmp(out16[0], out16[1], BENCH_SAMPLES * sizeof(int16_t));
+}
+
+int audio_bench_init(void)
+{
+	pcm_a = pvPortMalloc(BENCH_SAMPLES * sizeof(int16_t));
+	pcm_b = pvPortMalloc(BENCH_SAMPLES * sizeof(int16_t));
+	slot_in = pvPortMalloc(BENCH_SAMPLES * sizeof(int32_t));
+	out16[0] = pvPortMalloc(BENCH_SAMPLES * sizeof(int16_t));
+	out16[1] = pvPortMalloc(BENCH_SAMPLES * sizeof(int16_t));
+	out32[0] = pvPortMalloc(BENCH_SAMPLES * sizeof(int32_t));
+	out32[1] = pvPortMalloc(BENCH_SAMPLES * sizeof(int32_t));
+	if (!pcm_a || !pcm_b || !slot_in || !out16[0] || !out16[1] ||
+	    !out32[0] || !out32[1]) {
+		printf("audio buf malloc fail.\n");
+		return -1;
+	}
+
+	rs_fill();
+
+	return 0;
+}
+
+int audio_bench_run(void)
+{
+	uint32_t simd, ref;
+	int kernel, fail = 0;
+
+	printf("\nAudio benchmark, %d samples, CPU %lu Hz\n", BENCH_SAMPLES,
+	       (unsigned long)configCPU_CLOCK_HZ);
+	printf("kernel         simd     ref      (cycles per sample)\n");
+
+	bench_fill();
+	for (kernel = 0; kernel < BENCH_KERNEL_MAX; kernel++) {
+		simd = bench_cycles(kernel, 0);
+		ref = bench_cycles(kernel, 1);
+		printf("%-14s %3lu.%02lu   %3lu.%02lu\n",
+		       bench_name[kernel],
+		       (unsigned long)(simd / 100),
+		       (unsigned long)(simd % 100),
+		       (unsigned long)(ref / 100),
+		       (unsigned long)(ref % 100));
+		if (bench_check(kernel)) {
+			printf("%s: SIMD and reference differ!\n",
+			       bench_name[kernel]);
+			fail++;
+		}
+	}
+	printf("Bit-exact check: %s\n", fail ? "Failed!" : "Success.");
+
+	return fail + rs_report();
+}
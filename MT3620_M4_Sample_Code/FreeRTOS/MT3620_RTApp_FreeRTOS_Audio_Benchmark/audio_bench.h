@@ -0,0 +1,67 @@
+/*
+ * (C) 2005-2020 MediaTek Inc. All rights reserved.
+ *
+ * Copyright Statement:
+ *
+ * This MT3620 driver software/firmware and related documentation
+ * ("MediaTek Software") are protected under relevant copyright laws.
+ * The information contained herein is confidential and proprietary to
+ * MediaTek Inc. ("MediaTek"). You may only use, reproduce, modify, or
+ * distribute (as applicable) MediaTek Software if you have agreed to and been
+ * bound by this Statement and the applicable license agreement with MediaTek
+ * ("License Agreement") and been granted explicit permission to do so within
+ * the License Agreement ("Permitted User"). If you are not a Permitted User,
+ * please cease any access or use of MediaTek Software immediately.
+ *
+ * BY OPENING THIS FILE, RECEIVER HEREBY UNEQUIVOCALLY ACKNOWLEDGES AND AGREES
+ * THAT MEDIATEK SOFTWARE RECEIVED FROM MEDIATEK AND/OR ITS REPRESENTATIVES ARE
+ * PROVIDED TO RECEIVER ON AN "AS-IS" BASIS ONLY. MEDIATEK EXPRESSLY DISCLAIMS
+ * ANY AND ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE OR
+ * NONINFRINGEMENT. NEITHER DOES MEDIATEK PROVIDE ANY WARRANTY WHATSOEVER WITH
+ * RESPECT TO THE SOFTWARE OF ANY THIRD PARTY WHICH MAY BE USED BY,
+ * INCORPORATED IN, OR SUPPLIED WITH MEDIATEK SOFTWARE, AND RECEIVER AGREES TO
+ * LOOK ONLY TO SUCH THIRD PARTY FOR ANY WARRANTY CLAIM RELATING THERETO.
+ * RECEIVER EXPRESSLY ACKNOWLEDGES THAT IT IS RECEIVER'S SOLE RESPONSIBILITY TO
+ * OBTAIN FROM ANY THIRD PARTY ALL PROPER LICENSES CONTAINED IN MEDIATEK
+ * SOFTWARE. MEDIATEK SHALL ALSO NOT BE RESPONSIBLE FOR ANY MEDIATEK SOFTWARE
+ * RELEASES MADE TO RECEIVER'S SPECIFICATION OR TO CONFORM TO A PARTICULAR
+ * STANDARD OR OPEN FORUM. RECEIVER'S SOLE AND EXCLUSIVE REMEDY AND MEDIATEK'S
+ * ENTIRE AND CUMULATIVE LIABILITY WITH RESPECT TO MEDIATEK SOFTWARE RELEASED
+ * HEREUNDER WILL BE ANY SOFTWARE LICENSE FEES OR SERVICE CHARGE PAID BY
+ * RECEIVER TO MEDIATEK DURING THE PRECEDING TWELVE (12) MONTHS FOR SUCH
+ * MEDIATEK SOFTWARE AT ISSUE.
+ */
+
+#ifndef __AUDIO_BENCH_H__
+#define __AUDIO_BENCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os_hal_audio.h"
+
+/* Measures the audio kernels, the resampler and the mixer and prints the
+ * results. The same code runs in the RTApp and in the host build of
+ * MT3620_M4_Host_Test, where the DSP instructions are C functions.
+ * Return 0, or -1 if a buffer allocation failed.
+ */
+int audio_bench_init(void);
+/* one run of all benchmarks, return the number of failed checks: SIMD
+ * kernels that differ from their reference and presets above their
+ * THD+N limit
+ */
+int audio_bench_run(void);
+
+/* Provided by the application: a free running count of CPU cycles at
+ * configCPU_CLOCK_HZ. The RTApp reads the DWT cycle counter, the host
+ * build scales the process CPU time.
+ */
+uint32_t audio_bench_now(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUDIO_BENCH_H__ */
@@ -46,6 +46,8 @@
 
 static int lsm6dso_handle;
 static lsm6dso_ctx_t dev_ctx;
+static lsm6dso_burst_read_ptr burst_read;
+static lsm6dso_status_reg_t data_status;
 static axis3bit16_t data_raw_acceleration;
 static axis3bit16_t data_raw_angular_rate;
 static axis3bit16_t raw_angular_rate_calibration;
@@ -57,16 +59,51 @@ static float lsm6dsoTemperature_degC;
 /******************************************************************************/
 /* Functions */
 /******************************************************************************/
+/* Fetch STATUS_REG through OUTZ_H_A (0x1E~0x2D) in one transaction.
+ * The register address auto-increments (IF_INC is set after reset), so
+ * status, temperature, angular rate and acceleration come in one 16 byte
+ * read instead of six separate write-read transactions.
+ * Return -1 if lsm6dso_init() was given no burst read callback.
+ */
+int lsm6dso_read_all(void)
+{
+	const struct mtk_i2c_burst_seg segs[] = {
+		{ (uint8_t *)&data_status, 1 },
+		{ NULL, 1 },	/* 0x1F is reserved */
+		{ data_raw_temperature.u8bit, 2 },
+		{ data_raw_angular_rate.u8bit, 6 },
+		{ data_raw_acceleration.u8bit, 6 },
+	};
+
+	if (!burst_read)
+		return -1;
+
+	return burst_read(dev_ctx.handle, LSM6DSO_STATUS_REG, segs,
+			  sizeof(segs) / sizeof(segs[0]));
+}
+
 void lsm6dso_show_result(void)
 {
 	uint8_t reg;
 
+	if (burst_read) {
+		if (lsm6dso_read_all()) {
+			printf("[LSM6DSO] burst read fail\n");
+			return;
+		}
+	}
+
 	/* Read output only if new xl value is available */
-	lsm6dso_xl_flag_data_ready_get(&dev_ctx, &reg);
+	if (burst_read)
+		reg = data_status.xlda;
+	else
+		lsm6dso_xl_flag_data_ready_get(&dev_ctx, &reg);
 	if (reg) {
 		/* Read acceleration field data */
-		memset(data_raw_acceleration.u8bit, 0x00, 3 * sizeof(int16_t));
-		lsm6dso_acceleration_raw_get(&dev_ctx, data_raw_acceleration.u8bit);
+		if (!burst_read) {
+			memset(data_raw_acceleration.u8bit, 0x00, 3 * sizeof(int16_t));
+			lsm6dso_acceleration_raw_get(&dev_ctx, data_raw_acceleration.u8bit);
+		}
 
 		acceleration_mg[0] = lsm6dso_from_fs4_to_mg(data_raw_acceleration.i16bit[0]);
 		acceleration_mg[1] = lsm6dso_from_fs4_to_mg(data_raw_acceleration.i16bit[1]);
@@ -76,11 +113,16 @@ void lsm6dso_show_result(void)
 			acceleration_mg[0], acceleration_mg[1], acceleration_mg[2]);
 	}
 
-	lsm6dso_gy_flag_data_ready_get(&dev_ctx, &reg);
+	if (burst_read)
+		reg = data_status.gda;
+	else
+		lsm6dso_gy_flag_data_ready_get(&dev_ctx, &reg);
 	if (reg) {
 		/* Read angular rate field data */
-		memset(data_raw_angular_rate.u8bit, 0x00, 3 * sizeof(int16_t));
-		lsm6dso_angular_rate_raw_get(&dev_ctx, data_raw_angular_rate.u8bit);
+		if (!burst_read) {
+			memset(data_raw_angular_rate.u8bit, 0x00, 3 * sizeof(int16_t));
+			lsm6dso_angular_rate_raw_get(&dev_ctx, data_raw_angular_rate.u8bit);
+		}
 
 		/* Before we store the mdps values subtract the calibration data we captured at startup. */
 		angular_rate_dps[0] = (lsm6dso_from_fs2000_to_mdps(data_raw_angular_rate.i16bit[0] -
@@ -94,18 +136,23 @@ void lsm6dso_show_result(void)
 			angular_rate_dps[0], angular_rate_dps[1], angular_rate_dps[2]);
 	}
 
-	lsm6dso_temp_flag_data_ready_get(&dev_ctx, &reg);
+	if (burst_read)
+		reg = data_status.tda;
+	else
+		lsm6dso_temp_flag_data_ready_get(&dev_ctx, &reg);
 	if (reg) {
 		/* Read temperature data */
-		memset(data_raw_temperature.u8bit, 0x00, sizeof(int16_t));
-		lsm6dso_temperature_raw_get(&dev_ctx, data_raw_temperature.u8bit);
+		if (!burst_read) {
+			memset(data_raw_temperature.u8bit, 0x00, sizeof(int16_t));
+			lsm6dso_temperature_raw_get(&dev_ctx, data_raw_temperature.u8bit);
+		}
 		lsm6dsoTemperature_degC = lsm6dso_from_lsb_to_celsius(data_raw_temperature.i16bit);
 
 		printf("[LSM6DSO] Temperature  [degC]: %.2f\n", lsm6dsoTemperature_degC);
 	}
 }
 
-int lsm6dso_init(void *i2c_write, void *i2c_read)
+int lsm6dso_init(void *i2c_write, void *i2c_read, void *i2c_burst_read)
 {
 	uint8_t reg;
 
@@ -117,6 +164,8 @@ int lsm6dso_init(void *i2c_write, void *i2c_read)
 	dev_ctx.write_reg = i2c_write;
 	dev_ctx.read_reg = i2c_read;
 	dev_ctx.handle = &lsm6dso_handle;
+	/* optional, without it each register group is read separately */
+	burst_read = i2c_burst_read;
 
 	/* Check Device ID */
 	lsm6dso_device_id_get(&dev_ctx, &reg);
@@ -40,8 +40,16 @@
 extern "C" {
 #endif
 
+#include "os_hal_i2c.h"
+
+/* reads segs from reg on in one auto-increment transaction */
+typedef int32_t (*lsm6dso_burst_read_ptr)(int *handle, uint8_t reg,
+					  const struct mtk_i2c_burst_seg *segs,
+					  uint32_t seg_cnt);
+
 void lsm6dso_show_result(void);
-int lsm6dso_init(void *i2c_write, void *i2c_read);
+int lsm6dso_read_all(void);
+int lsm6dso_init(void *i2c_write, void *i2c_read, void *i2c_burst_read);
 
 #ifdef __cplusplus
 }
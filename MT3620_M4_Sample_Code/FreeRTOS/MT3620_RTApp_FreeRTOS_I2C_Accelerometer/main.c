@@ -115,6 +115,14 @@ int32_t i2c_read(int *fD, uint8_t reg, uint8_t *buf, uint16_t len)
 	return 0;
 }
 
+int32_t i2c_burst_read(int *fD, uint8_t reg,
+		       const struct mtk_i2c_burst_seg *segs, uint32_t seg_cnt)
+{
+	i2c_tx_buf[0] = reg;
+	return mtk_os_hal_i2c_burst_read(i2c_port_num, i2c_lsm6dso_addr,
+					 i2c_tx_buf, 1, segs, seg_cnt);
+}
+
 void i2c_enum(void)
 {
 	uint8_t i;
@@ -158,7 +166,7 @@ void i2c_task(void *pParameters)
 		return;
 
 	/* LSM6DSO Init */
-	if (lsm6dso_init(i2c_write, i2c_read))
+	if (lsm6dso_init(i2c_write, i2c_read, i2c_burst_read))
 		return;
 
 	while (1) {
@@ -84,18 +84,12 @@ void _putchar(char character)
 /******************************************************************************/
 /* Global Variables */
 /******************************************************************************/
-/* i2s_ignore_first_tx_callback: To skip the first tx callback */
-static unsigned char i2s_ignore_first_tx_callback;
 /* i2s_loopback_test_stop: To stop loopback test when error detected */
 static unsigned char i2s_loopback_test_stop;
 /* i2stxbuf: I2S Tx buffer */
 static unsigned int *i2stxbuf;
 /* i2srxbuf: I2S Rx buffer */
 static unsigned int *i2srxbuf;
-/* i2s_tx_index: (0~3) Next buffer slot to transmitted I2S data*/
-static unsigned int i2s_tx_index;
-/* i2s_rx_index: (0~3) Next buffer slot to receive I2S data */
-static unsigned int i2s_rx_index;
 /* i2s_tx_counter: (0~255), I2S Tx counter, accumulated when Tx callback */
 static unsigned char i2s_tx_counter;
 /* i2s_tx_counter: (0~255), I2S Rx counter, accumulated when Rx callback */
@@ -130,25 +124,17 @@ static audio_parameter audio_param_default = {
 static void i2s_tx_callback(void *data)
 {
 	/* Note! Don't try to do heavy job in this callback function */
-	/* In this sample code, Tx buffer managemene is handled in I2STask. */
-
-	if (i2s_ignore_first_tx_callback) {
-		i2s_ignore_first_tx_callback = 0;
-	} else {
-		i2s_tx_index++;
-		if (i2s_tx_index == 4)
-			i2s_tx_index = 0;
-	}
+	/* In this sample code, Tx periods are filled in I2STask with
+	 * mtk_os_hal_i2s_tx_acquire()/mtk_os_hal_i2s_tx_commit().
+	 */
 }
 
 static void i2s_rx_callback(void *data)
 {
 	/* Note! Don't try to do heavy job in this callback function */
-	/* In this sample code, Rx buffer managemene is handled in I2STask. */
-
-	i2s_rx_index++;
-	if (i2s_rx_index == 4)
-		i2s_rx_index = 0;
+	/* In this sample code, Rx periods are checked in I2STask with
+	 * mtk_os_hal_i2s_rx_acquire()/mtk_os_hal_i2s_rx_release().
+	 */
 }
 
 static void i2s_loopback_fill_tx_buffer(unsigned int *u4buf,
@@ -197,8 +183,7 @@ static int i2s_loopback_test(i2s_no i2s_port)
 	int result;
 	unsigned int *tx_buf = NULL;
 	unsigned int *rx_buf = NULL;
-	unsigned int i2s_tx_index_old;
-	unsigned int i2s_rx_index_old;
+	struct i2s_stream_stats stats;
 	static unsigned int i2s_test_counter;
 
 	i2s_test_counter++;
@@ -210,15 +195,11 @@ static int i2s_loopback_test(i2s_no i2s_port)
 
 	/* Initialize Rx buffer */
 	rx_buf = audio_param_default.rx_buffer_addr;
-	i2s_rx_index = 0;
-	i2s_rx_index_old = 0;
 	i2s_rx_counter = 0;
 	memset(rx_buf, 0, I2S_RX_BUFFER_LENGTH);
 
 	/* Initialize Tx buffer */
 	tx_buf = audio_param_default.tx_buffer_addr;
-	i2s_tx_index = 0;
-	i2s_tx_index_old = 0;
 	i2s_tx_counter = 0;
 	memset(tx_buf, 0, I2S_TX_BUFFER_LENGTH);
 
@@ -236,11 +217,11 @@ static int i2s_loopback_test(i2s_no i2s_port)
 	i2s_tx_counter++;
 
 	/* Configure I2S
-	 * Note! I2S Tx callback will be triggered for one time. No I2S data
-	 * will be transmitted before invoking mtk_os_hal_enable_i2s()
+	 * Note! The four periods filled above are the first ones to play.
+	 * No I2S data will be transmitted before invoking
+	 * mtk_os_hal_enable_i2s()
 	 */
 	i2s_loopback_test_stop = 0;
-	i2s_ignore_first_tx_callback = 1;
 	result = mtk_os_hal_config_i2s(i2s_port, &audio_param_default);
 	if (result) {
 		printf("mtk_os_hal_config_i2s fail : %x\n", result);
@@ -258,66 +239,22 @@ static int i2s_loopback_test(i2s_no i2s_port)
 	while (1) {
 		vTaskDelay(pdMS_TO_TICKS(1));
 
-		/* Fill Tx Buffer
-		 * i2s_tx_index = 0 means buf_offset 12KB ~ 16KB is transmitted.
-		 * i2s_tx_index = 1 means buf_offset 0~4KB is transmitted.
-		 * i2s_tx_index = 2 means buf_offset 4KB ~ 8KB is transmitted.
-		 * i2s_tx_index = 3 means buf_offset 8KB ~ 12KB is transmitted.
-		 */
-		if (i2s_tx_index != i2s_tx_index_old) {
-			if (i2s_tx_index == 0) {
-				tx_buf = audio_param_default.tx_buffer_addr +
-					((I2S_TX_BUFFER_PERIOD>>2)*3);
-			} else if (i2s_tx_index == 1) {
-				tx_buf = audio_param_default.tx_buffer_addr;
-			} else if (i2s_tx_index == 2) {
-				tx_buf = audio_param_default.tx_buffer_addr +
-					(I2S_TX_BUFFER_PERIOD>>2);
-			} else if (i2s_tx_index == 3) {
-				tx_buf = audio_param_default.tx_buffer_addr +
-					((I2S_TX_BUFFER_PERIOD >> 2) * 2);
-			} else {
-				printf("i2s_tx_index error! (%d)\n",
-					i2s_tx_index);
-				return -1;
-			}
+		/* Fill every Tx period the DMA has played, in place */
+		while (mtk_os_hal_i2s_tx_acquire(i2s_port, &tx_buf) > 0) {
 			i2s_loopback_fill_tx_buffer(tx_buf,
 						I2S_TX_BUFFER_PERIOD>>2,
 						i2s_tx_counter);
 			i2s_tx_counter++;
-			i2s_tx_index_old = i2s_tx_index;
+			mtk_os_hal_i2s_tx_commit(i2s_port);
 		}
 
-		/* Check Rx Buffer
-		 * i2s_rx_index = 1 means the rx data is in buf_offset 0~4KB.
-		 * i2s_rx_index = 2 means the rx data is in buf_offset 4~8KB.
-		 * i2s_rx_index = 3 means the rx data is in buf_offset 8~12KB.
-		 * i2s_rx_index = 0 means the rx data is in buf_offset 12~16KB.
-		 */
-		if (i2s_rx_index != i2s_rx_index_old) {
-			if (i2s_rx_index == 0) {
-				rx_buf = audio_param_default.rx_buffer_addr +
-						((I2S_RX_BUFFER_PERIOD>>2)*3);
-			} else if (i2s_rx_index == 1) {
-				rx_buf = audio_param_default.rx_buffer_addr;
-			} else if (i2s_rx_index == 2) {
-				rx_buf = audio_param_default.rx_buffer_addr +
-						(I2S_RX_BUFFER_PERIOD>>2);
-			} else if (i2s_rx_index == 3) {
-				rx_buf = audio_param_default.rx_buffer_addr +
-						((I2S_RX_BUFFER_PERIOD>>2)*2);
-			} else {
-				printf("i2s_rx_index error!\n");
-				return -1;
-			}
-
-			/* Check the received data */
+		/* Check every received Rx period, in place */
+		while (mtk_os_hal_i2s_rx_acquire(i2s_port, &rx_buf) > 0) {
 			i2s_loopback_check_rx_buffer(rx_buf,
 						I2S_RX_BUFFER_PERIOD>>2,
 						i2s_rx_counter);
 			i2s_rx_counter++;
-
-			i2s_rx_index_old = i2s_rx_index;
+			mtk_os_hal_i2s_rx_release(i2s_port);
 		}
 
 		/* Check test stop condition */
@@ -325,6 +262,10 @@ static int i2s_loopback_test(i2s_no i2s_port)
 			break;
 	}
 
+	mtk_os_hal_i2s_get_stats(i2s_port, &stats);
+	printf("[%d]Tx underrun: %d, Rx overrun: %d\n", i2s_test_counter,
+		stats.tx_underrun, stats.rx_overrun);
+
 	if (i2s_loopback_test_stop)
 		printf("[%d]I2S Loopback Test Result: Failed!\n",
 			i2s_test_counter);
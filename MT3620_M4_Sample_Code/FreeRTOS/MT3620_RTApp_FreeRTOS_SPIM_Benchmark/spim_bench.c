@@ -0,0 +1,325 @@
+/*
+ * (C) 2005-2020 MediaTek Inc. All rights reserved.
+ *
+ * Copyright Statement:
+ *
+ * This MT3620 driver software/firmware and related documentation
+ * ("MediaTek Software") are protected under relevant copyright laws.
+ * The information contained herein is confidential and proprietary to
+ * MediaTek Inc. ("MediaTek"). You may only use, reproduce, modify, or
+ * distribute (as applicable) MediaTek Software if you have agreed to and been
+ * bound by this Statement and the applicable license agreement with MediaTek
+ * ("License Agreement") and been granted explicit permission to do so within
+ * the License Agreement ("Permitted User"). If you are not a Permitted User,
+ * please cease any access or use of MediaTek Software immediately.
+ *
+ * BY OPENING THIS FILE, RECEIVER HEREBY UNEQUIVOCALLY ACKNOWLEDGES AND AGREES
+ * THAT MEDIATEK SOFTWARE RECEIVED FROM MEDIATEK AND/OR ITS REPRESENTATIVES ARE
+ * PROVIDED TO RECEIVER ON AN "AS-IS" BASIS ONLY. MEDIATEK EXPRESSLY DISCLAIMS
+ * ANY AND ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE OR
+ * NONINFRINGEMENT. NEITHER DOES MEDIATEK PROVIDE ANY WARRANTY WHATSOEVER WITH
+ * RESPECT TO THE SOFTWARE OF ANY THIRD PARTY WHICH MAY BE USED BY,
+ * INCORPORATED IN, OR SUPPLIED WITH MEDIATEK SOFTWARE, AND RECEIVER AGREES TO
+ * LOOK ONLY TO SUCH THIRD PARTY FOR ANY WARRANTY CLAIM RELATING THERETO.
+ * RECEIVER EXPRESSLY ACKNOWLEDGES THAT IT IS RECEIVER'S SOLE RESPONSIBILITY TO
+ * OBTAIN FROM ANY THIRD PARTY ALL PROPER LICENSES CONTAINED IN MEDIATEK
+ * SOFTWARE. MEDIATEK SHALL ALSO NOT BE RESPONSIBLE FOR ANY MEDIATEK SOFTWARE
+ * RELEASES MADE TO RECEIVER'S SPECIFICATION OR TO CONFORM TO A PARTICULAR
+ * STANDARD OR OPEN FORUM. RECEIVER'S SOLE AND EXCLUSIVE REMEDY AND MEDIATEK'S
+ * ENTIRE AND CUMULATIVE LIABILITY WITH RESPECT TO MEDIATEK SOFTWARE RELEASED
+ * HEREUNDER WILL BE ANY SOFTWARE LICENSE FEES OR SERVICE CHARGE PAID BY
+ * RECEIVER TO MEDIATEK DURING THE PRECEDING TWELVE (12) MONTHS FOR SUCH
+ * MEDIATEK SOFTWARE AT ISSUE.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "printf.h"
+#include "mt3620.h"
+
+#include "os_hal_spim.h"
+#include "spim_bench.h"
+
+/****************************************************************************/
+/* Configurations */
+/****************************************************************************/
+#define SPIM_CLOCK_POLARITY SPI_CPOL_0
+#define SPIM_CLOCK_PHASE SPI_CPHA_0
+#define SPIM_RX_MLSB SPI_MSB
+#define SPIM_TX_MSLB SPI_MSB
+#define SPIM_FULL_DUPLEX_MAX_LEN 16
+#define SPIM_HALF_DUPLEX_MAX_LEN 32
+
+/* transfers averaged for each result */
+#define BENCH_ITERATIONS 100
+/* messages queued back to back to measure the gap between transfers */
+#define BENCH_QUEUE_DEPTH 8
+/* bytes of the streaming write */
+#define BENCH_STREAM_LEN 4096
+
+/****************************************************************************/
+/* Global Variables */
+/****************************************************************************/
+static struct mtk_spi_config spi_default_config = {
+	.cpol = SPIM_CLOCK_POLARITY,
+	.cpha = SPIM_CLOCK_PHASE,
+	.rx_mlsb = SPIM_RX_MLSB,
+	.tx_mlsb = SPIM_TX_MSLB,
+	.slave_sel = SPI_SELECT_DEVICE_0,
+};
+static spim_num spi_master_port_num;
+static uint32_t spi_master_speed;
+static struct mtk_spi_device bench_dev;
+static uint8_t *spim_tx_buf;
+static uint8_t *spim_rx_buf;
+static uint8_t *spim_stream_buf;
+static volatile int g_async_done_flag;
+/* transfers that failed during the current run */
+static int g_bench_errors;
+
+static struct mtk_spi_transfer bench_xfer[BENCH_QUEUE_DEPTH];
+static struct mtk_spi_message bench_msg[BENCH_QUEUE_DEPTH];
+static volatile uint32_t bench_done_cycles[BENCH_QUEUE_DEPTH];
+static volatile int g_queue_done_cnt;
+
+/****************************************************************************/
+/* Functions */
+/****************************************************************************/
+static void bench_cycle_counter_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t bench_now(void)
+{
+	return DWT->CYCCNT;
+}
+
+/* CPU cycles the opcode and data bytes take on the wire */
+static uint32_t bench_wire_cycles(uint32_t bytes)
+{
+	return (uint64_t)bytes * 8 * (configCPU_CLOCK_HZ / 1000) /
+	       spi_master_speed;
+}
+
+static void bench_fill_xfer(struct mtk_spi_transfer *xfer, int use_dma,
+			    int length, int full_duplex)
+{
+	memset(xfer, 0, sizeof(*xfer));
+
+	xfer->tx_buf = spim_tx_buf;
+	xfer->rx_buf = full_duplex ? spim_rx_buf : NULL;
+	xfer->use_dma = use_dma;
+	xfer->speed_khz = spi_master_speed;
+	xfer->len = length;
+	xfer->opcode = 0x5a;
+	xfer->opcode_len = 1;
+}
+
+static int spi_xfer_complete(void *context)
+{
+	g_async_done_flag = 1;
+	return 0;
+}
+
+/* average CPU cycles of a blocking transfer, call to return */
+static uint32_t bench_sync(int use_dma, int length, int full_duplex)
+{
+	struct mtk_spi_transfer xfer;
+	uint32_t start;
+	int i;
+
+	bench_fill_xfer(&xfer, use_dma, length, full_duplex);
+
+	start = bench_now();
+	for (i = 0; i < BENCH_ITERATIONS; i++) {
+		if (mtk_os_hal_spim_transfer(spi_master_port_num,
+					     &spi_default_config, &xfer)) {
+			g_bench_errors++;
+			return 0;
+		}
+	}
+
+	return (bench_now() - start) / BENCH_ITERATIONS;
+}
+
+/* average CPU cycles of an async transfer, submit to completion */
+static uint32_t bench_async(int use_dma, int length, int full_duplex)
+{
+	struct mtk_spi_transfer xfer;
+	uint32_t start;
+	int i;
+
+	bench_fill_xfer(&xfer, use_dma, length, full_duplex);
+
+	start = bench_now();
+	for (i = 0; i < BENCH_ITERATIONS; i++) {
+		g_async_done_flag = 0;
+		if (mtk_os_hal_spim_async_transfer(spi_master_port_num,
+						   &spi_default_config, &xfer,
+						   spi_xfer_complete, NULL)) {
+			g_bench_errors++;
+			return 0;
+		}
+		while (g_async_done_flag == 0)
+			spim_bench_wait();
+	}
+
+	return (bench_now() - start) / BENCH_ITERATIONS;
+}
+
+static int spi_queue_complete(void *context)
+{
+	bench_done_cycles[(int)context] = bench_now();
+	g_queue_done_cnt++;
+	return 0;
+}
+
+/* average idle CPU cycles between the end of one queued transfer on the
+ * wire and the end of the next, i.e. completion period minus wire time
+ */
+static int32_t bench_gap(int use_dma, int length)
+{
+	uint32_t period;
+	int i;
+
+	g_queue_done_cnt = 0;
+	for (i = 0; i < BENCH_QUEUE_DEPTH; i++) {
+		bench_fill_xfer(&bench_xfer[i], use_dma, length, 1);
+		memset(&bench_msg[i], 0, sizeof(bench_msg[i]));
+		bench_msg[i].xfer = &bench_xfer[i];
+		bench_msg[i].complete = spi_queue_complete;
+		bench_msg[i].context = (void *)i;
+	}
+
+	for (i = 0; i < BENCH_QUEUE_DEPTH; i++) {
+		if (mtk_os_hal_spim_device_submit(&bench_dev, &bench_msg[i])) {
+			g_bench_errors++;
+			return 0;
+		}
+	}
+
+	while (g_queue_done_cnt < BENCH_QUEUE_DEPTH)
+		vTaskDelay(pdMS_TO_TICKS(1));
+
+	for (i = 0; i < BENCH_QUEUE_DEPTH; i++)
+		if (bench_msg[i].status)
+			g_bench_errors++;
+
+	period = (bench_done_cycles[BENCH_QUEUE_DEPTH - 1] -
+		  bench_done_cycles[0]) / (BENCH_QUEUE_DEPTH - 1);
+
+	return (int32_t)(period - bench_wire_cycles(1 + length));
+}
+
+static void bench_table(int full_duplex, int max_len)
+{
+	uint32_t first[4], last[4], cur[4];
+	int len, mode;
+
+	printf("\n%s, cycles per transfer:\n",
+	       full_duplex ? "full-duplex" : "tx only");
+	printf("len  wire    fifo    fifo_async  dma     dma_async\n");
+
+	for (len = 1; len <= max_len; len++) {
+		for (mode = 0; mode < 4; mode++) {
+			if (mode & 1)
+				cur[mode] = bench_async(mode >> 1, len,
+							full_duplex);
+			else
+				cur[mode] = bench_sync(mode >> 1, len,
+						       full_duplex);
+			if (len == 1)
+				first[mode] = cur[mode];
+			last[mode] = cur[mode];
+		}
+		printf("%-4d %-7lu %-7lu %-11lu %-7lu %lu\n", len,
+		       (unsigned long)bench_wire_cycles(1 + len),
+		       (unsigned long)cur[0], (unsigned long)cur[1],
+		       (unsigned long)cur[2], (unsigned long)cur[3]);
+	}
+
+	printf("per byte: wire %lu, fifo %lu, fifo_async %lu, dma %lu, dma_async %lu\n",
+	       (unsigned long)bench_wire_cycles(1),
+	       (unsigned long)((last[0] - first[0]) / (max_len - 1)),
+	       (unsigned long)((last[1] - first[1]) / (max_len - 1)),
+	       (unsigned long)((last[2] - first[2]) / (max_len - 1)),
+	       (unsigned long)((last[3] - first[3]) / (max_len - 1)));
+}
+
+static void bench_stream(void)
+{
+	struct mtk_spi_transfer xfer;
+	uint32_t cycles;
+
+	memset(&xfer, 0, sizeof(xfer));
+	xfer.tx_buf = spim_stream_buf;
+	xfer.use_dma = 1;
+	xfer.speed_khz = spi_master_speed;
+	xfer.len = BENCH_STREAM_LEN;
+
+	cycles = bench_now();
+	if (mtk_os_hal_spim_stream_transfer(spi_master_port_num,
+					    &spi_default_config, &xfer)) {
+		printf("mtk_os_hal_spim_stream_transfer fail\n");
+		g_bench_errors++;
+		return;
+	}
+	cycles = bench_now() - cycles;
+
+	printf("\nstreaming write of %d bytes: %lu cycles, wire %lu, %lu bytes/s\n",
+	       BENCH_STREAM_LEN, (unsigned long)cycles,
+	       (unsigned long)bench_wire_cycles(BENCH_STREAM_LEN),
+	       (unsigned long)((uint64_t)BENCH_STREAM_LEN *
+			       configCPU_CLOCK_HZ / cycles));
+}
+
+int spim_bench_init(spim_num bus_num, uint32_t speed_khz)
+{
+	spi_master_port_num = bus_num;
+	spi_master_speed = speed_khz;
+
+	spim_tx_buf = pvPortMalloc(SPIM_HALF_DUPLEX_MAX_LEN);
+	spim_rx_buf = pvPortMalloc(SPIM_HALF_DUPLEX_MAX_LEN);
+	spim_stream_buf = pvPortMalloc(BENCH_STREAM_LEN);
+	if (!spim_tx_buf || !spim_rx_buf || !spim_stream_buf) {
+		printf("spim buf malloc fail.\n");
+		return -1;
+	}
+	memset(spim_tx_buf, 0x11, SPIM_HALF_DUPLEX_MAX_LEN);
+	memset(spim_stream_buf, 0x22, BENCH_STREAM_LEN);
+
+	mtk_os_hal_spim_device_init(&bench_dev, bus_num,
+				    &spi_default_config, speed_khz);
+
+	bench_cycle_counter_init();
+
+	return 0;
+}
+
+int spim_bench_run(void)
+{
+	g_bench_errors = 0;
+
+	printf("\nSPIM benchmark at %lu kHz, CPU %lu Hz\n",
+	       (unsigned long)spi_master_speed,
+	       (unsigned long)configCPU_CLOCK_HZ);
+
+	bench_table(1, SPIM_FULL_DUPLEX_MAX_LEN);
+	bench_table(0, SPIM_HALF_DUPLEX_MAX_LEN);
+
+	printf("\ngap between queued transfers (cycles):\n");
+	printf("fifo 1B %ld, fifo 16B %ld, dma 1B %ld, dma 16B %ld\n",
+	       (long)bench_gap(0, 1), (long)bench_gap(0, 16),
+	       (long)bench_gap(1, 1), (long)bench_gap(1, 16));
+
+	bench_stream();
+
+	if (g_bench_errors)
+		printf("\n%d transfers failed\n", g_bench_errors);
+
+	return g_bench_errors;
+}
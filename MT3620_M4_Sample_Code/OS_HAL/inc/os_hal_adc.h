@@ -115,9 +115,19 @@
  *            - Call mtk_os_hal_adc_fsm_param_set(
  *            struct adc_fsm_param *adc_fsm_parameter)
  *
+ *        //Optional, hand the samples of an unfinished period to the
+ *        //callback when no sample came in for timeout_cnt DMA bus
+ *        //cycles, call it before mtk_os_hal_adc_fsm_param_set().
+ *        -Set the Virtual FIFO timeout.
+ *            - Call mtk_os_hal_adc_set_rx_timeout(u32 timeout_cnt)
+ *
  *        -Start the ADC module.
  *            - Call mtk_os_hal_adc_period_start(void)
  *
+ *        //In rx_callback_func, where in vfifo_addr the new samples are.
+ *        -Get the samples of the callback.
+ *            - Call mtk_os_hal_adc_get_rx_info(u32 *offset, u32 *len)
+ *
  *        //There is no need to continue sampling data, stop the ADC.
  *        -Stop the ADC module.
  *            - Call mtk_os_hal_adc_period_stop(void)
@@ -223,6 +233,37 @@ int mtk_os_hal_adc_period_start(void);
  */
 int mtk_os_hal_adc_period_stop(void);
 
+/**
+ * @brief  Set the Virtual FIFO timeout of period mode.\n
+ *	When no sample came in for timeout_cnt DMA bus clock cycles, the\n
+ *	samples received since the last callback are handed to\n
+ *	rx_callback_func without waiting for rx_period_len of them.\n
+ *	It applies from the next mtk_os_hal_adc_fsm_param_set() on.
+ *
+ *  @param [in] timeout_cnt : idle time in DMA bus clock cycles,\n
+ *	0 disables it (the default).
+ *
+ * @return
+ *	If return value is 0, it means success.\n
+ *	If return value is -#ADC_EPTR , it means ctlr is NULL.
+ */
+int mtk_os_hal_adc_set_rx_timeout(u32 timeout_cnt);
+
+/**
+ * @brief  Get the samples handed to the last rx_callback_func call.\n
+ *	Call it from rx_callback_func. There are rx_period_len samples,\n
+ *	or less after a Virtual FIFO timeout, they may wrap to the start\n
+ *	of vfifo_addr.
+ *
+ *  @param [out] offset : index of the first sample in vfifo_addr.
+ *  @param [out] len : number of samples.
+ *
+ * @return
+ *	If return value is 0, it means success.\n
+ *	If return value is -#ADC_EPTR , it means ctlr or a parameter is NULL.
+ */
+int mtk_os_hal_adc_get_rx_info(u32 *offset, u32 *len);
+
 #ifdef __cplusplus
 }
 #endif
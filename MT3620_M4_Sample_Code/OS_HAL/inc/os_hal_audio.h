@@ -0,0 +1,529 @@
+/*
+ * (C) 2005-2020 MediaTek Inc. All rights reserved.
+ *
+ * Copyright Statement:
+ *
+ * This MT3620 driver software/firmware and related documentation
+ * ("MediaTek Software") are protected under relevant copyright laws.
+ * The information contained herein is confidential and proprietary to
+ * MediaTek Inc. ("MediaTek"). You may only use, reproduce, modify, or
+ * distribute (as applicable) MediaTek Software if you have agreed to and been
+ * bound by this Statement and the applicable license agreement with MediaTek
+ * ("License Agreement") and been granted explicit permission to do so within
+ * the License Agreement ("Permitted User"). If you are not a Permitted User,
+ * please cease any access or use of MediaTek Software immediately.
+ *
+ * BY OPENING THIS FILE, RECEIVER HEREBY UNEQUIVOCALLY ACKNOWLEDGES AND AGREES
+ * THAT MEDIATEK SOFTWARE RECEIVED FROM MEDIATEK AND/OR ITS REPRESENTATIVES ARE
+ * PROVIDED TO RECEIVER ON AN "AS-IS" BASIS ONLY. MEDIATEK EXPRESSLY DISCLAIMS
+ * ANY AND ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE OR
+ * NONINFRINGEMENT. NEITHER DOES MEDIATEK PROVIDE ANY WARRANTY WHATSOEVER WITH
+ * RESPECT TO THE SOFTWARE OF ANY THIRD PARTY WHICH MAY BE USED BY,
+ * INCORPORATED IN, OR SUPPLIED WITH MEDIATEK SOFTWARE, AND RECEIVER AGREES TO
+ * LOOK ONLY TO SUCH THIRD PARTY FOR ANY WARRANTY CLAIM RELATING THERETO.
+ * RECEIVER EXPRESSLY ACKNOWLEDGES THAT IT IS RECEIVER'S SOLE RESPONSIBILITY TO
+ * OBTAIN FROM ANY THIRD PARTY ALL PROPER LICENSES CONTAINED IN MEDIATEK
+ * SOFTWARE. MEDIATEK SHALL ALSO NOT BE RESPONSIBLE FOR ANY MEDIATEK SOFTWARE
+ * RELEASES MADE TO RECEIVER'S SPECIFICATION OR TO CONFORM TO A PARTICULAR
+ * STANDARD OR OPEN FORUM. RECEIVER'S SOLE AND EXCLUSIVE REMEDY AND MEDIATEK'S
+ * ENTIRE AND CUMULATIVE LIABILITY WITH RESPECT TO MEDIATEK SOFTWARE RELEASED
+ * HEREUNDER WILL BE ANY SOFTWARE LICENSE FEES OR SERVICE CHARGE PAID BY
+ * RECEIVER TO MEDIATEK DURING THE PRECEDING TWELVE (12) MONTHS FOR SUCH
+ * MEDIATEK SOFTWARE AT ISSUE.
+ */
+
+
+#ifndef __OS_HAL_AUDIO_H__
+#define __OS_HAL_AUDIO_H__
+
+#include <stdint.h>
+#include "mhal_osai.h"
+
+/**
+ * @addtogroup OS-HAL
+ * @{
+ * @addtogroup audio
+ * @{
+ * This section introduces the audio sample kernels that go with the I2S
+ * driver: sample format conversion, interleaving, gain and mixing of
+ * 16-bit PCM, and a sample rate converter with an N-input mixer that
+ * renders several streams of any rate into one I2S TX period.
+ *
+ * @section OS_HAL_AUDIO_Terms_Chapter Terms and Acronyms
+ *
+ * |Terms                   |Details                             |
+ * |------------------------------|--|
+ * |\b PCM                        | Pulse Code Modulation.|
+ * |\b SIMD                       | Single Instruction, Multiple Data.|
+ * |\b Q15                        | Signed fixed point with 15 fraction bits.|
+ * |\b FIR                        | Finite Impulse Response filter.|
+ * |\b Polyphase                  | FIR split in sub-filters, one per fractional output position.|
+ *
+ * @section OS_HAL_AUDIO_Features_Chapter Supported Features
+ * - Each kernel has a SIMD version built on the Cortex-M4 DSP
+ *   instructions (__PKHBT, __PKHTB, __QADD16, __SMUAD, __SMLAD, __SSAT)
+ *   that works on two samples per step, and a portable C reference
+ *   version (*_ref) with the same results bit for bit.\n
+ *   The SIMD version is used when the compiler targets the DSP extension
+ *   (__ARM_FEATURE_DSP), or as set by MTK_AUDIO_SIMD.
+ * - The I2S 32-bit slot carries the 16-bit sample in its upper half.
+ * - Buffers need not be word aligned.
+ * - The resampler is a polyphase windowed-sinc FIR with Q15
+ *   coefficients, designed at init for any input and output rate.\n
+ *   Quality and CPU cost are set by the taps per phase, the number of
+ *   phases and the linear interpolation between phases, see
+ *   MTK_AUDIO_RS_QUALITY_FAST, MTK_AUDIO_RS_QUALITY_GOOD and
+ *   MTK_AUDIO_RS_QUALITY_BEST.
+ * - The mixer pulls each input through its own resampler, applies a Q15
+ *   gain, sums with saturation and writes stereo 32-bit slots straight
+ *   into the period from mtk_os_hal_i2s_tx_acquire().
+ * @}
+ * @}
+ */
+
+/**
+ * @addtogroup OS-HAL
+ * @{
+ * @addtogroup audio
+ * @{
+ * @section OS_HAL_AUDIO_Driver_Usage_Chapter How to use this driver
+ *
+ * - \b Device \b driver \b sample \b code \b is \b as \b follows: \n
+ *  - sample code (this is the user application sample code on freeRTos):
+ *    @code
+ *	- Convert an I2S RX period to 16-bit stereo and split the channels
+ *	 -Call mtk_os_hal_audio_s32_to_s16(rx, pcm, samples)
+ *	 -Call mtk_os_hal_audio_deinterleave_s16(pcm, left, right, frames)
+ *
+ *	- Process the channels
+ *	 -Call mtk_os_hal_audio_gain_s16(left, left, frames, gain, shift)
+ *	 -Call mtk_os_hal_audio_mix_s16(left, right, mono, frames)
+ *
+ *	- Build an I2S TX period
+ *	 -Call mtk_os_hal_audio_interleave_s16(left, right, pcm, frames)
+ *	 -Call mtk_os_hal_audio_s16_to_s32(pcm, tx, samples)
+ *
+ *	- Mix a 16 kHz voice prompt with a 44.1 kHz tone on a 48 kHz port
+ *	 -Call mtk_os_hal_audio_mixer_init(&mixer, 48000)
+ *	 -Call mtk_os_hal_audio_mixer_add(&mixer, &voice, &voice_cfg)
+ *	 -Call mtk_os_hal_audio_mixer_add(&mixer, &tone, &tone_cfg)
+ *	 -Loop:
+ *	  -Call mtk_os_hal_i2s_tx_acquire(i2s_no, &buf)
+ *	  -Call mtk_os_hal_audio_mixer_render(&mixer, buf, len / 2)
+ *	  -Call mtk_os_hal_i2s_tx_commit(i2s_no)
+ *
+ *	- Replay the prompt when its pull callback has ended it
+ *	 -Call mtk_os_hal_audio_mix_start(&voice)
+ *    @endcode
+ *
+ * @}
+ * @}
+ */
+
+/**
+* @addtogroup OS-HAL
+* @{
+* @addtogroup audio
+* @{
+*/
+
+/** @defgroup os_hal_audio_define Define
+  * @{
+  * This section defines the resampler limits and quality presets.
+  */
+
+/** Invalid parameter */
+#define AUDIO_EINVAL		1
+/** Too many mixer inputs */
+#define AUDIO_ENOSPC		2
+
+/** Most taps per phase; the history of each stream is 4 x this in bytes
+ *  per channel.
+ */
+#ifndef MTK_AUDIO_RS_TAPS_MAX
+#define MTK_AUDIO_RS_TAPS_MAX	32
+#endif
+/** Most phases */
+#define MTK_AUDIO_RS_PHASES_MAX	256
+/** Most inputs of one mixer */
+#ifndef MTK_AUDIO_MIX_INPUT_MAX
+#define MTK_AUDIO_MIX_INPUT_MAX	4
+#endif
+
+/** Coefficient storage in int16_t for taps and phases, the table keeps
+ *  one extra phase for the interpolation.
+ */
+#define MTK_AUDIO_RS_COEF_LEN(taps, phases)	((taps) * ((phases) + 1))
+
+/** 8 taps, 32 phases: lowest CPU, images of the input ~-40 dB. */
+#define MTK_AUDIO_RS_QUALITY_FAST	{ 8, 32, 0 }
+/** 16 taps, 64 phases, interpolated: voice and tones. */
+#define MTK_AUDIO_RS_QUALITY_GOOD	{ 16, 64, 1 }
+/** 32 taps, 128 phases, interpolated: music. */
+#define MTK_AUDIO_RS_QUALITY_BEST	{ 32, 128, 1 }
+
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_audio_typedef Typedef
+  * @{
+  * This section introduces the typedef used by the mixer.
+  */
+
+/** @brief	This defines the callback that feeds a mixer input.
+ *  @param [in] context : The context given in mtk_audio_mix_config.
+ *  @param [out] buf : Next block of 16-bit samples, L/R interleaved
+ *	for stereo. It must stay valid until the next call.
+ *  @return Number of frames in buf, 0 ends the stream.
+ */
+typedef u32 (*audio_mix_pull)(void *context, const int16_t **buf);
+
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_audio_struct Struct
+  * @{
+  * This section introduces the structures used by the resampler and
+  * the mixer.
+  */
+
+/** @brief	Resampler quality, usually one of the MTK_AUDIO_RS_QUALITY_*
+ *	presets.
+ */
+struct mtk_audio_rs_quality {
+	/** Taps per phase, even, 4 ~ MTK_AUDIO_RS_TAPS_MAX. Cost per
+	 *  output sample grows with taps.
+	 */
+	u16 taps;
+	/** Phases, power of two, 1 ~ MTK_AUDIO_RS_PHASES_MAX. Memory
+	 *  grows with phases, cost does not.
+	 */
+	u16 phases;
+	/** 1: interpolate between the two nearest phases, doubles the
+	 *  cost and removes the phase quantization noise.
+	 */
+	u8 interp;
+};
+
+/** @brief	Resampler state of one stream, fill it with
+ *	mtk_os_hal_audio_rs_init().
+ */
+struct mtk_audio_rs {
+	/** Coefficients, phases + 1 rows of taps */
+	int16_t *coef;
+	/** Input frames per output frame, integer part */
+	u32 step_int;
+	/** Input frames per output frame, fraction in 1 / 2^32 */
+	u32 step_frac;
+	/** Output position between two input frames, in 1 / 2^32 */
+	u32 frac;
+	/** Input frames to push before the next output frame */
+	u32 need;
+	/** Taps per phase */
+	u16 taps;
+	/** Oldest sample in hist */
+	u16 hidx;
+	/** log2 of the phase count */
+	u8 phase_bits;
+	/** Interpolate between phases */
+	u8 interp;
+	/** 1: mono, 2: stereo */
+	u8 channels;
+	/** Same rate in and out, no filtering */
+	u8 bypass;
+	/** History per channel, written twice so a window never wraps */
+	int16_t hist[2][2 * MTK_AUDIO_RS_TAPS_MAX];
+};
+
+/** @brief	Parameters of a mixer input. */
+struct mtk_audio_mix_config {
+	/** Input sample rate in Hz */
+	u32 rate;
+	/** 1: mono, played on both outputs, 2: stereo */
+	u8 channels;
+	/** Resampler quality, not used when rate is the mixer rate */
+	struct mtk_audio_rs_quality quality;
+	/** Coefficient storage of MTK_AUDIO_RS_COEF_LEN(taps, phases),
+	 *  may be NULL when rate is the mixer rate
+	 */
+	int16_t *coef;
+	/** Q15 gain, 32767 ~ 1.0 */
+	int16_t gain;
+	/** Feeds the input */
+	audio_mix_pull pull;
+	/** Passed to pull */
+	void *context;
+};
+
+/** @brief	Mixer input, owned by the caller and filled in by
+ *	mtk_os_hal_audio_mixer_add().
+ */
+struct mtk_audio_mix_input {
+	/** Resampler state */
+	struct mtk_audio_rs rs;
+	/** Feeds the input */
+	audio_mix_pull pull;
+	/** Passed to pull */
+	void *context;
+	/** Current input block */
+	const int16_t *buf;
+	/** Frames in buf */
+	u32 frames;
+	/** Next frame of buf */
+	u32 pos;
+	/** Q15 gain */
+	volatile int16_t gain;
+	/** Silent frames still to push after the end, to flush the FIR */
+	u16 drain;
+	/** 1: playing, 0: ended or not started */
+	volatile u8 active;
+};
+
+/** @brief	Mixer, fill it with mtk_os_hal_audio_mixer_init(). */
+struct mtk_audio_mixer {
+	/** Inputs */
+	struct mtk_audio_mix_input *inputs[MTK_AUDIO_MIX_INPUT_MAX];
+	/** Number of inputs */
+	u32 cnt;
+	/** Output sample rate in Hz */
+	u32 rate;
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_audio_function Function
+  * @{
+  * This section provides the audio kernels.\n
+  * Counts are in samples per channel. Gain and mix kernels may run in
+  * place (dst equal to a source), the others may not.
+  */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Expand 16-bit samples to I2S 32-bit slots.
+ * @brief  dst[i] = src[i] << 16
+ * @param [in] src : 16-bit samples.
+ * @param [out] dst : 32-bit slots.
+ * @param [in] cnt : Number of samples.
+ */
+void mtk_os_hal_audio_s16_to_s32(const int16_t *src, int32_t *dst, u32 cnt);
+
+/**
+ * @brief  Take the 16-bit samples from I2S 32-bit slots.
+ * @brief  dst[i] = src[i] >> 16, the low half is dropped.
+ * @param [in] src : 32-bit slots.
+ * @param [out] dst : 16-bit samples.
+ * @param [in] cnt : Number of samples.
+ */
+void mtk_os_hal_audio_s32_to_s16(const int32_t *src, int16_t *dst, u32 cnt);
+
+/**
+ * @brief  Split interleaved stereo into left and right.
+ * @param [in] src : L/R pairs, 2 * frames samples.
+ * @param [out] left : Left channel.
+ * @param [out] right : Right channel.
+ * @param [in] frames : Number of L/R pairs.
+ */
+void mtk_os_hal_audio_deinterleave_s16(const int16_t *src, int16_t *left,
+				       int16_t *right, u32 frames);
+
+/**
+ * @brief  Merge left and right into interleaved stereo.
+ * @param [in] left : Left channel.
+ * @param [in] right : Right channel.
+ * @param [out] dst : L/R pairs, 2 * frames samples.
+ * @param [in] frames : Number of L/R pairs.
+ */
+void mtk_os_hal_audio_interleave_s16(const int16_t *left,
+				     const int16_t *right, int16_t *dst,
+				     u32 frames);
+
+/**
+ * @brief  Scale samples with saturation.
+ * @brief  dst[i] = sat16((src[i] * gain) >> (15 - shift)), so the
+ *         gain is gain / 32768 * 2^shift.
+ * @param [in] src : 16-bit samples.
+ * @param [out] dst : 16-bit samples.
+ * @param [in] cnt : Number of samples.
+ * @param [in] gain : Q15 fraction.
+ * @param [in] shift : Left shift, 0 ~ 15.
+ */
+void mtk_os_hal_audio_gain_s16(const int16_t *src, int16_t *dst, u32 cnt,
+			       int16_t gain, u8 shift);
+
+/**
+ * @brief  Add two streams with saturation.
+ * @brief  dst[i] = sat16(a[i] + b[i])
+ * @param [in] a : 16-bit samples.
+ * @param [in] b : 16-bit samples.
+ * @param [out] dst : 16-bit samples.
+ * @param [in] cnt : Number of samples.
+ */
+void mtk_os_hal_audio_mix_s16(const int16_t *a, const int16_t *b,
+			      int16_t *dst, u32 cnt);
+
+/**
+ * @brief  Mix two streams with a Q15 gain each.
+ * @brief  dst[i] = sat16((a[i] * gain_a + b[i] * gain_b) >> 15).\n
+ *         The sum is 32 bits and wraps only if all four inputs are
+ *         -32768.
+ * @param [in] a : 16-bit samples.
+ * @param [in] b : 16-bit samples.
+ * @param [out] dst : 16-bit samples.
+ * @param [in] cnt : Number of samples.
+ * @param [in] gain_a : Q15 gain of a.
+ * @param [in] gain_b : Q15 gain of b.
+ */
+void mtk_os_hal_audio_mix_gain_s16(const int16_t *a, const int16_t *b,
+				   int16_t *dst, u32 cnt,
+				   int16_t gain_a, int16_t gain_b);
+
+/** @brief Portable C reference of mtk_os_hal_audio_s16_to_s32(). */
+void mtk_os_hal_audio_s16_to_s32_ref(const int16_t *src, int32_t *dst,
+				     u32 cnt);
+/** @brief Portable C reference of mtk_os_hal_audio_s32_to_s16(). */
+void mtk_os_hal_audio_s32_to_s16_ref(const int32_t *src, int16_t *dst,
+				     u32 cnt);
+/** @brief Portable C reference of mtk_os_hal_audio_deinterleave_s16(). */
+void mtk_os_hal_audio_deinterleave_s16_ref(const int16_t *src,
+					   int16_t *left, int16_t *right,
+					   u32 frames);
+/** @brief Portable C reference of mtk_os_hal_audio_interleave_s16(). */
+void mtk_os_hal_audio_interleave_s16_ref(const int16_t *left,
+					 const int16_t *right, int16_t *dst,
+					 u32 frames);
+/** @brief Portable C reference of mtk_os_hal_audio_gain_s16(). */
+void mtk_os_hal_audio_gain_s16_ref(const int16_t *src, int16_t *dst,
+				   u32 cnt, int16_t gain, u8 shift);
+/** @brief Portable C reference of mtk_os_hal_audio_mix_s16(). */
+void mtk_os_hal_audio_mix_s16_ref(const int16_t *a, const int16_t *b,
+				  int16_t *dst, u32 cnt);
+/** @brief Portable C reference of mtk_os_hal_audio_mix_gain_s16(). */
+void mtk_os_hal_audio_mix_gain_s16_ref(const int16_t *a, const int16_t *b,
+				       int16_t *dst, u32 cnt,
+				       int16_t gain_a, int16_t gain_b);
+
+/**
+ * @brief  Set up a resampler and design its filter.
+ * @brief  The cutoff follows the lower of the two rates, so the filter
+ *         removes the images when converting up and the aliases when
+ *         converting down. The design runs in floating point once, it
+ *         is not meant for the audio path.
+ * @param [out] rs : Resampler state.
+ * @param [in] in_rate : Input sample rate in Hz.
+ * @param [in] out_rate : Output sample rate in Hz.
+ * @param [in] channels : 1 or 2.
+ * @param [in] quality : Taps, phases and interpolation.
+ * @param [out] coef : MTK_AUDIO_RS_COEF_LEN(taps, phases) int16_t,
+ *	may be NULL when in_rate is out_rate.
+ * @return
+ * If return value is 0, the resampler is ready.\n
+ * If return value is -AUDIO_EINVAL, a parameter is out of range.
+ */
+int mtk_os_hal_audio_rs_init(struct mtk_audio_rs *rs, u32 in_rate,
+			     u32 out_rate, u8 channels,
+			     const struct mtk_audio_rs_quality *quality,
+			     int16_t *coef);
+
+/**
+ * @brief  Clear the history and position of a resampler, keeping its
+ *         filter, e.g. before replaying a stream.
+ * @param [in] rs : Resampler state.
+ */
+void mtk_os_hal_audio_rs_reset(struct mtk_audio_rs *rs);
+
+/**
+ * @brief  Set up an empty mixer.
+ * @param [out] mixer : Mixer.
+ * @param [in] rate : Output sample rate in Hz, normally the I2S
+ *	sample_rate.
+ * @return
+ * If return value is 0, the mixer is ready.\n
+ * If return value is -AUDIO_EINVAL, a parameter is invalid.
+ */
+int mtk_os_hal_audio_mixer_init(struct mtk_audio_mixer *mixer, u32 rate);
+
+/**
+ * @brief  Add an input to the mixer and start it.
+ * @brief  Inputs are added and removed from the task that renders.
+ * @param [in] mixer : Mixer.
+ * @param [out] input : Input state, must stay valid until removed.
+ * @param [in] cfg : Input parameters, may be freed on return.
+ * @return
+ * If return value is 0, the input plays from the next render.\n
+ * If return value is -AUDIO_EINVAL, a parameter is invalid.\n
+ * If return value is -AUDIO_ENOSPC, the mixer is full.
+ */
+int mtk_os_hal_audio_mixer_add(struct mtk_audio_mixer *mixer,
+			       struct mtk_audio_mix_input *input,
+			       const struct mtk_audio_mix_config *cfg);
+
+/**
+ * @brief  Remove an input from the mixer.
+ * @param [in] mixer : Mixer.
+ * @param [in] input : Input added before.
+ * @return
+ * If return value is 0, the input is removed.\n
+ * If return value is -AUDIO_EINVAL, the input is not in the mixer.
+ */
+int mtk_os_hal_audio_mixer_remove(struct mtk_audio_mixer *mixer,
+				  struct mtk_audio_mix_input *input);
+
+/**
+ * @brief  Restart an input that has ended.
+ * @brief  The resampler is reset and the input pulls again from the
+ *         next render.
+ * @param [in] input : Input in a mixer.
+ */
+void mtk_os_hal_audio_mix_start(struct mtk_audio_mix_input *input);
+
+/**
+ * @brief  Stop an input, it stays in the mixer and is skipped.
+ * @param [in] input : Input in a mixer.
+ */
+void mtk_os_hal_audio_mix_stop(struct mtk_audio_mix_input *input);
+
+/**
+ * @brief  Change the gain of an input, from any task.
+ * @param [in] input : Input in a mixer.
+ * @param [in] gain : Q15 gain, 32767 ~ 1.0.
+ */
+void mtk_os_hal_audio_mix_set_gain(struct mtk_audio_mix_input *input,
+				   int16_t gain);
+
+/**
+ * @brief  Render the active inputs into stereo I2S 32-bit slots.
+ * @brief  Each input is resampled to the mixer rate, scaled by its
+ *         gain and summed, the sum is saturated to 16 bits. With no
+ *         active input the frames are silence.
+ * @param [in] mixer : Mixer.
+ * @param [out] dst : L/R 32-bit slots, 2 * frames words, e.g. the
+ *	period from mtk_os_hal_i2s_tx_acquire().
+ * @param [in] frames : Number of L/R frames.
+ * @return Number of active inputs after the render.
+ */
+int mtk_os_hal_audio_mixer_render(struct mtk_audio_mixer *mixer,
+				  int32_t *dst, u32 frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+  * @}
+  */
+
+/**
+* @}
+* @}
+*/
+
+#endif  /*__OS_HAL_AUDIO_H__*/
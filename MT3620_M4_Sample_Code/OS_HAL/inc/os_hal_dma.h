@@ -76,10 +76,17 @@
  *	 -Call mtk_os_hal_dma_alloc_chan(enum dma_channel chn)
  *	   to allocate one DMA channel.
  *
+ *	- Or lease one DMA channel to keep it across transfers
+ *	 -Call mtk_os_hal_dma_lease_chan(enum dma_channel chn)
+ *
  *	- Config one DMA channel
  *	  -Call mtk_os_hal_dma_config(enum dma_channel chn,
 				struct dma_setting *setting)
  *
+ *	- Re-arm a configured channel with new addresses and count
+ *	  -Call mtk_os_hal_dma_rearm(enum dma_channel chn,
+				u32 src_addr, u32 dst_addr, u32 count)
+ *
  *	- Start one DMA channel
  *	 -Call mtk_os_hal_dma_start(enum dma_channel chn)
  *
@@ -126,6 +133,26 @@
  *	- Clear dreq signal of DMA channel
  *	 - Call  mtk_os_hal_dma_clr_dreq(enum dma_channel chn)
  *
+ *	- Flush partial VFF data after an idle time
+ *	 - Call  mtk_os_hal_dma_set_param(enum dma_channel chn,
+				OS_HAL_DMA_PARAM_VFF_TIMEOUT, u32 timeout_cnt)
+ *	 - Register a DMA_INT_VFIFO_TIMEOUT callback which reads
+ *	   OS_HAL_DMA_PARAM_VFF_FIFO_CNT bytes
+ *	 - Call  mtk_os_hal_dma_get_vff_stats(enum dma_channel chn,
+				struct dma_vff_stats *stats)
+ *
+ *	- Read DMA transfer statistics (build with MTK_DMA_TRACE_ENABLE=1)
+ *	 - Call  mtk_os_hal_dma_get_stats(enum dma_channel chn,
+				struct dma_chan_stats *stats)
+ *	 - Call  mtk_os_hal_dma_get_trace(struct dma_trace_record *records,
+				u32 max_records)
+ *	 - Call  mtk_os_hal_dma_dump_stats(void) to print them by printf
+ *
+ *	- Get a DMA-safe SYSRAM buffer (build with MTK_DMA_POOL_SIZE=bytes)
+ *	 - Call  mtk_os_hal_dma_pool_alloc(u32 size)
+ *	 - Call  mtk_os_hal_dma_pool_free(void *buf)
+ *	 - Call  mtk_os_hal_dma_pool_get_stats(struct dma_pool_stats *stats)
+ *
  *    @endcode
  *
  * @}
@@ -139,6 +166,45 @@
 * @{
 */
 
+/** @defgroup os_hal_dma_define Define
+ * @{
+ * This section introduces the Macro definition of DMA OS-HAL layer.
+ */
+
+/** Set MTK_DMA_TRACE_ENABLE to 1 (e.g. add_compile_definitions in the
+ * application CMakeLists.txt) to collect per-channel transfer statistics
+ * and a ring of recent transfer records. Timestamps come from the
+ * Cortex-M4 DWT cycle counter.
+ */
+#ifndef MTK_DMA_TRACE_ENABLE
+#define MTK_DMA_TRACE_ENABLE 0
+#endif
+
+/** The number of records kept in the DMA transfer trace ring. */
+#define MTK_DMA_TRACE_DEPTH 32
+
+/** Size in bytes of the DMA buffer pool, 0 disables it. The pool is placed
+ * in the .sysram section, so the application linker script must map
+ * .sysram to SYSRAM and leave room for it (e.g. lower configTOTAL_HEAP_SIZE
+ * by the same amount when the FreeRTOS heap is in SYSRAM). Must be a
+ * multiple of #MTK_DMA_POOL_ALIGN.
+ */
+#ifndef MTK_DMA_POOL_SIZE
+#define MTK_DMA_POOL_SIZE 0
+#endif
+
+/** Alignment of every DMA pool buffer, one cache line. It is also the
+ * smallest size class.
+ */
+#define MTK_DMA_POOL_ALIGN 32
+
+/** Number of DMA pool size classes: 32, 64, ... up to 4096 bytes. */
+#define MTK_DMA_POOL_CLASSES 8
+
+/**
+ * @}
+ */
+
 /** @defgroup os_hal_dma_enum Enum
  * @{
  * This section describes the enumeration definitions in DMA driver OS-HAL
@@ -238,6 +304,12 @@ enum dma_param_type {
 	OS_HAL_DMA_PARAM_VFF_HWPTR = 5,
 	/** The SW pointer of Virtual FIFO, Only for VFF DMA */
 	OS_HAL_DMA_PARAM_VFF_SWPTR = 6,
+	/** The FIFO timeout threshold in bus clock cycles, only for VFF DMA.
+	 * Once no new data arrives for this long, DMA_INT_VFIFO_TIMEOUT
+	 * fires so the partial data below the threshold can be consumed.
+	 * Setting a non-zero value enables the interrupt, 0 disables it.
+	 */
+	OS_HAL_DMA_PARAM_VFF_TIMEOUT = 7,
 };
 
 /** @brief DMA interrupt type definition.
@@ -264,6 +336,23 @@ enum dma_interrupt_type {
 	 */
 	DMA_INT_VFIFO_THRESHOLD = 0x1 << 3,
 };
+
+/** @brief DMA trace event definition.
+ * This definition indicates how a transfer record in the DMA trace ring
+ * was closed.
+ */
+enum dma_trace_event {
+	/** Transfer completed, or VFF threshold interrupt delivered data. */
+	DMA_TRACE_DONE = 0,
+	/** VFF timeout interrupt delivered data. */
+	DMA_TRACE_TIMEOUT = 1,
+	/** Channel was stopped after the whole count had been moved. */
+	DMA_TRACE_STOP = 2,
+	/** Configuration or start failed, or the channel was stopped with
+	 * data remaining.
+	 */
+	DMA_TRACE_ERROR = 3,
+};
 /**
  * @}
  */
@@ -413,6 +502,80 @@ struct dma_setting {
 	/** The setting to control DMA hardware transfer mode. */
 	struct dma_control_mode ctrl_mode;
 };
+
+/** @brief dma_chan_stats reports the activity of one DMA channel since
+ * #mtk_os_hal_dma_clear_stats(). Durations are in CPU cycles.
+ */
+struct dma_chan_stats {
+	/** Bytes moved by the channel. */
+	u32 bytes;
+	/** Transfers started by #mtk_os_hal_dma_start(). */
+	u32 xfer_cnt;
+	/** Completion (or VFF threshold) interrupts. */
+	u32 done_cnt;
+	/** Failed configurations or starts, and transfers stopped with data
+	 * remaining.
+	 */
+	u32 err_cnt;
+	/** VFF timeout interrupts. */
+	u32 timeout_cnt;
+	/** Duration of the last transfer, from start to completion. */
+	u32 last_cycles;
+	/** Longest transfer duration. */
+	u32 max_cycles;
+	/** Sum of the durations counted in done_cnt, total_cycles /
+	 * done_cnt is the average completed transfer. Timeouts and stops
+	 * are not included.
+	 */
+	u64 total_cycles;
+};
+
+/** @brief dma_trace_record is one entry of the DMA transfer trace ring.
+ * For VFF DMA, one record is written per interrupt and covers the data
+ * moved since the previous one.
+ */
+struct dma_trace_record {
+	/** Cycle count when the transfer started. */
+	u32 timestamp;
+	/** Cycles from start to completion. */
+	u32 cycles;
+	/** Bytes moved. */
+	u32 bytes;
+	/** DMA channel number, please refer to #dma_channel. */
+	u8 chn;
+	/** How the record was closed, please refer to #dma_trace_event. */
+	u8 event;
+};
+
+/** @brief dma_vff_stats counts how the data of one VFF DMA channel was
+ * delivered since the channel was allocated.
+ */
+struct dma_vff_stats {
+	/** DMA_INT_VFIFO_THRESHOLD interrupts. */
+	u32 thrsh_cnt;
+	/** DMA_INT_VFIFO_TIMEOUT interrupts. */
+	u32 timeout_cnt;
+	/** Sum of the FIFO data counts seen at the timeout interrupts. */
+	u32 timeout_bytes;
+};
+
+/** @brief dma_pool_stats reports the usage of the DMA buffer pool. */
+struct dma_pool_stats {
+	/** Pool size in bytes, #MTK_DMA_POOL_SIZE. */
+	u32 total_bytes;
+	/** Bytes handed out, rounded up to the size class. */
+	u32 used_bytes;
+	/** Highest used_bytes seen. */
+	u32 peak_bytes;
+	/** Successful allocations. */
+	u32 alloc_cnt;
+	/** Allocations that returned NULL. */
+	u32 fail_cnt;
+	/** Buffers in use, per size class. */
+	u16 class_used[MTK_DMA_POOL_CLASSES];
+	/** Buffers on the free list, per size class. */
+	u16 class_free[MTK_DMA_POOL_CLASSES];
+};
 /**
  * @}
  */
@@ -438,6 +601,21 @@ extern "C" {
  */
 int mtk_os_hal_dma_alloc_chan(enum dma_channel chn);
 
+/**
+ * @brief This function is used to lease one DMA channel.
+ * @brief Usage: Same as #mtk_os_hal_dma_alloc_chan(), but the channel stays
+ * owned by\n the caller until #mtk_os_hal_dma_release_chan(): neither
+ * #mtk_os_hal_dma_stop()\n nor #mtk_os_hal_dma_reset() hand it back. Drivers
+ * that run many short\n transfers on the same channel should lease it once
+ * at init time and use\n #mtk_os_hal_dma_rearm() between transfers.
+ * @param [in] chn : The DMA channel number, please refer to #dma_channel.
+ *
+ * @return
+ * Return 0 if users lease DMA channel successfully.\n
+ * Return negative integer indicating error number when error occur.\n
+ */
+int mtk_os_hal_dma_lease_chan(enum dma_channel chn);
+
 /**
  * @brief This function is used to config one DMA channel.
  * @brief Usage: Used to config one DMA channel.
@@ -451,6 +629,27 @@ int mtk_os_hal_dma_alloc_chan(enum dma_channel chn);
  */
 int mtk_os_hal_dma_config(enum dma_channel chn, struct dma_setting *setting);
 
+/**
+ * @brief This function is used to re-arm one configured DMA channel.
+ * @brief Usage: After one successful #mtk_os_hal_dma_config(), later
+ * transfers that\n only change the buffer and length can call this instead.
+ * Only the address\n and count registers are rewritten, every other setting
+ * is kept. For\n HALF-SIZE DMA only the memory side address is updated (src
+ * for MEM_2_PERI,\n dst for PERI_2_MEM), the peripheral address is kept. VFF
+ * DMA is not\n supported. The channel must be stopped (or completed) first.
+ * @param [in] chn : The DMA channel number, please refer to #dma_channel.
+ * @param [in] src_addr : The new source address.
+ * @param [in] dst_addr : The new destination address.
+ * @param [in] count : The new transfer length in bytes.
+ *
+ * @return
+ * Return 0 if users re-arm DMA channel successfully.\n
+ * Return -#DMA_EPARAM if the channel is not configured or is VFF DMA.\n
+ * Return negative integer indicating error number when error occur.\n
+ */
+int mtk_os_hal_dma_rearm(enum dma_channel chn, u32 src_addr, u32 dst_addr,
+			 u32 count);
+
 /**
  * @brief This function is used to start one DMA channel.
  * @brief Usage: Used to start one DMA channel.
@@ -630,6 +829,119 @@ int mtk_os_hal_dma_reset(enum dma_channel chn);
  */
 int mtk_os_hal_dma_clr_dreq(enum dma_channel chn);
 
+/**
+ * @brief This function is used to get the delivery counters of one VFF DMA
+ * channel.
+ * @brief Usage: Used to tune OS_HAL_DMA_PARAM_VFF_TIMEOUT and the FIFO
+ * threshold:\n many timeout deliveries mean the threshold is rarely reached
+ * at the\n current data rate.
+ * @param [in] chn : The DMA channel number, please refer to #dma_channel.
+ * @param [out] stats : The snapshot of the channel counters.
+ *
+ * @return
+ * Return 0 if users get the counters successfully.\n
+ * Return -#DMA_EPARAM if chn is not a VFF DMA channel.\n
+ * Return negative integer indicating error number when error occur.\n
+ */
+int mtk_os_hal_dma_get_vff_stats(enum dma_channel chn,
+				 struct dma_vff_stats *stats);
+
+#if MTK_DMA_TRACE_ENABLE
+/**
+ * @brief This function is used to get the transfer statistics of one DMA
+ * channel.
+ * @brief Usage: Only available when MTK_DMA_TRACE_ENABLE is 1. It can be
+ * called from any context.
+ * @param [in] chn : The DMA channel number, please refer to #dma_channel.
+ * @param [out] stats : The snapshot of the channel statistics.
+ *
+ * @return
+ * Return 0 if users get DMA channel statistics successfully.\n
+ * Return negative integer indicating error number when error occur.\n
+ */
+int mtk_os_hal_dma_get_stats(enum dma_channel chn,
+			     struct dma_chan_stats *stats);
+
+/**
+ * @brief This function is used to get the recent DMA transfer records.
+ * @brief Usage: Only available when MTK_DMA_TRACE_ENABLE is 1. At most
+ * #MTK_DMA_TRACE_DEPTH records of all channels are kept.
+ * @param [out] records : The buffer for the records, oldest first.
+ * @param [in] max_records : The number of records the buffer can hold.
+ *
+ * @return
+ * Return the number of records copied.\n
+ * Return negative integer indicating error number when error occur.\n
+ */
+int mtk_os_hal_dma_get_trace(struct dma_trace_record *records,
+			     u32 max_records);
+
+/**
+ * @brief This function is used to clear the statistics and the trace
+ * records of all DMA channels.
+ * @brief Usage: Only available when MTK_DMA_TRACE_ENABLE is 1.
+ *
+ * @return None.
+ */
+void mtk_os_hal_dma_clear_stats(void);
+
+/**
+ * @brief This function is used to print the statistics of the active DMA
+ * channels and the recent transfer records.
+ * @brief Usage: Only available when MTK_DMA_TRACE_ENABLE is 1. The output
+ * goes through printf, so it should be called from task context.
+ *
+ * @return None.
+ */
+void mtk_os_hal_dma_dump_stats(void);
+#endif
+
+#if MTK_DMA_POOL_SIZE
+/**
+ * @brief This function is used to allocate a DMA-safe buffer.
+ * @brief Usage: Only available when MTK_DMA_POOL_SIZE is not 0. The buffer
+ * is in SYSRAM,\n aligned to #MTK_DMA_POOL_ALIGN and rounded up to a power
+ * of two size class.\n Requests larger than the biggest class fail. It can
+ * be called from any context.
+ * @param [in] size : The buffer size in bytes.
+ *
+ * @return
+ * Return the buffer address if users allocate it successfully.\n
+ * Return NULL if size is 0, too large or the pool is exhausted.\n
+ */
+void *mtk_os_hal_dma_pool_alloc(u32 size);
+
+/**
+ * @brief This function is used to free a buffer returned by
+ * #mtk_os_hal_dma_pool_alloc().
+ * @param [in] buf : The buffer address.
+ *
+ * @return
+ * Return 0 if users free the buffer successfully.\n
+ * Return -#DMA_EPTR if buf does not belong to the pool or is already free.\n
+ */
+int mtk_os_hal_dma_pool_free(void *buf);
+
+/**
+ * @brief This function is used to get the DMA buffer pool usage.
+ * @param [out] stats : The snapshot of the pool usage.
+ *
+ * @return
+ * Return 0 if users get the pool usage successfully.\n
+ * Return -#DMA_EPTR if stats is NULL.\n
+ */
+int mtk_os_hal_dma_pool_get_stats(struct dma_pool_stats *stats);
+
+/**
+ * @brief This function is used to print the DMA buffer pool usage.
+ * @brief Usage: The output goes through printf, so it should be called
+ * from task context.
+ *
+ * @return None.
+ */
+void mtk_os_hal_dma_pool_dump(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
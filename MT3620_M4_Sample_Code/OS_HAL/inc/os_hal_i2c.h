@@ -37,6 +37,7 @@
 #define __OS_HAL_I2C_H__
 
 #include "mhal_i2c.h"
+#include "os_hal_gpio.h"
 
 /**
  * @addtogroup OS-HAL
@@ -80,6 +81,10 @@
  *	  -Call mtk_os_hal_i2c_speed_init(i2c_num bus_num,
 			     enum i2c_speed_kHz speed)
  *
+ *	- optionally move messages longer than len bytes by DMA, shorter
+ *	  ones through the 8-byte FIFO (default len: 8)
+ *	  -Call mtk_os_hal_i2c_set_dma_threshold(i2c_num bus_num, u16 len)
+ *
  *	- I2C master read data from slave device
  *	 -Call mtk_os_hal_i2c_read(i2c_num bus_num,
 			    u8 device_addr, u8 *buffer, u16 len)
@@ -93,6 +98,40 @@
 			    u8 device_addr, u8 *wr_buf, u8 *rd_buf,
 			    u16 wr_len, u16 rd_len)
  *
+ *	- read a register block in one transaction into several buffers
+ *	 -Call mtk_os_hal_i2c_burst_read(i2c_num bus_num,
+			    u8 device_addr, u8 *wr_buf, u16 wr_len,
+			    const struct mtk_i2c_burst_seg *segs, u32 seg_cnt)
+ *
+ *	- or open a handle per slave device, which carries its address,
+ *	  bus speed and timeout
+ *	 -Call mtk_os_hal_i2c_device_init(struct mtk_i2c_device *dev,
+			    i2c_num bus_num, u8 addr,
+			    enum i2c_speed_kHz speed, u32 timeout)
+ *	 -Call mtk_os_hal_i2c_device_read(), mtk_os_hal_i2c_device_write()
+ *	  or mtk_os_hal_i2c_device_write_read()
+ *
+ *	- queue a transfer of a device and get a callback when it's done
+ *	 -Call mtk_os_hal_i2c_device_async_read(),
+ *	  mtk_os_hal_i2c_device_async_write() or
+ *	  mtk_os_hal_i2c_device_async_write_read()
+ *
+ *	- All transfers of a bus are serialized by a mutex, so tasks may
+ *	  share a bus. Waiting tasks get the bus in priority order (FIFO
+ *	  among equal priorities) and the holder inherits the priority of
+ *	  the highest waiter.
+ *
+ *	-I2C master writes a list of (reg, value) pairs, e.g. a sensor
+ *	 init table, back to back with one completion
+ *	 -Call mtk_os_hal_i2c_write_regs(i2c_num bus_num, u8 device_addr,
+			    const u8 *regs, u32 cnt, u32 *fail_idx)
+ *
+ *	-I2C master runs a list of write/read/write-read messages
+ *	 back to back with one completion
+ *	 -Call mtk_os_hal_i2c_transfer_seq(i2c_num bus_num,
+			    struct mtk_i2c_seq_msg *msgs, u32 cnt,
+			    u32 *fail_idx)
+ *
  *	-Set I2C controler slave address
  *	 -Call mtk_os_hal_i2c_set_slave_addr(i2c_num bus_num,
 			    u8 slv_addr)
@@ -105,6 +144,22 @@
  *	 -Call mtk_os_hal_i2c_slave_rx(i2c_num bus_num,
 			    u8 *buffer, u16 len, u32 time_out)
  *
+ *	-Or keep the controller an always-ready slave with RX/TX rings or
+ *	 an emulated register map, serviced from the interrupt
+ *	 -Call mtk_os_hal_i2c_slave_start(i2c_num bus_num, u8 slv_addr,
+			    struct mtk_i2c_slave_config *config)
+ *	 -Call mtk_os_hal_i2c_slave_read() / mtk_os_hal_i2c_slave_write()
+ *	  in the ring mode, or access config->regs in the register map mode
+ *	 -Call mtk_os_hal_i2c_slave_stop(i2c_num bus_num)
+ *
+ *	- optionally wire two spare GPIOs to SCL/SDA for bus recovery
+ *	 -Call mtk_os_hal_i2c_set_recovery_gpio(i2c_num bus_num,
+			    os_hal_gpio_pin scl, os_hal_gpio_pin sda)
+ *
+ *	- read the NACK/timeout/recovery counters and latency of a bus
+ *	 -Call mtk_os_hal_i2c_get_stats(i2c_num bus_num,
+			    struct i2c_bus_stats *stats)
+ *
  *	- uninit I2C
  *	 - Call  mtk_os_hal_i2c_ctrl_deinit(i2c_num bus_num) to uninit
  *	    i2c and release resource.
@@ -143,6 +198,176 @@ typedef enum {
 	OS_HAL_I2C_ISU_MAX
 } i2c_num;
 
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_i2c_typedef Typedef
+  * @{
+  * This section introduces the typedef that I2C OS-HAL used.
+  */
+
+/** @brief This defines the completion callback of an async request.
+ * It's called in I2C or DMA interrupt context (or in the submitting
+ * task with interrupts disabled if the request can not be started), so
+ * it must be short and must not block, e.g. vTaskNotifyGiveFromISR()
+ * to the task that owns the request. It may submit the next request.
+ *
+ * @param [in] context : the context passed with the request.
+ * @param [in] status : 0 if the transfer succeeded, negative otherwise.
+ */
+typedef void (*i2c_async_complete) (void *context, int status);
+
+/** @brief This defines the STOP callback of the persistent slave mode.
+ * It's called in I2C interrupt context at the end of every transaction
+ * addressed to the slave, after the RX data has been stored and the TX
+ * FIFO has been refilled.
+ *
+ * @param [in] context : the context of #mtk_i2c_slave_config.
+ * @param [in] is_read : 1 if the master read, 0 if it wrote.
+ * @param [in] reg : register map mode: the first register read or
+ * written. Ring mode: 0.
+ * @param [in] len : number of data bytes moved, without the register
+ * pointer byte.
+ */
+typedef void (*i2c_slave_stop_callback) (void *context, u8 is_read,
+					 u8 reg, u32 len);
+
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_i2c_struct Struct
+  * @{
+  * This section introduces the structures of I2C OS-HAL.
+  */
+
+/** @brief Handle of one slave device on an I2C bus.
+ * It's initialized by mtk_os_hal_i2c_device_init() and passed to
+ * mtk_os_hal_i2c_device_read() and friends, so tasks sharing a bus
+ * don't have to agree on the bus speed.
+ */
+struct mtk_i2c_device {
+	/** I2C ISU port the device is connected to */
+	i2c_num bus_num;
+	/** 7-bit slave device address */
+	u8 addr;
+	/** bus speed of the device, 0 keeps the speed set by
+	 * mtk_os_hal_i2c_speed_init()
+	 */
+	enum i2c_speed_kHz speed;
+	/** transfer timeout in ms */
+	u32 timeout;
+};
+
+/** @brief An async request, see mtk_os_hal_i2c_device_async_read().
+ * It's owned by the caller and must stay valid, together with its
+ * buffers, until its callback has been called.
+ */
+struct mtk_i2c_request {
+	/** the device, set by the driver */
+	struct mtk_i2c_device *dev;
+	/** data to write, set by the driver */
+	u8 *wr_buf;
+	/** bytes to write, set by the driver */
+	u16 wr_len;
+	/** buffer to read into, set by the driver */
+	u8 *rd_buf;
+	/** bytes to read, set by the driver */
+	u16 rd_len;
+	/** called when the request is done, may be NULL */
+	i2c_async_complete complete;
+	/** argument of complete */
+	void *context;
+	/** result of the request, valid in complete */
+	int status;
+	/** queue link, used by the driver */
+	struct mtk_i2c_request *next;
+};
+
+/** @brief Setting of the persistent slave mode,
+ * see mtk_os_hal_i2c_slave_start().\n
+ * With regs set the slave emulates a register map: the first byte of a
+ * write sets the register pointer and the following bytes are stored
+ * from there, a read returns the registers from the pointer on, and the
+ * pointer auto-increments. Otherwise written bytes go into the RX ring
+ * and reads are served from the TX ring.
+ */
+struct mtk_i2c_slave_config {
+	/** RX ring of the ring mode */
+	u8 *rx_buf;
+	/** RX ring size in bytes */
+	u32 rx_size;
+	/** TX ring of the ring mode */
+	u8 *tx_buf;
+	/** TX ring size in bytes */
+	u32 tx_size;
+	/** register map, NULL for the ring mode */
+	u8 *regs;
+	/** register map size, 1~256 */
+	u32 reg_size;
+	/** called at the end of every transaction, may be NULL */
+	i2c_slave_stop_callback stop;
+	/** argument of stop */
+	void *context;
+};
+
+/** @brief Per-bus transaction counters, see mtk_os_hal_i2c_get_stats().
+ * A transaction is one blocking call, one sequence or one async
+ * request. Durations are Cortex-M4 DWT cycles from the start of the
+ * transaction to its completion.
+ */
+struct i2c_bus_stats {
+	/** Transactions finished, successfully or not. */
+	u32 xfer_cnt;
+	/** Address or data not acknowledged. */
+	u32 nack_cnt;
+	/** No completion within the timeout. */
+	u32 timeout_cnt;
+	/** Arbitration lost, or bus held busy and not recovered. */
+	u32 busy_cnt;
+	/** Other errors, e.g. FIFO errors. */
+	u32 err_cnt;
+	/** Bus recoveries attempted. */
+	u32 recover_cnt;
+	/** Recoveries that left the bus busy. */
+	u32 recover_fail_cnt;
+	/** Duration of the last transaction. */
+	u32 last_cycles;
+	/** Longest transaction duration. */
+	u32 max_cycles;
+	/** Sum of all transaction durations. */
+	u64 total_cycles;
+};
+
+/** @brief One destination of mtk_os_hal_i2c_burst_read().
+ * The segments take consecutive bytes of the read, a NULL buf skips
+ * len bytes (e.g. a reserved register in the middle of the burst).
+ */
+struct mtk_i2c_burst_seg {
+	/** Destination, or NULL to drop these bytes. */
+	u8 *buf;
+	/** Number of bytes. */
+	u16 len;
+};
+
+/** @brief One record of mtk_os_hal_i2c_transfer_seq().
+ * wr_len only: write. rd_len only: read. Both: write then repeated-start
+ * read. Buffers longer than 8 bytes need DMA-safe memory.
+ */
+struct mtk_i2c_seq_msg {
+	/** 7-bit slave device address */
+	u8 addr;
+	/** data to write, or NULL */
+	u8 *wr_buf;
+	/** bytes to write */
+	u16 wr_len;
+	/** buffer to read into, or NULL */
+	u8 *rd_buf;
+	/** bytes to read */
+	u16 rd_len;
+};
+
 /**
   * @}
   */
@@ -194,6 +419,27 @@ int mtk_os_hal_i2c_ctrl_deinit(i2c_num bus_num);
  */
 int mtk_os_hal_i2c_speed_init(i2c_num bus_num, enum i2c_speed_kHz speed);
 
+/**
+ *  @brief Select FIFO or DMA mode by message length.
+ *
+ *  Messages (of a write-read: either of the two) longer than len bytes
+ *  are moved by DMA, shorter ones are written to and read from the
+ *  hardware FIFO by the CPU, which saves the DMA setup on short register
+ *  accesses. The FIFO is 8 bytes deep and the controller only interrupts
+ *  at the end of a transfer, so len is limited to 8 and longer messages
+ *  always use DMA.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4
+ *
+ *  @param [in] len : the threshold in bytes, 0 restores the default (8).
+ *
+ *  @return "0" if the threshold is set successfully.\n
+ *  @return -#I2C_EPTR if i2c is NULL.\n
+ *  @return -#I2C_EINVAL if a parameter is invalid or DMA is not enabled.
+ */
+int mtk_os_hal_i2c_set_dma_threshold(i2c_num bus_num, u16 len);
+
 /**
  *  @brief I2C master read data from slave device.
  *
@@ -253,6 +499,171 @@ int mtk_os_hal_i2c_write(i2c_num bus_num, u8 device_addr, u8 *buffer, u16 len);
 int mtk_os_hal_i2c_write_read(i2c_num bus_num, u8 device_addr,
 			      u8 *wr_buf, u8 *rd_buf, u16 wr_len, u16 rd_len);
 
+/**
+ *  @brief Read a block of registers in one transaction and scatter it.
+ *
+ *  Writes wr_buf (usually the first register address), then reads the
+ *  sum of all segment lengths after a repeated start and copies each
+ *  part to its segment. With a device that auto-increments the register
+ *  address this replaces one write-read per register group with a single
+ *  transaction.\n
+ *  The controller runs at most one write and one read per START, so
+ *  the segments split the read, they don't add more repeated starts.\n
+ *  Both messages are staged in per-bus SYSRAM buffers, up to 8 bytes
+ *  of write and I2C_BURST_MAX_LEN (32) bytes of read, so wr_buf and the
+ *  segment buffers need not be DMA-safe.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *  @param [in] device_addr : Slave device address.
+ *  @param [in] wr_buf : Data to write before the read.
+ *  @param [in] wr_len : Length of wr_buf, 1~8.
+ *  @param [in] segs : Destinations of the read, in bus order.
+ *  @param [in] seg_cnt : Number of segments.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_burst_read(i2c_num bus_num, u8 device_addr,
+			      u8 *wr_buf, u16 wr_len,
+			      const struct mtk_i2c_burst_seg *segs, u32 seg_cnt);
+
+/**
+ *  @brief Initialize the handle of a slave device.
+ *
+ *  @param [out] dev : the device handle.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @param [in] addr : 7-bit slave device address.
+ *
+ *  @param [in] speed : bus speed of the device, one of the enum
+ *  #i2c_speed_kHz, 0 keeps the speed of the bus.
+ *
+ *  @param [in] timeout : transfer timeout in ms, 0 means 2000.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_device_init(struct mtk_i2c_device *dev, i2c_num bus_num,
+				u8 addr, enum i2c_speed_kHz speed,
+				u32 timeout);
+
+/**
+ *  @brief Same as mtk_os_hal_i2c_read() with the setting of dev.
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [out] buffer : the data read from the device.
+ *  @param [in] len : data length.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_device_read(struct mtk_i2c_device *dev, u8 *buffer,
+			       u16 len);
+
+/**
+ *  @brief Same as mtk_os_hal_i2c_write() with the setting of dev.
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] buffer : the data to write.
+ *  @param [in] len : data length.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_device_write(struct mtk_i2c_device *dev, u8 *buffer,
+				u16 len);
+
+/**
+ *  @brief Same as mtk_os_hal_i2c_write_read() with the setting of dev.
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] wr_buf : the data to write.
+ *  @param [out] rd_buf : the data read from the device.
+ *  @param [in] wr_len : write length.
+ *  @param [in] rd_len : read length.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_device_write_read(struct mtk_i2c_device *dev,
+				     u8 *wr_buf, u8 *rd_buf,
+				     u16 wr_len, u16 rd_len);
+
+/**
+ *  @brief Queue a read from dev and return immediately.
+ *
+ *  Requests of all devices of a bus are queued in submission order and
+ *  the I2C interrupt starts the next one as soon as the previous one is
+ *  done. A blocking call on the same bus waits only for the request on
+ *  the wire, the rest of the queue waits until the blocking call
+ *  returns. If that request has not ended within the device timeout
+ *  (1000 ms if it is 0), the controller is reset and the request
+ *  completes with -I2C_ETIMEDOUT. Otherwise async requests have no
+ *  timeout, a missing slave is reported by the controller as an ACK
+ *  error.
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] req : the request, owned by the caller until complete.
+ *  @param [out] buffer : the data read from the device.
+ *  @param [in] len : data length.
+ *  @param [in] complete : called when the read is done, may be NULL.
+ *  @param [in] context : argument of complete.
+ *
+ *  @return negative value means the request was not queued.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_device_async_read(struct mtk_i2c_device *dev,
+				     struct mtk_i2c_request *req,
+				     u8 *buffer, u16 len,
+				     i2c_async_complete complete,
+				     void *context);
+
+/**
+ *  @brief Queue a write to dev and return immediately,
+ *  see mtk_os_hal_i2c_device_async_read().
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] req : the request, owned by the caller until complete.
+ *  @param [in] buffer : the data to write.
+ *  @param [in] len : data length.
+ *  @param [in] complete : called when the write is done, may be NULL.
+ *  @param [in] context : argument of complete.
+ *
+ *  @return negative value means the request was not queued.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_device_async_write(struct mtk_i2c_device *dev,
+				      struct mtk_i2c_request *req,
+				      u8 *buffer, u16 len,
+				      i2c_async_complete complete,
+				      void *context);
+
+/**
+ *  @brief Queue a write then read of dev and return immediately,
+ *  see mtk_os_hal_i2c_device_async_read().
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] req : the request, owned by the caller until complete.
+ *  @param [in] wr_buf : the data to write, e.g. the register address.
+ *  @param [out] rd_buf : the data read from the device.
+ *  @param [in] wr_len : write length.
+ *  @param [in] rd_len : read length.
+ *  @param [in] complete : called when the transfer is done, may be NULL.
+ *  @param [in] context : argument of complete.
+ *
+ *  @return negative value means the request was not queued.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_device_async_write_read(struct mtk_i2c_device *dev,
+					   struct mtk_i2c_request *req,
+					   u8 *wr_buf, u8 *rd_buf,
+					   u16 wr_len, u16 rd_len,
+					   i2c_async_complete complete,
+					   void *context);
+
 /**
  *  @brief Set I2C slave address before transfer when I2C hardware
  *  controller is set as a slave role, it which means does not call
@@ -310,6 +721,192 @@ int mtk_os_hal_i2c_slave_tx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out);
  */
 int mtk_os_hal_i2c_slave_rx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out);
 
+/**
+ *  @brief Set the GPIOs used to clock out a slave that holds SDA low.
+ *
+ *  The ISU pins can not be switched to GPIO at run time, the pin mux is
+ *  fixed by the app manifest, so recovery needs two spare GPIOs wired
+ *  to SCL and SDA of the bus. They are kept as inputs and only pulled
+ *  low (open-drain) during a recovery: SCL is pulsed up to 9 times until
+ *  SDA is released, then a STOP is sent.\n
+ *  Without recovery GPIOs a recovery only resets the controller.\n
+ *  A master transfer recovers the bus before it starts if the controller
+ *  sees the bus busy, and after a timeout or a lost arbitration.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *  @param [in] scl : the GPIO wired to SCL.
+ *  @param [in] sda : the GPIO wired to SDA.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_set_recovery_gpio(i2c_num bus_num, os_hal_gpio_pin scl,
+				     os_hal_gpio_pin sda);
+
+/**
+ *  @brief Recover the bus now, see mtk_os_hal_i2c_set_recovery_gpio().
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @return -#I2C_EBUSY if the bus is still busy.
+ *  @return 0 means the bus is idle.
+ */
+int mtk_os_hal_i2c_recover(i2c_num bus_num);
+
+/**
+ *  @brief Get the transaction counters of a bus.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *  @param [out] stats : the counters.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_get_stats(i2c_num bus_num, struct i2c_bus_stats *stats);
+
+/**
+ *  @brief Clear the transaction counters of a bus.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_reset_stats(i2c_num bus_num);
+
+/**
+ *  @brief Start the persistent slave mode.
+ *
+ *  The controller answers slv_addr until mtk_os_hal_i2c_slave_stop(),
+ *  with no call pending: written bytes are stored from the interrupt and
+ *  reads are served from a TX FIFO that is refilled at the end of every
+ *  transaction. Master transfers on the bus fail with -#I2C_EBUSY
+ *  meanwhile.\n
+ *  The controller has no FIFO-level interrupt, so a transaction moves at
+ *  most 8 data bytes (a register map write: the pointer and 7 bytes).
+ *  The TX FIFO is preloaded, so in the register map mode the master has
+ *  to end the pointer write with a STOP before the read; a repeated
+ *  start reads from where the previous read ended.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *  @param [in] slv_addr : 7-bit slave address of the controller.
+ *  @param [in] config : rings or register map and the STOP callback,
+ *  copied by the driver. The buffers must stay valid until stop.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_slave_start(i2c_num bus_num, u8 slv_addr,
+			       struct mtk_i2c_slave_config *config);
+
+/**
+ *  @brief Stop the persistent slave mode and return the bus to the
+ *  master mode.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_i2c_slave_stop(i2c_num bus_num);
+
+/**
+ *  @brief Take up to len bytes the master wrote out of the RX ring,
+ *  without blocking. One reader per bus.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *  @param [out] buf : the received bytes.
+ *  @param [in] len : size of buf.
+ *
+ *  @return negative value means fail.
+ *  @return the number of bytes copied otherwise.
+ */
+int mtk_os_hal_i2c_slave_read(i2c_num bus_num, u8 *buf, u32 len);
+
+/**
+ *  @brief Queue up to len bytes for the next reads of the master,
+ *  without blocking. One writer per bus.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *  @param [in] buf : the bytes to send.
+ *  @param [in] len : number of bytes.
+ *
+ *  @return negative value means fail.
+ *  @return the number of bytes queued otherwise, less than len if the
+ *  TX ring is full.
+ */
+int mtk_os_hal_i2c_slave_write(i2c_num bus_num, u8 *buf, u32 len);
+
+/**
+ *  @brief Get the number of RX bytes dropped because the RX ring was
+ *  full, plus FIFO overflows and underflows, since the slave started.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @return the count.
+ */
+u32 mtk_os_hal_i2c_slave_get_overrun(i2c_num bus_num);
+
+/**
+ *  @brief I2C master writes a table of 8-bit registers with one completion.
+ *
+ *  Each pair is written as a 2-byte transfer. The next one is started
+ *  from the interrupt that completes the previous one, and the caller is
+ *  woken once, at the end or at the first failure.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @param [in] device_addr : slave device address.
+ *
+ *  @param [in] regs : cnt (register, value) byte pairs, e.g. an array of
+ *  struct { u8 reg; u8 val; }.
+ *
+ *  @param [in] cnt : number of pairs.
+ *
+ *  @param [out] fail_idx : the index of the pair that failed, cnt if all
+ *  succeeded. May be NULL.
+ *
+ *  @return negative value means fail.
+ *
+ *  @return "0" if all pairs were written successfully.
+ */
+int mtk_os_hal_i2c_write_regs(i2c_num bus_num, u8 device_addr,
+			      const u8 *regs, u32 cnt, u32 *fail_idx);
+
+/**
+ *  @brief I2C master runs a list of messages with one completion.
+ *
+ *  Like mtk_os_hal_i2c_write_regs() for any mix of write, read and
+ *  write-read records, see #mtk_i2c_seq_msg.
+ *
+ *  @param [in] bus_num : I2C ISU Port number,
+ *  it can be OS_HAL_I2C_ISU0~OS_HAL_I2C_ISU4.
+ *
+ *  @param [in] msgs : the records.
+ *
+ *  @param [in] cnt : number of records.
+ *
+ *  @param [out] fail_idx : the index of the record that failed,
+ *  cnt if all succeeded. May be NULL.
+ *
+ *  @return negative value means fail.
+ *
+ *  @return "0" if all records were transferred successfully.
+ */
+int mtk_os_hal_i2c_transfer_seq(i2c_num bus_num,
+				struct mtk_i2c_seq_msg *msgs, u32 cnt,
+				u32 *fail_idx);
+
 #ifdef __cplusplus
 }
 #endif
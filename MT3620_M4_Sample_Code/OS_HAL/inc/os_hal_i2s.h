@@ -84,6 +84,17 @@
  *	- Enable I2S transfer.
  *	  -Call mtk_os_hal_enable_i2s(i2s_no i2s_port).
  *
+ *	- Fill and process periods in place in the DMA buffers.
+ *	  -Call mtk_os_hal_i2s_tx_acquire(i2s_no i2s_port,
+				unsigned int **buf), fill the period and
+		call mtk_os_hal_i2s_tx_commit(i2s_no i2s_port).
+ *	  -Call mtk_os_hal_i2s_rx_acquire(i2s_no i2s_port,
+				unsigned int **buf), process the period and
+		call mtk_os_hal_i2s_rx_release(i2s_no i2s_port).
+ *	  -Call mtk_os_hal_i2s_get_stats(i2s_no i2s_port,
+				struct i2s_stream_stats *stats) for the
+		underrun and overrun counts.
+ *
  *	- Disable I2S transfer.
  *	 - Call  mtk_os_hal_disable_i2s(i2s_no i2s_port).
  *
@@ -151,6 +162,18 @@ typedef struct {
 	/** RX callback data */
 	void				*rx_callback_data;
 } audio_parameter;
+
+/** Period counters of the zero-copy API, reset by mtk_os_hal_config_i2s() */
+struct i2s_stream_stats {
+	/** TX periods handed to the DMA */
+	u32 tx_period_cnt;
+	/** TX periods not committed in time and played as silence */
+	u32 tx_underrun;
+	/** RX periods filled by the DMA */
+	u32 rx_period_cnt;
+	/** RX periods overwritten before they were released */
+	u32 rx_overrun;
+};
 /**
   * @}
   */
@@ -223,6 +246,75 @@ int mtk_os_hal_request_i2s(i2s_no i2s_port);
  */
 int mtk_os_hal_free_i2s(i2s_no i2s_port);
 
+/**
+ * @brief     Get the next writable TX period.
+ * @brief     Usage: User can call this function to fill the TX buffer in
+ *            place instead of copying into it.\n
+ *            A period is writable once the DMA has played it. Fill it and
+ *            pass it back with mtk_os_hal_i2s_tx_commit(). Calling this
+ *            again before the commit returns the same period.\n
+ *            The buffer contents at mtk_os_hal_config_i2s() are the first
+ *            tx_buffer_len / tx_period_len periods to play. If the DMA
+ *            reaches a period that is not committed, the period is played
+ *            as silence, counted as an underrun and skipped.\n
+ *            tx_buffer_len has to be a multiple of tx_period_len.
+ * @param[in] i2s_port : enum i2s_no.
+ * @param[out] buf : Start of the period.
+ * @return
+ *      Return the period length in bytes if a period is writable.\n
+ *      Return "0" if no period is writable yet, wait for the TX callback.\n
+ *      Return -#I2S_EPTR if the i2s_port or buf is invalid.\n
+ *      Return -#I2S_ELENGTH if the buffer is not a multiple of the period.
+ */
+int mtk_os_hal_i2s_tx_acquire(i2s_no i2s_port, unsigned int **buf);
+
+/**
+ * @brief     Commit the TX period from mtk_os_hal_i2s_tx_acquire().
+ * @param[in] i2s_port : enum i2s_no.
+ * @return
+ *      Return "0" if the period is committed. A period that an underrun
+ *      skipped meanwhile is dropped.\n
+ *      Return -#I2S_EPTR if the i2s_port is invalid or no period is held.
+ */
+int mtk_os_hal_i2s_tx_commit(i2s_no i2s_port);
+
+/**
+ * @brief     Get the oldest received RX period.
+ * @brief     Usage: User can call this function to process received data
+ *            in place and then release the period with
+ *            mtk_os_hal_i2s_rx_release().\n
+ *            If the DMA comes around to a period that is not released
+ *            yet, the period is dropped and counted as an overrun.\n
+ *            rx_buffer_len has to be a multiple of rx_period_len.
+ * @param[in] i2s_port : enum i2s_no.
+ * @param[out] buf : Start of the period.
+ * @return
+ *      Return the period length in bytes if a period is available.\n
+ *      Return "0" if no period is received yet, wait for the RX callback.\n
+ *      Return -#I2S_EPTR if the i2s_port or buf is invalid.\n
+ *      Return -#I2S_ELENGTH if the buffer is not a multiple of the period.
+ */
+int mtk_os_hal_i2s_rx_acquire(i2s_no i2s_port, unsigned int **buf);
+
+/**
+ * @brief     Release the RX period from mtk_os_hal_i2s_rx_acquire().
+ * @param[in] i2s_port : enum i2s_no.
+ * @return
+ *      Return "0" if the period is released.\n
+ *      Return -#I2S_EPTR if the i2s_port is invalid or no period is held.
+ */
+int mtk_os_hal_i2s_rx_release(i2s_no i2s_port);
+
+/**
+ * @brief     Get the period and underrun/overrun counters.
+ * @param[in] i2s_port : enum i2s_no.
+ * @param[out] stats : struct i2s_stream_stats.
+ * @return
+ *      Return "0" if the counters are returned.\n
+ *      Return -#I2S_EPTR if the i2s_port or stats is invalid.
+ */
+int mtk_os_hal_i2s_get_stats(i2s_no i2s_port, struct i2s_stream_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -88,6 +88,35 @@
 				   spi_usr_complete_callback complete,
 				   void *context)
  *
+ *	- Or bind the HW setting to a device handle once and transfer
+ *	  through the handle, the controller is then re-programmed only
+ *	  when another setting was used in between
+ *	  -Call mtk_os_hal_spim_device_init(struct mtk_spi_device *dev,
+				spim_num bus_num,
+				struct mtk_spi_config *config,
+				u32 speed_khz)
+ *	  -Call mtk_os_hal_spim_device_transfer(struct mtk_spi_device *dev,
+				    struct mtk_spi_transfer *xfer)
+ *
+ *	- Queue any number of asynchronous transfers on a shared bus
+ *	  -Call mtk_os_hal_spim_device_submit(struct mtk_spi_device *dev,
+				  struct mtk_spi_message *msg)
+ *
+ *	- Run a list of ops (opcode, data, read, GPIO hook) as one job
+ *	  -Call mtk_os_hal_spim_device_batch(struct mtk_spi_device *dev,
+				 struct mtk_spi_op *ops, u32 op_cnt)
+ *
+ *	- Read an SPI ADC continuously in full-duplex frames
+ *	  -Set msg->duplex and msg->frame_done, call
+ *	   mtk_os_hal_spim_device_submit(struct mtk_spi_device *dev,
+				  struct mtk_spi_message *msg)
+ *	  -Call mtk_os_hal_spim_duplex_stop(spim_num bus_num) to end it
+ *
+ *	- Use DMA mode to send or receive a buffer of any length
+ *	  -Call mtk_os_hal_spim_stream_transfer(spim_num bus_num,
+				    struct mtk_spi_config *config,
+				    struct mtk_spi_transfer *xfer)
+ *
  *	- uninit SPIM
  *	 - Call  mtk_os_hal_spim_ctlr_deinit(spim_num bus_num) to uninit
  *	    spim and release resource.
@@ -106,6 +135,49 @@
 * @{
 */
 
+/** @defgroup os_hal_spim_define Define
+  * @{
+  * This section introduces the build time settings of SPIM OS-HAL.
+  */
+
+/** Blocking FIFO transfers of up to this many data bytes are polled:
+ * the SPIM irq is masked and the task spins on the controller status
+ * instead of sleeping on a semaphore. 0 disables polling.
+ * It can be changed per bus by mtk_os_hal_spim_set_poll_len().
+ */
+#ifndef MTK_SPIM_POLL_LEN
+#define MTK_SPIM_POLL_LEN	2
+#endif
+
+/** Maximum number of status reads of one polled transfer, after that
+ * the transfer falls back to the irq path.
+ */
+#ifndef MTK_SPIM_POLL_BUDGET
+#define MTK_SPIM_POLL_BUDGET	2000
+#endif
+
+/** Deferred completions one bus can hold before they are called in
+ * interrupt context again, see mtk_os_hal_spim_set_complete_mode().
+ * It must be a power of two.
+ */
+#ifndef MTK_SPIM_COMPLETE_QUEUE_LEN
+#define MTK_SPIM_COMPLETE_QUEUE_LEN	8
+#endif
+
+/** Stack depth (in words) of the FreeRTOS completion worker task */
+#ifndef MTK_SPIM_COMPLETE_TASK_STACK
+#define MTK_SPIM_COMPLETE_TASK_STACK	512
+#endif
+
+/** Priority of the FreeRTOS completion worker task */
+#ifndef MTK_SPIM_COMPLETE_TASK_PRIO
+#define MTK_SPIM_COMPLETE_TASK_PRIO	(configMAX_PRIORITIES - 2)
+#endif
+
+/**
+  * @}
+  */
+
 /** @defgroup os_hal_spim_enum Enum
   * @{
   * This section introduces the enumerations
@@ -127,6 +199,24 @@ typedef enum {
 	OS_HAL_SPIM_ISU_MAX
 } spim_num;
 
+typedef enum {
+	/** complete() of async transfers is called in interrupt context */
+	OS_HAL_SPIM_COMPLETE_ISR = 0,
+	/** complete() of async transfers is called by the completion worker */
+	OS_HAL_SPIM_COMPLETE_TASK = 1,
+} spim_complete_mode;
+
+typedef enum {
+	/** send opcode (1~4 bytes) only */
+	OS_HAL_SPIM_OP_WRITE_OPCODE = 0,
+	/** send len bytes of buf, after opcode if opcode_len != 0 */
+	OS_HAL_SPIM_OP_WRITE = 1,
+	/** receive len bytes into buf, after opcode if opcode_len != 0 */
+	OS_HAL_SPIM_OP_READ = 2,
+	/** call hook(arg) between transfers, e.g. to drive a D/C or CS GPIO */
+	OS_HAL_SPIM_OP_HOOK = 3,
+} spim_op_type;
+
 /**
   * @}
   */
@@ -148,6 +238,123 @@ typedef enum {
  */
 typedef int (*spi_usr_complete_callback) (void *context);
 
+/** @brief This defines the hook prototype of a batch op.
+ * It's called in interrupt context (or in the submitting task for the
+ * leading hooks of a batch started on an idle bus), so it must be short
+ * and must not block, e.g. mtk_os_hal_gpio_set_output().
+ *
+ * @param [in] arg : the argument of the OS_HAL_SPIM_OP_HOOK op.
+ */
+typedef void (*spi_op_hook) (void *arg);
+
+/** @brief This defines the frame callback of a full-duplex stream.
+ * It's called in DMA interrupt context each time a frame buffer is full.
+ * The next transaction is already on the wire and fills the other
+ * buffer, so frame must be consumed before that buffer is full.
+ *
+ * @param [in] context : the context of the message.
+ * @param [in] frame : rx_buf[0] or rx_buf[1] of the stream.
+ * @param [in] len : frame_len of the stream.
+ */
+typedef void (*spi_frame_callback) (void *context, u8 *frame, u32 len);
+
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_spim_struct Struct
+  * @{
+  * This section introduces the structure that SPIM OS-HAL used.
+  */
+
+/** @brief Handle of one device on a SPIM bus.
+ * It's initialized by mtk_os_hal_spim_device_init() and passed to
+ * mtk_os_hal_spim_device_transfer().\n
+ * The controller remembers which handle programmed it last, so
+ * back-to-back transfers of the same handle skip the clock gate,
+ * software reset and mode setup entirely.\n
+ * The chip select of the device is config.slave_sel.
+ */
+struct mtk_spi_device {
+	/** SPIM ISU port the device is connected to */
+	spim_num bus_num;
+	/** HW setting of the device, owned by the handle */
+	struct mtk_spi_config config;
+	/** bus clock of the device, it overrides mtk_spi_transfer->speed_khz
+	 * unless it is 0
+	 */
+	u32 speed_khz;
+};
+
+/** @brief One step of a batch, see mtk_os_hal_spim_device_batch(). */
+struct mtk_spi_op {
+	/** what the step does */
+	spim_op_type type;
+	/** opcode of the transaction */
+	u32 opcode;
+	/** opcode length, 0~4 bytes */
+	u32 opcode_len;
+	/** data to send or receive */
+	void *buf;
+	/** data length in bytes.
+	 * FIFO: up to 32 bytes, 33 for a write without opcode (the first byte
+	 * is sent as opcode). DMA: any length, see
+	 * mtk_os_hal_spim_stream_transfer().
+	 */
+	u32 len;
+	/** 0: FIFO, 1: DMA stream */
+	u32 use_dma;
+	/** OS_HAL_SPIM_OP_HOOK only */
+	spi_op_hook hook;
+	/** OS_HAL_SPIM_OP_HOOK only: the argument of hook() */
+	void *arg;
+};
+
+/** @brief One queued transaction of a device.
+ * Every transfer on a bus, whichever API issued it, goes through a FIFO
+ * of messages and runs when the previous one has completed, so devices
+ * sharing an ISU never collide.\n
+ * The caller owns the memory, it must stay valid until complete()
+ * is called.
+ */
+struct mtk_spi_message {
+	/** the transfer to run */
+	struct mtk_spi_transfer *xfer;
+	/** 1: run xfer with the DMA stream engine, see
+	 * mtk_os_hal_spim_stream_transfer()
+	 */
+	u8 stream;
+	/** batch: run op_cnt ops back to back instead of xfer */
+	struct mtk_spi_op *ops;
+	/** number of ops */
+	u32 op_cnt;
+	/** full-duplex stream: repeat its transaction until
+	 * mtk_os_hal_spim_duplex_stop(), instead of xfer. DMA mode only.
+	 */
+	struct mtk_spi_duplex *duplex;
+	/** full-duplex stream only: called for each full frame */
+	spi_frame_callback frame_done;
+	/** called in interrupt context when the message is done */
+	spi_usr_complete_callback complete;
+	/** the argument to complete() when it's called */
+	void *context;
+	/** result, valid in complete(): 0 or a negative error code */
+	int status;
+	/** bytes transferred, valid in complete(): xfer->len or 0
+	 * (always 0 for a duplex stream)
+	 */
+	u32 count;
+
+	/** device the message is submitted to, set by the driver */
+	struct mtk_spi_device *dev;
+	/** HW setting of the message, set by the driver */
+	struct mtk_spi_config *config;
+	/** message is queued or on the wire, set by the driver */
+	u8 pending;
+	/** next message in the bus FIFO, set by the driver */
+	struct mtk_spi_message *next;
+};
+
 /**
   * @}
   */
@@ -255,6 +462,222 @@ int mtk_os_hal_spim_async_transfer(spim_num bus_num,
 				   spi_usr_complete_callback complete,
 				   void *context);
 
+/**
+ * @brief  use DMA mode to do one blocking half-duplex transfer of any length.
+ *
+ *  The buffer is cut into 32-byte segments that are chained from interrupt
+ *  context: while one segment is on the wire the next one is already built,
+ *  and the caller is woken up once when the last segment completes.\n
+ *  Chip select is released between segments, so the device must accept
+ *  the data as a series of independent transactions (e.g. display RAM
+ *  writes). See #mtk_mhal_spim_dma_stream_start() for the segment format.
+ *
+ *  @param [in] bus_num : SPIM ISU Port number,
+ *  it can be OS_HAL_SPIM_ISU0~OS_HAL_SPIM_ISU4
+ *  @param [in] config : the HW setting
+ *  @param [in] xfer : either tx_buf or rx_buf (DMA-safe memory) is set,
+ *  xfer->len may be larger than 32 bytes. xfer->use_dma is ignored.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_stream_transfer(spim_num bus_num,
+				    struct mtk_spi_config *config,
+				    struct mtk_spi_transfer *xfer);
+
+/**
+ * @brief  asynchronous version of mtk_os_hal_spim_stream_transfer().
+ *
+ *  @param [in] bus_num : SPIM ISU Port number,
+ *  it can be OS_HAL_SPIM_ISU0~OS_HAL_SPIM_ISU4
+ *  @param [in] config : the HW setting
+ *  @param [in] xfer : the stream, it must stay valid until complete().
+ * @param [in] complete : called once when the whole stream is done
+ * @param [in] context : the argument to complete() when it's called
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_async_stream_transfer(spim_num bus_num,
+					  struct mtk_spi_config *config,
+					  struct mtk_spi_transfer *xfer,
+					  spi_usr_complete_callback complete,
+					  void *context);
+
+/**
+ * @brief  Bind a HW setting to a device handle.
+ *
+ *  The setting is copied into the handle, to change it call this function
+ *  again rather than modifying dev->config.
+ *
+ *  @param [in] dev : the device handle to initialize.
+ *  @param [in] bus_num : SPIM ISU Port number,
+ *  it can be OS_HAL_SPIM_ISU0~OS_HAL_SPIM_ISU4
+ *  @param [in] config : the HW setting of the device.
+ *  @param [in] speed_khz : bus clock of the device,
+ *  0 keeps mtk_spi_transfer->speed_khz of each transfer.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_device_init(struct mtk_spi_device *dev,
+				spim_num bus_num,
+				struct mtk_spi_config *config,
+				u32 speed_khz);
+
+/**
+ * @brief  same as mtk_os_hal_spim_transfer() with the setting of dev.
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] xfer : the data should be read/writen.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_device_transfer(struct mtk_spi_device *dev,
+				    struct mtk_spi_transfer *xfer);
+
+/**
+ * @brief  same as mtk_os_hal_spim_async_transfer() with the setting of dev.
+ *
+ *  Each bus has one slot for mtk_os_hal_spim_async_transfer() and this
+ *  function, -SPIM_EBUSY is returned while it is in use. Use
+ *  mtk_os_hal_spim_device_submit() to queue more transfers.
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] xfer : the data should be read/writen.
+ * @param [in] complete : called to report transaction completions
+ * @param [in] context : the argument to complete() when it's called
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_device_async_transfer(struct mtk_spi_device *dev,
+					  struct mtk_spi_transfer *xfer,
+					  spi_usr_complete_callback complete,
+					  void *context);
+
+/**
+ * @brief  queue a message of dev at the tail of the bus FIFO.
+ *
+ *  The message starts immediately if the bus is idle, otherwise from the
+ *  interrupt that completes the message ahead of it. Consecutive messages
+ *  of the same device do not re-program the controller.\n
+ *  It can be called from a complete() callback.
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] msg : xfer, stream, complete and context must be set,
+ *  complete must not be NULL.
+ *
+ *  @return negative value means fail, complete() will not be called.
+ *  @return 0 means the message is queued.
+ */
+int mtk_os_hal_spim_device_submit(struct mtk_spi_device *dev,
+				  struct mtk_spi_message *msg);
+
+/**
+ * @brief  Set the polled transfer length of a bus.
+ *
+ *  Blocking FIFO transfers with at most len data bytes, issued while the
+ *  bus is idle, are polled instead of waiting for the SPIM irq. Longer,
+ *  DMA, stream and asynchronous transfers always use the irq path.
+ *
+ *  @param [in] bus_num : SPIM ISU Port number,
+ *  it can be OS_HAL_SPIM_ISU0~OS_HAL_SPIM_ISU4
+ *  @param [in] len : 0~32 bytes, 0 disables polling on this bus.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_set_poll_len(spim_num bus_num, u32 len);
+
+/**
+ * @brief  Run a list of ops of dev as one blocking job.
+ *
+ *  Every op after the first is started from the interrupt that completes
+ *  the previous one, hooks run in between, and the task is woken once at
+ *  the end. A display "command list" such as set_window is typically:
+ *  HOOK (D/C low), WRITE_OPCODE (command), HOOK (D/C high), WRITE (params).
+ *  The batch stops at the first op that fails to start.\n
+ *  A WRITE or READ op with a NULL buf or a len of 0 rejects the whole
+ *  batch before anything is sent.\n
+ *  For the asynchronous variant set msg->ops/op_cnt and call
+ *  mtk_os_hal_spim_device_submit().
+ *
+ *  @param [in] dev : the device handle.
+ *  @param [in] ops : the ops, they must stay valid until the call returns.
+ *  @param [in] op_cnt : number of ops.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_device_batch(struct mtk_spi_device *dev,
+				 struct mtk_spi_op *ops, u32 op_cnt);
+
+/**
+ * @brief  Stop the full-duplex stream running on a bus.
+ *
+ *  A full-duplex stream is started by setting msg->duplex and
+ *  msg->frame_done and calling mtk_os_hal_spim_device_submit(). It holds
+ *  the bus, every transaction is chained from the RX DMA interrupt, and
+ *  messages submitted meanwhile wait until it ends. This call returns at
+ *  once: the transaction on the wire is the last one, a partly filled
+ *  frame is dropped, then msg->complete() is called.
+ *
+ *  @param [in] bus_num : SPI master number.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means the stop is requested.
+ */
+int mtk_os_hal_spim_duplex_stop(spim_num bus_num);
+
+/**
+ * @brief  Select where complete() of the async transfers of a bus runs.
+ *
+ *  OS_HAL_SPIM_COMPLETE_ISR (default) calls it from the SPIM or DMA
+ *  interrupt, with the lowest latency.\n
+ *  OS_HAL_SPIM_COMPLETE_TASK only records the message, status and byte
+ *  count in a lock-free per-bus ring and wakes the completion worker,
+ *  so user code never runs at interrupt priority. The bus goes on with
+ *  the next queued message meanwhile, and the message stays pending until
+ *  its complete() has been called.\n
+ *  On FreeRTOS the worker is one task shared by all buses, created the
+ *  first time this mode is selected. Without an OS the application must
+ *  call mtk_os_hal_spim_process_completions() from its main loop.
+ *
+ *  @param [in] bus_num : SPIM ISU Port number,
+ *  it can be OS_HAL_SPIM_ISU0~OS_HAL_SPIM_ISU4
+ *  @param [in] mode : OS_HAL_SPIM_COMPLETE_ISR or OS_HAL_SPIM_COMPLETE_TASK
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_set_complete_mode(spim_num bus_num,
+				      spim_complete_mode mode);
+
+/**
+ * @brief  Call the deferred completions of all buses.
+ *
+ *  It is the body of the completion worker, bare-metal applications call
+ *  it from their main loop. It must not be called concurrently.
+ *
+ *  @return the number of completions called.
+ */
+int mtk_os_hal_spim_process_completions(void);
+
+/**
+ * @brief  Get how many deferred completions of a bus were called in
+ *  interrupt context because the ring was full.
+ *
+ *  @param [in] bus_num : SPIM ISU Port number,
+ *  it can be OS_HAL_SPIM_ISU0~OS_HAL_SPIM_ISU4
+ *  @param [out] count : the overflow count.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spim_get_complete_overflow(spim_num bus_num, u32 *count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,306 @@
+/*
+ * (C) 2005-2020 MediaTek Inc. All rights reserved.
+ *
+ * Copyright Statement:
+ *
+ * This MT3620 driver software/firmware and related documentation
+ * ("MediaTek Software") are protected under relevant copyright laws.
+ * The information contained herein is confidential and proprietary to
+ * MediaTek Inc. ("MediaTek"). You may only use, reproduce, modify, or
+ * distribute (as applicable) MediaTek Software if you have agreed to and been
+ * bound by this Statement and the applicable license agreement with MediaTek
+ * ("License Agreement") and been granted explicit permission to do so within
+ * the License Agreement ("Permitted User"). If you are not a Permitted User,
+ * please cease any access or use of MediaTek Software immediately.
+ *
+ * BY OPENING THIS FILE, RECEIVER HEREBY UNEQUIVOCALLY ACKNOWLEDGES AND AGREES
+ * THAT MEDIATEK SOFTWARE RECEIVED FROM MEDIATEK AND/OR ITS REPRESENTATIVES ARE
+ * PROVIDED TO RECEIVER ON AN "AS-IS" BASIS ONLY. MEDIATEK EXPRESSLY DISCLAIMS
+ * ANY AND ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE OR
+ * NONINFRINGEMENT. NEITHER DOES MEDIATEK PROVIDE ANY WARRANTY WHATSOEVER WITH
+ * RESPECT TO THE SOFTWARE OF ANY THIRD PARTY WHICH MAY BE USED BY,
+ * INCORPORATED IN, OR SUPPLIED WITH MEDIATEK SOFTWARE, AND RECEIVER AGREES TO
+ * LOOK ONLY TO SUCH THIRD PARTY FOR ANY WARRANTY CLAIM RELATING THERETO.
+ * RECEIVER EXPRESSLY ACKNOWLEDGES THAT IT IS RECEIVER'S SOLE RESPONSIBILITY TO
+ * OBTAIN FROM ANY THIRD PARTY ALL PROPER LICENSES CONTAINED IN MEDIATEK
+ * SOFTWARE. MEDIATEK SHALL ALSO NOT BE RESPONSIBLE FOR ANY MEDIATEK SOFTWARE
+ * RELEASES MADE TO RECEIVER'S SPECIFICATION OR TO CONFORM TO A PARTICULAR
+ * STANDARD OR OPEN FORUM. RECEIVER'S SOLE AND EXCLUSIVE REMEDY AND MEDIATEK'S
+ * ENTIRE AND CUMULATIVE LIABILITY WITH RESPECT TO MEDIATEK SOFTWARE RELEASED
+ * HEREUNDER WILL BE ANY SOFTWARE LICENSE FEES OR SERVICE CHARGE PAID BY
+ * RECEIVER TO MEDIATEK DURING THE PRECEDING TWELVE (12) MONTHS FOR SUCH
+ * MEDIATEK SOFTWARE AT ISSUE.
+ */
+
+#ifndef __OS_HAL_SPIS_H__
+#define __OS_HAL_SPIS_H__
+
+#include "mhal_spis.h"
+
+/**
+ * @addtogroup OS-HAL
+ * @{
+ * @addtogroup spis
+ * @{
+ * This section introduces the Serial Peripheral Interface Slave (SPIS) APIs
+ * including terms and acronyms, supported features,
+ * details on how to use this driver, enums, structures and functions.
+ *
+ * @section OS_HAL_SPIS_Terms_Chapter Terms and Acronyms
+ *
+ * |Terms                   |Details                             |
+ * |------------------------------|--|
+ * |\b DMA                        | Direct Memory Access.|
+ * |\b FIFO                       | First In, First Out.|
+ * |\b H2DMB                      | Host to device mailbox, see @ref SPIS.|
+ * |\b SPI                        | Serial Peripheral Interface.|
+ *
+ * @section OS_HAL_SPIS_Features_Chapter Supported Features
+ * See @ref MHAL_SPIS_Features_Chapter for the details of  Supported Features.
+ * On top of them this driver:
+ * 1. Receives every frame the host writes into an RX ring of DMA-safe
+ *    slots, the DMA writes the slot directly.
+ * 2. Answers every host read from a TX ring of queued frames, or from a
+ *    pre-loaded response when the ring is empty, so the reply is ready
+ *    as soon as the H2DMB arrives.
+ * 3. Calls a per-frame callback in interrupt context for both.
+ *
+ * The M-HAL/HDL implementation of SPIS (mhal_spis.c) is not part of this
+ * package yet, this driver is built on the M-HAL interface declared in
+ * mhal_spis.h and links once it is provided. Until then
+ * MT3620_M4_Host_Test runs it against a stub of that interface.
+ *
+ * @}
+ * @}
+ */
+
+/**
+ * @addtogroup OS-HAL
+ * @{
+ * @addtogroup spis
+ * @{
+ * @section OS_HAL_SPIS_Driver_Usage_Chapter How to use this driver
+ *
+ * - \b Device \b driver \b sample \b code \b is \b as \b follows: \n
+ *  - sample code (this is the user application sample code on freeRTos):
+ *    @code
+ *	- init SPIS
+ *	 -Call mtk_os_hal_spis_ctlr_init(spis_num bus_num,
+				struct mtk_spis_config *config)
+ *
+ *	- Get notified per frame (optional)
+ *	 -Call mtk_os_hal_spis_register_callback(spis_num bus_num,
+				spis_rx_frame_callback rx_done,
+				spis_tx_frame_callback tx_done,
+				void *context)
+ *
+ *	- Prepare what the host reads
+ *	 -Call mtk_os_hal_spis_set_response(spis_num bus_num,
+				const u8 *buf, u32 len) once, and/or
+ *	 -Call mtk_os_hal_spis_write(spis_num bus_num,
+				const u8 *buf, u32 len) per frame
+ *
+ *	- Fetch what the host wrote
+ *	 -Call mtk_os_hal_spis_read(spis_num bus_num, u8 *buf, u32 len)
+ *
+ *	- uninit SPIS
+ *	 -Call mtk_os_hal_spis_ctlr_deinit(spis_num bus_num)
+ *
+ *    @endcode
+ *
+ * @}
+ * @}
+ */
+
+/**
+* @addtogroup OS-HAL
+* @{
+* @addtogroup spis
+* @{
+*/
+
+/** @defgroup os_hal_spis_define Define
+  * @{
+  * This section introduces the build time settings of SPIS OS-HAL.
+  */
+
+/** Largest frame of one H2DMB transaction: 8 double words */
+#define MTK_SPIS_FRAME_BYTES	32
+
+/** Frames each of the RX and TX rings holds, it must be a power of two */
+#ifndef MTK_SPIS_RING_FRAMES
+#define MTK_SPIS_RING_FRAMES	8
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_spis_enum Enum
+  * @{
+  * This section introduces the enumerations of SPIS OS-HAL.
+  */
+
+typedef enum {
+	/** Use ISU0 as SPIS port */
+	OS_HAL_SPIS_ISU0 = 0,
+	/** Use ISU1 as SPIS port */
+	OS_HAL_SPIS_ISU1 = 1,
+	/** Use ISU2 as SPIS port */
+	OS_HAL_SPIS_ISU2 = 2,
+	/** Use ISU3 as SPIS port */
+	OS_HAL_SPIS_ISU3 = 3,
+	/** Use ISU4 as SPIS port */
+	OS_HAL_SPIS_ISU4 = 4,
+	/** The maximum ISU number (invalid) */
+	OS_HAL_SPIS_ISU_MAX
+} spis_num;
+
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_spis_typedef Typedef
+  * @{
+  * This section introduces the callbacks of SPIS OS-HAL.
+  */
+
+/** @brief This defines the callback of a frame written by the host.
+ * It's called in interrupt context. frame is the RX ring slot, it stays
+ * valid until it is consumed by mtk_os_hal_spis_read().
+ *
+ * @param [in] context : the context given at registration.
+ * @param [in] frame : the frame received.
+ * @param [in] len : bytes of the frame.
+ */
+typedef void (*spis_rx_frame_callback) (void *context, u8 *frame, u32 len);
+
+/** @brief This defines the callback of a frame read by the host.
+ * It's called in interrupt context, e.g. to queue the next reply.
+ *
+ * @param [in] context : the context given at registration.
+ * @param [in] len : bytes the host has read.
+ */
+typedef void (*spis_tx_frame_callback) (void *context, u32 len);
+
+/**
+  * @}
+  */
+
+/** @defgroup os_hal_spis_function Function
+  * @{
+   * This section provides high level APIs to upper layer.
+  */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  Init the SPIS controller and its rings, and wait for the host.
+ *
+ *  @param [in] bus_num : SPIS ISU Port number,
+ *  it can be OS_HAL_SPIS_ISU0~OS_HAL_SPIS_ISU4.
+ *  @param [in] config : the clock mode the host uses.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spis_ctlr_init(spis_num bus_num,
+			      struct mtk_spis_config *config);
+
+/**
+ * @brief  Deinit the SPIS controller and free its rings.
+ *
+ *  @param [in] bus_num : SPIS ISU Port number.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spis_ctlr_deinit(spis_num bus_num);
+
+/**
+ * @brief  Register the per-frame callbacks.
+ *
+ *  @param [in] bus_num : SPIS ISU Port number.
+ *  @param [in] rx_done : called for each frame the host wrote, or NULL.
+ *  @param [in] tx_done : called for each frame the host read, or NULL.
+ *  @param [in] context : the argument to the callbacks.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spis_register_callback(spis_num bus_num,
+				      spis_rx_frame_callback rx_done,
+				      spis_tx_frame_callback tx_done,
+				      void *context);
+
+/**
+ * @brief  Take the oldest frame the host wrote out of the RX ring.
+ *
+ *  @param [in] bus_num : SPIS ISU Port number.
+ *  @param [out] buf : where the frame is copied.
+ *  @param [in] len : size of buf, a longer frame is truncated.
+ *
+ *  @return negative value means fail.
+ *  @return the bytes copied, 0 if the RX ring is empty.
+ */
+int mtk_os_hal_spis_read(spis_num bus_num, u8 *buf, u32 len);
+
+/**
+ * @brief  Queue a frame for the next host read.
+ *
+ *  Queued frames are sent in order, one per host read. If the host reads
+ *  fewer bytes than queued, the rest of the frame is dropped.
+ *
+ *  @param [in] bus_num : SPIS ISU Port number.
+ *  @param [in] buf : the frame.
+ *  @param [in] len : 1~#MTK_SPIS_FRAME_BYTES bytes.
+ *
+ *  @return negative value means fail, -#EBUSY if the TX ring is full.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spis_write(spis_num bus_num, const u8 *buf, u32 len);
+
+/**
+ * @brief  Pre-load the reply sent while the TX ring is empty.
+ *
+ *  E.g. a status word the host polls. It is sent without any CPU work at
+ *  read time, as often as the host reads it, until it is replaced.
+ *
+ *  @param [in] bus_num : SPIS ISU Port number.
+ *  @param [in] buf : the reply.
+ *  @param [in] len : 0~#MTK_SPIS_FRAME_BYTES bytes, the rest is zero.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spis_set_response(spis_num bus_num, const u8 *buf, u32 len);
+
+/**
+ * @brief  Get the number of host writes dropped because the RX ring was
+ *  full.
+ *
+ *  @param [in] bus_num : SPIS ISU Port number.
+ *  @param [out] count : dropped frames since init.
+ *
+ *  @return negative value means fail.
+ *  @return 0 means success.
+ */
+int mtk_os_hal_spis_get_overrun(spis_num bus_num, u32 *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+  * @}
+  */
+
+/**
+* @}
+* @}
+*/
+
+#endif
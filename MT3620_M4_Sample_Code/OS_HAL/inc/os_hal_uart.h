@@ -121,6 +121,10 @@
  *        - Call mtk_os_hal_uart_dma_get_data(UART_PORT port_num,
  *          u8 *data, u32 len, bool vff_mode, u32 timeout)
  *
+ *      - End VFF DMA receives on an idle line
+ *        - Call mtk_os_hal_uart_dma_set_rx_timeout(UART_PORT port_num,
+ *          u32 timeout_cnt)
+ *
  *    @endcode
  *
  *
@@ -342,7 +346,10 @@ int mtk_os_hal_uart_dma_send_data(UART_PORT port_num,
 
 /**
  * @brief  Get UART data in DMA mode. This function will return when :
- *    "Error detected" or "timeout" or "RX DMA completed".
+ *    "Error detected" or "timeout" or "RX DMA completed".\n
+ *    In VFF mode with an RX timeout set by\n
+ *    mtk_os_hal_uart_dma_set_rx_timeout(), it also returns once the line\n
+ *    has been idle for that long, with less than len bytes.
  *
  *  @param [in] bus_num : UART Port number,
  *  it can be OS_HAL_UART_PORT0~OS_HAL_UART_ISU4.
@@ -356,6 +363,23 @@ int mtk_os_hal_uart_dma_send_data(UART_PORT port_num,
 int mtk_os_hal_uart_dma_get_data(UART_PORT port_num,
 	u8 *data, u32 len, bool vff_mode, u32 timeout);
 
+/**
+ * @brief  Set the idle time that ends a VFF mode DMA receive.\n
+ *    The VFF DMA raises its timeout interrupt when no byte came in for\n
+ *    timeout_cnt DMA bus clock cycles after the last one, and\n
+ *    mtk_os_hal_uart_dma_get_data() returns the bytes received so far\n
+ *    instead of waiting for len bytes or its own timeout.\n
+ *    It applies to the receives started after the call.
+ *
+ *  @param [in] bus_num : UART Port number,
+ *  it can be OS_HAL_UART_ISU0~OS_HAL_UART_ISU4.
+ *  @param [in] timeout_cnt : idle time in DMA bus clock cycles,
+ *  0 disables it (the default).
+ *
+ *  @return 0 on success, -#UART_EPTR if the port is invalid.
+ */
+int mtk_os_hal_uart_dma_set_rx_timeout(UART_PORT port_num, u32 timeout_cnt);
+
 #ifdef __cplusplus
 }
 #endif
@@ -362,3 +362,30 @@ int mtk_os_hal_adc_period_stop(void)
 	return ret;
 }
 
+int mtk_os_hal_adc_set_rx_timeout(u32 timeout_cnt)
+{
+	struct mtk_adc_controller_rtos *ctlr_rtos;
+
+	ctlr_rtos =	_mtk_os_hal_adc_get_ctlr();
+	if (!ctlr_rtos || !ctlr_rtos->ctlr)
+		return -ADC_EPTR;
+
+	ctlr_rtos->ctlr->rx_timeout = timeout_cnt;
+
+	return 0;
+}
+
+int mtk_os_hal_adc_get_rx_info(u32 *offset, u32 *len)
+{
+	struct mtk_adc_controller_rtos *ctlr_rtos;
+
+	ctlr_rtos =	_mtk_os_hal_adc_get_ctlr();
+	if (!ctlr_rtos || !ctlr_rtos->ctlr || !offset || !len)
+		return -ADC_EPTR;
+
+	/* each sample takes 4 bytes */
+	*offset = ctlr_rtos->ctlr->rx_pos / 4;
+	*len = ctlr_rtos->ctlr->rx_len / 4;
+
+	return 0;
+}
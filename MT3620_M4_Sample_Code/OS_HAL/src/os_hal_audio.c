@@ -0,0 +1,673 @@
+/*
+ * (C) 2005-2020 MediaTek Inc. All rights reserved.
+ *
+ * Copyright Statement:
+ *
+ * This MT3620 driver software/firmware and related documentation
+ * ("MediaTek Software") are protected under relevant copyright laws.
+ * The information contained herein is confidential and proprietary to
+ * MediaTek Inc. ("MediaTek"). You may only use, reproduce, modify, or
+ * distribute (as applicable) MediaTek Software if you have agreed to and been
+ * bound by this Statement and the applicable license agreement with MediaTek
+ * ("License Agreement") and been granted explicit permission to do so within
+ * the License Agreement ("Permitted User"). If you are not a Permitted User,
+ * please cease any access or use of MediaTek Software immediately.
+ *
+ * BY OPENING THIS FILE, RECEIVER HEREBY UNEQUIVOCALLY ACKNOWLEDGES AND AGREES
+ * THAT MEDIATEK SOFTWARE RECEIVED FROM MEDIATEK AND/OR ITS REPRESENTATIVES ARE
+ * PROVIDED TO RECEIVER ON AN "AS-IS" BASIS ONLY. MEDIATEK EXPRESSLY DISCLAIMS
+ * ANY AND ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE OR
+ * NONINFRINGEMENT. NEITHER DOES MEDIATEK PROVIDE ANY WARRANTY WHATSOEVER WITH
+ * RESPECT TO THE SOFTWARE OF ANY THIRD PARTY WHICH MAY BE USED BY,
+ * INCORPORATED IN, OR SUPPLIED WITH MEDIATEK SOFTWARE, AND RECEIVER AGREES TO
+ * LOOK ONLY TO SUCH THIRD PARTY FOR ANY WARRANTY CLAIM RELATING THERETO.
+ * RECEIVER EXPRESSLY ACKNOWLEDGES THAT IT IS RECEIVER'S SOLE RESPONSIBILITY TO
+ * OBTAIN FROM ANY THIRD PARTY ALL PROPER LICENSES CONTAINED IN MEDIATEK
+ * SOFTWARE. MEDIATEK SHALL ALSO NOT BE RESPONSIBLE FOR ANY MEDIATEK SOFTWARE
+ * RELEASES MADE TO RECEIVER'S SPECIFICATION OR TO CONFORM TO A PARTICULAR
+ * STANDARD OR OPEN FORUM. RECEIVER'S SOLE AND EXCLUSIVE REMEDY AND MEDIATEK'S
+ * ENTIRE AND CUMULATIVE LIABILITY WITH RESPECT TO MEDIATEK SOFTWARE RELEASED
+ * HEREUNDER WILL BE ANY SOFTWARE LICENSE FEES OR SERVICE CHARGE PAID BY
+ * RECEIVER TO MEDIATEK DURING THE PRECEDING TWELVE (12) MONTHS FOR SUCH
+ * MEDIATEK SOFTWARE AT ISSUE.
+ */
+
+
+#include <string.h>
+#include "mt3620.h"
+#include "os_hal_audio.h"
+
+/* 1: use the Cortex-M4 DSP instructions, 0: use the C reference */
+#ifndef MTK_AUDIO_SIMD
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define MTK_AUDIO_SIMD 1
+#else
+#define MTK_AUDIO_SIMD 0
+#endif
+#endif
+
+static inline int16_t _mtk_os_hal_audio_sat16(int32_t val)
+{
+	if (val > INT16_MAX)
+		return INT16_MAX;
+	if (val < INT16_MIN)
+		return INT16_MIN;
+	return (int16_t)val;
+}
+
+void mtk_os_hal_audio_s16_to_s32_ref(const int16_t *src, int32_t *dst,
+				     u32 cnt)
+{
+	u32 i;
+
+	for (i = 0; i < cnt; i++)
+		dst[i] = (int32_t)((u32)(u16)src[i] << 16);
+}
+
+void mtk_os_hal_audio_s32_to_s16_ref(const int32_t *src, int16_t *dst,
+				     u32 cnt)
+{
+	u32 i;
+
+	for (i = 0; i < cnt; i++)
+		dst[i] = (int16_t)(src[i] >> 16);
+}
+
+void mtk_os_hal_audio_deinterleave_s16_ref(const int16_t *src,
+					   int16_t *left, int16_t *right,
+					   u32 frames)
+{
+	u32 i;
+
+	for (i = 0; i < frames; i++) {
+		left[i] = src[2 * i];
+		right[i] = src[2 * i + 1];
+	}
+}
+
+void mtk_os_hal_audio_interleave_s16_ref(const int16_t *left,
+					 const int16_t *right, int16_t *dst,
+					 u32 frames)
+{
+	u32 i;
+
+	for (i = 0; i < frames; i++) {
+		dst[2 * i] = left[i];
+		dst[2 * i + 1] = right[i];
+	}
+}
+
+void mtk_os_hal_audio_gain_s16_ref(const int16_t *src, int16_t *dst,
+				   u32 cnt, int16_t gain, u8 shift)
+{
+	u32 rs = shift < 15 ? 15 - shift : 0;
+	u32 i;
+
+	for (i = 0; i < cnt; i++)
+		dst[i] = _mtk_os_hal_audio_sat16(
+				((int32_t)src[i] * gain) >> rs);
+}
+
+void mtk_os_hal_audio_mix_s16_ref(const int16_t *a, const int16_t *b,
+				  int16_t *dst, u32 cnt)
+{
+	u32 i;
+
+	for (i = 0; i < cnt; i++)
+		dst[i] = _mtk_os_hal_audio_sat16((int32_t)a[i] + b[i]);
+}
+
+void mtk_os_hal_audio_mix_gain_s16_ref(const int16_t *a, const int16_t *b,
+				       int16_t *dst, u32 cnt,
+				       int16_t gain_a, int16_t gain_b)
+{
+	int32_t acc;
+	u32 i;
+
+	for (i = 0; i < cnt; i++) {
+		/* wraps like the 32-bit accumulator of SMLAD */
+		acc = (int32_t)((u32)((int32_t)a[i] * gain_a) +
+				(u32)((int32_t)b[i] * gain_b));
+		dst[i] = _mtk_os_hal_audio_sat16(acc >> 15);
+	}
+}
+
+#if MTK_AUDIO_SIMD
+/* two 16-bit samples as one word, buffers may be unaligned */
+static inline u32 _mtk_os_hal_audio_rd2(const int16_t *p)
+{
+	u32 val;
+
+	memcpy(&val, p, sizeof(val));
+	return val;
+}
+
+static inline void _mtk_os_hal_audio_wr2(int16_t *p, u32 val)
+{
+	memcpy(p, &val, sizeof(val));
+}
+
+void mtk_os_hal_audio_s16_to_s32(const int16_t *src, int32_t *dst, u32 cnt)
+{
+	u32 pair;
+
+	for (; cnt >= 2; cnt -= 2, src += 2, dst += 2) {
+		pair = _mtk_os_hal_audio_rd2(src);
+		dst[0] = (int32_t)(pair << 16);
+		dst[1] = (int32_t)(pair & 0xffff0000);
+	}
+	if (cnt)
+		mtk_os_hal_audio_s16_to_s32_ref(src, dst, cnt);
+}
+
+void mtk_os_hal_audio_s32_to_s16(const int32_t *src, int16_t *dst, u32 cnt)
+{
+	for (; cnt >= 2; cnt -= 2, src += 2, dst += 2)
+		_mtk_os_hal_audio_wr2(dst, __PKHTB((u32)src[1],
+						   (u32)src[0], 16));
+	if (cnt)
+		mtk_os_hal_audio_s32_to_s16_ref(src, dst, cnt);
+}
+
+void mtk_os_hal_audio_deinterleave_s16(const int16_t *src, int16_t *left,
+				       int16_t *right, u32 frames)
+{
+	u32 lr0, lr1;
+
+	for (; frames >= 2; frames -= 2, src += 4, left += 2, right += 2) {
+		lr0 = _mtk_os_hal_audio_rd2(src);
+		lr1 = _mtk_os_hal_audio_rd2(src + 2);
+		_mtk_os_hal_audio_wr2(left, __PKHBT(lr0, lr1, 16));
+		_mtk_os_hal_audio_wr2(right, __PKHTB(lr1, lr0, 16));
+	}
+	if (frames)
+		mtk_os_hal_audio_deinterleave_s16_ref(src, left, right,
+						      frames);
+}
+
+void mtk_os_hal_audio_interleave_s16(const int16_t *left,
+				     const int16_t *right, int16_t *dst,
+				     u32 frames)
+{
+	u32 l, r;
+
+	for (; frames >= 2; frames -= 2, left += 2, right += 2, dst += 4) {
+		l = _mtk_os_hal_audio_rd2(left);
+		r = _mtk_os_hal_audio_rd2(right);
+		_mtk_os_hal_audio_wr2(dst, __PKHBT(l, r, 16));
+		_mtk_os_hal_audio_wr2(dst + 2, __PKHTB(r, l, 16));
+	}
+	if (frames)
+		mtk_os_hal_audio_interleave_s16_ref(left, right, dst, frames);
+}
+
+void mtk_os_hal_audio_gain_s16(const int16_t *src, int16_t *dst, u32 cnt,
+			       int16_t gain, u8 shift)
+{
+	/* SMUAD with one half of the gain zero is a single multiply */
+	u32 gain_lo = (u16)gain;
+	u32 gain_hi = gain_lo << 16;
+	u32 rs = shift < 15 ? 15 - shift : 0;
+	u32 pair, s0, s1;
+
+	for (; cnt >= 2; cnt -= 2, src += 2, dst += 2) {
+		pair = _mtk_os_hal_audio_rd2(src);
+		s0 = __SSAT((int32_t)__SMUAD(pair, gain_lo) >> rs, 16);
+		s1 = __SSAT((int32_t)__SMUAD(pair, gain_hi) >> rs, 16);
+		_mtk_os_hal_audio_wr2(dst, __PKHBT(s0, s1, 16));
+	}
+	if (cnt)
+		mtk_os_hal_audio_gain_s16_ref(src, dst, cnt, gain, shift);
+}
+
+void mtk_os_hal_audio_mix_s16(const int16_t *a, const int16_t *b,
+			      int16_t *dst, u32 cnt)
+{
+	for (; cnt >= 2; cnt -= 2, a += 2, b += 2, dst += 2)
+		_mtk_os_hal_audio_wr2(dst,
+				      __QADD16(_mtk_os_hal_audio_rd2(a),
+					       _mtk_os_hal_audio_rd2(b)));
+	if (cnt)
+		mtk_os_hal_audio_mix_s16_ref(a, b, dst, cnt);
+}
+
+void mtk_os_hal_audio_mix_gain_s16(const int16_t *a, const int16_t *b,
+				   int16_t *dst, u32 cnt,
+				   int16_t gain_a, int16_t gain_b)
+{
+	u32 gains = (u16)gain_a | ((u32)(u16)gain_b << 16);
+	u32 pa, pb, s0, s1;
+
+	for (; cnt >= 2; cnt -= 2, a += 2, b += 2, dst += 2) {
+		pa = _mtk_os_hal_audio_rd2(a);
+		pb = _mtk_os_hal_audio_rd2(b);
+		/* pair a[n] with b[n], one dual multiply-add per sample */
+		s0 = __SSAT((int32_t)__SMLAD(__PKHBT(pa, pb, 16), gains, 0)
+			    >> 15, 16);
+		s1 = __SSAT((int32_t)__SMLAD(__PKHTB(pb, pa, 16), gains, 0)
+			    >> 15, 16);
+		_mtk_os_hal_audio_wr2(dst, __PKHBT(s0, s1, 16));
+	}
+	if (cnt)
+		mtk_os_hal_audio_mix_gain_s16_ref(a, b, dst, cnt,
+						  gain_a, gain_b);
+}
+#else
+void mtk_os_hal_audio_s16_to_s32(const int16_t *src, int32_t *dst, u32 cnt)
+{
+	mtk_os_hal_audio_s16_to_s32_ref(src, dst, cnt);
+}
+
+void mtk_os_hal_audio_s32_to_s16(const int32_t *src, int16_t *dst, u32 cnt)
+{
+	mtk_os_hal_audio_s32_to_s16_ref(src, dst, cnt);
+}
+
+void mtk_os_hal_audio_deinterleave_s16(const int16_t *src, int16_t *left,
+				       int16_t *right, u32 frames)
+{
+	mtk_os_hal_audio_deinterleave_s16_ref(src, left, right, frames);
+}
+
+void mtk_os_hal_audio_interleave_s16(const int16_t *left,
+				     const int16_t *right, int16_t *dst,
+				     u32 frames)
+{
+	mtk_os_hal_audio_interleave_s16_ref(left, right, dst, frames);
+}
+
+void mtk_os_hal_audio_gain_s16(const int16_t *src, int16_t *dst, u32 cnt,
+			       int16_t gain, u8 shift)
+{
+	mtk_os_hal_audio_gain_s16_ref(src, dst, cnt, gain, shift);
+}
+
+void mtk_os_hal_audio_mix_s16(const int16_t *a, const int16_t *b,
+			      int16_t *dst, u32 cnt)
+{
+	mtk_os_hal_audio_mix_s16_ref(a, b, dst, cnt);
+}
+
+void mtk_os_hal_audio_mix_gain_s16(const int16_t *a, const int16_t *b,
+				   int16_t *dst, u32 cnt,
+				   int16_t gain_a, int16_t gain_b)
+{
+	mtk_os_hal_audio_mix_gain_s16_ref(a, b, dst, cnt, gain_a, gain_b);
+}
+#endif
+
+/* frames rendered per pass, the mixer sum of a pass lives on the stack */
+#ifndef MTK_AUDIO_MIX_CHUNK
+#define MTK_AUDIO_MIX_CHUNK	32
+#endif
+
+#define AUDIO_PI	3.14159265f
+
+/* only used by the filter design, good to ~1e-7 so no libm is needed */
+static float _mtk_os_hal_audio_sin(float x)
+{
+	float x2, term, sum;
+	int i;
+
+	x -= 2 * AUDIO_PI * (float)(int)(x / (2 * AUDIO_PI));
+	if (x > AUDIO_PI)
+		x -= 2 * AUDIO_PI;
+	else if (x < -AUDIO_PI)
+		x += 2 * AUDIO_PI;
+	if (x > AUDIO_PI / 2)
+		x = AUDIO_PI - x;
+	else if (x < -AUDIO_PI / 2)
+		x = -AUDIO_PI - x;
+
+	x2 = x * x;
+	term = x;
+	sum = x;
+	for (i = 2; i <= 12; i += 2) {
+		term *= -x2 / (float)(i * (i + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+static float _mtk_os_hal_audio_cos(float x)
+{
+	return _mtk_os_hal_audio_sin(x + AUDIO_PI / 2);
+}
+
+/* windowed sinc at t input frames from the center, half = taps / 2 */
+static float _mtk_os_hal_audio_rs_tap(float t, float cutoff, float half)
+{
+	float x = 2 * cutoff * t;
+	float u = t / half;
+	float sinc, win;
+
+	if (u <= -1.0f || u >= 1.0f)
+		return 0.0f;
+	sinc = x == 0.0f ? 1.0f :
+	       _mtk_os_hal_audio_sin(AUDIO_PI * x) / (AUDIO_PI * x);
+	/* Blackman */
+	win = 0.42f + 0.5f * _mtk_os_hal_audio_cos(AUDIO_PI * u) +
+	      0.08f * _mtk_os_hal_audio_cos(2 * AUDIO_PI * u);
+	return 2 * cutoff * sinc * win;
+}
+
+/*
+ * Row p of the table is the sub-filter for an output p / phases of an
+ * input frame after the center of the window. Row phases is the next
+ * frame's row 0, it is only read by the interpolation. Each row is
+ * scaled to a DC gain of exactly 1.0, so the level does not ripple
+ * with the phase.
+ */
+static void _mtk_os_hal_audio_rs_design(struct mtk_audio_rs *rs,
+					u32 in_rate, u32 out_rate,
+					u32 phases)
+{
+	u32 taps = rs->taps;
+	float half = (float)taps / 2;
+	float ratio = out_rate < in_rate ? (float)out_rate / in_rate : 1.0f;
+	/* the transition band of the Blackman window is ~3 / taps */
+	float cutoff = ratio * (0.5f - 1.5f / taps);
+	float sum, t;
+	int16_t *row;
+	int32_t q, total;
+	u32 p, j, big;
+
+	for (p = 0; p <= phases; p++) {
+		row = rs->coef + p * taps;
+		sum = 0.0f;
+		for (j = 0; j < taps; j++) {
+			t = half - 1 - j + (float)p / phases;
+			sum += _mtk_os_hal_audio_rs_tap(t, cutoff, half);
+		}
+		total = 0;
+		big = 0;
+		for (j = 0; j < taps; j++) {
+			t = half - 1 - j + (float)p / phases;
+			q = (int32_t)(_mtk_os_hal_audio_rs_tap(t, cutoff, half)
+				      / sum * 32768.0f + 16384.5f) - 16384;
+			row[j] = _mtk_os_hal_audio_sat16(q);
+			total += row[j];
+			if (row[j] > row[big])
+				big = j;
+		}
+		/* put the rounding error on the largest tap */
+		row[big] = _mtk_os_hal_audio_sat16(row[big] + 32768 - total);
+	}
+}
+
+#if MTK_AUDIO_SIMD
+static inline int32_t _mtk_os_hal_audio_dot(const int16_t *x,
+					    const int16_t *c, u32 taps)
+{
+	u32 acc = 0;
+
+	for (; taps; taps -= 2, x += 2, c += 2)
+		acc = __SMLAD(_mtk_os_hal_audio_rd2(x),
+			      _mtk_os_hal_audio_rd2(c), acc);
+	return (int32_t)acc;
+}
+#else
+static inline int32_t _mtk_os_hal_audio_dot(const int16_t *x,
+					    const int16_t *c, u32 taps)
+{
+	u32 acc = 0;
+	u32 i;
+
+	for (i = 0; i < taps; i++)
+		acc += (u32)((int32_t)x[i] * c[i]);
+	return (int32_t)acc;
+}
+#endif
+
+static int16_t _mtk_os_hal_audio_rs_out(const struct mtk_audio_rs *rs,
+					u32 ch)
+{
+	const int16_t *x = &rs->hist[ch][rs->hidx];
+	u64 pos = (u64)rs->frac << rs->phase_bits;
+	const int16_t *c = rs->coef + (u32)(pos >> 32) * rs->taps;
+	int32_t acc, next;
+
+	if (rs->bypass)
+		return x[0];
+
+	acc = _mtk_os_hal_audio_dot(x, c, rs->taps);
+	if (rs->interp) {
+		next = _mtk_os_hal_audio_dot(x, c + rs->taps, rs->taps);
+		acc += (int32_t)((((int64_t)next - acc) *
+				  (u16)((u32)pos >> 16)) >> 16);
+	}
+	return _mtk_os_hal_audio_sat16((acc + (1 << 14)) >> 15);
+}
+
+static void _mtk_os_hal_audio_rs_push(struct mtk_audio_rs *rs,
+				      const int16_t *frame)
+{
+	u32 i = rs->hidx;
+	u32 taps = rs->taps;
+	int16_t l = frame ? frame[0] : 0;
+
+	rs->hist[0][i] = l;
+	rs->hist[0][i + taps] = l;
+	if (rs->channels == 2) {
+		rs->hist[1][i] = frame ? frame[1] : 0;
+		rs->hist[1][i + taps] = rs->hist[1][i];
+	}
+	rs->hidx = i + 1 == taps ? 0 : i + 1;
+}
+
+static void _mtk_os_hal_audio_rs_advance(struct mtk_audio_rs *rs)
+{
+	u32 frac = rs->frac + rs->step_frac;
+
+	rs->need = rs->step_int + (frac < rs->frac);
+	rs->frac = frac;
+}
+
+int mtk_os_hal_audio_rs_init(struct mtk_audio_rs *rs, u32 in_rate,
+			     u32 out_rate, u8 channels,
+			     const struct mtk_audio_rs_quality *quality,
+			     int16_t *coef)
+{
+	u64 step;
+	u32 phases;
+
+	if (!rs || !in_rate || !out_rate || channels < 1 || channels > 2)
+		return -AUDIO_EINVAL;
+
+	memset(rs, 0, sizeof(*rs));
+	rs->channels = channels;
+	step = ((u64)in_rate << 32) / out_rate;
+	rs->step_int = (u32)(step >> 32);
+	rs->step_frac = (u32)step;
+
+	if (in_rate == out_rate) {
+		/* the window is the newest frame */
+		rs->bypass = 1;
+		rs->taps = 1;
+	} else {
+		if (!quality || !coef)
+			return -AUDIO_EINVAL;
+		phases = quality->phases;
+		if (quality->taps < 4 || quality->taps % 2 ||
+		    quality->taps > MTK_AUDIO_RS_TAPS_MAX ||
+		    !phases || phases > MTK_AUDIO_RS_PHASES_MAX ||
+		    (phases & (phases - 1)))
+			return -AUDIO_EINVAL;
+		rs->taps = quality->taps;
+		rs->interp = quality->interp;
+		rs->coef = coef;
+		while ((1UL << rs->phase_bits) < phases)
+			rs->phase_bits++;
+		_mtk_os_hal_audio_rs_design(rs, in_rate, out_rate, phases);
+	}
+	mtk_os_hal_audio_rs_reset(rs);
+
+	return 0;
+}
+
+void mtk_os_hal_audio_rs_reset(struct mtk_audio_rs *rs)
+{
+	memset(rs->hist, 0, sizeof(rs->hist));
+	rs->hidx = 0;
+	rs->frac = 0;
+	rs->need = 1;
+}
+
+int mtk_os_hal_audio_mixer_init(struct mtk_audio_mixer *mixer, u32 rate)
+{
+	if (!mixer || !rate)
+		return -AUDIO_EINVAL;
+
+	memset(mixer, 0, sizeof(*mixer));
+	mixer->rate = rate;
+
+	return 0;
+}
+
+int mtk_os_hal_audio_mixer_add(struct mtk_audio_mixer *mixer,
+			       struct mtk_audio_mix_input *input,
+			       const struct mtk_audio_mix_config *cfg)
+{
+	int ret;
+
+	if (!mixer || !input || !cfg || !cfg->pull)
+		return -AUDIO_EINVAL;
+	if (mixer->cnt >= MTK_AUDIO_MIX_INPUT_MAX)
+		return -AUDIO_ENOSPC;
+
+	ret = mtk_os_hal_audio_rs_init(&input->rs, cfg->rate, mixer->rate,
+				       cfg->channels, &cfg->quality,
+				       cfg->coef);
+	if (ret)
+		return ret;
+
+	input->pull = cfg->pull;
+	input->context = cfg->context;
+	input->gain = cfg->gain;
+	mtk_os_hal_audio_mix_start(input);
+	mixer->inputs[mixer->cnt++] = input;
+
+	return 0;
+}
+
+int mtk_os_hal_audio_mixer_remove(struct mtk_audio_mixer *mixer,
+				  struct mtk_audio_mix_input *input)
+{
+	u32 i;
+
+	if (!mixer || !input)
+		return -AUDIO_EINVAL;
+
+	for (i = 0; i < mixer->cnt; i++) {
+		if (mixer->inputs[i] != input)
+			continue;
+		input->active = 0;
+		mixer->inputs[i] = mixer->inputs[--mixer->cnt];
+		mixer->inputs[mixer->cnt] = NULL;
+		return 0;
+	}
+
+	return -AUDIO_EINVAL;
+}
+
+void mtk_os_hal_audio_mix_start(struct mtk_audio_mix_input *input)
+{
+	input->active = 0;
+	mtk_os_hal_audio_rs_reset(&input->rs);
+	input->buf = NULL;
+	input->frames = 0;
+	input->pos = 0;
+	input->drain = 0;
+	input->active = 1;
+}
+
+void mtk_os_hal_audio_mix_stop(struct mtk_audio_mix_input *input)
+{
+	input->active = 0;
+}
+
+void mtk_os_hal_audio_mix_set_gain(struct mtk_audio_mix_input *input,
+				   int16_t gain)
+{
+	input->gain = gain;
+}
+
+/* next input frame, NULL for silence */
+static const int16_t *_mtk_os_hal_audio_mix_next(
+					struct mtk_audio_mix_input *input)
+{
+	const int16_t *frame;
+
+	if (!input->active)
+		return NULL;
+
+	if (input->pos >= input->frames) {
+		input->pos = 0;
+		input->frames = 0;
+		if (!input->drain) {
+			input->frames = input->pull(input->context,
+						    &input->buf);
+			/* flush the window before going quiet */
+			if (!input->frames)
+				input->drain = input->rs.taps;
+		}
+		if (!input->frames) {
+			if (--input->drain == 0)
+				input->active = 0;
+			return NULL;
+		}
+	}
+
+	frame = input->buf + input->pos * input->rs.channels;
+	input->pos++;
+
+	return frame;
+}
+
+static void _mtk_os_hal_audio_mix_input(struct mtk_audio_mix_input *input,
+					int32_t *acc, u32 frames)
+{
+	struct mtk_audio_rs *rs = &input->rs;
+	int32_t gain = input->gain;
+	int32_t l, r;
+	u32 i;
+
+	for (i = 0; i < frames; i++, acc += 2) {
+		for (; rs->need; rs->need--)
+			_mtk_os_hal_audio_rs_push(rs,
+					_mtk_os_hal_audio_mix_next(input));
+		l = _mtk_os_hal_audio_rs_out(rs, 0);
+		r = rs->channels == 2 ? _mtk_os_hal_audio_rs_out(rs, 1) : l;
+		acc[0] += (l * gain) >> 15;
+		acc[1] += (r * gain) >> 15;
+		_mtk_os_hal_audio_rs_advance(rs);
+	}
+}
+
+int mtk_os_hal_audio_mixer_render(struct mtk_audio_mixer *mixer,
+				  int32_t *dst, u32 frames)
+{
+	int32_t acc[2 * MTK_AUDIO_MIX_CHUNK];
+	u32 i, n;
+	int active = 0;
+
+	while (frames) {
+		n = frames < MTK_AUDIO_MIX_CHUNK ? frames : MTK_AUDIO_MIX_CHUNK;
+		memset(acc, 0, 2 * n * sizeof(acc[0]));
+		for (i = 0; i < mixer->cnt; i++)
+			if (mixer->inputs[i]->active)
+				_mtk_os_hal_audio_mix_input(mixer->inputs[i],
+							    acc, n);
+		for (i = 0; i < 2 * n; i++)
+			dst[i] = (int32_t)((u32)(u16)
+				 _mtk_os_hal_audio_sat16(acc[i]) << 16);
+		dst += 2 * n;
+		frames -= n;
+	}
+
+	for (i = 0; i < mixer->cnt; i++)
+		active += mixer->inputs[i]->active;
+
+	return active;
+}
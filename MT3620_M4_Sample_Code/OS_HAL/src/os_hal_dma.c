@@ -37,13 +37,25 @@
 #include "nvic.h"
 #include "os_hal_dma.h"
 
+/* DMA_BASE and the SYSRAM window can be overridden from the build line,
+ * e.g. to point them at a register model and a host buffer.
+ */
+#ifndef DMA_BASE
 #define DMA_BASE 0x21080000
+#endif
+#ifndef DMA_SYSRAM_ORIGIN
 #define DMA_SYSRAM_ORIGIN 0x22000000
+#endif
+#ifndef DMA_SYSRAM_SIZE
 #define DMA_SYSRAM_SIZE 0x10000
+#endif
 #define DMA_SYSRAM_END (DMA_SYSRAM_ORIGIN + DMA_SYSRAM_SIZE)
 
 #define DMA_CHANNEL_MAX (VDMA_ADC_RX_CH29 + 1)
 
+#define DMA_TRACE_VFF_WRAP 0x00010000
+#define DMA_TRACE_VFF_PTR 0x0000FFFF
+
 /** @brief options for DMA status */
 enum dma_sta {
 	IDLE,    /**< DMA status as idle state*/
@@ -57,6 +69,21 @@ struct dma_controller_rtos {
 	struct dma_interrupt interrupt_1;
 	struct dma_interrupt interrupt_2;
 	struct dma_controller *ctlr;
+	/* channel is held across transfers, stop/reset keep it owned */
+	u8 leased;
+	/* a full config has been written, rearm may be used */
+	u8 configured;
+	struct dma_vff_stats vff_stats;
+#if MTK_DMA_TRACE_ENABLE
+	struct dma_chan_stats stats;
+	/* cycle count when the current transfer (or VFF period) began */
+	u32 trace_start;
+	/* byte count programmed for the current FULL/HALF-SIZE transfer */
+	u32 trace_count;
+	/* last VFF hwptr seen, used to derive the bytes moved */
+	u32 trace_hwptr;
+	u8 trace_active;
+#endif
 };
 
 static struct dma_controller_rtos g_dma_ctlr_rtos[DMA_CHANNEL_MAX];
@@ -64,6 +91,162 @@ static struct dma_controller g_dma_ctlr[DMA_CHANNEL_MAX];
 static struct dma_ctrl g_dma_ctrl_mode[DMA_CHANNEL_MAX];
 static struct dma_config g_dma_config[DMA_CHANNEL_MAX];
 
+#if MTK_DMA_TRACE_ENABLE
+static struct dma_trace_record g_dma_trace[MTK_DMA_TRACE_DEPTH];
+static u32 g_dma_trace_idx;
+
+static inline u32 _mtk_os_hal_dma_trace_now(void)
+{
+	return DWT->CYCCNT;
+}
+
+static void _mtk_os_hal_dma_trace_init(void)
+{
+	if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)
+		return;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static void _mtk_os_hal_dma_trace_record(struct dma_controller_rtos *ctrl_rtos,
+					 enum dma_trace_event event, u32 bytes)
+{
+	struct dma_chan_stats *stats = &ctrl_rtos->stats;
+	struct dma_trace_record *rec;
+	u32 now = _mtk_os_hal_dma_trace_now();
+	u32 cycles = now - ctrl_rtos->trace_start;
+	u32 primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	stats->bytes += bytes;
+	switch (event) {
+	case DMA_TRACE_DONE:
+		stats->done_cnt++;
+		stats->total_cycles += cycles;
+		break;
+	case DMA_TRACE_TIMEOUT:
+		stats->timeout_cnt++;
+		break;
+	case DMA_TRACE_ERROR:
+		stats->err_cnt++;
+		break;
+	default:
+		break;
+	}
+	if (event != DMA_TRACE_ERROR) {
+		stats->last_cycles = cycles;
+		if (cycles > stats->max_cycles)
+			stats->max_cycles = cycles;
+	}
+
+	rec = &g_dma_trace[g_dma_trace_idx % MTK_DMA_TRACE_DEPTH];
+	rec->timestamp = ctrl_rtos->trace_start;
+	rec->cycles = cycles;
+	rec->bytes = bytes;
+	rec->chn = ctrl_rtos->ctlr ? ctrl_rtos->ctlr->chn : 0xff;
+	rec->event = (u8)event;
+	g_dma_trace_idx++;
+
+	ctrl_rtos->trace_start = now;
+
+	__set_PRIMASK(primask);
+}
+
+/* bytes the VFF engine moved since the last call, derived from hwptr */
+static u32 _mtk_os_hal_dma_trace_vff_bytes(struct dma_controller_rtos *ctrl_rtos)
+{
+	struct dma_controller *ctrl = ctrl_rtos->ctlr;
+	u32 hwptr, last, ffsize, bytes;
+
+	hwptr = mtk_mhal_dma_get_param(ctrl, DMA_PARAM_VFF_HWPTR);
+	last = ctrl_rtos->trace_hwptr;
+	ffsize = ctrl->cfg->fifo_size;
+	ctrl_rtos->trace_hwptr = hwptr;
+
+	if ((hwptr & DMA_TRACE_VFF_WRAP) == (last & DMA_TRACE_VFF_WRAP))
+		bytes = (hwptr & DMA_TRACE_VFF_PTR) - (last & DMA_TRACE_VFF_PTR);
+	else
+		bytes = ffsize - (last & DMA_TRACE_VFF_PTR) +
+			(hwptr & DMA_TRACE_VFF_PTR);
+
+	return bytes;
+}
+
+static void _mtk_os_hal_dma_trace_start(struct dma_controller_rtos *ctrl_rtos)
+{
+	struct dma_controller *ctrl = ctrl_rtos->ctlr;
+
+	ctrl_rtos->stats.xfer_cnt++;
+	ctrl_rtos->trace_start = _mtk_os_hal_dma_trace_now();
+	ctrl_rtos->trace_active = 1;
+	if (ctrl->chn_type == DMA_TYPE_VFF)
+		ctrl_rtos->trace_hwptr = mtk_mhal_dma_get_param(ctrl,
+			DMA_PARAM_VFF_HWPTR);
+	else
+		ctrl_rtos->trace_count = ctrl->cfg->count;
+}
+
+/* called from DMA ISR: isr_callback_1 reports completion (or VFF threshold),
+ * isr_callback_2 reports VFF timeout (or HALF-SIZE half-completion, which
+ * is not traced).
+ */
+static void _mtk_os_hal_dma_trace_irq(struct dma_controller_rtos *ctrl_rtos,
+				      enum dma_trace_event event)
+{
+	if (!ctrl_rtos->trace_active)
+		return;
+
+	if (ctrl_rtos->ctlr->chn_type == DMA_TYPE_VFF) {
+		_mtk_os_hal_dma_trace_record(ctrl_rtos, event,
+			_mtk_os_hal_dma_trace_vff_bytes(ctrl_rtos));
+	} else if (event == DMA_TRACE_DONE) {
+		ctrl_rtos->trace_active = 0;
+		_mtk_os_hal_dma_trace_record(ctrl_rtos, event,
+			ctrl_rtos->trace_count);
+	}
+}
+
+/* a stopped transfer which has not completed moved count - RLCT bytes */
+static void _mtk_os_hal_dma_trace_stop(struct dma_controller_rtos *ctrl_rtos)
+{
+	struct dma_controller *ctrl = ctrl_rtos->ctlr;
+	u32 remain;
+
+	if (ctrl == NULL || !ctrl_rtos->trace_active)
+		return;
+
+	ctrl_rtos->trace_active = 0;
+	if (ctrl->chn_type == DMA_TYPE_VFF) {
+		_mtk_os_hal_dma_trace_record(ctrl_rtos, DMA_TRACE_STOP,
+			_mtk_os_hal_dma_trace_vff_bytes(ctrl_rtos));
+		return;
+	}
+
+	remain = mtk_mhal_dma_get_param(ctrl, DMA_PARAM_RLCT);
+	if (remain > ctrl_rtos->trace_count)
+		remain = ctrl_rtos->trace_count;
+	_mtk_os_hal_dma_trace_record(ctrl_rtos,
+		remain ? DMA_TRACE_ERROR : DMA_TRACE_STOP,
+		ctrl_rtos->trace_count - remain);
+}
+
+static void _mtk_os_hal_dma_trace_error(struct dma_controller_rtos *ctrl_rtos)
+{
+	ctrl_rtos->trace_active = 0;
+	ctrl_rtos->trace_start = _mtk_os_hal_dma_trace_now();
+	_mtk_os_hal_dma_trace_record(ctrl_rtos, DMA_TRACE_ERROR, 0);
+}
+#else
+#define _mtk_os_hal_dma_trace_init() do {} while (0)
+#define _mtk_os_hal_dma_trace_start(ctrl_rtos) do {} while (0)
+#define _mtk_os_hal_dma_trace_irq(ctrl_rtos, event) do {} while (0)
+#define _mtk_os_hal_dma_trace_stop(ctrl_rtos) do {} while (0)
+#define _mtk_os_hal_dma_trace_error(ctrl_rtos) do {} while (0)
+#endif
+
 static inline enum dma_type _mtk_os_hal_dma_get_chn_type(enum dma_channel chn)
 {
 	if (chn <= DMA_ISU4_RX_CH9)
@@ -110,6 +293,11 @@ static int _mtk_os_hal_dma_done_callback_1(void *data)
 {
 	struct dma_controller_rtos *ctlr_rtos = data;
 
+	if (ctlr_rtos->ctlr->chn_type == DMA_TYPE_VFF)
+		ctlr_rtos->vff_stats.thrsh_cnt++;
+
+	_mtk_os_hal_dma_trace_irq(ctlr_rtos, DMA_TRACE_DONE);
+
 	if (ctlr_rtos->interrupt_1.isr_cb != NULL)
 		ctlr_rtos->interrupt_1.isr_cb(ctlr_rtos->interrupt_1.cb_data);
 
@@ -120,6 +308,15 @@ static int _mtk_os_hal_dma_done_callback_2(void *data)
 {
 	struct dma_controller_rtos *ctlr_rtos = data;
 
+	if (ctlr_rtos->ctlr->chn_type == DMA_TYPE_VFF) {
+		ctlr_rtos->vff_stats.timeout_cnt++;
+		ctlr_rtos->vff_stats.timeout_bytes +=
+			mtk_mhal_dma_get_param(ctlr_rtos->ctlr,
+					       DMA_PARAM_VFF_FIFO_CNT);
+	}
+
+	_mtk_os_hal_dma_trace_irq(ctlr_rtos, DMA_TRACE_TIMEOUT);
+
 	if (ctlr_rtos->interrupt_2.isr_cb != NULL)
 		ctlr_rtos->interrupt_2.isr_cb(ctlr_rtos->interrupt_2.cb_data);
 
@@ -149,10 +346,12 @@ static void _mtk_os_hal_dma_reset_controller_rtos(
 	ctrl_rtos->interrupt_1.cb_data = NULL;
 	ctrl_rtos->interrupt_2.isr_cb = NULL;
 	ctrl_rtos->interrupt_2.cb_data = NULL;
+	ctrl_rtos->leased = 0;
+	ctrl_rtos->configured = 0;
 	ctrl_rtos->status = IDLE;
 }
 
-int mtk_os_hal_dma_alloc_chan(enum dma_channel chn)
+static int _mtk_os_hal_dma_alloc_chan(enum dma_channel chn, u8 leased)
 {
 	struct dma_controller_rtos *ctrl_rtos;
 	int ret = 0;
@@ -160,7 +359,7 @@ int mtk_os_hal_dma_alloc_chan(enum dma_channel chn)
 	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
 	if (ctrl_rtos == NULL)
 		return -DMA_EPTR;
-	if (ctrl_rtos->status == IDLE) {
+	if (ctrl_rtos->status == IDLE && !ctrl_rtos->leased) {
 		/* clear dma_controller_rtos setting */
 		if (ctrl_rtos->ctlr != NULL)
 			_mtk_os_hal_dma_reset_controller_rtos(ctrl_rtos);
@@ -180,11 +379,15 @@ int mtk_os_hal_dma_alloc_chan(enum dma_channel chn)
 
 		mtk_mhal_dma_clock_enable(ctrl_rtos->ctlr);
 
+		_mtk_os_hal_dma_trace_init();
+
 		CM4_Install_NVIC(CM4_IRQ_M4DMA, CM4_DMA_PRI, IRQ_LEVEL_TRIGGER,
 				 _mtk_os_hal_dma_irq_handler, TRUE);
 
 		mtk_mhal_dma_reset(ctrl_rtos->ctlr);
 
+		memset(&ctrl_rtos->vff_stats, 0, sizeof(ctrl_rtos->vff_stats));
+		ctrl_rtos->leased = leased;
 		ctrl_rtos->status = RUNNING;
 	} else {
 		printf("chn %d is being used\n", chn);
@@ -197,6 +400,16 @@ int mtk_os_hal_dma_alloc_chan(enum dma_channel chn)
 	return ret;
 }
 
+int mtk_os_hal_dma_alloc_chan(enum dma_channel chn)
+{
+	return _mtk_os_hal_dma_alloc_chan(chn, 0);
+}
+
+int mtk_os_hal_dma_lease_chan(enum dma_channel chn)
+{
+	return _mtk_os_hal_dma_alloc_chan(chn, 1);
+}
+
 static void _mtk_os_hal_dma_set_control_mode(struct dma_controller *ctrl,
 				      struct dma_control_mode *ctrl_mode)
 {
@@ -219,15 +432,11 @@ static int _mtk_os_hal_dma_addr_check(u32 addr)
 	return -DMA_EPTR;
 }
 
-int mtk_os_hal_dma_config(enum dma_channel chn, struct dma_setting *setting)
+static int _mtk_os_hal_dma_config(struct dma_controller_rtos *ctrl_rtos,
+				  struct dma_setting *setting)
 {
-	struct dma_controller_rtos *ctrl_rtos;
 	struct dma_controller *ctrl;
 
-	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
-	if (ctrl_rtos == NULL)
-		return -DMA_EPTR;
-
 	ctrl = ctrl_rtos->ctlr;
 	if (ctrl == NULL) {
 		printf("dma channel has not been allocated!\n");
@@ -319,15 +528,91 @@ int mtk_os_hal_dma_config(enum dma_channel chn, struct dma_setting *setting)
 	return mtk_mhal_dma_config(ctrl);
 }
 
+int mtk_os_hal_dma_config(enum dma_channel chn, struct dma_setting *setting)
+{
+	struct dma_controller_rtos *ctrl_rtos;
+	int ret;
+
+	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
+	if (ctrl_rtos == NULL)
+		return -DMA_EPTR;
+
+	ret = _mtk_os_hal_dma_config(ctrl_rtos, setting);
+	ctrl_rtos->configured = !ret;
+	if (ret && ctrl_rtos->ctlr != NULL)
+		_mtk_os_hal_dma_trace_error(ctrl_rtos);
+
+	return ret;
+}
+
+int mtk_os_hal_dma_rearm(enum dma_channel chn, u32 src_addr, u32 dst_addr,
+			 u32 count)
+{
+	struct dma_controller_rtos *ctrl_rtos;
+	struct dma_controller *ctrl;
+	u32 mem_addr;
+	int ret;
+
+	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
+	if (ctrl_rtos == NULL)
+		return -DMA_EPTR;
+
+	ctrl = ctrl_rtos->ctlr;
+	if (ctrl == NULL || !ctrl_rtos->configured) {
+		printf("dma chn %d has not been configured!\n", chn);
+		return -DMA_EPARAM;
+	}
+
+	if (ctrl->chn_type == DMA_TYPE_FULLSIZE) {
+		if (_mtk_os_hal_dma_addr_check(src_addr) ||
+		    _mtk_os_hal_dma_addr_check(dst_addr)) {
+			printf("DMA support SYSRAM memory only, src(0x%x) dst(0x%x) out of range\n",
+				src_addr, dst_addr);
+			return -DMA_EPTR;
+		}
+		ctrl->cfg->addr_1 = src_addr;
+		ctrl->cfg->addr_2 = dst_addr;
+	} else if (ctrl->chn_type == DMA_TYPE_HALFSIZE) {
+		/* the peripheral (fix) address keeps its configured value */
+		if (ctrl->ctrls->dir == MEM_2_PERI)
+			mem_addr = src_addr;
+		else
+			mem_addr = dst_addr;
+		if (_mtk_os_hal_dma_addr_check(mem_addr)) {
+			printf("DMA support SYSRAM memory only, addr(0x%x) out of range\n",
+				mem_addr);
+			return -DMA_EPTR;
+		}
+		ctrl->cfg->addr_1 = mem_addr;
+	} else {
+		return -DMA_EPARAM;
+	}
+	ctrl->cfg->count = count;
+
+	ret = mtk_mhal_dma_rearm(ctrl);
+	if (ret)
+		_mtk_os_hal_dma_trace_error(ctrl_rtos);
+
+	return ret;
+}
+
 int mtk_os_hal_dma_start(enum dma_channel chn)
 {
 	struct dma_controller_rtos *ctrl_rtos;
+	int ret;
 
 	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
 	if (ctrl_rtos == NULL)
 		return -DMA_EPTR;
 
-	return mtk_mhal_dma_start(ctrl_rtos->ctlr);
+	if (ctrl_rtos->ctlr != NULL)
+		_mtk_os_hal_dma_trace_start(ctrl_rtos);
+
+	ret = mtk_mhal_dma_start(ctrl_rtos->ctlr);
+	if (ret && ctrl_rtos->ctlr != NULL)
+		_mtk_os_hal_dma_trace_error(ctrl_rtos);
+
+	return ret;
 }
 
 int mtk_os_hal_dma_stop(enum dma_channel chn)
@@ -337,7 +622,10 @@ int mtk_os_hal_dma_stop(enum dma_channel chn)
 	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
 	if (ctrl_rtos == NULL)
 		return -DMA_EPTR;
-	ctrl_rtos->status = IDLE;
+	if (!ctrl_rtos->leased)
+		ctrl_rtos->status = IDLE;
+
+	_mtk_os_hal_dma_trace_stop(ctrl_rtos);
 
 	return mtk_mhal_dma_stop(ctrl_rtos->ctlr);
 }
@@ -447,6 +735,26 @@ int mtk_os_hal_dma_get_param(enum dma_channel chn,
 				      (enum dma_param)param_type);
 }
 
+int mtk_os_hal_dma_get_vff_stats(enum dma_channel chn,
+				 struct dma_vff_stats *stats)
+{
+	struct dma_controller_rtos *ctrl_rtos;
+	u32 primask;
+
+	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
+	if (ctrl_rtos == NULL || stats == NULL)
+		return -DMA_EPTR;
+	if (_mtk_os_hal_dma_get_chn_type(chn) != DMA_TYPE_VFF)
+		return -DMA_EPARAM;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*stats = ctrl_rtos->vff_stats;
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
 int mtk_os_hal_dma_update_swptr(enum dma_channel chn, u32 length_byte)
 {
 	struct dma_controller_rtos *ctrl_rtos = NULL;
@@ -478,6 +786,8 @@ int mtk_os_hal_dma_release_chan(enum dma_channel chn)
 	if (ctrl_rtos == NULL)
 		return -DMA_EPTR;
 
+	_mtk_os_hal_dma_trace_stop(ctrl_rtos);
+
 	ret = mtk_mhal_dma_stop(ctrl_rtos->ctlr);
 	if (ret) {
 		printf("stop dma fail!\n");
@@ -498,7 +808,10 @@ int mtk_os_hal_dma_reset(enum dma_channel chn)
 	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
 	if (ctrl_rtos == NULL)
 		return -DMA_EPTR;
-	ctrl_rtos->status = IDLE;
+	if (!ctrl_rtos->leased)
+		ctrl_rtos->status = IDLE;
+	/* channel reset clears the programmed registers */
+	ctrl_rtos->configured = 0;
 
 	return mtk_mhal_dma_reset(ctrl_rtos->ctlr);
 }
@@ -513,3 +826,315 @@ int mtk_os_hal_dma_clr_dreq(enum dma_channel chn)
 
 	return mtk_mhal_dma_clr_dreq(ctrl_rtos->ctlr);
 }
+
+#if MTK_DMA_TRACE_ENABLE
+int mtk_os_hal_dma_get_stats(enum dma_channel chn,
+			     struct dma_chan_stats *stats)
+{
+	struct dma_controller_rtos *ctrl_rtos;
+	u32 primask;
+
+	ctrl_rtos = _mtk_os_hal_dma_get_ctlr(chn);
+	if (ctrl_rtos == NULL || stats == NULL)
+		return -DMA_EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*stats = ctrl_rtos->stats;
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_dma_get_trace(struct dma_trace_record *records, u32 max_records)
+{
+	u32 primask, first, cnt, i;
+
+	if (records == NULL)
+		return -DMA_EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	cnt = g_dma_trace_idx < MTK_DMA_TRACE_DEPTH ?
+		g_dma_trace_idx : MTK_DMA_TRACE_DEPTH;
+	if (cnt > max_records)
+		cnt = max_records;
+	/* oldest record first */
+	first = g_dma_trace_idx - cnt;
+	for (i = 0; i < cnt; i++)
+		records[i] = g_dma_trace[(first + i) % MTK_DMA_TRACE_DEPTH];
+
+	__set_PRIMASK(primask);
+
+	return cnt;
+}
+
+void mtk_os_hal_dma_clear_stats(void)
+{
+	u32 primask;
+	int chn;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	for (chn = 0; chn < DMA_CHANNEL_MAX; chn++)
+		memset(&g_dma_ctlr_rtos[chn].stats, 0,
+		       sizeof(g_dma_ctlr_rtos[chn].stats));
+	memset(g_dma_trace, 0, sizeof(g_dma_trace));
+	g_dma_trace_idx = 0;
+
+	__set_PRIMASK(primask);
+}
+
+void mtk_os_hal_dma_dump_stats(void)
+{
+	struct dma_chan_stats stats;
+	struct dma_trace_record rec[MTK_DMA_TRACE_DEPTH];
+	int chn, cnt, i;
+
+	printf("chn       bytes   xfers    done  errors timeouts  avg_cyc  max_cyc\n");
+	for (chn = DMA_ISU0_TX_CH0; chn <= VDMA_ADC_RX_CH29; chn++) {
+		if (mtk_os_hal_dma_get_stats((enum dma_channel)chn, &stats))
+			continue;
+		if (stats.xfer_cnt == 0 && stats.err_cnt == 0)
+			continue;
+		printf("%3d %11u %7u %7u %7u %8u %8u %8u\n", chn,
+		       stats.bytes, stats.xfer_cnt, stats.done_cnt,
+		       stats.err_cnt, stats.timeout_cnt,
+		       stats.done_cnt ? (u32)(stats.total_cycles /
+					      stats.done_cnt) : 0,
+		       stats.max_cycles);
+	}
+
+	cnt = mtk_os_hal_dma_get_trace(rec, MTK_DMA_TRACE_DEPTH);
+	printf("recent transfers (oldest first):\n");
+	for (i = 0; i < cnt; i++)
+		printf("chn %2d event %d bytes %6u start 0x%08x cycles %u\n",
+		       rec[i].chn, rec[i].event, rec[i].bytes,
+		       rec[i].timestamp, rec[i].cycles);
+}
+#endif
+
+#if MTK_DMA_POOL_SIZE
+#if (MTK_DMA_POOL_SIZE % MTK_DMA_POOL_ALIGN) != 0
+#error "MTK_DMA_POOL_SIZE must be a multiple of MTK_DMA_POOL_ALIGN"
+#endif
+
+#define DMA_POOL_SLOTS (MTK_DMA_POOL_SIZE / MTK_DMA_POOL_ALIGN)
+#define DMA_POOL_CLASS_SIZE(c) (MTK_DMA_POOL_ALIGN << (c))
+/* g_dma_pool_slot[] flags, the low bits hold the size class */
+#define DMA_POOL_SLOT_USED 0x40
+#define DMA_POOL_SLOT_FREE 0x80
+#define DMA_POOL_SLOT_CLASS 0x0F
+
+struct dma_pool_block {
+	struct dma_pool_block *next;
+};
+
+static u8 g_dma_pool[MTK_DMA_POOL_SIZE]
+	__attribute__((section(".sysram"), aligned(MTK_DMA_POOL_ALIGN)));
+/* state of the block starting at each slot, 0 inside a block */
+static u8 g_dma_pool_slot[DMA_POOL_SLOTS];
+static struct dma_pool_block *g_dma_pool_free[MTK_DMA_POOL_CLASSES];
+static u8 g_dma_pool_ready;
+static struct dma_pool_stats g_dma_pool_stats;
+
+static int _mtk_os_hal_dma_pool_class(u32 size)
+{
+	int c;
+
+	for (c = 0; c < MTK_DMA_POOL_CLASSES; c++) {
+		if (size <= DMA_POOL_CLASS_SIZE(c))
+			return c;
+	}
+
+	return -1;
+}
+
+static void _mtk_os_hal_dma_pool_push(int c, u32 offset)
+{
+	struct dma_pool_block *blk = (void *)&g_dma_pool[offset];
+
+	blk->next = g_dma_pool_free[c];
+	g_dma_pool_free[c] = blk;
+	g_dma_pool_slot[offset / MTK_DMA_POOL_ALIGN] = DMA_POOL_SLOT_FREE | c;
+	g_dma_pool_stats.class_free[c]++;
+}
+
+static void _mtk_os_hal_dma_pool_unlink(int c, u32 offset)
+{
+	struct dma_pool_block **pp = &g_dma_pool_free[c];
+	struct dma_pool_block *blk = (void *)&g_dma_pool[offset];
+
+	while (*pp != NULL && *pp != blk)
+		pp = &(*pp)->next;
+	if (*pp == NULL)
+		return;
+
+	*pp = blk->next;
+	g_dma_pool_slot[offset / MTK_DMA_POOL_ALIGN] = 0;
+	g_dma_pool_stats.class_free[c]--;
+}
+
+/* Split the pool into the biggest naturally aligned blocks. */
+static void _mtk_os_hal_dma_pool_init(void)
+{
+	u32 offset = 0;
+	int c;
+
+	while (offset < MTK_DMA_POOL_SIZE) {
+		c = MTK_DMA_POOL_CLASSES - 1;
+		while (c > 0 && ((offset & (DMA_POOL_CLASS_SIZE(c) - 1)) ||
+		       offset + DMA_POOL_CLASS_SIZE(c) > MTK_DMA_POOL_SIZE))
+			c--;
+		_mtk_os_hal_dma_pool_push(c, offset);
+		offset += DMA_POOL_CLASS_SIZE(c);
+	}
+	g_dma_pool_ready = 1;
+}
+
+/* Called with interrupts disabled. Take the smallest free block that fits
+ * and split it down to class c, the upper halves go back as free buddies.
+ */
+static u8 *_mtk_os_hal_dma_pool_get(int c)
+{
+	struct dma_pool_block *blk;
+	u32 offset;
+	int k;
+
+	for (k = c; k < MTK_DMA_POOL_CLASSES; k++) {
+		if (g_dma_pool_free[k] != NULL)
+			break;
+	}
+	if (k == MTK_DMA_POOL_CLASSES)
+		return NULL;
+
+	blk = g_dma_pool_free[k];
+	offset = (u8 *)blk - g_dma_pool;
+	_mtk_os_hal_dma_pool_unlink(k, offset);
+	while (k > c) {
+		k--;
+		_mtk_os_hal_dma_pool_push(k, offset + DMA_POOL_CLASS_SIZE(k));
+	}
+	g_dma_pool_slot[offset / MTK_DMA_POOL_ALIGN] = DMA_POOL_SLOT_USED | c;
+
+	return &g_dma_pool[offset];
+}
+
+void *mtk_os_hal_dma_pool_alloc(u32 size)
+{
+	u32 primask;
+	u8 *buf = NULL;
+	int c;
+
+	c = _mtk_os_hal_dma_pool_class(size);
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (!g_dma_pool_ready)
+		_mtk_os_hal_dma_pool_init();
+
+	if (size != 0 && c >= 0)
+		buf = _mtk_os_hal_dma_pool_get(c);
+
+	if (buf != NULL) {
+		g_dma_pool_stats.class_used[c]++;
+		g_dma_pool_stats.alloc_cnt++;
+		g_dma_pool_stats.used_bytes += DMA_POOL_CLASS_SIZE(c);
+		if (g_dma_pool_stats.used_bytes > g_dma_pool_stats.peak_bytes)
+			g_dma_pool_stats.peak_bytes =
+				g_dma_pool_stats.used_bytes;
+	} else {
+		g_dma_pool_stats.fail_cnt++;
+	}
+
+	__set_PRIMASK(primask);
+
+	return buf;
+}
+
+int mtk_os_hal_dma_pool_free(void *buf)
+{
+	u32 primask, offset, buddy;
+	u8 slot;
+	int c;
+
+	if ((u8 *)buf < g_dma_pool ||
+	    (u8 *)buf >= g_dma_pool + MTK_DMA_POOL_SIZE)
+		return -DMA_EPTR;
+
+	offset = (u8 *)buf - g_dma_pool;
+	if (offset % MTK_DMA_POOL_ALIGN)
+		return -DMA_EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	slot = g_dma_pool_slot[offset / MTK_DMA_POOL_ALIGN];
+	if (!(slot & DMA_POOL_SLOT_USED)) {
+		__set_PRIMASK(primask);
+		printf("dma pool: %p is not allocated\n", buf);
+		return -DMA_EPTR;
+	}
+
+	c = slot & DMA_POOL_SLOT_CLASS;
+	g_dma_pool_slot[offset / MTK_DMA_POOL_ALIGN] = 0;
+	g_dma_pool_stats.class_used[c]--;
+	g_dma_pool_stats.used_bytes -= DMA_POOL_CLASS_SIZE(c);
+
+	/* merge with the free buddy as long as there is one */
+	while (c < MTK_DMA_POOL_CLASSES - 1) {
+		buddy = offset ^ DMA_POOL_CLASS_SIZE(c);
+		if (buddy + DMA_POOL_CLASS_SIZE(c) > MTK_DMA_POOL_SIZE ||
+		    g_dma_pool_slot[buddy / MTK_DMA_POOL_ALIGN] !=
+		    (DMA_POOL_SLOT_FREE | c))
+			break;
+		_mtk_os_hal_dma_pool_unlink(c, buddy);
+		if (buddy < offset)
+			offset = buddy;
+		c++;
+	}
+	_mtk_os_hal_dma_pool_push(c, offset);
+
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_dma_pool_get_stats(struct dma_pool_stats *stats)
+{
+	u32 primask;
+
+	if (stats == NULL)
+		return -DMA_EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (!g_dma_pool_ready)
+		_mtk_os_hal_dma_pool_init();
+	*stats = g_dma_pool_stats;
+	__set_PRIMASK(primask);
+
+	stats->total_bytes = MTK_DMA_POOL_SIZE;
+
+	return 0;
+}
+
+void mtk_os_hal_dma_pool_dump(void)
+{
+	struct dma_pool_stats stats;
+	int c;
+
+	mtk_os_hal_dma_pool_get_stats(&stats);
+
+	printf("dma pool %p: total %u used %u peak %u\n", g_dma_pool,
+	       stats.total_bytes, stats.used_bytes, stats.peak_bytes);
+	printf("allocs %u failures %u\n", stats.alloc_cnt, stats.fail_cnt);
+	for (c = 0; c < MTK_DMA_POOL_CLASSES; c++)
+		printf("class %5u: used %u free %u\n",
+		       DMA_POOL_CLASS_SIZE(c), stats.class_used[c],
+		       stats.class_free[c]);
+}
+#endif
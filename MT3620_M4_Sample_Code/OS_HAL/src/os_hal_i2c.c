@@ -42,8 +42,21 @@
 #include "os_hal_i2c.h"
 #include "os_hal_dma.h"
 
+/* depth of the master and slave FIFOs */
+#define I2C_FIFO_LEN 8
+
 #ifndef OSAI_ENABLE_DMA
-#define PIO_I2C_MAX_LEN 8
+#define PIO_I2C_MAX_LEN I2C_FIFO_LEN
+#endif
+
+/* how long a blocking call waits for an async request of a device
+ * with no timeout before aborting it
+ */
+#define I2C_ASYNC_TIMEOUT_MS 1000
+
+/* staging buffer of mtk_os_hal_i2c_burst_read() */
+#ifndef I2C_BURST_MAX_LEN
+#define I2C_BURST_MAX_LEN 32
 #endif
 
 #define ISU0_I2C_BASE	0x38070200
@@ -92,15 +105,412 @@ struct mtk_i2c_ctrl_rtos {
 	/* the type based on OS */
 #ifdef OSAI_FREERTOS
 	QueueHandle_t xfer_completion;
+	/* one transaction on the bus at a time, FIFO among equal
+	 * priorities and with priority inheritance
+	 */
+	SemaphoreHandle_t bus_lock;
 #else
 	volatile u8 xfer_completion;
 #endif
+
+	/* sequence chained from the irq: (reg, value) pairs or messages */
+	const u8 *seq_regs;
+	struct mtk_i2c_seq_msg *seq_msgs;
+	u32 seq_cnt;
+	u32 seq_idx;
+	int seq_ret;
+	u8 seq_addr;
+	u8 seq_wr[2];
+	struct i2c_msg seq_msg[2];
+
+	/* async requests, the head is on the wire while cur_req is set */
+	struct mtk_i2c_request *q_head;
+	struct mtk_i2c_request *q_tail;
+	struct mtk_i2c_request *cur_req;
+	struct i2c_msg async_msg[2];
+	/* the controller is owned by a blocking call or the queue */
+	volatile u8 hw_busy;
+	/* a blocking call waits for the request on the wire, the queue
+	 * does not start anything else until it has the controller
+	 */
+	volatile u8 sync_wait;
+
+	/* persistent slave mode */
+	u8 slave_on;
+	struct mtk_i2c_slave_config slv;
+	/* RX/TX ring positions, free running */
+	volatile u32 rx_head;
+	volatile u32 rx_tail;
+	volatile u32 tx_head;
+	volatile u32 tx_tail;
+	/* bytes written to the TX FIFO and not yet accounted as sent */
+	u32 tx_loaded;
+	/* register pointer of the register map mode */
+	u8 reg_ptr;
+	u32 rx_overrun;
+
+	struct i2c_bus_stats stats;
+	/* DWT cycle count when the async request on the wire started */
+	u32 async_start_cycles;
+	/* GPIOs wired to SCL/SDA for clocking out a stuck slave */
+	u8 rcv_gpio;
+	os_hal_gpio_pin rcv_scl;
+	os_hal_gpio_pin rcv_sda;
 };
 
 static struct mtk_i2c_ctrl_rtos g_i2c_ctrl_rtos[OS_HAL_I2C_ISU_MAX];
+/* staging of mtk_os_hal_i2c_burst_read(). A read longer than the FIFO
+ * moves both messages by DMA, which only reaches SYSRAM, not TCM.
+ */
+struct mtk_i2c_burst_buf {
+	u8 wr[I2C_FIFO_LEN];
+	u8 rd[I2C_BURST_MAX_LEN];
+};
+
+static __attribute__((section(".sysram")))
+	struct mtk_i2c_burst_buf g_i2c_burst_buf[OS_HAL_I2C_ISU_MAX];
 struct mtk_i2c_controller g_i2c_ctrl[OS_HAL_I2C_ISU_MAX];
 struct mtk_i2c_private g_i2c_mdata[OS_HAL_I2C_ISU_MAX];
 
+static inline u32 _mtk_os_hal_i2c_cycles(void)
+{
+	return DWT->CYCCNT;
+}
+
+/* count one transaction that ended with ret and started at start */
+static void _mtk_os_hal_i2c_stats_add(struct mtk_i2c_ctrl_rtos *ctrl_rtos,
+				      int ret, u32 start)
+{
+	struct i2c_bus_stats *stats = &ctrl_rtos->stats;
+	u32 cycles = _mtk_os_hal_i2c_cycles() - start;
+	u32 primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	stats->xfer_cnt++;
+	switch (ret) {
+	case 0:
+		break;
+	case -I2C_ENXIO:
+		stats->nack_cnt++;
+		break;
+	case -I2C_ETIMEDOUT:
+		stats->timeout_cnt++;
+		break;
+	case -I2C_EBUSY:
+		stats->busy_cnt++;
+		break;
+	default:
+		stats->err_cnt++;
+		break;
+	}
+
+	stats->last_cycles = cycles;
+	if (cycles > stats->max_cycles)
+		stats->max_cycles = cycles;
+	stats->total_cycles += cycles;
+
+	__set_PRIMASK(primask);
+}
+
+/* without DMA a message has to fit into the hardware FIFO */
+static int _mtk_os_hal_i2c_check_len(u16 len)
+{
+#ifndef OSAI_ENABLE_DMA
+	if (len > PIO_I2C_MAX_LEN) {
+		printf("Error! buf length should be less than or equal to %d\n", PIO_I2C_MAX_LEN);
+		return -I2C_EINVAL;
+	}
+#endif
+	return 0;
+}
+
+/* point i2c->msg at record seq_idx of the sequence */
+static void _mtk_os_hal_i2c_seq_load(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	struct i2c_msg *msgs = ctrl_rtos->seq_msg;
+	struct mtk_i2c_seq_msg *s;
+	u8 num = 0;
+
+	if (ctrl_rtos->seq_regs) {
+		ctrl_rtos->seq_wr[0] = ctrl_rtos->seq_regs[ctrl_rtos->seq_idx * 2];
+		ctrl_rtos->seq_wr[1] =
+			ctrl_rtos->seq_regs[ctrl_rtos->seq_idx * 2 + 1];
+		msgs[0].addr = ctrl_rtos->seq_addr;
+		msgs[0].flags = I2C_MASTER_WR;
+		msgs[0].len = 2;
+		msgs[0].buf = ctrl_rtos->seq_wr;
+		num = 1;
+	} else {
+		s = &ctrl_rtos->seq_msgs[ctrl_rtos->seq_idx];
+		if (s->wr_len) {
+			msgs[num].addr = s->addr;
+			msgs[num].flags = I2C_MASTER_WR;
+			msgs[num].len = s->wr_len;
+			msgs[num].buf = s->wr_buf;
+			num++;
+		}
+		if (s->rd_len) {
+			msgs[num].addr = s->addr;
+			msgs[num].flags = I2C_MASTER_RD;
+			msgs[num].len = s->rd_len;
+			msgs[num].buf = s->rd_buf;
+			num++;
+		}
+	}
+
+	i2c->msg = msgs;
+	i2c->msg_num = num;
+	i2c->dma_en = false;
+	i2c->irq_stat = 0;
+}
+
+/* the current record of the sequence is done, start the next one.
+ * Return 1 if it is on the bus, 0 if the sequence has ended.
+ */
+static int _mtk_os_hal_i2c_seq_next(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	int ret;
+
+	if (!ctrl_rtos->seq_cnt)
+		return 0;
+
+	ret = mtk_mhal_i2c_result_handle(i2c);
+	if (!ret && ++ctrl_rtos->seq_idx < ctrl_rtos->seq_cnt) {
+		_mtk_os_hal_i2c_seq_load(ctrl_rtos);
+		ret = mtk_mhal_i2c_trigger_transfer(i2c);
+		if (!ret)
+			return 1;
+	}
+
+	ctrl_rtos->seq_ret = ret;
+	ctrl_rtos->seq_cnt = 0;
+
+	return 0;
+}
+
+/* wake the task blocked on xfer_completion, from irq or task context */
+static void _mtk_os_hal_i2c_give(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+#ifdef OSAI_FREERTOS
+	BaseType_t x_higher_priority_task_woken = pdFALSE;
+
+	if (__get_IPSR()) {
+		xSemaphoreGiveFromISR(ctrl_rtos->xfer_completion,
+				      &x_higher_priority_task_woken);
+		portYIELD_FROM_ISR(x_higher_priority_task_woken);
+	} else {
+		xSemaphoreGive(ctrl_rtos->xfer_completion);
+	}
+#else
+	ctrl_rtos->xfer_completion++;
+#endif
+}
+
+/* take the head request off the queue. The tail goes with the last one,
+ * so that a callback queueing again starts a new queue.
+ */
+static void _mtk_os_hal_i2c_async_pop(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	ctrl_rtos->q_head = ctrl_rtos->q_head->next;
+	if (!ctrl_rtos->q_head)
+		ctrl_rtos->q_tail = NULL;
+	ctrl_rtos->cur_req = NULL;
+}
+
+/* start the head of the queue, or release the controller if it is empty
+ * or a blocking call waits for it. Called with interrupts disabled or
+ * from the irq.
+ */
+static void _mtk_os_hal_i2c_async_start(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	struct i2c_msg *msgs = ctrl_rtos->async_msg;
+	struct mtk_i2c_request *req;
+	enum i2c_speed_kHz bus_speed;
+	u8 num;
+	int ret;
+
+	while (!ctrl_rtos->sync_wait && (req = ctrl_rtos->q_head) != NULL) {
+		ctrl_rtos->hw_busy = 1;
+		ctrl_rtos->cur_req = req;
+
+		num = 0;
+		if (req->wr_len) {
+			msgs[num].addr = req->dev->addr;
+			msgs[num].flags = I2C_MASTER_WR;
+			msgs[num].len = req->wr_len;
+			msgs[num].buf = req->wr_buf;
+			num++;
+		}
+		if (req->rd_len) {
+			msgs[num].addr = req->dev->addr;
+			msgs[num].flags = I2C_MASTER_RD;
+			msgs[num].len = req->rd_len;
+			msgs[num].buf = req->rd_buf;
+			num++;
+		}
+
+		i2c->msg = msgs;
+		i2c->msg_num = num;
+		i2c->dma_en = false;
+		i2c->i2c_mode = I2C_MASTER_MODE;
+		i2c->irq_stat = 0;
+
+		/* trigger_transfer programs i2c_speed into the controller */
+		bus_speed = i2c->i2c_speed;
+		if (req->dev->speed)
+			i2c->i2c_speed = req->dev->speed;
+		ctrl_rtos->async_start_cycles = _mtk_os_hal_i2c_cycles();
+		ret = mtk_mhal_i2c_trigger_transfer(i2c);
+		i2c->i2c_speed = bus_speed;
+		if (!ret)
+			return;
+
+		_mtk_os_hal_i2c_stats_add(ctrl_rtos, ret,
+					  ctrl_rtos->async_start_cycles);
+		_mtk_os_hal_i2c_async_pop(ctrl_rtos);
+		req->status = ret;
+		if (req->complete)
+			req->complete(req->context, ret);
+	}
+
+	ctrl_rtos->hw_busy = 0;
+	/* the rest of the queue is held until the blocking call unlocks */
+	if (ctrl_rtos->sync_wait)
+		_mtk_os_hal_i2c_give(ctrl_rtos);
+}
+
+/* the request on the wire is done, complete it and start the next one */
+static void _mtk_os_hal_i2c_async_done(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	struct mtk_i2c_request *req = ctrl_rtos->cur_req;
+	int ret;
+
+	ret = mtk_mhal_i2c_result_handle(i2c);
+	if (ret)
+		mtk_mhal_i2c_init_hw(i2c);
+	_mtk_os_hal_i2c_stats_add(ctrl_rtos, ret, ctrl_rtos->async_start_cycles);
+
+	_mtk_os_hal_i2c_async_pop(ctrl_rtos);
+	req->status = ret;
+	if (req->complete)
+		req->complete(req->context, ret);
+
+	_mtk_os_hal_i2c_async_start(ctrl_rtos);
+}
+
+/* the request on the wire has not ended in time (a slave stretching SCL,
+ * a lost interrupt): reset the controller, complete the request with
+ * -I2C_ETIMEDOUT and release the controller. Interrupts disabled.
+ */
+static void _mtk_os_hal_i2c_async_abort(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	struct mtk_i2c_request *req = ctrl_rtos->cur_req;
+
+	mtk_mhal_i2c_init_hw(i2c);
+	i2c->irq_stat = 0;
+	_mtk_os_hal_i2c_stats_add(ctrl_rtos, -I2C_ETIMEDOUT,
+				  ctrl_rtos->async_start_cycles);
+
+	_mtk_os_hal_i2c_async_pop(ctrl_rtos);
+	ctrl_rtos->hw_busy = 0;
+	req->status = -I2C_ETIMEDOUT;
+	if (req->complete)
+		req->complete(req->context, -I2C_ETIMEDOUT);
+}
+
+/* top the TX FIFO up from the TX ring or the register map */
+static void _mtk_os_hal_i2c_slave_fill(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	struct mtk_i2c_slave_config *slv = &ctrl_rtos->slv;
+	u8 buf[I2C_FIFO_LEN];
+	u32 n, i;
+
+	if (ctrl_rtos->tx_loaded >= I2C_FIFO_LEN)
+		return;
+	n = I2C_FIFO_LEN - ctrl_rtos->tx_loaded;
+
+	if (slv->regs) {
+		/* the bytes following what is already in the FIFO */
+		for (i = 0; i < n; i++)
+			buf[i] = slv->regs[(ctrl_rtos->reg_ptr +
+					    ctrl_rtos->tx_loaded + i) %
+					   slv->reg_size];
+	} else {
+		if (n > ctrl_rtos->tx_head - ctrl_rtos->tx_tail)
+			n = ctrl_rtos->tx_head - ctrl_rtos->tx_tail;
+		for (i = 0; i < n; i++)
+			buf[i] = slv->tx_buf[(ctrl_rtos->tx_tail + i) %
+					     slv->tx_size];
+	}
+
+	n = mtk_mhal_i2c_slave_fifo_write(ctrl_rtos->i2c, buf, n);
+	ctrl_rtos->tx_loaded += n;
+	if (!slv->regs)
+		ctrl_rtos->tx_tail += n;
+}
+
+/* end of a transaction addressed to the persistent slave */
+static void _mtk_os_hal_i2c_slave_irq(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	struct mtk_i2c_slave_config *slv = &ctrl_rtos->slv;
+	u8 buf[I2C_FIFO_LEN];
+	u8 is_read = 0;
+	u8 reg = 0;
+	u32 len, i;
+
+	if (mtk_mhal_i2c_slave_stream_irq(i2c, &is_read))
+		ctrl_rtos->rx_overrun++;
+
+	if (is_read) {
+		len = ctrl_rtos->tx_loaded - mtk_mhal_i2c_slave_tx_pending(i2c);
+		ctrl_rtos->tx_loaded -= len;
+		if (slv->regs) {
+			reg = ctrl_rtos->reg_ptr;
+			ctrl_rtos->reg_ptr += len;
+		}
+	} else {
+		len = mtk_mhal_i2c_slave_fifo_read(i2c, buf, sizeof(buf));
+		if (slv->regs) {
+			/* first byte is the register pointer, then data */
+			if (len) {
+				ctrl_rtos->reg_ptr = buf[0];
+				reg = buf[0];
+				for (i = 1; i < len; i++)
+					slv->regs[(reg + i - 1) %
+						  slv->reg_size] = buf[i];
+				ctrl_rtos->reg_ptr += len - 1;
+				len--;
+			}
+			/* the next read starts at the new pointer */
+			mtk_mhal_i2c_slave_tx_flush(i2c);
+			ctrl_rtos->tx_loaded = 0;
+		} else {
+			for (i = 0; i < len; i++) {
+				if (ctrl_rtos->rx_head - ctrl_rtos->rx_tail >=
+				    slv->rx_size) {
+					ctrl_rtos->rx_overrun++;
+					break;
+				}
+				slv->rx_buf[ctrl_rtos->rx_head %
+					    slv->rx_size] = buf[i];
+				ctrl_rtos->rx_head++;
+			}
+		}
+	}
+
+	_mtk_os_hal_i2c_slave_fill(ctrl_rtos);
+
+	if (slv->stop)
+		slv->stop(slv->context, is_read, reg, len);
+}
+
 static void _mtk_os_hal_i2c_irq_handler(int bus_num)
 {
 	u8 ret = 0;
@@ -109,12 +519,23 @@ static void _mtk_os_hal_i2c_irq_handler(int bus_num)
 #ifdef OSAI_FREERTOS
 	BaseType_t x_higher_priority_task_woken = pdFALSE;
 #endif
+	if (ctrl_rtos->slave_on) {
+		_mtk_os_hal_i2c_slave_irq(ctrl_rtos);
+		return;
+	}
+
 	ret = mtk_mhal_i2c_irq_handle(i2c);
 
 	/* 1. FIFO mode: return completion done in I2C irq handler
 	 * 2. DMA mode: return completion done in DMA irq handler
 	 */
 	if (!ret) {
+		if (_mtk_os_hal_i2c_seq_next(ctrl_rtos))
+			return;
+		if (ctrl_rtos->cur_req) {
+			_mtk_os_hal_i2c_async_done(ctrl_rtos);
+			return;
+		}
 #ifdef OSAI_FREERTOS
 		xSemaphoreGiveFromISR(ctrl_rtos->xfer_completion,
 				      &x_higher_priority_task_woken);
@@ -210,6 +631,13 @@ static int _mtk_os_hal_i2c_dma_done_callback(void *data)
 
 	ctrl_rtos = (struct mtk_i2c_ctrl_rtos *)data;
 
+	if (_mtk_os_hal_i2c_seq_next(ctrl_rtos))
+		return 0;
+	if (ctrl_rtos->cur_req) {
+		_mtk_os_hal_i2c_async_done(ctrl_rtos);
+		return 0;
+	}
+
 	/* while using DMA mode, release semaphore in this callback */
 	xSemaphoreGiveFromISR(ctrl_rtos->xfer_completion,
 			      &x_higher_priority_task_woken);
@@ -219,6 +647,13 @@ static int _mtk_os_hal_i2c_dma_done_callback(void *data)
 #else
 	struct mtk_i2c_ctrl_rtos *ctrl_rtos = data;
 
+	if (_mtk_os_hal_i2c_seq_next(ctrl_rtos))
+		return 0;
+	if (ctrl_rtos->cur_req) {
+		_mtk_os_hal_i2c_async_done(ctrl_rtos);
+		return 0;
+	}
+
 	ctrl_rtos->xfer_completion++;
 	return 0;
 #endif
@@ -245,13 +680,180 @@ static int _mtk_os_hal_i2c_wait_for_completion_timeout(
 	return 0;
 }
 
+/* take the bus for a blocking call: lock out the other tasks, then wait
+ * for the async request on the wire and hold the rest of the queue until
+ * unlock. A request that does not end within its device timeout is
+ * aborted. Fails while the bus is a persistent slave.
+ */
+static int _mtk_os_hal_i2c_lock(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	struct mtk_i2c_request *req;
+	u32 primask, timeout;
+
+#ifdef OSAI_FREERTOS
+	xSemaphoreTake(ctrl_rtos->bus_lock, portMAX_DELAY);
+#endif
+
+	if (ctrl_rtos->slave_on) {
+#ifdef OSAI_FREERTOS
+		xSemaphoreGive(ctrl_rtos->bus_lock);
+#endif
+		return -I2C_EBUSY;
+	}
+
+	for (;;) {
+		primask = __get_PRIMASK();
+		__disable_irq();
+		if (!ctrl_rtos->hw_busy) {
+			ctrl_rtos->hw_busy = 1;
+			ctrl_rtos->sync_wait = 0;
+			__set_PRIMASK(primask);
+			break;
+		}
+		ctrl_rtos->sync_wait = 1;
+		req = ctrl_rtos->cur_req;
+		timeout = req && req->dev->timeout ? req->dev->timeout :
+			  I2C_ASYNC_TIMEOUT_MS;
+		__set_PRIMASK(primask);
+
+		if (!_mtk_os_hal_i2c_wait_for_completion_timeout(ctrl_rtos,
+								 timeout))
+			continue;
+
+		primask = __get_PRIMASK();
+		__disable_irq();
+		/* still the same request on the wire */
+		if (req && ctrl_rtos->cur_req == req)
+			_mtk_os_hal_i2c_async_abort(ctrl_rtos);
+		__set_PRIMASK(primask);
+	}
+
+	/* drop a give left over by a transfer that timed out or by an
+	 * interrupt of an aborted request
+	 */
+#ifdef OSAI_FREERTOS
+	xSemaphoreTake(ctrl_rtos->xfer_completion, 0);
+#else
+	ctrl_rtos->xfer_completion = 0;
+#endif
+
+	return 0;
+}
+
+static void _mtk_os_hal_i2c_unlock(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	u32 primask;
+
+	/* start what was queued meanwhile */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	_mtk_os_hal_i2c_async_start(ctrl_rtos);
+	__set_PRIMASK(primask);
+
+#ifdef OSAI_FREERTOS
+	xSemaphoreGive(ctrl_rtos->bus_lock);
+#endif
+}
+
+/* pulse SCL through the recovery GPIOs until the slave releases SDA,
+ * then send a STOP. The pins are driven open-drain: output low to pull
+ * a line down, input to release it.
+ */
+static int _mtk_os_hal_i2c_clock_out(struct mtk_i2c_ctrl_rtos *ctrl_rtos)
+{
+	os_hal_gpio_pin scl = ctrl_rtos->rcv_scl;
+	os_hal_gpio_pin sda = ctrl_rtos->rcv_sda;
+	os_hal_gpio_data level = OS_HAL_GPIO_DATA_LOW;
+	int i;
+
+	mtk_os_hal_gpio_set_output(scl, OS_HAL_GPIO_DATA_LOW);
+	mtk_os_hal_gpio_set_output(sda, OS_HAL_GPIO_DATA_LOW);
+	mtk_os_hal_gpio_set_direction(scl, OS_HAL_GPIO_DIR_INPUT);
+	mtk_os_hal_gpio_set_direction(sda, OS_HAL_GPIO_DIR_INPUT);
+
+	/* a slave in the middle of a byte lets go within 9 clocks */
+	for (i = 0; i < 9; i++) {
+		mtk_os_hal_gpio_get_input(sda, &level);
+		if (level == OS_HAL_GPIO_DATA_HIGH)
+			break;
+		mtk_os_hal_gpio_set_direction(scl, OS_HAL_GPIO_DIR_OUTPUT);
+		osai_delay_us(5);
+		mtk_os_hal_gpio_set_direction(scl, OS_HAL_GPIO_DIR_INPUT);
+		osai_delay_us(5);
+	}
+
+	/* STOP: SDA rises while SCL is high */
+	mtk_os_hal_gpio_set_direction(scl, OS_HAL_GPIO_DIR_OUTPUT);
+	mtk_os_hal_gpio_set_direction(sda, OS_HAL_GPIO_DIR_OUTPUT);
+	osai_delay_us(5);
+	mtk_os_hal_gpio_set_direction(scl, OS_HAL_GPIO_DIR_INPUT);
+	osai_delay_us(5);
+	mtk_os_hal_gpio_set_direction(sda, OS_HAL_GPIO_DIR_INPUT);
+	osai_delay_us(5);
+
+	mtk_os_hal_gpio_get_input(sda, &level);
+
+	return level == OS_HAL_GPIO_DATA_HIGH ? 0 : -I2C_EBUSY;
+}
+
+/* reset the controller and, if the bus stays busy, clock it out */
+static int _mtk_os_hal_i2c_recover(struct mtk_i2c_ctrl_rtos *ctrl_rtos,
+				   int bus_num)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	int busy;
+
+	ctrl_rtos->stats.recover_cnt++;
+
+	mtk_mhal_i2c_init_hw(i2c);
+	busy = mtk_mhal_i2c_bus_busy(i2c);
+	if (busy > 0 && ctrl_rtos->rcv_gpio) {
+		_mtk_os_hal_i2c_clock_out(ctrl_rtos);
+		mtk_mhal_i2c_init_hw(i2c);
+		busy = mtk_mhal_i2c_bus_busy(i2c);
+	}
+
+	if (busy > 0) {
+		printf("i2c%d bus stuck busy\n", bus_num);
+		ctrl_rtos->stats.recover_fail_cnt++;
+		return -I2C_EBUSY;
+	}
+
+	return 0;
+}
+
+/* clean up after a failed master or slave transfer */
+static void _mtk_os_hal_i2c_error(struct mtk_i2c_ctrl_rtos *ctrl_rtos,
+				  int bus_num, int ret)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+
+	mtk_mhal_i2c_dump_register(i2c);
+
+	/* a timeout or a lost arbitration may leave the bus held */
+	if (i2c->i2c_mode == I2C_MASTER_MODE &&
+	    (ret == -I2C_ETIMEDOUT || ret == -I2C_EBUSY))
+		_mtk_os_hal_i2c_recover(ctrl_rtos, bus_num);
+	else
+		mtk_mhal_i2c_init_hw(i2c);
+}
+
 int _mtk_os_hal_i2c_transfer(struct mtk_i2c_ctrl_rtos *ctrl_rtos, int bus_num)
 {
 	int ret = I2C_OK;
 	struct mtk_i2c_controller *i2c;
+	u32 start = _mtk_os_hal_i2c_cycles();
 
 	i2c = ctrl_rtos->i2c;
 
+	/* fail fast on a stuck bus instead of waiting for the timeout */
+	if (i2c->i2c_mode == I2C_MASTER_MODE &&
+	    mtk_mhal_i2c_bus_busy(i2c) > 0) {
+		ret = _mtk_os_hal_i2c_recover(ctrl_rtos, bus_num);
+		if (ret)
+			goto err_exit;
+	}
+
 	ret = mtk_mhal_i2c_trigger_transfer(i2c);
 	if (ret) {
 		printf("i2c%d trigger transfer fail\n", bus_num);
@@ -266,12 +868,60 @@ int _mtk_os_hal_i2c_transfer(struct mtk_i2c_ctrl_rtos *ctrl_rtos, int bus_num)
 	} else
 		ret = mtk_mhal_i2c_result_handle(i2c);
 
-	if (ret) {
-		mtk_mhal_i2c_dump_register(i2c);
-		mtk_mhal_i2c_init_hw(i2c);
-	}
+	if (ret)
+		_mtk_os_hal_i2c_error(ctrl_rtos, bus_num, ret);
 
 err_exit:
+	_mtk_os_hal_i2c_stats_add(ctrl_rtos, ret, start);
+
+	return ret;
+}
+
+/* run a master transfer of num msgs, the caller holds the bus lock.
+ * speed 0 keeps the speed of the bus.
+ */
+static int _mtk_os_hal_i2c_master_xfer_locked(
+				struct mtk_i2c_ctrl_rtos *ctrl_rtos,
+				int bus_num, struct i2c_msg *msgs,
+				u8 num, enum i2c_speed_kHz speed, u32 timeout)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	enum i2c_speed_kHz bus_speed;
+	int ret;
+
+	/* trigger_transfer programs i2c_speed into the controller */
+	bus_speed = i2c->i2c_speed;
+	if (speed)
+		i2c->i2c_speed = speed;
+
+	i2c->msg_num = num;
+	i2c->dma_en = false;
+	i2c->i2c_mode = I2C_MASTER_MODE;
+	i2c->timeout = timeout;
+	i2c->irq_stat = 0;
+	i2c->msg = msgs;
+
+	ret = _mtk_os_hal_i2c_transfer(ctrl_rtos, bus_num);
+
+	i2c->i2c_speed = bus_speed;
+
+	return ret;
+}
+
+static int _mtk_os_hal_i2c_master_xfer(struct mtk_i2c_ctrl_rtos *ctrl_rtos,
+				       int bus_num, struct i2c_msg *msgs,
+				       u8 num, enum i2c_speed_kHz speed,
+				       u32 timeout)
+{
+	int ret;
+
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
+
+	ret = _mtk_os_hal_i2c_master_xfer_locked(ctrl_rtos, bus_num, msgs, num,
+						 speed, timeout);
+
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
 
 	return ret;
 }
@@ -299,9 +949,19 @@ int mtk_os_hal_i2c_ctrl_init(i2c_num bus_num)
 					     (void *)ctrl_rtos);
 
 	ctrl_rtos->i2c = i2c;
+
+	/* transaction latency is measured with the DWT cycle counter */
+	if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+
 #ifdef OSAI_FREERTOS
 	if (!ctrl_rtos->xfer_completion)
 		ctrl_rtos->xfer_completion = xSemaphoreCreateBinary();
+	if (!ctrl_rtos->bus_lock)
+		ctrl_rtos->bus_lock = xSemaphoreCreateMutex();
 #else
 	ctrl_rtos->xfer_completion = 0;
 #endif
@@ -341,11 +1001,17 @@ int mtk_os_hal_i2c_ctrl_deinit(i2c_num bus_num)
 		vSemaphoreDelete(ctrl_rtos->xfer_completion);
 		ctrl_rtos->xfer_completion = NULL;
 	}
+	if (ctrl_rtos->bus_lock) {
+		vSemaphoreDelete(ctrl_rtos->bus_lock);
+		ctrl_rtos->bus_lock = NULL;
+	}
 #else
 	ctrl_rtos->xfer_completion = 0;
 #endif
 
 	_mtk_os_hal_i2c_free_irq(bus_num);
+	ctrl_rtos->slave_on = 0;
+	ctrl_rtos->hw_busy = 0;
 	mtk_mhal_i2c_release_dma(i2c);
 	mtk_mhal_i2c_disable_clk(i2c);
 
@@ -372,13 +1038,40 @@ int mtk_os_hal_i2c_speed_init(i2c_num bus_num, enum i2c_speed_kHz speed)
 		return -I2C_EPTR;
 	}
 
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
 	ret = mtk_mhal_i2c_init_speed(i2c, speed);
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
 	if (ret)
 		printf("i2c%d init speed fail\n", bus_num);
 
 	return ret;
 }
 
+int mtk_os_hal_i2c_set_dma_threshold(i2c_num bus_num, u16 len)
+{
+	struct mtk_i2c_controller *i2c;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	i2c = g_i2c_ctrl_rtos[bus_num].i2c;
+	if (!i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", bus_num);
+		return -I2C_EPTR;
+	}
+
+#ifndef OSAI_ENABLE_DMA
+	/* FIFO mode only, nothing to select */
+	if (len && len < PIO_I2C_MAX_LEN)
+		return -I2C_EINVAL;
+#endif
+
+	i2c->dma_threshold = len;
+
+	return 0;
+}
+
 int mtk_os_hal_i2c_read(i2c_num bus_num, u8 device_addr, u8 *buffer, u16 len)
 {
 	struct i2c_msg msgs;
@@ -389,12 +1082,8 @@ int mtk_os_hal_i2c_read(i2c_num bus_num, u8 device_addr, u8 *buffer, u16 len)
 	if (bus_num >= OS_HAL_I2C_ISU_MAX)
 		return -I2C_EINVAL;
 
-#ifndef OSAI_ENABLE_DMA
-	if (len > PIO_I2C_MAX_LEN) {
-		printf("Error! buf length should be less than or equal to %d\n", PIO_I2C_MAX_LEN);
+	if (_mtk_os_hal_i2c_check_len(len))
 		return -I2C_EINVAL;
-	}
-#endif
 
 	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
 
@@ -404,20 +1093,12 @@ int mtk_os_hal_i2c_read(i2c_num bus_num, u8 device_addr, u8 *buffer, u16 len)
 		return -I2C_EPTR;
 	}
 
-	i2c->msg_num = 1;
-	i2c->dma_en = false;
-	i2c->i2c_mode = I2C_MASTER_MODE;
-	i2c->timeout = 2000;
-	i2c->irq_stat = 0;
-
 	msgs.addr = device_addr;
 	msgs.flags = I2C_MASTER_RD;
 	msgs.len = len;
 	msgs.buf = buffer;
 
-	i2c->msg = &msgs;
-
-	ret = _mtk_os_hal_i2c_transfer(ctrl_rtos, bus_num);
+	ret = _mtk_os_hal_i2c_master_xfer(ctrl_rtos, bus_num, &msgs, 1, 0, 2000);
 	if (ret)
 		printf("i2c%d read fail\n", bus_num);
 
@@ -434,12 +1115,8 @@ int   mtk_os_hal_i2c_write(i2c_num bus_num, u8 device_addr, u8 *buffer, u16 len)
 	if (bus_num >= OS_HAL_I2C_ISU_MAX)
 		return -I2C_EINVAL;
 
-#ifndef OSAI_ENABLE_DMA
-	if (len > PIO_I2C_MAX_LEN) {
-		printf("Error! buf length should be less than or equal to %d\n", PIO_I2C_MAX_LEN);
+	if (_mtk_os_hal_i2c_check_len(len))
 		return -I2C_EINVAL;
-	}
-#endif
 
 	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
 
@@ -449,20 +1126,12 @@ int   mtk_os_hal_i2c_write(i2c_num bus_num, u8 device_addr, u8 *buffer, u16 len)
 		return -I2C_EPTR;
 	}
 
-	i2c->msg_num = 1;
-	i2c->dma_en = false;
-	i2c->i2c_mode = I2C_MASTER_MODE;
-	i2c->timeout = 2000;
-	i2c->irq_stat = 0;
-
 	msgs.addr = device_addr;
 	msgs.flags = I2C_MASTER_WR;
 	msgs.len = len;
 	msgs.buf = buffer;
 
-	i2c->msg = &msgs;
-
-	ret = _mtk_os_hal_i2c_transfer(ctrl_rtos, bus_num);
+	ret = _mtk_os_hal_i2c_master_xfer(ctrl_rtos, bus_num, &msgs, 1, 0, 2000);
 	if (ret)
 		printf("i2c%d write fail\n", bus_num);
 
@@ -480,12 +1149,9 @@ int mtk_os_hal_i2c_write_read(i2c_num bus_num, u8 device_addr,
 	if (bus_num >= OS_HAL_I2C_ISU_MAX)
 		return -I2C_EINVAL;
 
-#ifndef OSAI_ENABLE_DMA
-	if (wr_len > PIO_I2C_MAX_LEN || rd_len > PIO_I2C_MAX_LEN) {
-		printf("Error! buf length should be less than or equal to %d\n", PIO_I2C_MAX_LEN);
+	if (_mtk_os_hal_i2c_check_len(wr_len) ||
+	    _mtk_os_hal_i2c_check_len(rd_len))
 		return -I2C_EINVAL;
-	}
-#endif
 
 	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
 
@@ -495,12 +1161,6 @@ int mtk_os_hal_i2c_write_read(i2c_num bus_num, u8 device_addr,
 		return -I2C_EPTR;
 	}
 
-	i2c->msg_num = 2;
-	i2c->dma_en = false;
-	i2c->i2c_mode = I2C_MASTER_MODE;
-	i2c->timeout = 2000;
-	i2c->irq_stat = 0;
-
 	msgs[0].addr = device_addr;
 	msgs[0].flags = I2C_MASTER_WR;
 	msgs[0].len = wr_len;
@@ -511,15 +1171,281 @@ int mtk_os_hal_i2c_write_read(i2c_num bus_num, u8 device_addr,
 	msgs[1].len = rd_len;
 	msgs[1].buf = rd_buf;
 
-	i2c->msg = &msgs[0];
-
-	ret = _mtk_os_hal_i2c_transfer(ctrl_rtos, bus_num);
+	ret = _mtk_os_hal_i2c_master_xfer(ctrl_rtos, bus_num, msgs, 2, 0, 2000);
 	if (ret)
 		printf("i2c%d write fail\n", bus_num);
 
 	return ret;
 }
 
+int mtk_os_hal_i2c_burst_read(i2c_num bus_num, u8 device_addr,
+			      u8 *wr_buf, u16 wr_len,
+			      const struct mtk_i2c_burst_seg *segs, u32 seg_cnt)
+{
+	struct i2c_msg msgs[2];
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	struct mtk_i2c_burst_buf *burst;
+	u8 *rd_buf;
+	u32 rd_len = 0;
+	u32 i;
+	int ret;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	if (!wr_buf || !segs)
+		return -I2C_EPTR;
+
+	for (i = 0; i < seg_cnt; i++)
+		rd_len += segs[i].len;
+
+	if (!wr_len || wr_len > I2C_FIFO_LEN ||
+	    !rd_len || rd_len > I2C_BURST_MAX_LEN ||
+	    _mtk_os_hal_i2c_check_len(rd_len))
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	if (!ctrl_rtos->i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", bus_num);
+		return -I2C_EPTR;
+	}
+
+	burst = &g_i2c_burst_buf[bus_num];
+
+	msgs[0].addr = device_addr;
+	msgs[0].flags = I2C_MASTER_WR;
+	msgs[0].len = wr_len;
+	msgs[0].buf = burst->wr;
+
+	msgs[1].addr = device_addr;
+	msgs[1].flags = I2C_MASTER_RD;
+	msgs[1].len = rd_len;
+	msgs[1].buf = burst->rd;
+
+	/* the staging buffer is shared by the bus, keep it until scattered */
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
+
+	memcpy(burst->wr, wr_buf, wr_len);
+	ret = _mtk_os_hal_i2c_master_xfer_locked(ctrl_rtos, bus_num, msgs, 2,
+						 0, 2000);
+	if (!ret) {
+		rd_buf = burst->rd;
+		for (i = 0; i < seg_cnt; i++) {
+			if (segs[i].buf)
+				memcpy(segs[i].buf, rd_buf, segs[i].len);
+			rd_buf += segs[i].len;
+		}
+	}
+
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
+
+	if (ret)
+		printf("i2c%d burst read fail\n", bus_num);
+
+	return ret;
+}
+
+int mtk_os_hal_i2c_device_init(struct mtk_i2c_device *dev, i2c_num bus_num,
+				u8 addr, enum i2c_speed_kHz speed,
+				u32 timeout)
+{
+	if (!dev)
+		return -I2C_EPTR;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX || addr >= 0x80)
+		return -I2C_EINVAL;
+
+	dev->bus_num = bus_num;
+	dev->addr = addr;
+	dev->speed = speed;
+	dev->timeout = timeout ? timeout : 2000;
+
+	return 0;
+}
+
+/* msgs[0..num-1] to dev, with the speed and timeout of dev */
+static int _mtk_os_hal_i2c_device_xfer(struct mtk_i2c_device *dev,
+				       struct i2c_msg *msgs, u8 num)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	u8 i;
+
+	if (!dev)
+		return -I2C_EPTR;
+
+	if (dev->bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	for (i = 0; i < num; i++) {
+		if (_mtk_os_hal_i2c_check_len(msgs[i].len))
+			return -I2C_EINVAL;
+		msgs[i].addr = dev->addr;
+	}
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[dev->bus_num];
+	if (!ctrl_rtos->i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", dev->bus_num);
+		return -I2C_EPTR;
+	}
+
+	return _mtk_os_hal_i2c_master_xfer(ctrl_rtos, dev->bus_num, msgs, num,
+					   dev->speed, dev->timeout);
+}
+
+int mtk_os_hal_i2c_device_read(struct mtk_i2c_device *dev, u8 *buffer,
+			       u16 len)
+{
+	struct i2c_msg msgs;
+
+	msgs.flags = I2C_MASTER_RD;
+	msgs.len = len;
+	msgs.buf = buffer;
+
+	return _mtk_os_hal_i2c_device_xfer(dev, &msgs, 1);
+}
+
+int mtk_os_hal_i2c_device_write(struct mtk_i2c_device *dev, u8 *buffer,
+				u16 len)
+{
+	struct i2c_msg msgs;
+
+	msgs.flags = I2C_MASTER_WR;
+	msgs.len = len;
+	msgs.buf = buffer;
+
+	return _mtk_os_hal_i2c_device_xfer(dev, &msgs, 1);
+}
+
+int mtk_os_hal_i2c_device_write_read(struct mtk_i2c_device *dev,
+				     u8 *wr_buf, u8 *rd_buf,
+				     u16 wr_len, u16 rd_len)
+{
+	struct i2c_msg msgs[2];
+
+	msgs[0].flags = I2C_MASTER_WR;
+	msgs[0].len = wr_len;
+	msgs[0].buf = wr_buf;
+
+	msgs[1].flags = I2C_MASTER_RD;
+	msgs[1].len = rd_len;
+	msgs[1].buf = rd_buf;
+
+	return _mtk_os_hal_i2c_device_xfer(dev, msgs, 2);
+}
+
+/* queue req for dev and start it if the bus is idle */
+static int _mtk_os_hal_i2c_submit(struct mtk_i2c_device *dev,
+				  struct mtk_i2c_request *req)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	u32 primask;
+
+	if (!dev || !req)
+		return -I2C_EPTR;
+
+	if (dev->bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	if (_mtk_os_hal_i2c_check_len(req->wr_len) ||
+	    _mtk_os_hal_i2c_check_len(req->rd_len))
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[dev->bus_num];
+	if (!ctrl_rtos->i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", dev->bus_num);
+		return -I2C_EPTR;
+	}
+
+	if (ctrl_rtos->slave_on)
+		return -I2C_EBUSY;
+
+	req->dev = dev;
+	req->status = 0;
+	req->next = NULL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (ctrl_rtos->q_tail)
+		ctrl_rtos->q_tail->next = req;
+	else
+		ctrl_rtos->q_head = req;
+	ctrl_rtos->q_tail = req;
+	/* while a blocking call waits, the request stays queued */
+	if (!ctrl_rtos->hw_busy && !ctrl_rtos->sync_wait)
+		_mtk_os_hal_i2c_async_start(ctrl_rtos);
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_i2c_device_async_read(struct mtk_i2c_device *dev,
+				     struct mtk_i2c_request *req,
+				     u8 *buffer, u16 len,
+				     i2c_async_complete complete,
+				     void *context)
+{
+	if (!req)
+		return -I2C_EPTR;
+
+	if (!len)
+		return -I2C_EINVAL;
+
+	req->wr_buf = NULL;
+	req->wr_len = 0;
+	req->rd_buf = buffer;
+	req->rd_len = len;
+	req->complete = complete;
+	req->context = context;
+
+	return _mtk_os_hal_i2c_submit(dev, req);
+}
+
+int mtk_os_hal_i2c_device_async_write(struct mtk_i2c_device *dev,
+				      struct mtk_i2c_request *req,
+				      u8 *buffer, u16 len,
+				      i2c_async_complete complete,
+				      void *context)
+{
+	if (!req)
+		return -I2C_EPTR;
+
+	if (!len)
+		return -I2C_EINVAL;
+
+	req->wr_buf = buffer;
+	req->wr_len = len;
+	req->rd_buf = NULL;
+	req->rd_len = 0;
+	req->complete = complete;
+	req->context = context;
+
+	return _mtk_os_hal_i2c_submit(dev, req);
+}
+
+int mtk_os_hal_i2c_device_async_write_read(struct mtk_i2c_device *dev,
+					   struct mtk_i2c_request *req,
+					   u8 *wr_buf, u8 *rd_buf,
+					   u16 wr_len, u16 rd_len,
+					   i2c_async_complete complete,
+					   void *context)
+{
+	if (!req)
+		return -I2C_EPTR;
+
+	if (!wr_len || !rd_len)
+		return -I2C_EINVAL;
+
+	req->wr_buf = wr_buf;
+	req->wr_len = wr_len;
+	req->rd_buf = rd_buf;
+	req->rd_len = rd_len;
+	req->complete = complete;
+	req->context = context;
+
+	return _mtk_os_hal_i2c_submit(dev, req);
+}
+
 int mtk_os_hal_i2c_set_slave_addr(i2c_num bus_num, u8 slv_addr)
 {
 	int ret = I2C_OK;
@@ -537,9 +1463,11 @@ int mtk_os_hal_i2c_set_slave_addr(i2c_num bus_num, u8 slv_addr)
 		return -I2C_EPTR;
 	}
 
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
 	i2c->i2c_mode = I2C_SLAVE_MODE;
-
 	ret = mtk_mhal_i2c_init_slv_addr(i2c, slv_addr);
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
 	if (ret)
 		printf("i2c%d init slv_addr fail\n", bus_num);
 
@@ -556,12 +1484,8 @@ int mtk_os_hal_i2c_slave_tx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out)
 	if (bus_num >= OS_HAL_I2C_ISU_MAX)
 		return -I2C_EINVAL;
 
-#ifndef OSAI_ENABLE_DMA
-	if (len > PIO_I2C_MAX_LEN) {
-		printf("Error! buf length should be less than or equal to %d\n", PIO_I2C_MAX_LEN);
+	if (_mtk_os_hal_i2c_check_len(len))
 		return -I2C_EINVAL;
-	}
-#endif
 
 	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
 
@@ -571,6 +1495,9 @@ int mtk_os_hal_i2c_slave_tx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out)
 		return -I2C_EPTR;
 	}
 
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
+
 	i2c->msg_num = 1;
 	i2c->dma_en = false;
 	i2c->i2c_mode = I2C_SLAVE_MODE;
@@ -584,6 +1511,8 @@ int mtk_os_hal_i2c_slave_tx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out)
 	i2c->msg = &msgs;
 
 	ret = _mtk_os_hal_i2c_transfer(ctrl_rtos, bus_num);
+
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
 	if (ret)
 		printf("i2c%d slave TX fail\n", bus_num);
 
@@ -601,12 +1530,8 @@ int mtk_os_hal_i2c_slave_rx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out)
 	if (bus_num >= OS_HAL_I2C_ISU_MAX)
 		return -I2C_EINVAL;
 
-#ifndef OSAI_ENABLE_DMA
-	if (len > PIO_I2C_MAX_LEN) {
-		printf("Error! buf length should be less than or equal to %d\n", PIO_I2C_MAX_LEN);
+	if (_mtk_os_hal_i2c_check_len(len))
 		return -I2C_EINVAL;
-	}
-#endif
 
 	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
 
@@ -616,6 +1541,9 @@ int mtk_os_hal_i2c_slave_rx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out)
 		return -I2C_EPTR;
 	}
 
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
+
 	i2c->msg_num = 1;
 	i2c->dma_en = false;
 	i2c->i2c_mode = I2C_SLAVE_MODE;
@@ -630,6 +1558,8 @@ int mtk_os_hal_i2c_slave_rx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out)
 	msgs.len = len;
 
 	ret = _mtk_os_hal_i2c_transfer(ctrl_rtos, bus_num);
+
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
 	if (ret) {
 		printf("i2c%d slave RX fail\n", bus_num);
 		return ret;
@@ -638,3 +1568,354 @@ int mtk_os_hal_i2c_slave_rx(i2c_num bus_num, u8 *buffer, u16 len, u32 time_out)
 	return 0;
 }
 
+/* run the sequence set up in ctrl_rtos as one blocking transfer */
+static int _mtk_os_hal_i2c_seq_run(struct mtk_i2c_ctrl_rtos *ctrl_rtos,
+				   int bus_num, u32 *fail_idx)
+{
+	struct mtk_i2c_controller *i2c = ctrl_rtos->i2c;
+	u32 start = _mtk_os_hal_i2c_cycles();
+	u32 primask;
+	int ret;
+
+	i2c->i2c_mode = I2C_MASTER_MODE;
+	/* records take well under a millisecond each at 100kHz */
+	i2c->timeout = 2000 + ctrl_rtos->seq_cnt;
+	ctrl_rtos->seq_idx = 0;
+	ctrl_rtos->seq_ret = 0;
+	_mtk_os_hal_i2c_seq_load(ctrl_rtos);
+
+	ret = mtk_mhal_i2c_trigger_transfer(i2c);
+	if (ret) {
+		printf("i2c%d trigger transfer fail\n", bus_num);
+		ctrl_rtos->seq_cnt = 0;
+	} else {
+		ret = _mtk_os_hal_i2c_wait_for_completion_timeout(ctrl_rtos,
+							  i2c->timeout);
+		if (ret) {
+			printf("Take i2c%d Semaphore timeout!\n", bus_num);
+			ret = -I2C_ETIMEDOUT;
+		} else {
+			ret = ctrl_rtos->seq_ret;
+		}
+	}
+
+	/* stop a sequence the waiter gave up on */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ctrl_rtos->seq_cnt = 0;
+	__set_PRIMASK(primask);
+
+	if (fail_idx)
+		*fail_idx = ctrl_rtos->seq_idx;
+
+	if (ret) {
+		printf("i2c%d sequence fail at %ld\n", bus_num,
+		       (long)ctrl_rtos->seq_idx);
+		_mtk_os_hal_i2c_error(ctrl_rtos, bus_num, ret);
+	}
+	_mtk_os_hal_i2c_stats_add(ctrl_rtos, ret, start);
+
+	ctrl_rtos->seq_regs = NULL;
+	ctrl_rtos->seq_msgs = NULL;
+
+	return ret;
+}
+
+int mtk_os_hal_i2c_write_regs(i2c_num bus_num, u8 device_addr,
+			      const u8 *regs, u32 cnt, u32 *fail_idx)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	int ret;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	if (!ctrl_rtos->i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", bus_num);
+		return -I2C_EPTR;
+	}
+
+	if (!regs || !cnt)
+		return -I2C_EINVAL;
+
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
+
+	ctrl_rtos->seq_regs = regs;
+	ctrl_rtos->seq_msgs = NULL;
+	ctrl_rtos->seq_addr = device_addr;
+	ctrl_rtos->seq_cnt = cnt;
+
+	ret = _mtk_os_hal_i2c_seq_run(ctrl_rtos, bus_num, fail_idx);
+
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
+
+	return ret;
+}
+
+int mtk_os_hal_i2c_transfer_seq(i2c_num bus_num,
+				struct mtk_i2c_seq_msg *msgs, u32 cnt,
+				u32 *fail_idx)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	u32 i;
+	int ret;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	if (!ctrl_rtos->i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", bus_num);
+		return -I2C_EPTR;
+	}
+
+	if (!msgs || !cnt)
+		return -I2C_EINVAL;
+
+	for (i = 0; i < cnt; i++) {
+		if (!msgs[i].wr_len && !msgs[i].rd_len)
+			return -I2C_EINVAL;
+		if (_mtk_os_hal_i2c_check_len(msgs[i].wr_len) ||
+		    _mtk_os_hal_i2c_check_len(msgs[i].rd_len))
+			return -I2C_EINVAL;
+	}
+
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
+
+	ctrl_rtos->seq_regs = NULL;
+	ctrl_rtos->seq_msgs = msgs;
+	ctrl_rtos->seq_cnt = cnt;
+
+	ret = _mtk_os_hal_i2c_seq_run(ctrl_rtos, bus_num, fail_idx);
+
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
+
+	return ret;
+}
+
+int mtk_os_hal_i2c_slave_start(i2c_num bus_num, u8 slv_addr,
+			       struct mtk_i2c_slave_config *config)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	struct mtk_i2c_controller *i2c;
+	int ret;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX || !config)
+		return -I2C_EINVAL;
+
+	if (config->regs ? !config->reg_size || config->reg_size > 256 :
+	    !config->rx_buf || !config->rx_size ||
+	    !config->tx_buf || !config->tx_size)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	i2c = ctrl_rtos->i2c;
+	if (!i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", bus_num);
+		return -I2C_EPTR;
+	}
+
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
+
+	i2c->i2c_mode = I2C_SLAVE_MODE;
+	ret = mtk_mhal_i2c_init_slv_addr(i2c, slv_addr);
+	if (ret) {
+		printf("i2c%d init slv_addr fail\n", bus_num);
+		_mtk_os_hal_i2c_unlock(ctrl_rtos);
+		return ret;
+	}
+
+	ctrl_rtos->slv = *config;
+	ctrl_rtos->rx_head = 0;
+	ctrl_rtos->rx_tail = 0;
+	ctrl_rtos->tx_head = 0;
+	ctrl_rtos->tx_tail = 0;
+	ctrl_rtos->tx_loaded = 0;
+	ctrl_rtos->reg_ptr = 0;
+	ctrl_rtos->rx_overrun = 0;
+
+	ret = mtk_mhal_i2c_slave_stream_start(i2c);
+	if (!ret) {
+		/* a register map is readable right away */
+		_mtk_os_hal_i2c_slave_fill(ctrl_rtos);
+		/* the controller stays owned by the slave until stop */
+		ctrl_rtos->slave_on = 1;
+	}
+
+#ifdef OSAI_FREERTOS
+	xSemaphoreGive(ctrl_rtos->bus_lock);
+#endif
+
+	return ret;
+}
+
+int mtk_os_hal_i2c_slave_stop(i2c_num bus_num)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	u32 primask;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	if (!ctrl_rtos->i2c || !ctrl_rtos->slave_on)
+		return -I2C_EINVAL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ctrl_rtos->slave_on = 0;
+	/* reset the controller, it stops answering the slave address */
+	mtk_mhal_i2c_init_hw(ctrl_rtos->i2c);
+	ctrl_rtos->i2c->i2c_mode = I2C_MASTER_MODE;
+	_mtk_os_hal_i2c_async_start(ctrl_rtos);
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_i2c_slave_read(i2c_num bus_num, u8 *buf, u32 len)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	u32 n, i;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX || !buf)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	if (!ctrl_rtos->slave_on || ctrl_rtos->slv.regs)
+		return -I2C_EINVAL;
+
+	/* single consumer, the irq only moves rx_head */
+	n = ctrl_rtos->rx_head - ctrl_rtos->rx_tail;
+	if (n > len)
+		n = len;
+	for (i = 0; i < n; i++)
+		buf[i] = ctrl_rtos->slv.rx_buf[(ctrl_rtos->rx_tail + i) %
+					       ctrl_rtos->slv.rx_size];
+	ctrl_rtos->rx_tail += n;
+
+	return n;
+}
+
+int mtk_os_hal_i2c_slave_write(i2c_num bus_num, u8 *buf, u32 len)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	u32 primask;
+	u32 n, i;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX || !buf)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	if (!ctrl_rtos->slave_on || ctrl_rtos->slv.regs)
+		return -I2C_EINVAL;
+
+	/* single producer, the irq only moves tx_tail */
+	n = ctrl_rtos->slv.tx_size - (ctrl_rtos->tx_head - ctrl_rtos->tx_tail);
+	if (n > len)
+		n = len;
+	for (i = 0; i < n; i++)
+		ctrl_rtos->slv.tx_buf[(ctrl_rtos->tx_head + i) %
+				      ctrl_rtos->slv.tx_size] = buf[i];
+	ctrl_rtos->tx_head += n;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	_mtk_os_hal_i2c_slave_fill(ctrl_rtos);
+	__set_PRIMASK(primask);
+
+	return n;
+}
+
+u32 mtk_os_hal_i2c_slave_get_overrun(i2c_num bus_num)
+{
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return 0;
+
+	return g_i2c_ctrl_rtos[bus_num].rx_overrun;
+}
+
+int mtk_os_hal_i2c_set_recovery_gpio(i2c_num bus_num, os_hal_gpio_pin scl,
+				     os_hal_gpio_pin sda)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	if (scl >= OS_HAL_GPIO_MAX || sda >= OS_HAL_GPIO_MAX || scl == sda)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	ctrl_rtos->rcv_scl = scl;
+	ctrl_rtos->rcv_sda = sda;
+	ctrl_rtos->rcv_gpio = 1;
+
+	/* released until a recovery needs them */
+	mtk_os_hal_gpio_set_direction(scl, OS_HAL_GPIO_DIR_INPUT);
+	mtk_os_hal_gpio_set_direction(sda, OS_HAL_GPIO_DIR_INPUT);
+
+	return 0;
+}
+
+int mtk_os_hal_i2c_recover(i2c_num bus_num)
+{
+	struct mtk_i2c_ctrl_rtos *ctrl_rtos;
+	int ret;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	ctrl_rtos = &g_i2c_ctrl_rtos[bus_num];
+	if (!ctrl_rtos->i2c) {
+		printf("i2c%d *i2c is NULL Pointer\n", bus_num);
+		return -I2C_EPTR;
+	}
+
+	if (_mtk_os_hal_i2c_lock(ctrl_rtos))
+		return -I2C_EBUSY;
+
+	ctrl_rtos->i2c->i2c_mode = I2C_MASTER_MODE;
+	ret = _mtk_os_hal_i2c_recover(ctrl_rtos, bus_num);
+
+	_mtk_os_hal_i2c_unlock(ctrl_rtos);
+
+	return ret;
+}
+
+int mtk_os_hal_i2c_get_stats(i2c_num bus_num, struct i2c_bus_stats *stats)
+{
+	u32 primask;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	if (!stats)
+		return -I2C_EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*stats = g_i2c_ctrl_rtos[bus_num].stats;
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_i2c_reset_stats(i2c_num bus_num)
+{
+	u32 primask;
+
+	if (bus_num >= OS_HAL_I2C_ISU_MAX)
+		return -I2C_EINVAL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	memset(&g_i2c_ctrl_rtos[bus_num].stats, 0, sizeof(struct i2c_bus_stats));
+	__set_PRIMASK(primask);
+
+	return 0;
+}
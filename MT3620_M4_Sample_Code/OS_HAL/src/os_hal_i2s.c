@@ -33,6 +33,7 @@
  * MEDIATEK SOFTWARE AT ISSUE.
  */
 
+#include "nvic.h"
 #include "os_hal_i2s.h"
 #include "os_hal_dma.h"
 
@@ -68,6 +69,26 @@ struct mtk_i2s_ctlr_cfg {
 	void *tx_callback_data;
 	i2s_dma_callback_func rx_callback_func;
 	void *rx_callback_data;
+
+	/* period ownership of the zero-copy API, 0 periods disables it.
+	 * The counters run in periods since mtk_os_hal_config_i2s().
+	 */
+	unsigned int *tx_buffer_addr;
+	unsigned int *rx_buffer_addr;
+	u32 tx_periods;
+	u32 rx_periods;
+	/* TX periods handed to the VFIFO and committed by the user */
+	volatile u32 tx_sent;
+	volatile u32 tx_done;
+	/* RX periods filled by the VFIFO and released by the user */
+	volatile u32 rx_recv;
+	volatile u32 rx_done;
+	/* the user holds a period; stale once an xrun took it away */
+	u8 tx_held;
+	volatile u8 tx_stale;
+	u8 rx_held;
+	volatile u8 rx_stale;
+	struct i2s_stream_stats stats;
 };
 
 static struct mtk_i2s_ctlr_cfg i2s0_ctlr_cfg;
@@ -75,8 +96,63 @@ static struct mtk_i2s_ctlr_cfg i2s1_ctlr_cfg;
 static struct mtk_i2s_private	i2s0_mdata;
 static struct mtk_i2s_private	i2s1_mdata;
 
+static struct mtk_i2s_ctlr_cfg *_mtk_os_hal_i2s_get_cfg(i2s_no i2s_port)
+{
+	if (i2s_port >= MTK_I2S_MAX_PORT_NUMBER)
+		return NULL;
+
+	return i2s_port == MHAL_I2S0 ? &i2s0_ctlr_cfg : &i2s1_ctlr_cfg;
+}
+
+static inline u32 *_mtk_os_hal_i2s_period_addr(unsigned int *buffer,
+					       u32 period_len, u32 idx)
+{
+	return (u32 *)((u8 *)buffer + period_len * idx);
+}
+
+/* the TX VFIFO takes the next period. If the user has not committed it,
+ * play silence and skip it, the user continues with the one after.
+ */
+static void _mtk_os_hal_i2s_tx_period(struct mtk_i2s_ctlr_cfg *cfg)
+{
+	if (!cfg->tx_periods)
+		return;
+
+	if (cfg->tx_done <= cfg->tx_sent) {
+		memset(_mtk_os_hal_i2s_period_addr(cfg->tx_buffer_addr,
+				cfg->tx_period_len,
+				cfg->tx_sent % cfg->tx_periods),
+		       0, cfg->tx_period_len);
+		cfg->tx_done = cfg->tx_sent + 1;
+		if (cfg->tx_held)
+			cfg->tx_stale = 1;
+		cfg->stats.tx_underrun++;
+	}
+	cfg->tx_sent++;
+	cfg->stats.tx_period_cnt++;
+}
+
+/* one more RX period is filled and the VFIFO moves on to the next one.
+ * If the user still owns that one, drop it so it can be overwritten.
+ */
+static void _mtk_os_hal_i2s_rx_period(struct mtk_i2s_ctlr_cfg *cfg)
+{
+	if (!cfg->rx_periods)
+		return;
+
+	cfg->rx_recv++;
+	cfg->stats.rx_period_cnt++;
+	if (cfg->rx_recv - cfg->rx_done >= cfg->rx_periods) {
+		if (cfg->rx_held)
+			cfg->rx_stale = 1;
+		cfg->rx_done++;
+		cfg->stats.rx_overrun++;
+	}
+}
+
 void _mtk_os_hal_i2s0_tx_callback(void *data)
 {
+	_mtk_os_hal_i2s_tx_period(&i2s0_ctlr_cfg);
 	mtk_mhal_i2s_move_tx_point(&i2s0_ctlr_cfg.i2s_ctrl,
 				   i2s0_ctlr_cfg.tx_period_len);
 	if (*i2s0_ctlr_cfg.tx_callback_func != NULL)
@@ -85,6 +161,7 @@ void _mtk_os_hal_i2s0_tx_callback(void *data)
 }
 void _mtk_os_hal_i2s0_rx_callback(void *data)
 {
+	_mtk_os_hal_i2s_rx_period(&i2s0_ctlr_cfg);
 	mtk_mhal_i2s_move_rx_point(&i2s0_ctlr_cfg.i2s_ctrl,
 				   i2s0_ctlr_cfg.rx_period_len);
 	if (*i2s0_ctlr_cfg.rx_callback_func != NULL)
@@ -93,6 +170,7 @@ void _mtk_os_hal_i2s0_rx_callback(void *data)
 }
 void _mtk_os_hal_i2s1_tx_callback(void *data)
 {
+	_mtk_os_hal_i2s_tx_period(&i2s1_ctlr_cfg);
 	mtk_mhal_i2s_move_tx_point(&i2s1_ctlr_cfg.i2s_ctrl,
 				   i2s1_ctlr_cfg.tx_period_len);
 	if (*i2s1_ctlr_cfg.tx_callback_func != NULL)
@@ -101,6 +179,7 @@ void _mtk_os_hal_i2s1_tx_callback(void *data)
 }
 void _mtk_os_hal_i2s1_rx_callback(void *data)
 {
+	_mtk_os_hal_i2s_rx_period(&i2s1_ctlr_cfg);
 	mtk_mhal_i2s_move_rx_point(&i2s1_ctlr_cfg.i2s_ctrl,
 				   i2s1_ctlr_cfg.rx_period_len);
 	if (*i2s1_ctlr_cfg.rx_callback_func != NULL)
@@ -235,6 +314,31 @@ int mtk_os_hal_config_i2s(i2s_no i2s_port, audio_parameter *parameter)
 	i2s_ctrl_cfg->tx_callback_data = parameter->tx_callback_data;
 	i2s_ctrl_cfg->rx_callback_data = parameter->rx_callback_data;
 
+	/* The buffer contents at this point are the first periods to
+	 * play, so all TX periods start out committed.
+	 */
+	i2s_ctrl_cfg->tx_buffer_addr = parameter->tx_buffer_addr;
+	i2s_ctrl_cfg->rx_buffer_addr = parameter->rx_buffer_addr;
+	i2s_ctrl_cfg->tx_periods = 0;
+	if (parameter->tx_period_len &&
+	    !(parameter->tx_buffer_len % parameter->tx_period_len))
+		i2s_ctrl_cfg->tx_periods = parameter->tx_buffer_len /
+					   parameter->tx_period_len;
+	i2s_ctrl_cfg->rx_periods = 0;
+	if (parameter->rx_period_len &&
+	    !(parameter->rx_buffer_len % parameter->rx_period_len))
+		i2s_ctrl_cfg->rx_periods = parameter->rx_buffer_len /
+					   parameter->rx_period_len;
+	i2s_ctrl_cfg->tx_sent = 0;
+	i2s_ctrl_cfg->tx_done = i2s_ctrl_cfg->tx_periods;
+	i2s_ctrl_cfg->rx_recv = 0;
+	i2s_ctrl_cfg->rx_done = 0;
+	i2s_ctrl_cfg->tx_held = 0;
+	i2s_ctrl_cfg->tx_stale = 0;
+	i2s_ctrl_cfg->rx_held = 0;
+	i2s_ctrl_cfg->rx_stale = 0;
+	memset(&i2s_ctrl_cfg->stats, 0, sizeof(struct i2s_stream_stats));
+
 	if (i2s_port == MHAL_I2S0)
 		result = mtk_mhal_i2s_cfg_tx_dma_irq_enable(
 					&i2s_ctrl_cfg->i2s_ctrl,
@@ -375,3 +479,130 @@ int mtk_os_hal_disable_i2s(i2s_no i2s_port)
 	}
 	return 0;
 }
+
+int mtk_os_hal_i2s_tx_acquire(i2s_no i2s_port, unsigned int **buf)
+{
+	struct mtk_i2s_ctlr_cfg *cfg = _mtk_os_hal_i2s_get_cfg(i2s_port);
+	u32 played;
+	u32 primask;
+	int ret = 0;
+
+	if (!cfg || !buf)
+		return -I2S_EPTR;
+	if (!cfg->tx_periods)
+		return -I2S_ELENGTH;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (cfg->tx_held && cfg->tx_stale) {
+		cfg->tx_held = 0;
+		cfg->tx_stale = 0;
+	}
+
+	/* the period handed out last is still playing */
+	played = cfg->tx_sent ? cfg->tx_sent - 1 : 0;
+	if (cfg->tx_held || cfg->tx_done - played < cfg->tx_periods) {
+		*buf = _mtk_os_hal_i2s_period_addr(cfg->tx_buffer_addr,
+				cfg->tx_period_len,
+				cfg->tx_done % cfg->tx_periods);
+		cfg->tx_held = 1;
+		ret = cfg->tx_period_len;
+	}
+
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+int mtk_os_hal_i2s_tx_commit(i2s_no i2s_port)
+{
+	struct mtk_i2s_ctlr_cfg *cfg = _mtk_os_hal_i2s_get_cfg(i2s_port);
+	u32 primask;
+
+	if (!cfg || !cfg->tx_held)
+		return -I2S_EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* an underrun already played silence in place of this period */
+	if (!cfg->tx_stale)
+		cfg->tx_done++;
+	cfg->tx_held = 0;
+	cfg->tx_stale = 0;
+
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_i2s_rx_acquire(i2s_no i2s_port, unsigned int **buf)
+{
+	struct mtk_i2s_ctlr_cfg *cfg = _mtk_os_hal_i2s_get_cfg(i2s_port);
+	u32 primask;
+	int ret = 0;
+
+	if (!cfg || !buf)
+		return -I2S_EPTR;
+	if (!cfg->rx_periods)
+		return -I2S_ELENGTH;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (cfg->rx_held && cfg->rx_stale) {
+		cfg->rx_held = 0;
+		cfg->rx_stale = 0;
+	}
+
+	if (cfg->rx_held || cfg->rx_recv != cfg->rx_done) {
+		*buf = _mtk_os_hal_i2s_period_addr(cfg->rx_buffer_addr,
+				cfg->rx_period_len,
+				cfg->rx_done % cfg->rx_periods);
+		cfg->rx_held = 1;
+		ret = cfg->rx_period_len;
+	}
+
+	__set_PRIMASK(primask);
+
+	return ret;
+}
+
+int mtk_os_hal_i2s_rx_release(i2s_no i2s_port)
+{
+	struct mtk_i2s_ctlr_cfg *cfg = _mtk_os_hal_i2s_get_cfg(i2s_port);
+	u32 primask;
+
+	if (!cfg || !cfg->rx_held)
+		return -I2S_EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* an overrun already dropped this period */
+	if (!cfg->rx_stale)
+		cfg->rx_done++;
+	cfg->rx_held = 0;
+	cfg->rx_stale = 0;
+
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_i2s_get_stats(i2s_no i2s_port, struct i2s_stream_stats *stats)
+{
+	struct mtk_i2s_ctlr_cfg *cfg = _mtk_os_hal_i2s_get_cfg(i2s_port);
+	u32 primask;
+
+	if (!cfg || !stats)
+		return -I2S_EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*stats = cfg->stats;
+	__set_PRIMASK(primask);
+
+	return 0;
+}
@@ -36,6 +36,7 @@
 #ifdef OSAI_FREERTOS
 #include <FreeRTOS.h>
 #include <semphr.h>
+#include <task.h>
 #endif
 
 #include "nvic.h"
@@ -43,8 +44,9 @@
 #include "os_hal_dma.h"
 #include "os_hal_spim.h"
 
-#if defined(OSAI_ENABLE_DMA) && !defined(OSAI_FREERTOS)
-static __attribute__((section(".sysram"))) uint8_t spim_dma_buf[MTK_SPIM_DMA_BUFFER_BYTES];
+#if defined(OSAI_ENABLE_DMA) && !defined(OSAI_FREERTOS) && !MTK_DMA_POOL_SIZE
+static __attribute__((section(".sysram")))
+	uint8_t spim_dma_buf[MTK_SPIM_DMA_BUFFER_BYTES * 2];
 #endif
 
 #define ISU0_SPIM_BASE			0x38070300
@@ -70,6 +72,14 @@ static int spim_dma_chan[OS_HAL_SPIM_ISU_MAX][2] = {
 	{DMA_ISU4_TX_CH8, DMA_ISU4_RX_CH9},
 };
 
+static const int spim_irq_num[OS_HAL_SPIM_ISU_MAX] = {
+	CM4_IRQ_ISU_G0_SPIM,
+	CM4_IRQ_ISU_G1_SPIM,
+	CM4_IRQ_ISU_G2_SPIM,
+	CM4_IRQ_ISU_G3_SPIM,
+	CM4_IRQ_ISU_G4_SPIM,
+};
+
 #define ISU0_CG_BASE	0x38070000
 #define ISU1_CG_BASE	0x38080000
 #define ISU2_CG_BASE	0x38090000
@@ -84,6 +94,13 @@ static unsigned long cg_base_addr[OS_HAL_SPIM_ISU_MAX] = {
 	ISU4_CG_BASE,
 };
 
+/* one deferred completion, written by the irq and read by the worker */
+struct mtk_spi_completion {
+	struct mtk_spi_message *msg;
+	int status;
+	u32 count;
+};
+
 /**
  * this os special spi structure, need mapping it to mtk_spi_controller
  */
@@ -97,12 +114,49 @@ struct mtk_spi_controller_rtos {
 	volatile u8 xfer_completion;
 #endif
 
-	/* used for async API */
-	spi_usr_complete_callback complete;
-	void *context;
+	/* bus manager: FIFO of submitted messages and the one on the wire */
+	struct mtk_spi_message *queue_head;
+	struct mtk_spi_message *queue_tail;
+	struct mtk_spi_message *cur_msg;
+	u8 busy;
+	/* message slot of the single-shot async APIs */
+	struct mtk_spi_message async_msg;
+	/* FIFO transfers up to this many data bytes are polled */
+	u32 poll_len;
+	/* NVIC line of the SPIM irq */
+	int irq_num;
+
+	/* async completions are called in irq or in the worker */
+	spim_complete_mode complete_mode;
+	/* single-producer (completion irq) single-consumer (worker) ring */
+	struct mtk_spi_completion cq[MTK_SPIM_COMPLETE_QUEUE_LEN];
+	volatile u32 cq_head;
+	volatile u32 cq_tail;
+	/* completions called in irq because the ring was full */
+	u32 cq_overflow;
+#ifdef OSAI_FREERTOS
+	/* serializes the tasks waiting on xfer_completion */
+	SemaphoreHandle_t bus_lock;
+#endif
+
+	/* result of the message on the wire, set before its completion */
+	int msg_ret;
+	/* next op of the batch message on the wire */
+	u32 op_idx;
+	/* transfer built from the current batch op */
+	struct mtk_spi_transfer op_xfer;
+
+	/* config the controller was last programmed with */
+	struct mtk_spi_config hw_config;
+	u8 hw_config_valid;
+	/* device handle that programmed hw_config, NULL for raw API */
+	struct mtk_spi_device *hw_owner;
 };
 
 static struct mtk_spi_controller_rtos g_spim_ctlr_rtos[OS_HAL_SPIM_ISU_MAX];
+#ifdef OSAI_FREERTOS
+static TaskHandle_t g_spim_complete_task;
+#endif
 static struct mtk_spi_controller g_spim_ctlr[OS_HAL_SPIM_ISU_MAX];
 static struct mtk_spi_private g_spim_mdata[OS_HAL_SPIM_ISU_MAX];
 
@@ -134,14 +188,359 @@ int mtk_os_hal_spim_dump_reg(spim_num bus_num)
 	return 0;
 }
 
+/* clock gate and reset the controller only if config differs from
+ * what it was last programmed with
+ */
+static int _mtk_os_hal_spim_apply_config(struct mtk_spi_controller_rtos
+					 *ctlr_rtos,
+					 struct mtk_spi_config *config,
+					 struct mtk_spi_device *dev)
+{
+	struct mtk_spi_controller *ctlr = ctlr_rtos->ctlr;
+
+	if (!config)
+		return -SPIM_EPTR;
+
+	if (ctlr_rtos->hw_config_valid) {
+		if (dev && ctlr_rtos->hw_owner == dev)
+			return 0;
+		if (!memcmp(&ctlr_rtos->hw_config, config, sizeof(*config))) {
+			ctlr_rtos->hw_owner = dev;
+			return 0;
+		}
+	}
+
+	mtk_mhal_spim_enable_clk(ctlr);
+	mtk_mhal_spim_prepare_hw(ctlr, config);
+
+	ctlr_rtos->hw_config = *config;
+	ctlr_rtos->hw_config_valid = 1;
+	ctlr_rtos->hw_owner = dev;
+
+	return 0;
+}
+
+/* force a full clock/reset/config on the next transfer */
+static void _mtk_os_hal_spim_invalidate_config(struct mtk_spi_controller_rtos
+					       *ctlr_rtos)
+{
+	ctlr_rtos->hw_config_valid = 0;
+	ctlr_rtos->hw_owner = NULL;
+}
+
+/* data bytes of all transfers of msg */
+static u32 _mtk_os_hal_spim_msg_len(struct mtk_spi_message *msg)
+{
+	u32 i, len = 0;
+
+	/* frames of a duplex stream are reported by frame_done() */
+	if (msg->duplex)
+		return 0;
+
+	if (!msg->ops)
+		return msg->xfer->len;
+
+	for (i = 0; i < msg->op_cnt; i++)
+		if (msg->ops[i].type != OS_HAL_SPIM_OP_HOOK)
+			len += msg->ops[i].len;
+
+	return len;
+}
+
+/* report the end of cur_msg and release the bus */
+static void _mtk_os_hal_spim_xfer_done(struct mtk_spi_controller_rtos
+				       *ctlr_rtos, int status)
+{
+	struct mtk_spi_message *msg = ctlr_rtos->cur_msg;
+#ifdef OSAI_FREERTOS
+	BaseType_t x_higher_priority_task_woken = pdFALSE;
+#endif
+
+	struct mtk_spi_completion *cq;
+	u32 head;
+
+	/* late irq of a message whose waiter already gave up */
+	if (!msg)
+		return;
+
+	ctlr_rtos->cur_msg = NULL;
+	ctlr_rtos->busy = 0;
+
+	if (msg->complete &&
+	    ctlr_rtos->complete_mode == OS_HAL_SPIM_COMPLETE_TASK) {
+		head = ctlr_rtos->cq_head;
+		if (head - ctlr_rtos->cq_tail < MTK_SPIM_COMPLETE_QUEUE_LEN) {
+			/* msg stays pending until the worker has called it */
+			cq = &ctlr_rtos->cq[head % MTK_SPIM_COMPLETE_QUEUE_LEN];
+			cq->msg = msg;
+			cq->status = status;
+			cq->count = status ? 0 : _mtk_os_hal_spim_msg_len(msg);
+			__DMB();
+			ctlr_rtos->cq_head = head + 1;
+#ifdef OSAI_FREERTOS
+			if (__get_IPSR()) {
+				vTaskNotifyGiveFromISR(g_spim_complete_task,
+					&x_higher_priority_task_woken);
+				portYIELD_FROM_ISR(x_higher_priority_task_woken);
+			} else {
+				xTaskNotifyGive(g_spim_complete_task);
+			}
+#endif
+			return;
+		}
+		ctlr_rtos->cq_overflow++;
+	}
+
+	msg->status = status;
+	msg->count = status ? 0 : _mtk_os_hal_spim_msg_len(msg);
+	msg->pending = 0;
+
+	if (msg->complete) {
+		/* async xfer */
+		msg->complete(msg->context);
+	} else {
+		/* sync xfer */
+#ifdef OSAI_FREERTOS
+		if (__get_IPSR()) {
+			xSemaphoreGiveFromISR(ctlr_rtos->xfer_completion,
+					      &x_higher_priority_task_woken);
+			portYIELD_FROM_ISR(x_higher_priority_task_woken);
+		} else {
+			xSemaphoreGive(ctlr_rtos->xfer_completion);
+		}
+#else
+		ctlr_rtos->xfer_completion++;
+#endif
+	}
+}
+
+/* put one transfer on the wire, completion comes from irq */
+static int _mtk_os_hal_spim_start_xfer(struct mtk_spi_controller_rtos
+				       *ctlr_rtos,
+				       struct mtk_spi_transfer *xfer,
+				       u8 stream)
+{
+	struct mtk_spi_controller *ctlr = ctlr_rtos->ctlr;
+	int ret;
+
+	if (stream)
+		return mtk_mhal_spim_dma_stream_start(ctlr, xfer);
+
+	ret = mtk_mhal_spim_prepare_transfer(ctlr, xfer);
+	if (ret)
+		return ret;
+
+	if (xfer->use_dma)
+#ifdef OSAI_ENABLE_DMA
+		ret = mtk_mhal_spim_dma_transfer_one(ctlr, xfer);
+#else
+		return -1;
+#endif
+	else
+		ret = mtk_mhal_spim_fifo_transfer_one(ctlr, xfer);
+
+	return ret;
+}
+
+/* translate a batch op into the controller's transaction format */
+static void _mtk_os_hal_spim_op_to_xfer(struct mtk_spi_op *op,
+					struct mtk_spi_transfer *xfer)
+{
+	const u8 *buf = op->buf;
+
+	xfer->tx_buf = NULL;
+	xfer->rx_buf = NULL;
+	xfer->tx_frame = NULL;
+	xfer->opcode = op->opcode;
+	xfer->opcode_len = op->opcode_len;
+	xfer->len = 0;
+	xfer->use_dma = op->use_dma;
+
+	switch (op->type) {
+	case OS_HAL_SPIM_OP_WRITE:
+		xfer->tx_buf = buf;
+		xfer->len = op->len;
+		/* FIFO tx needs an opcode, the stream engine borrows its own */
+		if (!op->use_dma && !op->opcode_len) {
+			xfer->opcode = buf[0];
+			xfer->opcode_len = 1;
+			xfer->tx_buf = buf + 1;
+			xfer->len = op->len - 1;
+		}
+		break;
+	case OS_HAL_SPIM_OP_READ:
+		xfer->rx_buf = op->buf;
+		xfer->len = op->len;
+		break;
+	default:
+		break;
+	}
+}
+
+/* run hooks and start the next transfer op of the batch on the wire.
+ * Return 1 if a transfer is in progress, 0 if the batch is finished.
+ */
+static int _mtk_os_hal_spim_batch_run(struct mtk_spi_controller_rtos
+				      *ctlr_rtos)
+{
+	struct mtk_spi_message *msg = ctlr_rtos->cur_msg;
+	struct mtk_spi_transfer *xfer = &ctlr_rtos->op_xfer;
+	struct mtk_spi_op *op;
+	int ret;
+
+	while (ctlr_rtos->op_idx < msg->op_cnt) {
+		op = &msg->ops[ctlr_rtos->op_idx++];
+
+		if (op->type == OS_HAL_SPIM_OP_HOOK) {
+			if (op->hook)
+				op->hook(op->arg);
+			continue;
+		}
+
+		_mtk_os_hal_spim_op_to_xfer(op, xfer);
+		ret = _mtk_os_hal_spim_start_xfer(ctlr_rtos, xfer, op->use_dma);
+
+		return ret ? ret : 1;
+	}
+
+	return 0;
+}
+
+/* the transfer on the wire is done, chain the rest of cur_msg.
+ * Return 1 if more of it is in progress, 0 if it is complete.
+ */
+static int _mtk_os_hal_spim_continue(struct mtk_spi_controller_rtos
+				     *ctlr_rtos)
+{
+	struct mtk_spi_message *msg = ctlr_rtos->cur_msg;
+	u8 *frame;
+	int ret;
+
+	if (msg && msg->duplex) {
+		ret = mtk_mhal_spim_dma_duplex_next(ctlr_rtos->ctlr, &frame);
+		if (frame && msg->frame_done)
+			msg->frame_done(msg->context, frame,
+					msg->duplex->frame_len);
+		if (ret > 0)
+			return 1;
+		if (ret < 0)
+			ctlr_rtos->msg_ret = ret;
+		return 0;
+	}
+
+	ret = mtk_mhal_spim_dma_stream_next(ctlr_rtos->ctlr);
+	if (ret > 0)
+		return 1;
+	if (ret < 0) {
+		ctlr_rtos->msg_ret = ret;
+		return 0;
+	}
+
+	if (msg && msg->ops && !ctlr_rtos->msg_ret) {
+		ret = _mtk_os_hal_spim_batch_run(ctlr_rtos);
+		if (ret > 0)
+			return 1;
+		if (ret < 0)
+			ctlr_rtos->msg_ret = ret;
+	}
+
+	return 0;
+}
+
+/* program the bus for msg and trigger it.
+ * Return 0 if it is in progress (completion comes from irq),
+ * 1 if it has already finished (a batch of hooks only).
+ */
+static int _mtk_os_hal_spim_start_msg(struct mtk_spi_controller_rtos
+				      *ctlr_rtos,
+				      struct mtk_spi_message *msg)
+{
+	struct mtk_spi_transfer *xfer = msg->xfer;
+	u32 speed_khz = 0;
+	int ret;
+
+	if (msg->dev && msg->dev->speed_khz)
+		speed_khz = msg->dev->speed_khz;
+
+	ret = _mtk_os_hal_spim_apply_config(ctlr_rtos, msg->config, msg->dev);
+	if (ret)
+		return ret;
+
+	ctlr_rtos->msg_ret = 0;
+
+	if (msg->duplex) {
+		if (speed_khz)
+			msg->duplex->speed_khz = speed_khz;
+		return mtk_mhal_spim_dma_duplex_start(ctlr_rtos->ctlr,
+						      msg->duplex);
+	}
+
+	if (msg->ops) {
+		ctlr_rtos->op_idx = 0;
+		ctlr_rtos->op_xfer.speed_khz = speed_khz;
+		ret = _mtk_os_hal_spim_batch_run(ctlr_rtos);
+		return (ret > 0) ? 0 : (ret ? ret : 1);
+	}
+
+	if (speed_khz)
+		xfer->speed_khz = speed_khz;
+
+	return _mtk_os_hal_spim_start_xfer(ctlr_rtos, xfer, msg->stream);
+}
+
+/* start queued messages until one is on the wire or the queue is empty.
+ * A start failure of owner is returned to its submitter instead of
+ * being reported through its completion.
+ */
+static int _mtk_os_hal_spim_kick(struct mtk_spi_controller_rtos *ctlr_rtos,
+				 struct mtk_spi_message *owner)
+{
+	struct mtk_spi_message *msg;
+	u32 primask;
+	int ret, owner_ret = 0;
+
+	while (1) {
+		primask = __get_PRIMASK();
+		__disable_irq();
+		msg = ctlr_rtos->queue_head;
+		if (ctlr_rtos->busy || !msg) {
+			__set_PRIMASK(primask);
+			return owner_ret;
+		}
+		ctlr_rtos->queue_head = msg->next;
+		if (!msg->next)
+			ctlr_rtos->queue_tail = NULL;
+		msg->next = NULL;
+		ctlr_rtos->busy = 1;
+		ctlr_rtos->cur_msg = msg;
+		__set_PRIMASK(primask);
+
+		ret = _mtk_os_hal_spim_start_msg(ctlr_rtos, msg);
+		if (!ret)
+			return owner_ret;
+		if (ret == 1) {
+			_mtk_os_hal_spim_xfer_done(ctlr_rtos, 0);
+			continue;
+		}
+
+		printf("spi master transfer one fail.\n");
+		if (msg == owner) {
+			ctlr_rtos->cur_msg = NULL;
+			msg->status = ret;
+			msg->pending = 0;
+			ctlr_rtos->busy = 0;
+			owner_ret = ret;
+		} else {
+			_mtk_os_hal_spim_xfer_done(ctlr_rtos, ret);
+		}
+	}
+}
+
 static int _mtk_os_hal_spim_irq_handler(spim_num bus_num)
 {
 	struct mtk_spi_controller_rtos *ctlr_rtos;
 	struct mtk_spi_controller *ctlr;
 	struct mtk_spi_transfer *curr_xfer;
-#ifdef OSAI_FREERTOS
-	BaseType_t x_higher_priority_task_woken = pdFALSE;
-#endif
 
 	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
 	if (!ctlr_rtos)
@@ -152,28 +551,24 @@ static int _mtk_os_hal_spim_irq_handler(spim_num bus_num)
 
 	mtk_mhal_spim_clear_irq_status(ctlr);
 
+	/* nothing on the wire, the buffers of curr_xfer are not ours */
+	if (!ctlr_rtos->cur_msg)
+		return 0;
+
 	if (!curr_xfer->use_dma)
 		mtk_mhal_spim_fifo_handle_rx(ctlr, curr_xfer);
 
 	/* 1. FIFO mode: return completion done in SPI irq handler
 	 * 2. DMA mode: return rx completion done in DMA irq handler
+	 * 3. DMA stream: chain the next segment instead of completing
 	 */
 	if (!curr_xfer->use_dma ||
 	    ((curr_xfer->opcode_len != 0) && !curr_xfer->rx_buf)) {
-		if (ctlr_rtos->complete) {
-			/* async xfer */
-			ctlr_rtos->complete(ctlr_rtos->context);
-			ctlr_rtos->complete = NULL;
-			ctlr_rtos->context = NULL;
-		} else {
-			/* sync xfer */
-#ifdef OSAI_FREERTOS
-			xSemaphoreGiveFromISR(ctlr_rtos->xfer_completion, &x_higher_priority_task_woken);
-			portYIELD_FROM_ISR(x_higher_priority_task_woken);
-#else
-			ctlr_rtos->xfer_completion++;
-#endif
-		}
+		if (_mtk_os_hal_spim_continue(ctlr_rtos))
+			return 0;
+
+		_mtk_os_hal_spim_xfer_done(ctlr_rtos, ctlr_rtos->msg_ret);
+		_mtk_os_hal_spim_kick(ctlr_rtos, NULL);
 	}
 
 	return 0;
@@ -258,26 +653,14 @@ static void _mtk_os_hal_spim_free_irq(int bus_num)
 
 static int _mtk_os_hal_spim_dma_done_callback(void *data)
 {
-#ifdef OSAI_FREERTOS
-	BaseType_t x_higher_priority_task_woken = pdFALSE;
-#endif
 	struct mtk_spi_controller_rtos *ctlr_rtos = data;
 
-	if (ctlr_rtos->complete) {
-		ctlr_rtos->complete(ctlr_rtos->context);
-		ctlr_rtos->complete = NULL;
-		ctlr_rtos->context = NULL;
-	} else {
-		/* while using DMA mode to do sync xfer,
-		 * release semaphore in this callback
-		 */
-#ifdef OSAI_FREERTOS
-		xSemaphoreGiveFromISR(ctlr_rtos->xfer_completion, &x_higher_priority_task_woken);
-		portYIELD_FROM_ISR(x_higher_priority_task_woken);
-#else
-		ctlr_rtos->xfer_completion++;
-#endif
-	}
+	if (_mtk_os_hal_spim_continue(ctlr_rtos))
+		return 0;
+
+	/* while using DMA mode, the rx DMA done is the end of the xfer */
+	_mtk_os_hal_spim_xfer_done(ctlr_rtos, ctlr_rtos->msg_ret);
+	_mtk_os_hal_spim_kick(ctlr_rtos, NULL);
 
 	return 0;
 }
@@ -298,17 +681,29 @@ int mtk_os_hal_spim_ctlr_init(spim_num bus_num)
 	ctlr = ctlr_rtos->ctlr;
 	ctlr->mdata = &g_spim_mdata[bus_num];
 
-	/* Allocated by pvPortMalloc to guard memory is in sram */
+	/* Allocated from the DMA pool or by pvPortMalloc to guard memory
+	 * is in sram. The second half is the stream ping-pong buffer.
+	 */
 #ifdef OSAI_ENABLE_DMA
 
-#ifdef OSAI_FREERTOS
-	ctlr->dma_tmp_tx_buf = pvPortMalloc(MTK_SPIM_DMA_BUFFER_BYTES);
+#if MTK_DMA_POOL_SIZE
+	ctlr->dma_tmp_tx_buf =
+		mtk_os_hal_dma_pool_alloc(MTK_SPIM_DMA_BUFFER_BYTES * 2);
+#elif defined(OSAI_FREERTOS)
+	ctlr->dma_tmp_tx_buf = pvPortMalloc(MTK_SPIM_DMA_BUFFER_BYTES * 2);
 #else
 	ctlr->dma_tmp_tx_buf = spim_dma_buf;
 #endif
+	if (!ctlr->dma_tmp_tx_buf) {
+		printf("spim%d dma buffer alloc fail\n", bus_num);
+		return -SPIM_ENOMEM;
+	}
+	ctlr->dma_stream_buf = ctlr->dma_tmp_tx_buf +
+			       MTK_SPIM_DMA_BUFFER_BYTES;
 
 #else	/* OSAI_ENABLE_DMA */
 	ctlr->dma_tmp_tx_buf = NULL;
+	ctlr->dma_stream_buf = NULL;
 #endif
 
 	ctlr->base = (void __iomem *)spim_base_addr[bus_num];
@@ -317,8 +712,12 @@ int mtk_os_hal_spim_ctlr_init(spim_num bus_num)
 	ctlr->dma_tx_chan = spim_dma_chan[bus_num][0];
 	ctlr->dma_rx_chan = spim_dma_chan[bus_num][1];
 
+	ctlr_rtos->poll_len = MTK_SPIM_POLL_LEN;
+	ctlr_rtos->irq_num = spim_irq_num[bus_num];
+
 #ifdef OSAI_FREERTOS
 	ctlr_rtos->xfer_completion = xSemaphoreCreateBinary();
+	ctlr_rtos->bus_lock = xSemaphoreCreateMutex();
 #else
 	ctlr_rtos->xfer_completion = 0;
 #endif
@@ -347,16 +746,20 @@ int mtk_os_hal_spim_ctlr_deinit(spim_num bus_num)
 
 #ifdef OSAI_FREERTOS
 	vSemaphoreDelete(ctlr_rtos->xfer_completion);
+	vSemaphoreDelete(ctlr_rtos->bus_lock);
 #else
 	ctlr_rtos->xfer_completion = 0;
 #endif
 	ctlr = ctlr_rtos->ctlr;
+	_mtk_os_hal_spim_invalidate_config(ctlr_rtos);
 
 	_mtk_os_hal_spim_free_irq(bus_num);
 	mtk_mhal_spim_release_dma_chan(ctlr);
 	mtk_mhal_spim_disable_clk(ctlr);
 
-#if defined(OSAI_ENABLE_DMA) && defined(OSAI_FREERTOS)
+#if defined(OSAI_ENABLE_DMA) && MTK_DMA_POOL_SIZE
+	mtk_os_hal_dma_pool_free(ctlr->dma_tmp_tx_buf);
+#elif defined(OSAI_ENABLE_DMA) && defined(OSAI_FREERTOS)
 	vPortFree(ctlr->dma_tmp_tx_buf);
 #endif
 	ctlr_rtos->ctlr = NULL;
@@ -385,47 +788,243 @@ static int _mtk_os_hal_spim_wait_for_completion_timeout(
 	return 0;
 }
 
-int mtk_os_hal_spim_transfer(spim_num bus_num,
-			     struct mtk_spi_config *config,
-			     struct mtk_spi_transfer *xfer)
+/* remove msg from the bus after its waiter gave up */
+static void _mtk_os_hal_spim_cancel(struct mtk_spi_controller_rtos *ctlr_rtos,
+				    struct mtk_spi_message *msg)
 {
-	struct mtk_spi_controller_rtos *ctlr_rtos;
-	struct mtk_spi_controller *ctlr;
-	int ret;
+	struct mtk_spi_message **pp, *prev = NULL;
+	u32 primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (ctlr_rtos->cur_msg == msg) {
+		ctlr_rtos->cur_msg = NULL;
+		ctlr_rtos->busy = 0;
+		/* stop the controller and its DMA before the bus goes to the
+		 * next message, a late completion would end that one instead
+		 */
+		mtk_mhal_spim_abort(ctlr_rtos->ctlr);
+		NVIC_ClearPendingIRQ((IRQn_Type)ctlr_rtos->irq_num);
+		_mtk_os_hal_spim_invalidate_config(ctlr_rtos);
+	} else {
+		for (pp = &ctlr_rtos->queue_head; *pp; pp = &(*pp)->next) {
+			if (*pp == msg) {
+				*pp = msg->next;
+				if (ctlr_rtos->queue_tail == msg)
+					ctlr_rtos->queue_tail = prev;
+				break;
+			}
+			prev = *pp;
+		}
+	}
+	msg->pending = 0;
+	msg->next = NULL;
+	__set_PRIMASK(primask);
 
-	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
-	if (!ctlr_rtos)
-		return -1;
+	_mtk_os_hal_spim_kick(ctlr_rtos, NULL);
+}
 
-	ctlr = ctlr_rtos->ctlr;
+/* every data op of a batch must carry at least one byte in a buffer */
+static int _mtk_os_hal_spim_check_ops(struct mtk_spi_op *ops, u32 op_cnt)
+{
+	u32 i;
+
+	for (i = 0; i < op_cnt; i++) {
+		if (ops[i].type != OS_HAL_SPIM_OP_WRITE &&
+		    ops[i].type != OS_HAL_SPIM_OP_READ)
+			continue;
+		if (!ops[i].buf)
+			return -SPIM_EPTR;
+		if (!ops[i].len)
+			return -SPIM_ELENGTH;
+	}
 
-	mtk_mhal_spim_enable_clk(ctlr);
+	return 0;
+}
 
-	mtk_mhal_spim_prepare_hw(ctlr, config);
-	mtk_mhal_spim_prepare_transfer(ctlr, xfer);
+/* append msg to the bus FIFO, start it at once if the bus is idle */
+static int _mtk_os_hal_spim_submit(struct mtk_spi_controller_rtos *ctlr_rtos,
+				   struct mtk_spi_message *msg)
+{
+	u32 primask;
+	int ret;
 
-	if (xfer->use_dma)
-#ifdef OSAI_ENABLE_DMA
-		ret = mtk_mhal_spim_dma_transfer_one(ctlr, xfer);
-#else
-		return -1;
-#endif
+	if (!ctlr_rtos->ctlr || (!msg->xfer && !msg->ops && !msg->duplex))
+		return -SPIM_EPTR;
+
+	if (msg->ops) {
+		ret = _mtk_os_hal_spim_check_ops(msg->ops, msg->op_cnt);
+		if (ret)
+			return ret;
+	}
+
+	msg->status = 0;
+	msg->pending = 1;
+	msg->next = NULL;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (ctlr_rtos->queue_tail)
+		ctlr_rtos->queue_tail->next = msg;
 	else
-		ret = mtk_mhal_spim_fifo_transfer_one(ctlr, xfer);
+		ctlr_rtos->queue_head = msg;
+	ctlr_rtos->queue_tail = msg;
+	__set_PRIMASK(primask);
+
+	return _mtk_os_hal_spim_kick(ctlr_rtos, msg);
+}
+
+/* Run a short FIFO msg with the SPIM irq masked and spin on the status.
+ * Return 1 if msg is not eligible or the bus is in use, the caller then
+ * queues it. If the budget runs out the irq is unmasked and the transfer
+ * completes through it as usual.
+ */
+static int _mtk_os_hal_spim_poll(struct mtk_spi_controller_rtos *ctlr_rtos,
+				 struct mtk_spi_message *msg, int *done)
+{
+	struct mtk_spi_controller *ctlr = ctlr_rtos->ctlr;
+	struct mtk_spi_transfer *xfer = msg->xfer;
+	u32 primask, budget;
+	int ret;
+
+	*done = 0;
+
+	if (!ctlr || msg->ops || msg->stream || xfer->use_dma ||
+	    xfer->len > ctlr_rtos->poll_len)
+		return 1;
 
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (ctlr_rtos->busy || ctlr_rtos->queue_head) {
+		__set_PRIMASK(primask);
+		return 1;
+	}
+	ctlr_rtos->busy = 1;
+	ctlr_rtos->cur_msg = msg;
+	msg->pending = 1;
+	msg->status = 0;
+	__set_PRIMASK(primask);
+
+	NVIC_DisableIRQ((IRQn_Type)ctlr_rtos->irq_num);
+
+	ret = _mtk_os_hal_spim_start_msg(ctlr_rtos, msg);
 	if (ret) {
 		printf("spi master transfer one fail.\n");
-		goto err_xfer_fail;
+		ctlr_rtos->cur_msg = NULL;
+		ctlr_rtos->busy = 0;
+		msg->pending = 0;
+		NVIC_EnableIRQ((IRQn_Type)ctlr_rtos->irq_num);
+		_mtk_os_hal_spim_kick(ctlr_rtos, NULL);
+		return ret;
 	}
 
-	ret = _mtk_os_hal_spim_wait_for_completion_timeout(ctlr_rtos, 1000);
-	if (ret)
-		printf("Take spi master Semaphore timeout!\n");
+	for (budget = MTK_SPIM_POLL_BUDGET; budget; budget--) {
+		if (mtk_mhal_spim_poll_done(ctlr) == 1)
+			break;
+	}
+
+	if (budget) {
+		mtk_mhal_spim_fifo_handle_rx(ctlr, xfer);
+		ctlr_rtos->cur_msg = NULL;
+		ctlr_rtos->busy = 0;
+		msg->count = xfer->len;
+		msg->pending = 0;
+		*done = 1;
+	}
+
+	/* the status read acknowledged the irq, drop its pending state.
+	 * Otherwise the irq completes msg as soon as it is unmasked.
+	 */
+	if (*done)
+		NVIC_ClearPendingIRQ((IRQn_Type)ctlr_rtos->irq_num);
+	NVIC_EnableIRQ((IRQn_Type)ctlr_rtos->irq_num);
+
+	if (*done)
+		_mtk_os_hal_spim_kick(ctlr_rtos, NULL);
+
+	return 0;
+}
+
+/* submit msg and block until it is done, one waiter per bus at a time */
+static int _mtk_os_hal_spim_sync(struct mtk_spi_controller_rtos *ctlr_rtos,
+				 struct mtk_spi_message *msg, int time_ms)
+{
+	int ret, done;
+
+	msg->complete = NULL;
+	msg->context = NULL;
+
+#ifdef OSAI_FREERTOS
+	xSemaphoreTake(ctlr_rtos->bus_lock, portMAX_DELAY);
+	/* drop a give left over by a message that timed out */
+	xSemaphoreTake(ctlr_rtos->xfer_completion, 0);
+#endif
+
+	ret = _mtk_os_hal_spim_poll(ctlr_rtos, msg, &done);
+	if (ret == 1)
+		ret = _mtk_os_hal_spim_submit(ctlr_rtos, msg);
+	else if (!ret && done)
+		goto out;
+
+	if (!ret) {
+		ret = _mtk_os_hal_spim_wait_for_completion_timeout(ctlr_rtos,
+								   time_ms);
+		if (ret) {
+			printf("Take spi master Semaphore timeout!\n");
+			_mtk_os_hal_spim_cancel(ctlr_rtos, msg);
+		} else {
+			ret = msg->status;
+		}
+	}
+
+out:
+#ifdef OSAI_FREERTOS
+	xSemaphoreGive(ctlr_rtos->bus_lock);
+#endif
 
-err_xfer_fail:
 	return ret;
 }
 
+/* queue a transfer in the single-shot async slot of the bus */
+static int _mtk_os_hal_spim_async(struct mtk_spi_controller_rtos *ctlr_rtos,
+				  struct mtk_spi_device *dev,
+				  struct mtk_spi_config *config,
+				  struct mtk_spi_transfer *xfer, u8 stream,
+				  spi_usr_complete_callback complete,
+				  void *context)
+{
+	struct mtk_spi_message *msg = &ctlr_rtos->async_msg;
+
+	if (msg->pending)
+		return -SPIM_EBUSY;
+
+	msg->dev = dev;
+	msg->config = config;
+	msg->xfer = xfer;
+	msg->stream = stream;
+	msg->complete = complete;
+	msg->context = context;
+
+	return _mtk_os_hal_spim_submit(ctlr_rtos, msg);
+}
+
+int mtk_os_hal_spim_transfer(spim_num bus_num,
+			     struct mtk_spi_config *config,
+			     struct mtk_spi_transfer *xfer)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+	struct mtk_spi_message msg = {0};
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	msg.config = config;
+	msg.xfer = xfer;
+
+	return _mtk_os_hal_spim_sync(ctlr_rtos, &msg, 1000);
+}
+
 int mtk_os_hal_spim_async_transfer(spim_num bus_num,
 				   struct mtk_spi_config *config,
 				   struct mtk_spi_transfer *xfer,
@@ -433,39 +1032,279 @@ int mtk_os_hal_spim_async_transfer(spim_num bus_num,
 				   void *context)
 {
 	struct mtk_spi_controller_rtos *ctlr_rtos;
-	struct mtk_spi_controller *ctlr;
-	int ret;
 
 	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
 	if (!ctlr_rtos)
 		return -1;
 
-	/* async user private function */
-	ctlr_rtos->complete = complete;
-	ctlr_rtos->context = context;
+	return _mtk_os_hal_spim_async(ctlr_rtos, NULL, config, xfer, 0,
+				      complete, context);
+}
 
-	ctlr = ctlr_rtos->ctlr;
+/* wire time of the stream at its bus clock, doubled for segment gaps */
+static int _mtk_os_hal_spim_stream_timeout_ms(struct mtk_spi_transfer *xfer)
+{
+	u32 speed_khz = xfer->speed_khz ? xfer->speed_khz : 1000;
 
-	mtk_mhal_spim_enable_clk(ctlr);
+	return 1000 + (xfer->len * 8 * 2) / speed_khz;
+}
 
-	mtk_mhal_spim_prepare_hw(ctlr, config);
-	mtk_mhal_spim_prepare_transfer(ctlr, xfer);
+int mtk_os_hal_spim_stream_transfer(spim_num bus_num,
+				    struct mtk_spi_config *config,
+				    struct mtk_spi_transfer *xfer)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+	struct mtk_spi_message msg = {0};
 
-	if (xfer->use_dma)
-#ifdef OSAI_ENABLE_DMA
-		ret = mtk_mhal_spim_dma_transfer_one(ctlr, xfer);
-#else
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	msg.config = config;
+	msg.xfer = xfer;
+	msg.stream = 1;
+
+	return _mtk_os_hal_spim_sync(ctlr_rtos, &msg,
+				     _mtk_os_hal_spim_stream_timeout_ms(xfer));
+}
+
+int mtk_os_hal_spim_async_stream_transfer(spim_num bus_num,
+					  struct mtk_spi_config *config,
+					  struct mtk_spi_transfer *xfer,
+					  spi_usr_complete_callback complete,
+					  void *context)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	return _mtk_os_hal_spim_async(ctlr_rtos, NULL, config, xfer, 1,
+				      complete, context);
+}
+
+int mtk_os_hal_spim_device_init(struct mtk_spi_device *dev,
+				spim_num bus_num,
+				struct mtk_spi_config *config,
+				u32 speed_khz)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+
+	if (!dev || !config)
+		return -SPIM_EPTR;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	/* the handle may be re-initialized with a different config */
+	if (ctlr_rtos->hw_owner == dev)
+		_mtk_os_hal_spim_invalidate_config(ctlr_rtos);
+
+	dev->bus_num = bus_num;
+	dev->config = *config;
+	dev->speed_khz = speed_khz;
+
+	return 0;
+}
+
+int mtk_os_hal_spim_device_transfer(struct mtk_spi_device *dev,
+				    struct mtk_spi_transfer *xfer)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+	struct mtk_spi_message msg = {0};
+
+	if (!dev)
+		return -SPIM_EPTR;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(dev->bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	msg.dev = dev;
+	msg.config = &dev->config;
+	msg.xfer = xfer;
+
+	return _mtk_os_hal_spim_sync(ctlr_rtos, &msg, 1000);
+}
+
+int mtk_os_hal_spim_device_async_transfer(struct mtk_spi_device *dev,
+					  struct mtk_spi_transfer *xfer,
+					  spi_usr_complete_callback complete,
+					  void *context)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+
+	if (!dev)
+		return -SPIM_EPTR;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(dev->bus_num);
+	if (!ctlr_rtos)
 		return -1;
+
+	return _mtk_os_hal_spim_async(ctlr_rtos, dev, &dev->config, xfer, 0,
+				      complete, context);
+}
+
+int mtk_os_hal_spim_device_submit(struct mtk_spi_device *dev,
+				  struct mtk_spi_message *msg)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+
+	if (!dev || !msg || !msg->complete)
+		return -SPIM_EPTR;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(dev->bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	if (msg->pending)
+		return -SPIM_EBUSY;
+
+	msg->dev = dev;
+	msg->config = &dev->config;
+
+	return _mtk_os_hal_spim_submit(ctlr_rtos, msg);
+}
+
+int mtk_os_hal_spim_set_poll_len(spim_num bus_num, u32 len)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	if (len > 32)
+		return -SPIM_ELENGTH;
+
+	ctlr_rtos->poll_len = len;
+
+	return 0;
+}
+
+int mtk_os_hal_spim_process_completions(void)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+	struct mtk_spi_completion cq;
+	struct mtk_spi_message *msg;
+	int bus_num, cnt = 0;
+	u32 tail;
+
+	for (bus_num = 0; bus_num < OS_HAL_SPIM_ISU_MAX; bus_num++) {
+		ctlr_rtos = &g_spim_ctlr_rtos[bus_num];
+
+		tail = ctlr_rtos->cq_tail;
+		while (tail != ctlr_rtos->cq_head) {
+			__DMB();
+			cq = ctlr_rtos->cq[tail % MTK_SPIM_COMPLETE_QUEUE_LEN];
+			ctlr_rtos->cq_tail = ++tail;
+
+			msg = cq.msg;
+			msg->status = cq.status;
+			msg->count = cq.count;
+			msg->pending = 0;
+			msg->complete(msg->context);
+			cnt++;
+		}
+	}
+
+	return cnt;
+}
+
+#ifdef OSAI_FREERTOS
+static void _mtk_os_hal_spim_complete_task(void *arg)
+{
+	while (1) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		mtk_os_hal_spim_process_completions();
+	}
+}
 #endif
-	else
-		ret = mtk_mhal_spim_fifo_transfer_one(ctlr, xfer);
 
-	if (ret) {
-		printf("spi master async one fail.\n");
-		ctlr_rtos->complete = NULL;
-		ctlr_rtos->context = NULL;
+int mtk_os_hal_spim_set_complete_mode(spim_num bus_num,
+				      spim_complete_mode mode)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	if (mode != OS_HAL_SPIM_COMPLETE_ISR &&
+	    mode != OS_HAL_SPIM_COMPLETE_TASK)
+		return -SPIM_EPTR;
+
+#ifdef OSAI_FREERTOS
+	/* one worker serves every bus, created on first use */
+	if (mode == OS_HAL_SPIM_COMPLETE_TASK && !g_spim_complete_task) {
+		if (xTaskCreate(_mtk_os_hal_spim_complete_task, "SPIM Complete",
+				MTK_SPIM_COMPLETE_TASK_STACK, NULL,
+				MTK_SPIM_COMPLETE_TASK_PRIO,
+				&g_spim_complete_task) != pdPASS) {
+			printf("spim complete task create fail\n");
+			return -SPIM_ENOMEM;
+		}
 	}
+#endif
 
-	return ret;
+	ctlr_rtos->complete_mode = mode;
+
+	return 0;
+}
+
+int mtk_os_hal_spim_get_complete_overflow(spim_num bus_num, u32 *count)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	if (!count)
+		return -SPIM_EPTR;
+
+	*count = ctlr_rtos->cq_overflow;
+
+	return 0;
+}
+
+int mtk_os_hal_spim_device_batch(struct mtk_spi_device *dev,
+				 struct mtk_spi_op *ops, u32 op_cnt)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+	struct mtk_spi_message msg = {0};
+	u32 i, time_ms = 1000, speed_khz;
+
+	if (!dev || !ops || !op_cnt)
+		return -SPIM_EPTR;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(dev->bus_num);
+	if (!ctlr_rtos)
+		return -1;
+
+	msg.dev = dev;
+	msg.config = &dev->config;
+	msg.ops = ops;
+	msg.op_cnt = op_cnt;
+
+	/* allow for the wire time of long DMA ops */
+	speed_khz = dev->speed_khz ? dev->speed_khz : 1000;
+	for (i = 0; i < op_cnt; i++)
+		if (ops[i].type != OS_HAL_SPIM_OP_HOOK)
+			time_ms += (ops[i].len * 8 * 2) / speed_khz;
+
+	return _mtk_os_hal_spim_sync(ctlr_rtos, &msg, time_ms);
 }
 
+int mtk_os_hal_spim_duplex_stop(spim_num bus_num)
+{
+	struct mtk_spi_controller_rtos *ctlr_rtos;
+
+	ctlr_rtos = _mtk_os_hal_spim_get_ctlr(bus_num);
+	if (!ctlr_rtos || !ctlr_rtos->ctlr)
+		return -1;
+
+	return mtk_mhal_spim_dma_duplex_stop(ctlr_rtos->ctlr);
+}
@@ -0,0 +1,507 @@
+/*
+ * (C) 2005-2020 MediaTek Inc. All rights reserved.
+ *
+ * Copyright Statement:
+ *
+ * This MT3620 driver software/firmware and related documentation
+ * ("MediaTek Software") are protected under relevant copyright laws.
+ * The information contained herein is confidential and proprietary to
+ * MediaTek Inc. ("MediaTek"). You may only use, reproduce, modify, or
+ * distribute (as applicable) MediaTek Software if you have agreed to and been
+ * bound by this Statement and the applicable license agreement with MediaTek
+ * ("License Agreement") and been granted explicit permission to do so within
+ * the License Agreement ("Permitted User"). If you are not a Permitted User,
+ * please cease any access or use of MediaTek Software immediately.
+ *
+ * BY OPENING THIS FILE, RECEIVER HEREBY UNEQUIVOCALLY ACKNOWLEDGES AND AGREES
+ * THAT MEDIATEK SOFTWARE RECEIVED FROM MEDIATEK AND/OR ITS REPRESENTATIVES ARE
+ * PROVIDED TO RECEIVER ON AN "AS-IS" BASIS ONLY. MEDIATEK EXPRESSLY DISCLAIMS
+ * ANY AND ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE OR
+ * NONINFRINGEMENT. NEITHER DOES MEDIATEK PROVIDE ANY WARRANTY WHATSOEVER WITH
+ * RESPECT TO THE SOFTWARE OF ANY THIRD PARTY WHICH MAY BE USED BY,
+ * INCORPORATED IN, OR SUPPLIED WITH MEDIATEK SOFTWARE, AND RECEIVER AGREES TO
+ * LOOK ONLY TO SUCH THIRD PARTY FOR ANY WARRANTY CLAIM RELATING THERETO.
+ * RECEIVER EXPRESSLY ACKNOWLEDGES THAT IT IS RECEIVER'S SOLE RESPONSIBILITY TO
+ * OBTAIN FROM ANY THIRD PARTY ALL PROPER LICENSES CONTAINED IN MEDIATEK
+ * SOFTWARE. MEDIATEK SHALL ALSO NOT BE RESPONSIBLE FOR ANY MEDIATEK SOFTWARE
+ * RELEASES MADE TO RECEIVER'S SPECIFICATION OR TO CONFORM TO A PARTICULAR
+ * STANDARD OR OPEN FORUM. RECEIVER'S SOLE AND EXCLUSIVE REMEDY AND MEDIATEK'S
+ * ENTIRE AND CUMULATIVE LIABILITY WITH RESPECT TO MEDIATEK SOFTWARE RELEASED
+ * HEREUNDER WILL BE ANY SOFTWARE LICENSE FEES OR SERVICE CHARGE PAID BY
+ * RECEIVER TO MEDIATEK DURING THE PRECEDING TWELVE (12) MONTHS FOR SUCH
+ * MEDIATEK SOFTWARE AT ISSUE.
+ */
+
+#ifdef OSAI_FREERTOS
+#include <FreeRTOS.h>
+#endif
+
+#include "nvic.h"
+
+#include "os_hal_dma.h"
+#include "os_hal_spis.h"
+
+#define MTK_SPIS_RING_BYTES	(MTK_SPIS_RING_FRAMES * MTK_SPIS_FRAME_BYTES)
+/* rx ring, tx ring, the response and the slot of dropped host writes */
+#define MTK_SPIS_BUF_BYTES	(MTK_SPIS_RING_BYTES * 2 + \
+				 MTK_SPIS_FRAME_BYTES * 2)
+
+#if !defined(OSAI_FREERTOS) && !MTK_DMA_POOL_SIZE
+static __attribute__((section(".sysram"), aligned(4)))
+	uint8_t spis_dma_buf[OS_HAL_SPIS_ISU_MAX][MTK_SPIS_BUF_BYTES];
+#endif
+
+#define ISU0_SPIS_BASE			0x38070400
+#define ISU1_SPIS_BASE			0x38080400
+#define ISU2_SPIS_BASE			0x38090400
+#define ISU3_SPIS_BASE			0x380a0400
+#define ISU4_SPIS_BASE			0x380b0400
+
+static unsigned long spis_base_addr[OS_HAL_SPIS_ISU_MAX] = {
+	ISU0_SPIS_BASE,
+	ISU1_SPIS_BASE,
+	ISU2_SPIS_BASE,
+	ISU3_SPIS_BASE,
+	ISU4_SPIS_BASE,
+};
+
+#define ISU0_CG_BASE	0x38070000
+#define ISU1_CG_BASE	0x38080000
+#define ISU2_CG_BASE	0x38090000
+#define ISU3_CG_BASE	0x380a0000
+#define ISU4_CG_BASE	0x380b0000
+
+static unsigned long cg_base_addr[OS_HAL_SPIS_ISU_MAX] = {
+	ISU0_CG_BASE,
+	ISU1_CG_BASE,
+	ISU2_CG_BASE,
+	ISU3_CG_BASE,
+	ISU4_CG_BASE,
+};
+
+static int spis_dma_chan[OS_HAL_SPIS_ISU_MAX][2] = {
+	/* [0]:tx, [1]:rx */
+	{DMA_ISU0_TX_CH0, DMA_ISU0_RX_CH1},
+	{DMA_ISU1_TX_CH2, DMA_ISU1_RX_CH3},
+	{DMA_ISU2_TX_CH4, DMA_ISU2_RX_CH5},
+	{DMA_ISU3_TX_CH6, DMA_ISU3_RX_CH7},
+	{DMA_ISU4_TX_CH8, DMA_ISU4_RX_CH9},
+};
+
+static const int spis_irq_num[OS_HAL_SPIS_ISU_MAX] = {
+	CM4_IRQ_ISU_G0_SPIS,
+	CM4_IRQ_ISU_G1_SPIS,
+	CM4_IRQ_ISU_G2_SPIS,
+	CM4_IRQ_ISU_G3_SPIS,
+	CM4_IRQ_ISU_G4_SPIS,
+};
+
+/**
+ * this os special spis structure, need mapping it to mtk_spis_controller
+ */
+struct mtk_spis_controller_rtos {
+	struct mtk_spis_controller *ctlr;
+	/* filled from the H2DMB by M-HAL, buffers by this driver */
+	struct mtk_spis_transfer xfer;
+
+	/* DMA-safe memory of the rings, see MTK_SPIS_BUF_BYTES */
+	u8 *buf;
+	/* frames written by the host: irq produces, read() consumes */
+	u8 *rx_ring;
+	u32 rx_len[MTK_SPIS_RING_FRAMES];
+	volatile u32 rx_head;
+	volatile u32 rx_tail;
+	/* frames for the host to read: write() produces, irq consumes */
+	u8 *tx_ring;
+	volatile u32 tx_head;
+	volatile u32 tx_tail;
+	/* sent when the tx ring is empty */
+	u8 *response;
+	/* receives host writes while the rx ring is full */
+	u8 *scratch;
+	u32 overrun;
+
+	/* an H2DMB was accepted, its data phase is on the wire */
+	u8 in_data;
+	/* xfer uses a ring slot, which is committed when it is done */
+	u8 from_ring;
+
+	spis_rx_frame_callback rx_done;
+	spis_tx_frame_callback tx_done;
+	void *context;
+};
+
+static struct mtk_spis_controller_rtos g_spis_ctlr_rtos[OS_HAL_SPIS_ISU_MAX];
+static struct mtk_spis_controller g_spis_ctlr[OS_HAL_SPIS_ISU_MAX];
+static struct mtk_spis_private g_spis_mdata[OS_HAL_SPIS_ISU_MAX];
+
+static struct mtk_spis_controller_rtos *
+	_mtk_os_hal_spis_get_ctlr(spis_num bus_num)
+{
+	if (bus_num > OS_HAL_SPIS_ISU_MAX - 1) {
+		printf("invalid, bus_num should be 0~%d\n",
+			OS_HAL_SPIS_ISU_MAX - 1);
+		return NULL;
+	}
+
+	return &g_spis_ctlr_rtos[bus_num];
+}
+
+static u8 *_mtk_os_hal_spis_slot(u8 *ring, u32 idx)
+{
+	return ring + (idx % MTK_SPIS_RING_FRAMES) * MTK_SPIS_FRAME_BYTES;
+}
+
+/* called by M-HAL once the H2DMB is parsed: point xfer at the memory
+ * the data phase uses, so DMA moves it without any copy
+ */
+static int _mtk_os_hal_spis_handle_transfer(void *user_data,
+					    enum spis_direction_cmd cmd)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos = user_data;
+	struct mtk_spis_transfer *xfer = &ctlr_rtos->xfer;
+
+	if (cmd == SPIM_WRITE_DATA) {
+		xfer->tx_buf = NULL;
+		ctlr_rtos->from_ring = (ctlr_rtos->rx_head - ctlr_rtos->rx_tail <
+					MTK_SPIS_RING_FRAMES);
+		if (ctlr_rtos->from_ring)
+			xfer->rx_buf = _mtk_os_hal_spis_slot(ctlr_rtos->rx_ring,
+							ctlr_rtos->rx_head);
+		else
+			xfer->rx_buf = ctlr_rtos->scratch;
+	} else {
+		xfer->rx_buf = NULL;
+		ctlr_rtos->from_ring = (ctlr_rtos->tx_head != ctlr_rtos->tx_tail);
+		if (ctlr_rtos->from_ring)
+			xfer->tx_buf = _mtk_os_hal_spis_slot(ctlr_rtos->tx_ring,
+							ctlr_rtos->tx_tail);
+		else
+			xfer->tx_buf = ctlr_rtos->response;
+	}
+
+	return 0;
+}
+
+/* the data phase of the accepted H2DMB is done */
+static void _mtk_os_hal_spis_data_done(struct mtk_spis_controller_rtos
+				       *ctlr_rtos)
+{
+	struct mtk_spis_controller *ctlr = ctlr_rtos->ctlr;
+	struct mtk_spis_transfer *xfer = &ctlr_rtos->xfer;
+	u32 idx;
+
+	if (!ctlr_rtos->in_data)
+		return;
+	ctlr_rtos->in_data = 0;
+
+	if (xfer->direction == SPIM_WRITE_DATA) {
+		mtk_mhal_spis_handle_rx(ctlr);
+		mtk_mhal_spis_send_d2hmb(ctlr);
+
+		if (!ctlr_rtos->from_ring) {
+			ctlr_rtos->overrun++;
+			return;
+		}
+		idx = ctlr_rtos->rx_head % MTK_SPIS_RING_FRAMES;
+		ctlr_rtos->rx_len[idx] = xfer->len;
+		__DMB();
+		ctlr_rtos->rx_head++;
+
+		if (ctlr_rtos->rx_done)
+			ctlr_rtos->rx_done(ctlr_rtos->context, xfer->rx_buf,
+					   xfer->len);
+	} else {
+		mtk_mhal_spis_handle_tx(ctlr);
+		mtk_mhal_spis_send_d2hmb(ctlr);
+
+		if (ctlr_rtos->from_ring)
+			ctlr_rtos->tx_tail++;
+
+		if (ctlr_rtos->tx_done)
+			ctlr_rtos->tx_done(ctlr_rtos->context, xfer->len);
+	}
+}
+
+/* mhal_spis.h does not export the irq status codes, the phase tells what
+ * the irq means: with no data phase pending it is a new H2DMB, otherwise
+ * it ends the FIFO data phase (a DMA data phase ends in the DMA irq).
+ */
+static void _mtk_os_hal_spis_irq_handler(spis_num bus_num)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos = &g_spis_ctlr_rtos[bus_num];
+	struct mtk_spis_controller *ctlr = ctlr_rtos->ctlr;
+	struct mtk_spis_transfer *xfer = &ctlr_rtos->xfer;
+	int ret;
+
+	mtk_mhal_spis_get_irq_status(ctlr);
+	mtk_mhal_spis_clear_irq_status(ctlr);
+
+	if (ctlr_rtos->in_data) {
+		if (!xfer->use_dma)
+			_mtk_os_hal_spis_data_done(ctlr_rtos);
+		return;
+	}
+
+	/* parses the H2DMB and calls _mtk_os_hal_spis_handle_transfer() */
+	ret = mtk_mhal_spis_handle_h2dmb(ctlr);
+	mtk_mhal_spis_send_d2hmb(ctlr);
+	if (ret)
+		return;
+
+	if (xfer->use_dma)
+		ret = mtk_mhal_spis_dma_transfer_one(ctlr, xfer);
+	else
+		ret = mtk_mhal_spis_fifo_transfer_one(ctlr, xfer);
+	if (ret) {
+		printf("spis%d transfer one fail %d\n", bus_num, ret);
+		return;
+	}
+
+	ctlr_rtos->in_data = 1;
+}
+
+static int _mtk_os_hal_spis_dma_done_callback(void *user_data)
+{
+	_mtk_os_hal_spis_data_done(user_data);
+
+	return 0;
+}
+
+static void _mtk_os_hal_spis0_irq_event(void)
+{
+	_mtk_os_hal_spis_irq_handler(OS_HAL_SPIS_ISU0);
+}
+
+static void _mtk_os_hal_spis1_irq_event(void)
+{
+	_mtk_os_hal_spis_irq_handler(OS_HAL_SPIS_ISU1);
+}
+
+static void _mtk_os_hal_spis2_irq_event(void)
+{
+	_mtk_os_hal_spis_irq_handler(OS_HAL_SPIS_ISU2);
+}
+
+static void _mtk_os_hal_spis3_irq_event(void)
+{
+	_mtk_os_hal_spis_irq_handler(OS_HAL_SPIS_ISU3);
+}
+
+static void _mtk_os_hal_spis4_irq_event(void)
+{
+	_mtk_os_hal_spis_irq_handler(OS_HAL_SPIS_ISU4);
+}
+
+static void (*const spis_irq_event[OS_HAL_SPIS_ISU_MAX])(void) = {
+	_mtk_os_hal_spis0_irq_event,
+	_mtk_os_hal_spis1_irq_event,
+	_mtk_os_hal_spis2_irq_event,
+	_mtk_os_hal_spis3_irq_event,
+	_mtk_os_hal_spis4_irq_event,
+};
+
+int mtk_os_hal_spis_ctlr_init(spis_num bus_num,
+			      struct mtk_spis_config *config)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos;
+	struct mtk_spis_controller *ctlr;
+	struct mtk_spis_private *mdata;
+
+	ctlr_rtos = _mtk_os_hal_spis_get_ctlr(bus_num);
+	if (!ctlr_rtos || !config)
+		return -EPTR;
+
+	memset(ctlr_rtos, 0, sizeof(struct mtk_spis_controller_rtos));
+
+	ctlr_rtos->ctlr = &g_spis_ctlr[bus_num];
+	ctlr = ctlr_rtos->ctlr;
+	ctlr->mdata = &g_spis_mdata[bus_num];
+	mdata = ctlr->mdata;
+
+	/* Allocated from the DMA pool or by pvPortMalloc to guard memory
+	 * is in sram, the HW moves whole double words so every slot is
+	 * 4 bytes aligned.
+	 */
+#if MTK_DMA_POOL_SIZE
+	ctlr_rtos->buf = mtk_os_hal_dma_pool_alloc(MTK_SPIS_BUF_BYTES);
+#elif defined(OSAI_FREERTOS)
+	ctlr_rtos->buf = pvPortMalloc(MTK_SPIS_BUF_BYTES);
+#else
+	ctlr_rtos->buf = spis_dma_buf[bus_num];
+#endif
+	if (!ctlr_rtos->buf) {
+		printf("spis%d ring buffer alloc fail\n", bus_num);
+		return -EMEM;
+	}
+	memset(ctlr_rtos->buf, 0, MTK_SPIS_BUF_BYTES);
+	ctlr_rtos->rx_ring = ctlr_rtos->buf;
+	ctlr_rtos->tx_ring = ctlr_rtos->rx_ring + MTK_SPIS_RING_BYTES;
+	ctlr_rtos->response = ctlr_rtos->tx_ring + MTK_SPIS_RING_BYTES;
+	ctlr_rtos->scratch = ctlr_rtos->response + MTK_SPIS_FRAME_BYTES;
+
+	ctlr->base = (void __iomem *)spis_base_addr[bus_num];
+	ctlr->cg_base = (void __iomem *)cg_base_addr[bus_num];
+	ctlr->dma_tx_chan = spis_dma_chan[bus_num][0];
+	ctlr->dma_rx_chan = spis_dma_chan[bus_num][1];
+	ctlr->xfer = &ctlr_rtos->xfer;
+
+	mdata->d2hmb_state = SPIS_IDLE;
+	mdata->user_data = ctlr_rtos;
+	mtk_mhal_spis_handle_transfer_callback_register(ctlr,
+					_mtk_os_hal_spis_handle_transfer);
+	mtk_mhal_spis_dma_done_callback_register(ctlr,
+					_mtk_os_hal_spis_dma_done_callback);
+
+	mtk_mhal_spis_enable_clk(ctlr);
+	mtk_mhal_spis_setup_hw(ctlr, config);
+	mtk_mhal_spis_allocate_dma_chan(ctlr);
+
+	CM4_Install_NVIC(spis_irq_num[bus_num], DEFAULT_PRI, IRQ_LEVEL_TRIGGER,
+			 spis_irq_event[bus_num], TRUE);
+	mtk_mhal_spis_enable_irq(ctlr);
+
+	return 0;
+}
+
+int mtk_os_hal_spis_ctlr_deinit(spis_num bus_num)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos;
+	struct mtk_spis_controller *ctlr;
+
+	ctlr_rtos = _mtk_os_hal_spis_get_ctlr(bus_num);
+	if (!ctlr_rtos || !ctlr_rtos->ctlr)
+		return -EPTR;
+
+	ctlr = ctlr_rtos->ctlr;
+
+	NVIC_DisableIRQ((IRQn_Type)spis_irq_num[bus_num]);
+	mtk_mhal_spis_release_dma_chan(ctlr);
+	mtk_mhal_spis_disable_clk(ctlr);
+
+#if MTK_DMA_POOL_SIZE
+	mtk_os_hal_dma_pool_free(ctlr_rtos->buf);
+#elif defined(OSAI_FREERTOS)
+	vPortFree(ctlr_rtos->buf);
+#endif
+	ctlr_rtos->buf = NULL;
+	ctlr_rtos->ctlr = NULL;
+
+	return 0;
+}
+
+int mtk_os_hal_spis_register_callback(spis_num bus_num,
+				      spis_rx_frame_callback rx_done,
+				      spis_tx_frame_callback tx_done,
+				      void *context)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos;
+	u32 primask;
+
+	ctlr_rtos = _mtk_os_hal_spis_get_ctlr(bus_num);
+	if (!ctlr_rtos || !ctlr_rtos->ctlr)
+		return -EPTR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	ctlr_rtos->rx_done = rx_done;
+	ctlr_rtos->tx_done = tx_done;
+	ctlr_rtos->context = context;
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_spis_read(spis_num bus_num, u8 *buf, u32 len)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos;
+	u32 primask, tail, n;
+
+	ctlr_rtos = _mtk_os_hal_spis_get_ctlr(bus_num);
+	if (!ctlr_rtos || !ctlr_rtos->ctlr || !buf)
+		return -EPTR;
+
+	/* callers may be a task and an rx_done callback at once */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	tail = ctlr_rtos->rx_tail;
+	if (tail == ctlr_rtos->rx_head) {
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	n = ctlr_rtos->rx_len[tail % MTK_SPIS_RING_FRAMES];
+	if (n > len)
+		n = len;
+	memcpy(buf, _mtk_os_hal_spis_slot(ctlr_rtos->rx_ring, tail), n);
+	ctlr_rtos->rx_tail = tail + 1;
+	__set_PRIMASK(primask);
+
+	return n;
+}
+
+int mtk_os_hal_spis_write(spis_num bus_num, const u8 *buf, u32 len)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos;
+	u32 primask, head;
+	u8 *slot;
+
+	ctlr_rtos = _mtk_os_hal_spis_get_ctlr(bus_num);
+	if (!ctlr_rtos || !ctlr_rtos->ctlr || !buf)
+		return -EPTR;
+
+	if (len == 0 || len > MTK_SPIS_FRAME_BYTES)
+		return -ELENGTH;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	head = ctlr_rtos->tx_head;
+	if (head - ctlr_rtos->tx_tail >= MTK_SPIS_RING_FRAMES) {
+		__set_PRIMASK(primask);
+		return -EBUSY;
+	}
+	slot = _mtk_os_hal_spis_slot(ctlr_rtos->tx_ring, head);
+	memcpy(slot, buf, len);
+	memset(slot + len, 0, MTK_SPIS_FRAME_BYTES - len);
+	osai_clean_cache(slot, MTK_SPIS_FRAME_BYTES);
+	ctlr_rtos->tx_head = head + 1;
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_spis_set_response(spis_num bus_num, const u8 *buf, u32 len)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos;
+	u32 primask;
+
+	ctlr_rtos = _mtk_os_hal_spis_get_ctlr(bus_num);
+	if (!ctlr_rtos || !ctlr_rtos->ctlr || (len && !buf))
+		return -EPTR;
+
+	if (len > MTK_SPIS_FRAME_BYTES)
+		return -ELENGTH;
+
+	/* a host read already on the wire may see part of the new reply */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	memcpy(ctlr_rtos->response, buf, len);
+	memset(ctlr_rtos->response + len, 0, MTK_SPIS_FRAME_BYTES - len);
+	osai_clean_cache(ctlr_rtos->response, MTK_SPIS_FRAME_BYTES);
+	__set_PRIMASK(primask);
+
+	return 0;
+}
+
+int mtk_os_hal_spis_get_overrun(spis_num bus_num, u32 *count)
+{
+	struct mtk_spis_controller_rtos *ctlr_rtos;
+
+	ctlr_rtos = _mtk_os_hal_spis_get_ctlr(bus_num);
+	if (!ctlr_rtos || !ctlr_rtos->ctlr || !count)
+		return -EPTR;
+
+	*count = ctlr_rtos->overrun;
+
+	return 0;
+}
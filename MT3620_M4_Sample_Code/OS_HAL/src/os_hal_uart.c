@@ -466,6 +466,19 @@ int mtk_os_hal_uart_dma_send_data(UART_PORT port_num,
 	return ctlr->mdata->tx_size;
 }
 
+int mtk_os_hal_uart_dma_set_rx_timeout(UART_PORT port_num, u32 timeout_cnt)
+{
+	struct mtk_uart_controller_rtos *ctlr_rtos =
+		_mtk_os_hal_uart_get_ctlr(port_num);
+
+	if (!ctlr_rtos || !ctlr_rtos->ctlr)
+		return -UART_EPTR;
+
+	ctlr_rtos->ctlr->mdata->rx_timeout = timeout_cnt;
+
+	return 0;
+}
+
 int mtk_os_hal_uart_dma_get_data(UART_PORT port_num,
 	u8 *data, u32 len, bool vff_mode, u32 timeout)
 {